@@ -18,6 +18,16 @@ CALL build.bat
 POPD
 IF %ERRORLEVEL% NEQ 0 GOTO :error
 
+PUSHD tools\packer
+CALL build.bat
+POPD
+IF %ERRORLEVEL% NEQ 0 GOTO :error
+
+PUSHD tools\texconv
+CALL build.bat
+POPD
+IF %ERRORLEVEL% NEQ 0 GOTO :error
+
 ECHO "Done!"
 GOTO :end
 
@@ -0,0 +1,27 @@
+#!/bin/bash
+# Build Everything
+set -e
+
+echo "Building everything...."
+
+pushd platform > /dev/null
+./build.sh
+popd > /dev/null
+
+pushd fracture > /dev/null
+./build.sh
+popd > /dev/null
+
+pushd testbed > /dev/null
+./build.sh
+popd > /dev/null
+
+pushd tools/packer > /dev/null
+./build.sh
+popd > /dev/null
+
+pushd tools/texconv > /dev/null
+./build.sh
+popd > /dev/null
+
+echo "Done!"
@@ -0,0 +1,21 @@
+#!/bin/bash
+# Build script for the fracture engine
+set -e
+
+# Get a list of all the .c files
+cFileNames=$(find . -type f -name "*.c")
+
+assembly="fracture"
+compilerFlags="-g -shared -fPIC -fvisibility=hidden -Wvarargs -Wall -Werror -O3"
+# -Wall -Werror
+includeFlags="-I../fracture/src -I../platform/src"
+linkerFlags="-L../bin/ -lplatform -lvulkan -lxcb -lX11 -lX11-xcb -lpthread -lm"
+defines="-D_DEBUG -DFR_EXPORT -D_ENABLE_ASSERTS -DPLATFORM_LINUX -D_STRING_SAFETY_CHECKS -D_SIMD -DFR_MATH_FORCE_INLINE -D_RNG_XORWOW -D_VEC3_SIMD"
+
+mkdir -p ../bin
+
+echo "Building $assembly..."
+clang $cFileNames $compilerFlags -o ../bin/lib$assembly.so $defines $includeFlags $linkerFlags
+
+echo "Writing the compile_flags.txt file"
+echo $includeFlags $defines $compilerFlags | tr " " "\n" > compile_flags.txt
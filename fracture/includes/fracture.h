@@ -12,13 +12,24 @@
 #pragma once
 
 #include "fracture/core/containers/darrays.h"
+#include "fracture/core/library/cpu_features.h"
 #include "fracture/core/library/fracture_string.h"
 #include "fracture/core/library/random/fr_random.h"
+#include "fracture/core/library/spatial/bvh.h"
+#include "fracture/core/library/spatial/loose_tree.h"
+#include "fracture/core/library/spatial/spatial_hash.h"
 #include "fracture/core/systems/clock.h"
 #include "fracture/core/systems/event.h"
+#include "fracture/core/systems/file_io.h"
 #include "fracture/core/systems/fracture_memory.h"
 #include "fracture/core/systems/input.h"
+#include "fracture/core/systems/job_system.h"
 #include "fracture/core/systems/logging.h"
 #include "fracture/engine/application_types.h"
+#include "fracture/resources/image_loader.h"
+#include "fracture/resources/resource_pack.h"
+#include "fracture/resources/resource_system.h"
+#include "fracture/resources/texture_encoder.h"
+#include "fracture/resources/texture_file.h"
 #include "fracture/fracture_core.h"
 #include "fracture_math.h"
@@ -11,14 +11,20 @@
 #pragma once
 
 #include "fracture/core/library/math/affine.h"
+#include "fracture/core/library/math/frustum.h"
+#include "fracture/core/library/math/geometry.h"
 #include "fracture/core/library/math/ivec2.h"
 #include "fracture/core/library/math/ivec3.h"
 #include "fracture/core/library/math/ivec4.h"
 #include "fracture/core/library/math/mat2.h"
 #include "fracture/core/library/math/mat3.h"
 #include "fracture/core/library/math/mat4.h"
+#include "fracture/core/library/math/mat4_batch.h"
 #include "fracture/core/library/math/math_constants.h"
 #include "fracture/core/library/math/math_types.h"
+#include "fracture/core/library/math/quat_batch.h"
+#include "fracture/core/library/math/simd/dispatch.h"
+#include "fracture/core/library/math/transcendental.h"
 #include "fracture/core/library/math/utils.h"
 #include "fracture/core/library/math/vec2.h"
 #include "fracture/core/library/math/vec3.h"
@@ -3,15 +3,19 @@
 #include "fracture/core/systems/fracture_memory.h"
 #include "fracture/core/systems/logging.h"
 
+STATIC_ASSERT(sizeof(u64) * DARRAY_FIELDS_LENGTH <= DARRAY_HEADER_SIZE, "darray fields do not fit in the header");
+
 void* _darray_create(u64 capacity, u64 element_size) {
     u64 memory_requirement = element_size * capacity;
-    memory_requirement += sizeof(u64) * DARRAY_FIELDS_LENGTH;
-    u64* darray = fr_memory_allocate(memory_requirement, MEMORY_TYPE_DARRAY);
-    fr_memory_zero(darray, memory_requirement);
-    darray[DARRAY_CAPACITY] = capacity;
-    darray[DARRAY_LENGTH] = 0;
-    darray[DARRAY_ELEMENT_SIZE] = element_size;
-    return (void*)(darray + DARRAY_FIELDS_LENGTH);
+    memory_requirement += DARRAY_HEADER_SIZE;
+    u8* block = fr_memory_allocate_aligned(memory_requirement, FR_CACHE_LINE_SIZE, MEMORY_TYPE_DARRAY);
+    fr_memory_zero(block, memory_requirement);
+    void* darray = block + DARRAY_HEADER_SIZE;
+    u64* darray_header = (u64*)darray - DARRAY_FIELDS_LENGTH;
+    darray_header[DARRAY_CAPACITY] = capacity;
+    darray_header[DARRAY_LENGTH] = 0;
+    darray_header[DARRAY_ELEMENT_SIZE] = element_size;
+    return darray;
 }
 
 void darray_destroy(void* darray) {
@@ -19,10 +23,10 @@ void darray_destroy(void* darray) {
         return;
     }
     u64* darray_header = (u64*)darray - DARRAY_FIELDS_LENGTH;
-    fr_memory_free(
-        darray_header,
-        darray_header[DARRAY_CAPACITY] * darray_header[DARRAY_ELEMENT_SIZE] + sizeof(u64) * DARRAY_FIELDS_LENGTH,
-        MEMORY_TYPE_DARRAY);
+    fr_memory_free_aligned((u8*)darray - DARRAY_HEADER_SIZE,
+                           darray_header[DARRAY_CAPACITY] * darray_header[DARRAY_ELEMENT_SIZE] + DARRAY_HEADER_SIZE,
+                           FR_CACHE_LINE_SIZE,
+                           MEMORY_TYPE_DARRAY);
 }
 
 void* darray_resize(void* darray, u64 new_capacity) {
@@ -9,7 +9,9 @@
  * of memory that contains the array. Before this block of memory the length of
  * the array, the capacity of the array, and the size of each element in the
  * array are stored continuously. The dynamic array is a generic data structure
- * and can store elements of any type.
+ * and can store elements of any type. The header takes up a whole cache line
+ * and the block is cache line aligned so the elements always start on a cache
+ * line, which keeps arrays of SIMD types aligned for aligned loads.
  * @version 0.0.1
  * @date 2024-02-17
  *
@@ -33,6 +35,9 @@ typedef struct darray {
 
 typedef enum darray_fields { DARRAY_LENGTH, DARRAY_CAPACITY, DARRAY_ELEMENT_SIZE, DARRAY_FIELDS_LENGTH } darray_fields;
 
+// Size of the header in front of the elements. The fields sit at the end of it, right before the first element.
+#define DARRAY_HEADER_SIZE FR_CACHE_LINE_SIZE
+
 #define DARRAY_DEFAULT_CAPACITY 8
 #define DARRAY_GROWTH_FACTOR 2
 
@@ -56,13 +56,20 @@ typedef char b8;
 #define MB(x) (x * 1000ULL * 1000ULL)
 #define GB(x) (x * 1000ULL * 1000ULL * 1000ULL)
 
+// Size of a cache line. Used to pad data that is written by different threads to avoid false sharing and to align
+// arrays that are streamed through SIMD code.
+#define FR_CACHE_LINE_SIZE 64
+
+// Size of a memory page
+#define FR_PAGE_SIZE 4096
+
 // Min and Max and Clamp
 #define MIN(x, y) (x < y ? x : y)
 #define MAX(x, y) (x > y ? x : y)
 #define CLAMP(x, min, max) (x < min ? min : (x > max ? max : x))
 
 // Define static assert
-#if defined(__clang__) || defined(__gcc__)
+#if defined(__clang__) || defined(__GNUC__)
 #define STATIC_ASSERT _Static_assert
 #else
 #define STATIC_ASSERT static_assert
@@ -128,7 +135,13 @@ STATIC_ASSERT(sizeof(b8) == 1, "b8 is not 1 byte");
 
 // Define debug break
 #ifdef _ENABLE_ASSERTS
+#if defined(_MSC_VER) || defined(_WIN32)
 #define DEBUG_BREAK() __debugbreak()
+#elif defined(__clang__)
+#define DEBUG_BREAK() __builtin_debugtrap()
+#else
+#define DEBUG_BREAK() __builtin_trap()
+#endif
 #define FR_ENABLE_ASSERTS 1
 #define FR_ASSERT(expression) \
     if (expression) {         \
@@ -147,7 +160,7 @@ STATIC_ASSERT(sizeof(b8) == 1, "b8 is not 1 byte");
 #error "64-bit Windows is required"
 #endif
 #elif defined(__linux__) || defined(__gnu_linux__)
-#define FR_PLATFORM_LINUX
+#define FR_PLATFORM_LINUX 1
 #ifndef __x86_64__
 #error "64-bit Linux is required"
 #endif
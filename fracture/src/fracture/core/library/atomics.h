@@ -0,0 +1,98 @@
+/**
+ * @file atomics.h
+ * @author Aditya Rajagopal
+ * @brief Thin inline wrappers over the compiler atomic builtins used by the multithreaded systems of the engine.
+ * @details The loads and stores take an explicit memory order so that lock free code (e.g. the work stealing deques of
+ * the job system) can spell out exactly which barriers it needs. Both clang and gcc provide the __atomic builtins on
+ * every platform we support.
+ * @version 0.0.1
+ * @date 2024-04-04
+ *
+ * @copyright Fracture Game Engine is Copyright (c) Aditya Rajagopal 2024-2024
+ *
+ */
+#pragma once
+
+#include "fracture/core/defines.h"
+
+#define FR_MEMORY_ORDER_RELAXED __ATOMIC_RELAXED
+#define FR_MEMORY_ORDER_ACQUIRE __ATOMIC_ACQUIRE
+#define FR_MEMORY_ORDER_RELEASE __ATOMIC_RELEASE
+#define FR_MEMORY_ORDER_ACQ_REL __ATOMIC_ACQ_REL
+#define FR_MEMORY_ORDER_SEQ_CST __ATOMIC_SEQ_CST
+
+static inline i32 fr_atomic_load_i32(const volatile i32* value, i32 order) { return __atomic_load_n(value, order); }
+
+static inline void fr_atomic_store_i32(volatile i32* value, i32 desired, i32 order) {
+    __atomic_store_n(value, desired, order);
+}
+
+/**
+ * @brief Atomically adds to the value and returns the value before the addition.
+ */
+static inline i32 fr_atomic_fetch_add_i32(volatile i32* value, i32 amount, i32 order) {
+    return __atomic_fetch_add(value, amount, order);
+}
+
+/**
+ * @brief Atomically replaces the value and returns the previous value.
+ */
+static inline i32 fr_atomic_exchange_i32(volatile i32* value, i32 desired, i32 order) {
+    return __atomic_exchange_n(value, desired, order);
+}
+
+/**
+ * @brief Atomically replaces the value with desired if it is equal to expected.
+ * @return b8 TRUE if the exchange happened, FALSE otherwise in which case expected holds the current value.
+ */
+static inline b8 fr_atomic_compare_exchange_i32(volatile i32* value, i32* expected, i32 desired, i32 order) {
+    return __atomic_compare_exchange_n(value, expected, desired, FALSE, order, FR_MEMORY_ORDER_RELAXED);
+}
+
+static inline i64 fr_atomic_load_i64(const volatile i64* value, i32 order) { return __atomic_load_n(value, order); }
+
+static inline void fr_atomic_store_i64(volatile i64* value, i64 desired, i32 order) {
+    __atomic_store_n(value, desired, order);
+}
+
+/**
+ * @brief Atomically adds to the value and returns the value before the addition.
+ */
+static inline i64 fr_atomic_fetch_add_i64(volatile i64* value, i64 amount, i32 order) {
+    return __atomic_fetch_add(value, amount, order);
+}
+
+/**
+ * @brief Atomically replaces the value with desired if it is equal to expected.
+ * @return b8 TRUE if the exchange happened, FALSE otherwise in which case expected holds the current value.
+ */
+static inline b8 fr_atomic_compare_exchange_i64(volatile i64* value, i64* expected, i64 desired, i32 order) {
+    return __atomic_compare_exchange_n(value, expected, desired, FALSE, order, FR_MEMORY_ORDER_RELAXED);
+}
+
+static inline void* fr_atomic_load_ptr(void* const volatile* value, i32 order) { return __atomic_load_n(value, order); }
+
+static inline void fr_atomic_store_ptr(void* volatile* value, void* desired, i32 order) {
+    __atomic_store_n(value, desired, order);
+}
+
+/**
+ * @brief Atomically replaces the pointer and returns the previous pointer.
+ */
+static inline void* fr_atomic_exchange_ptr(void* volatile* value, void* desired, i32 order) {
+    return __atomic_exchange_n(value, desired, order);
+}
+
+/**
+ * @brief Issues a memory fence with the given order.
+ */
+static inline void fr_atomic_fence(i32 order) { __atomic_thread_fence(order); }
+
+/**
+ * @brief Hints to the processor that the calling thread is in a spin wait loop.
+ */
+static inline void fr_atomic_pause() {
+#if defined(__x86_64__) || defined(_M_X64)
+    __builtin_ia32_pause();
+#endif
+}
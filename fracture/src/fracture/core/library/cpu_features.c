@@ -0,0 +1,109 @@
+#include "cpu_features.h"
+
+#include "fracture/core/library/atomics.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define FR_CPU_X86 1
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#else
+#define FR_CPU_X86 0
+#endif
+
+// Sentinel for features that have not been detected yet. Detection never sets the top bit.
+#define CPU_FEATURES_UNKNOWN -1
+
+// XCR0 bits of the register state the operating system saves
+#define XCR0_SSE_AVX_STATE 0x6
+#define XCR0_AVX512_STATE 0xE0
+
+static volatile i32 cpu_features = CPU_FEATURES_UNKNOWN;
+
+static u32 _cpu_detect_features();
+
+u32 fr_cpu_features() {
+    i32 features = fr_atomic_load_i32(&cpu_features, FR_MEMORY_ORDER_RELAXED);
+    if (features == CPU_FEATURES_UNKNOWN) {
+        // Detection gives the same answer on every thread so racing callers can all store it
+        features = (i32)_cpu_detect_features();
+        fr_atomic_store_i32(&cpu_features, features, FR_MEMORY_ORDER_RELAXED);
+    }
+    return (u32)features;
+}
+
+b8 fr_cpu_has_feature(cpu_feature_flags feature) { return (fr_cpu_features() & feature) == (u32)feature; }
+
+// -----------------------------------------------------------------------
+// PRIVATE FUNCTIONS
+// -----------------------------------------------------------------------
+
+#if FR_CPU_X86
+static void _cpu_cpuid(u32 leaf, u32 subleaf, u32* out_registers) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int registers[4];
+    __cpuidex(registers, (int)leaf, (int)subleaf);
+    for (u32 i = 0; i < 4; ++i) {
+        out_registers[i] = (u32)registers[i];
+    }
+#else
+    __cpuid_count(leaf, subleaf, out_registers[0], out_registers[1], out_registers[2], out_registers[3]);
+#endif
+}
+
+static u64 _cpu_xgetbv() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    return _xgetbv(0);
+#else
+    u32 low, high;
+    __asm__ volatile("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+    return ((u64)high << 32) | low;
+#endif
+}
+#endif
+
+static u32 _cpu_detect_features() {
+    u32 features = 0;
+#if FR_CPU_X86
+    // eax, ebx, ecx, edx
+    u32 registers[4];
+    _cpu_cpuid(0, 0, registers);
+    u32 max_leaf = registers[0];
+    if (max_leaf < 1) {
+        return features;
+    }
+
+    _cpu_cpuid(1, 0, registers);
+    u32 ecx = registers[2];
+    u32 edx = registers[3];
+    features |= (edx & BIT(26)) ? FR_CPU_FEATURE_SSE2 : 0;
+    features |= (ecx & BIT(0)) ? FR_CPU_FEATURE_SSE3 : 0;
+    features |= (ecx & BIT(9)) ? FR_CPU_FEATURE_SSSE3 : 0;
+    features |= (ecx & BIT(19)) ? FR_CPU_FEATURE_SSE41 : 0;
+    features |= (ecx & BIT(20)) ? FR_CPU_FEATURE_SSE42 : 0;
+
+    // The AVX registers are only usable if the operating system saves them (OSXSAVE and the XCR0 state bits)
+    b8 os_saves_avx = FALSE;
+    b8 os_saves_avx512 = FALSE;
+    if (ecx & BIT(27)) {
+        u64 xcr0 = _cpu_xgetbv();
+        os_saves_avx = (xcr0 & XCR0_SSE_AVX_STATE) == XCR0_SSE_AVX_STATE;
+        os_saves_avx512 = os_saves_avx && (xcr0 & XCR0_AVX512_STATE) == XCR0_AVX512_STATE;
+    }
+    if (!os_saves_avx) {
+        return features;
+    }
+    features |= (ecx & BIT(28)) ? FR_CPU_FEATURE_AVX : 0;
+    features |= (ecx & BIT(12)) ? FR_CPU_FEATURE_FMA : 0;
+
+    if (max_leaf >= 7) {
+        _cpu_cpuid(7, 0, registers);
+        u32 ebx = registers[1];
+        features |= (ebx & BIT(5)) ? FR_CPU_FEATURE_AVX2 : 0;
+        features |= (os_saves_avx512 && (ebx & BIT(16))) ? FR_CPU_FEATURE_AVX512F : 0;
+    }
+#endif
+    return features;
+}
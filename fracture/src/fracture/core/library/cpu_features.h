@@ -0,0 +1,64 @@
+/**
+ * @file cpu_features.h
+ * @author Aditya Rajagopal
+ * @brief Runtime detection of the instruction set extensions of the processor.
+ * @details The engine is compiled for the SSE2 baseline. Code paths that need newer extensions are compiled with the
+ * target attribute of the function (FR_TARGET_*) and only called after checking fr_cpu_has_feature, so a single
+ * binary runs everywhere and still uses AVX2 where it is available. Extensions that use the wider registers are only
+ * reported if the operating system saves those registers on context switches.
+ * @version 0.0.1
+ * @date 2024-04-24
+ *
+ * @copyright Fracture Game Engine is Copyright (c) Aditya Rajagopal 2024-2024
+ *
+ */
+#pragma once
+
+#include "fracture/core/defines.h"
+
+#if defined(_MSC_VER) && !defined(__clang__)
+// MSVC allows intrinsics of any extension in any function
+#define FR_TARGET_SSSE3
+#define FR_TARGET_SSE41
+#define FR_TARGET_AVX2
+#define FR_TARGET_AVX2_FMA
+#define FR_TARGET_AVX512
+#else
+#define FR_TARGET_SSSE3 __attribute__((target("ssse3")))
+#define FR_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define FR_TARGET_AVX2 __attribute__((target("avx2")))
+#define FR_TARGET_AVX2_FMA __attribute__((target("avx2,fma")))
+#define FR_TARGET_AVX512 __attribute__((target("avx512f")))
+#endif
+
+/**
+ * @brief Instruction set extensions that can be queried.
+ *
+ */
+typedef enum cpu_feature_flags {
+    FR_CPU_FEATURE_SSE2 = BIT(0),
+    FR_CPU_FEATURE_SSE3 = BIT(1),
+    FR_CPU_FEATURE_SSSE3 = BIT(2),
+    FR_CPU_FEATURE_SSE41 = BIT(3),
+    FR_CPU_FEATURE_SSE42 = BIT(4),
+    FR_CPU_FEATURE_AVX = BIT(5),
+    FR_CPU_FEATURE_AVX2 = BIT(6),
+    FR_CPU_FEATURE_FMA = BIT(7),
+    FR_CPU_FEATURE_AVX512F = BIT(8),
+} cpu_feature_flags;
+
+/**
+ * @brief Gets the extensions supported by the processor and the operating system. Detected on the first call, later
+ * calls return the cached result.
+ *
+ * @return u32 Combination of cpu_feature_flags
+ */
+FR_API u32 fr_cpu_features();
+
+/**
+ * @brief Checks if an extension is supported.
+ *
+ * @param feature One of cpu_feature_flags
+ * @return b8 TRUE if the extension can be used, FALSE otherwise
+ */
+FR_API b8 fr_cpu_has_feature(cpu_feature_flags feature);
@@ -0,0 +1,575 @@
+#include "fracture_compression.h"
+
+#include <string.h>
+
+#define LZ4_MIN_MATCH 4
+// The last LZ4_LAST_LITERALS bytes are always literals and the last match starts LZ4_MATCH_FIND_LIMIT bytes before the
+// end at the latest. Required by the format so that decoders can copy in wide chunks.
+#define LZ4_LAST_LITERALS 5
+#define LZ4_MATCH_FIND_LIMIT 12
+#define LZ4_MAX_OFFSET 65535
+#define LZ4_HASH_BITS 12
+// The search step grows by one for every 2^LZ4_SKIP_TRIGGER bytes without a match so incompressible data is skipped
+// quickly
+#define LZ4_SKIP_TRIGGER 6
+
+static inline u32 _lz4_read32(const u8* p) {
+    u32 value;
+    memcpy(&value, p, sizeof(u32));
+    return value;
+}
+
+static inline u32 _lz4_hash(u32 sequence) { return (sequence * 2654435761U) >> (32 - LZ4_HASH_BITS); }
+
+// Writes the extra bytes of a literal or match length that did not fit in its 4 bits of the token
+static inline u8* _lz4_write_length(u8* op, u64 length) {
+    while (length >= 255) {
+        *op++ = 255;
+        length -= 255;
+    }
+    *op++ = (u8)length;
+    return op;
+}
+
+u64 fr_compress_lz4_bound(u64 size) { return size + size / 255 + 16; }
+
+u64 fr_compress_lz4(const void* source, u64 source_size, void* dest, u64 dest_capacity) {
+    if (source_size > FR_LZ4_MAX_INPUT_SIZE) {
+        return 0;
+    }
+
+    const u8* src = (const u8*)source;
+    u8* dst = (u8*)dest;
+    u8* op = dst;
+    u8* const op_end = dst + dest_capacity;
+
+    u32 table[1 << LZ4_HASH_BITS];
+    memset(table, 0, sizeof(table));
+
+    u64 anchor = 0;
+    u64 ip = 1;
+    if (source_size > LZ4_MATCH_FIND_LIMIT) {
+        const u64 match_limit = source_size - LZ4_MATCH_FIND_LIMIT;
+        const u64 extend_limit = source_size - LZ4_LAST_LITERALS;
+
+        while (ip < match_limit) {
+            u32 sequence = _lz4_read32(src + ip);
+            u32 hash = _lz4_hash(sequence);
+            u64 candidate = table[hash];
+            table[hash] = (u32)ip;
+
+            if (ip - candidate > LZ4_MAX_OFFSET || _lz4_read32(src + candidate) != sequence) {
+                ip += 1 + ((ip - anchor) >> LZ4_SKIP_TRIGGER);
+                continue;
+            }
+
+            // Grow the match backwards into the pending literals and then forwards
+            while (ip > anchor && candidate > 0 && src[ip - 1] == src[candidate - 1]) {
+                ip--;
+                candidate--;
+            }
+            u64 match_length = LZ4_MIN_MATCH;
+            while (ip + match_length < extend_limit && src[ip + match_length] == src[candidate + match_length]) {
+                match_length++;
+            }
+
+            u64 literal_length = ip - anchor;
+            // Token, worst case length bytes for both lengths, literals and offset
+            if ((u64)(op_end - op) < 1 + literal_length / 255 + 1 + literal_length + 2 + match_length / 255 + 1) {
+                return 0;
+            }
+
+            u8* token = op++;
+            *token = (u8)((literal_length >= 15 ? 15 : literal_length) << 4);
+            if (literal_length >= 15) {
+                op = _lz4_write_length(op, literal_length - 15);
+            }
+            memcpy(op, src + anchor, literal_length);
+            op += literal_length;
+
+            u64 offset = ip - candidate;
+            *op++ = (u8)(offset & 0xFF);
+            *op++ = (u8)(offset >> 8);
+
+            u64 extra_match = match_length - LZ4_MIN_MATCH;
+            *token |= (u8)(extra_match >= 15 ? 15 : extra_match);
+            if (extra_match >= 15) {
+                op = _lz4_write_length(op, extra_match - 15);
+            }
+
+            ip += match_length;
+            anchor = ip;
+            // Index a position inside the match so that the next repeat of it is found
+            if (ip - 2 < match_limit) {
+                table[_lz4_hash(_lz4_read32(src + ip - 2))] = (u32)(ip - 2);
+            }
+        }
+    }
+
+    // The last sequence is literals only
+    u64 literal_length = source_size - anchor;
+    if ((u64)(op_end - op) < 1 + literal_length / 255 + 1 + literal_length) {
+        return 0;
+    }
+    u8* token = op++;
+    *token = (u8)((literal_length >= 15 ? 15 : literal_length) << 4);
+    if (literal_length >= 15) {
+        op = _lz4_write_length(op, literal_length - 15);
+    }
+    memcpy(op, src + anchor, literal_length);
+    op += literal_length;
+
+    return (u64)(op - dst);
+}
+
+b8 fr_decompress_lz4(const void* source, u64 source_size, void* dest, u64 dest_size) {
+    const u8* ip = (const u8*)source;
+    const u8* const ip_end = ip + source_size;
+    u8* const dst = (u8*)dest;
+    u8* op = dst;
+    u8* const op_end = dst + dest_size;
+
+    while (ip < ip_end) {
+        u8 token = *ip++;
+
+        u64 literal_length = token >> 4;
+        if (literal_length == 15) {
+            u8 extra;
+            do {
+                if (ip == ip_end) {
+                    return FALSE;
+                }
+                extra = *ip++;
+                literal_length += extra;
+            } while (extra == 255);
+        }
+        if ((u64)(ip_end - ip) < literal_length || (u64)(op_end - op) < literal_length) {
+            return FALSE;
+        }
+        memcpy(op, ip, literal_length);
+        ip += literal_length;
+        op += literal_length;
+
+        // The last sequence has no match
+        if (ip == ip_end) {
+            break;
+        }
+
+        if (ip_end - ip < 2) {
+            return FALSE;
+        }
+        u64 offset = (u64)ip[0] | ((u64)ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > (u64)(op - dst)) {
+            return FALSE;
+        }
+
+        u64 match_length = (token & 15);
+        if (match_length == 15) {
+            u8 extra;
+            do {
+                if (ip == ip_end) {
+                    return FALSE;
+                }
+                extra = *ip++;
+                match_length += extra;
+            } while (extra == 255);
+        }
+        match_length += LZ4_MIN_MATCH;
+        if ((u64)(op_end - op) < match_length) {
+            return FALSE;
+        }
+
+        const u8* match = op - offset;
+        if (offset >= match_length) {
+            memcpy(op, match, match_length);
+            op += match_length;
+        } else {
+            // Overlapping matches repeat the last offset bytes, which a forward byte copy does naturally
+            for (u64 i = 0; i < match_length; ++i) {
+                *op++ = match[i];
+            }
+        }
+    }
+
+    return op == op_end;
+}
+
+// Codes of up to ZLIB_FAST_BITS bits are decoded with one lookup, longer ones by walking the canonical code lengths
+#define ZLIB_FAST_BITS 10
+#define ZLIB_FAST_MASK ((1 << ZLIB_FAST_BITS) - 1)
+#define ZLIB_MAX_CODE_LENGTH 15
+#define ZLIB_LITERAL_SYMBOLS 288
+#define ZLIB_DISTANCE_SYMBOLS 32
+#define ZLIB_END_OF_BLOCK 256
+
+typedef struct zlib_huffman {
+    // (code length << 9) | symbol, 0 for codes longer than ZLIB_FAST_BITS
+    u16 fast[1 << ZLIB_FAST_BITS];
+    u16 first_code[ZLIB_MAX_CODE_LENGTH + 1];
+    u16 first_symbol[ZLIB_MAX_CODE_LENGTH + 1];
+    // Exclusive upper bound of the codes of each length, left aligned to 16 bits
+    u32 max_code[ZLIB_MAX_CODE_LENGTH + 2];
+    u8 lengths[ZLIB_LITERAL_SYMBOLS];
+    u16 symbols[ZLIB_LITERAL_SYMBOLS];
+} zlib_huffman;
+
+typedef struct zlib_stream {
+    const u8* in;
+    const u8* in_end;
+    u64 bits;
+    u32 bit_count;
+    u8* out_start;
+    u8* out;
+    u8* out_end;
+} zlib_stream;
+
+static const u16 zlib_length_base[29] = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+                                         31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const u8 zlib_length_extra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                         2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+static const u16 zlib_distance_base[30] = {1,    2,    3,    4,    5,    7,     9,     13,    17,  25,
+                                           33,   49,   65,   97,   129,  193,   257,   385,   513, 769,
+                                           1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+static const u8 zlib_distance_extra[30] = {0, 0, 0, 0, 1, 1, 2, 2,  3,  3,  4,  4,  5,  5,  6,
+                                           6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+// Order the code lengths of the code length alphabet are stored in
+static const u8 zlib_code_length_order[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+static inline u32 _zlib_reverse_bits(u32 code, u32 length) {
+    u32 result = 0;
+    for (u32 i = 0; i < length; ++i) {
+        result = (result << 1) | (code & 1);
+        code >>= 1;
+    }
+    return result;
+}
+
+static inline void _zlib_refill(zlib_stream* stream) {
+    if (stream->in_end - stream->in >= 8) {
+        // Loads a whole word and only counts the complete bytes that fit. The partial byte on top is loaded again,
+        // with the same bits in the same place, by the next refill.
+        u64 word;
+        memcpy(&word, stream->in, sizeof(u64));
+        stream->bits |= word << stream->bit_count;
+        stream->in += (63 - stream->bit_count) >> 3;
+        stream->bit_count |= 56;
+        return;
+    }
+    while (stream->bit_count <= 56 && stream->in < stream->in_end) {
+        stream->bits |= (u64)(*stream->in++) << stream->bit_count;
+        stream->bit_count += 8;
+    }
+}
+
+static inline b8 _zlib_read_bits(zlib_stream* stream, u32 count, u32* out_value) {
+    if (stream->bit_count < count) {
+        _zlib_refill(stream);
+        if (stream->bit_count < count) {
+            return FALSE;
+        }
+    }
+    *out_value = (u32)(stream->bits & ((1ULL << count) - 1));
+    stream->bits >>= count;
+    stream->bit_count -= count;
+    return TRUE;
+}
+
+static b8 _zlib_build_huffman(zlib_huffman* huffman, const u8* lengths, u32 count) {
+    u32 length_counts[ZLIB_MAX_CODE_LENGTH + 1] = {0};
+    u32 next_code[ZLIB_MAX_CODE_LENGTH + 1];
+    memset(huffman->fast, 0, sizeof(huffman->fast));
+    for (u32 i = 0; i < count; ++i) {
+        length_counts[lengths[i]]++;
+    }
+    length_counts[0] = 0;
+
+    u32 code = 0;
+    u32 symbol = 0;
+    for (u32 length = 1; length <= ZLIB_MAX_CODE_LENGTH; ++length) {
+        next_code[length] = code;
+        huffman->first_code[length] = (u16)code;
+        huffman->first_symbol[length] = (u16)symbol;
+        code += length_counts[length];
+        // Over subscribed code
+        if (length_counts[length] != 0 && code - 1 >= (1u << length)) {
+            return FALSE;
+        }
+        huffman->max_code[length] = code << (16 - length);
+        code <<= 1;
+        symbol += length_counts[length];
+    }
+    huffman->max_code[ZLIB_MAX_CODE_LENGTH + 1] = 0x10000;
+
+    for (u32 i = 0; i < count; ++i) {
+        u32 length = lengths[i];
+        if (length == 0) {
+            continue;
+        }
+        u32 slot = next_code[length] - huffman->first_code[length] + huffman->first_symbol[length];
+        huffman->lengths[slot] = (u8)length;
+        huffman->symbols[slot] = (u16)i;
+        if (length <= ZLIB_FAST_BITS) {
+            // DEFLATE sends codes most significant bit first, so the table is indexed by the reversed code
+            u16 entry = (u16)((length << 9) | i);
+            for (u32 j = _zlib_reverse_bits(next_code[length], length); j < (1u << ZLIB_FAST_BITS); j += 1u << length) {
+                huffman->fast[j] = entry;
+            }
+        }
+        next_code[length]++;
+    }
+    return TRUE;
+}
+
+static inline b8 _zlib_decode(zlib_stream* stream, const zlib_huffman* huffman, u32* out_symbol) {
+    if (stream->bit_count < 16) {
+        _zlib_refill(stream);
+    }
+
+    u32 entry = huffman->fast[stream->bits & ZLIB_FAST_MASK];
+    u32 length;
+    u32 symbol;
+    if (entry != 0) {
+        length = entry >> 9;
+        symbol = entry & 511;
+    } else {
+        u32 code = _zlib_reverse_bits((u32)(stream->bits & 0xFFFF), 16);
+        for (length = ZLIB_FAST_BITS + 1; length <= ZLIB_MAX_CODE_LENGTH; ++length) {
+            if (code < huffman->max_code[length]) {
+                break;
+            }
+        }
+        if (length > ZLIB_MAX_CODE_LENGTH) {
+            return FALSE;
+        }
+        u32 slot = (code >> (16 - length)) - huffman->first_code[length] + huffman->first_symbol[length];
+        if (slot >= ZLIB_LITERAL_SYMBOLS || huffman->lengths[slot] != length) {
+            return FALSE;
+        }
+        symbol = huffman->symbols[slot];
+    }
+
+    if (length > stream->bit_count) {
+        return FALSE;
+    }
+    stream->bits >>= length;
+    stream->bit_count -= length;
+    *out_symbol = symbol;
+    return TRUE;
+}
+
+static b8 _zlib_stored_block(zlib_stream* stream) {
+    // Skip to the byte boundary, the remaining bits of the buffer are whole bytes of the stream
+    u32 padding = stream->bit_count & 7;
+    stream->bits >>= padding;
+    stream->bit_count -= padding;
+
+    u32 length, inverse_length;
+    if (!_zlib_read_bits(stream, 16, &length) || !_zlib_read_bits(stream, 16, &inverse_length) ||
+        (length ^ 0xFFFF) != inverse_length) {
+        return FALSE;
+    }
+    if ((u64)(stream->out_end - stream->out) < length) {
+        return FALSE;
+    }
+
+    // The buffer only holds whole bytes after the padding, and they are the ones right before in. Hand them back and
+    // copy the whole block from the input.
+    stream->in -= stream->bit_count >> 3;
+    stream->bits = 0;
+    stream->bit_count = 0;
+
+    if ((u64)(stream->in_end - stream->in) < length) {
+        return FALSE;
+    }
+    memcpy(stream->out, stream->in, length);
+    stream->out += length;
+    stream->in += length;
+    return TRUE;
+}
+
+static b8 _zlib_dynamic_tables(zlib_stream* stream, zlib_huffman* literals, zlib_huffman* distances) {
+    u32 literal_count, distance_count, code_length_count;
+    if (!_zlib_read_bits(stream, 5, &literal_count) || !_zlib_read_bits(stream, 5, &distance_count) ||
+        !_zlib_read_bits(stream, 4, &code_length_count)) {
+        return FALSE;
+    }
+    literal_count += 257;
+    distance_count += 1;
+    code_length_count += 4;
+
+    u8 code_length_lengths[19] = {0};
+    for (u32 i = 0; i < code_length_count; ++i) {
+        u32 length;
+        if (!_zlib_read_bits(stream, 3, &length)) {
+            return FALSE;
+        }
+        code_length_lengths[zlib_code_length_order[i]] = (u8)length;
+    }
+    zlib_huffman code_lengths;
+    if (!_zlib_build_huffman(&code_lengths, code_length_lengths, 19)) {
+        return FALSE;
+    }
+
+    // Literal and distance code lengths are one sequence, repeats can cross from one to the other
+    u8 lengths[ZLIB_LITERAL_SYMBOLS + ZLIB_DISTANCE_SYMBOLS];
+    u32 total = literal_count + distance_count;
+    u32 count = 0;
+    while (count < total) {
+        u32 symbol;
+        if (!_zlib_decode(stream, &code_lengths, &symbol)) {
+            return FALSE;
+        }
+        if (symbol < 16) {
+            lengths[count++] = (u8)symbol;
+            continue;
+        }
+
+        u32 repeat;
+        u8 value = 0;
+        if (symbol == 16) {
+            if (count == 0 || !_zlib_read_bits(stream, 2, &repeat)) {
+                return FALSE;
+            }
+            repeat += 3;
+            value = lengths[count - 1];
+        } else if (symbol == 17) {
+            if (!_zlib_read_bits(stream, 3, &repeat)) {
+                return FALSE;
+            }
+            repeat += 3;
+        } else {
+            if (!_zlib_read_bits(stream, 7, &repeat)) {
+                return FALSE;
+            }
+            repeat += 11;
+        }
+        if (total - count < repeat) {
+            return FALSE;
+        }
+        memset(lengths + count, value, repeat);
+        count += repeat;
+    }
+
+    // The end of block code must exist
+    if (lengths[ZLIB_END_OF_BLOCK] == 0) {
+        return FALSE;
+    }
+    return _zlib_build_huffman(literals, lengths, literal_count) &&
+           _zlib_build_huffman(distances, lengths + literal_count, distance_count);
+}
+
+static b8 _zlib_fixed_tables(zlib_huffman* literals, zlib_huffman* distances) {
+    u8 lengths[ZLIB_LITERAL_SYMBOLS];
+    memset(lengths, 8, 144);
+    memset(lengths + 144, 9, 112);
+    memset(lengths + 256, 7, 24);
+    memset(lengths + 280, 8, 8);
+    if (!_zlib_build_huffman(literals, lengths, ZLIB_LITERAL_SYMBOLS)) {
+        return FALSE;
+    }
+    memset(lengths, 5, ZLIB_DISTANCE_SYMBOLS);
+    return _zlib_build_huffman(distances, lengths, ZLIB_DISTANCE_SYMBOLS);
+}
+
+static b8 _zlib_compressed_block(zlib_stream* stream, const zlib_huffman* literals, const zlib_huffman* distances) {
+    for (;;) {
+        u32 symbol;
+        if (!_zlib_decode(stream, literals, &symbol)) {
+            return FALSE;
+        }
+        if (symbol < 256) {
+            if (stream->out == stream->out_end) {
+                return FALSE;
+            }
+            *stream->out++ = (u8)symbol;
+            continue;
+        }
+        if (symbol == ZLIB_END_OF_BLOCK) {
+            return TRUE;
+        }
+
+        symbol -= 257;
+        if (symbol >= 29) {
+            return FALSE;
+        }
+        u32 extra;
+        if (!_zlib_read_bits(stream, zlib_length_extra[symbol], &extra)) {
+            return FALSE;
+        }
+        u64 length = zlib_length_base[symbol] + extra;
+
+        if (!_zlib_decode(stream, distances, &symbol) || symbol >= 30 ||
+            !_zlib_read_bits(stream, zlib_distance_extra[symbol], &extra)) {
+            return FALSE;
+        }
+        u64 distance = zlib_distance_base[symbol] + extra;
+        if (distance > (u64)(stream->out - stream->out_start) || length > (u64)(stream->out_end - stream->out)) {
+            return FALSE;
+        }
+
+        u8* out = stream->out;
+        const u8* match = out - distance;
+        stream->out += length;
+        if (distance == 1) {
+            memset(out, *match, length);
+        } else if (distance >= 8 && (u64)(stream->out_end - out) >= length + 8) {
+            // Copy whole words, overshooting by up to 7 bytes that the next symbols overwrite
+            for (u64 i = 0; i < length; i += 8) {
+                memcpy(out + i, match + i, 8);
+            }
+        } else {
+            // Overlapping matches repeat the last distance bytes, which a forward byte copy does naturally
+            for (u64 i = 0; i < length; ++i) {
+                out[i] = match[i];
+            }
+        }
+    }
+}
+
+b8 fr_decompress_zlib(const void* source, u64 source_size, void* dest, u64 dest_capacity, u64* out_size) {
+    const u8* in = (const u8*)source;
+    if (source_size < 2) {
+        return FALSE;
+    }
+    // Deflate with a window of at most 32 KiB, no preset dictionary, and the header check
+    u32 method = in[0] & 15;
+    u32 window_bits = (in[0] >> 4) + 8;
+    if (method != 8 || window_bits > 15 || (in[1] & 0x20) != 0 || ((in[0] << 8) | in[1]) % 31 != 0) {
+        return FALSE;
+    }
+
+    zlib_stream stream = {0};
+    stream.in = in + 2;
+    stream.in_end = in + source_size;
+    stream.out_start = (u8*)dest;
+    stream.out = stream.out_start;
+    stream.out_end = stream.out_start + dest_capacity;
+
+    zlib_huffman literals;
+    zlib_huffman distances;
+    u32 final_block = 0;
+    do {
+        u32 type;
+        if (!_zlib_read_bits(&stream, 1, &final_block) || !_zlib_read_bits(&stream, 2, &type)) {
+            return FALSE;
+        }
+
+        b8 result = FALSE;
+        if (type == 0) {
+            result = _zlib_stored_block(&stream);
+        } else if (type == 1) {
+            result = _zlib_fixed_tables(&literals, &distances) &&
+                     _zlib_compressed_block(&stream, &literals, &distances);
+        } else if (type == 2) {
+            result = _zlib_dynamic_tables(&stream, &literals, &distances) &&
+                     _zlib_compressed_block(&stream, &literals, &distances);
+        }
+        if (!result) {
+            return FALSE;
+        }
+    } while (!final_block);
+
+    *out_size = (u64)(stream.out - stream.out_start);
+    return TRUE;
+}
@@ -0,0 +1,67 @@
+/**
+ * @file fracture_compression.h
+ * @author Aditya Rajagopal
+ * @brief LZ4 block compression and zlib decompression.
+ * @details Produces and consumes the standard LZ4 block format (no frame header, checksums or dictionaries) so data
+ * can be inspected with other LZ4 tools. The compressor is the simple greedy single hash table variant: it trades
+ * some ratio for speed, while decompression runs at memory speed regardless of how the data was compressed which is
+ * what matters for loading assets.
+ *
+ * The zlib decompressor exists to read formats we do not control, PNG in particular. It decodes Huffman codes of up
+ * to ZLIB_FAST_BITS bits with a single table lookup and refills its bit buffer a word at a time.
+ * @version 0.0.1
+ * @date 2024-04-22
+ *
+ * @copyright Fracture Game Engine is Copyright (c) Aditya Rajagopal 2024-2024
+ *
+ */
+#pragma once
+
+#include "fracture/core/defines.h"
+
+// Largest input the compressor accepts
+#define FR_LZ4_MAX_INPUT_SIZE 0x7E000000ULL
+
+/**
+ * @brief Gets the worst case size of the compressed data, for data that does not compress at all.
+ *
+ * @param size The size of the uncompressed data
+ * @return u64 The size the destination buffer needs to be to always fit the compressed data
+ */
+FR_API u64 fr_compress_lz4_bound(u64 size);
+
+/**
+ * @brief Compresses a block of memory.
+ *
+ * @param source The data to compress
+ * @param source_size The size of the data. At most FR_LZ4_MAX_INPUT_SIZE.
+ * @param dest The buffer to write the compressed data to
+ * @param dest_capacity The size of the buffer
+ * @return u64 The size of the compressed data or 0 if it did not fit in the buffer
+ */
+FR_API u64 fr_compress_lz4(const void* source, u64 source_size, void* dest, u64 dest_capacity);
+
+/**
+ * @brief Decompresses a block compressed with fr_compress_lz4. Malformed input is detected and never reads or writes
+ * out of bounds.
+ *
+ * @param source The compressed data
+ * @param source_size The size of the compressed data
+ * @param dest The buffer to write the uncompressed data to
+ * @param dest_size The exact size of the uncompressed data
+ * @return b8 TRUE if the data was decompressed, FALSE if it is malformed or does not decompress to dest_size bytes
+ */
+FR_API b8 fr_decompress_lz4(const void* source, u64 source_size, void* dest, u64 dest_size);
+
+/**
+ * @brief Decompresses a zlib stream (RFC 1950 wrapping RFC 1951 DEFLATE data). Preset dictionaries are not supported
+ * and the Adler-32 checksum is not verified. Malformed input is detected and never reads or writes out of bounds.
+ *
+ * @param source The compressed data
+ * @param source_size The size of the compressed data
+ * @param dest The buffer to write the uncompressed data to
+ * @param dest_capacity The size of the buffer
+ * @param out_size The size of the uncompressed data
+ * @return b8 TRUE if the data was decompressed, FALSE if it is malformed or does not fit in the buffer
+ */
+FR_API b8 fr_decompress_zlib(const void* source, u64 source_size, void* dest, u64 dest_capacity, u64* out_size);
@@ -0,0 +1,52 @@
+/**
+ * @file fracture_hash.h
+ * @author Aditya Rajagopal
+ * @brief Non cryptographic hash functions used to key resources by name.
+ * @details FNV-1a is not the fastest hash for long keys but it is tiny, has no alignment requirements and mixes short
+ * keys (file paths) well enough to be used directly as a table index. The hashes are written to disk by the resource
+ * packer, so the function must never change.
+ * @version 0.0.1
+ * @date 2024-04-22
+ *
+ * @copyright Fracture Game Engine is Copyright (c) Aditya Rajagopal 2024-2024
+ *
+ */
+#pragma once
+
+#include "fracture/core/defines.h"
+
+#define FR_HASH_FNV1A_64_OFFSET_BASIS 0xCBF29CE484222325ULL
+#define FR_HASH_FNV1A_64_PRIME 0x00000100000001B3ULL
+
+/**
+ * @brief Hashes a block of memory with 64 bit FNV-1a.
+ *
+ * @param data The memory to hash
+ * @param size The size of the memory in bytes
+ * @return u64 The hash
+ */
+static inline u64 fr_hash_fnv1a_64(const void* data, u64 size) {
+    const u8* bytes = (const u8*)data;
+    u64 hash = FR_HASH_FNV1A_64_OFFSET_BASIS;
+    for (u64 i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= FR_HASH_FNV1A_64_PRIME;
+    }
+    return hash;
+}
+
+/**
+ * @brief Hashes a null terminated string with 64 bit FNV-1a. Same result as fr_hash_fnv1a_64 over the characters
+ * without the terminator.
+ *
+ * @param string The string to hash
+ * @return u64 The hash
+ */
+static inline u64 fr_hash_string(const char* string) {
+    u64 hash = FR_HASH_FNV1A_64_OFFSET_BASIS;
+    for (const u8* c = (const u8*)string; *c != 0; ++c) {
+        hash ^= *c;
+        hash *= FR_HASH_FNV1A_64_PRIME;
+    }
+    return hash;
+}
@@ -61,10 +61,8 @@ FR_FORCE_INLINE void fr_camera_perspective(f32 fov_radians, f32 aspect_ratio, f3
 
 FR_FORCE_INLINE void fr_camera_look_at(vec3* position, vec3* target, vec3* up, mat4* out) {
     vec3 z_axis, x_axis, y_axis;
-    // vector from position to target
-    z_axis.x = target->x - position->x;
-    z_axis.y = target->y - position->y;
-    z_axis.z = target->z - position->z;
+    // vector from position to target. fr_vec3_sub also sets the padding of SIMD vec3 that the normalization reads.
+    fr_vec3_sub(target, position, &z_axis);
 
     fr_vec3_normalize(&z_axis, &z_axis);
     fr_vec3_cross(&z_axis, up, &x_axis);
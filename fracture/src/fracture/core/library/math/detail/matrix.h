@@ -83,14 +83,18 @@ typedef FR_ALIGN(16) union mat4x2s {
 #endif
 } mat4x2;
 
-typedef union mat3x4s {
+// The upper three rows of an affine transform stored row by row, the layout of bone matrices uploaded to the GPU
+typedef FR_ALIGN(16) union mat3x4s {
     struct {
         f32 m00, m01, m02, m03;
         f32 m10, m11, m12, m13;
         f32 m20, m21, m22, m23;
     };
     f32 data[12];
-    vec3 columns[4];
+    vec4 rows[3];
+#if FR_SIMD == 1
+    __m128 simd[3];
+#endif
 } mat3x4;
 
 typedef union mat2x4s {
@@ -0,0 +1,404 @@
+#include "frustum.h"
+
+#include "fracture/core/systems/job_system.h"
+#include "simd/avx.h"
+#include "simd/avx512.h"
+#include "simd/dispatch.h"
+#include "simd/sse.h"
+#include "utils.h"
+
+// Upper bound on the number of jobs of one cull, larger arrays get larger batches
+#define FRUSTUM_CULL_MAX_BATCHES 256
+
+// Culls the volumes [start, end) and writes the indices of the visible ones to out, which holds end - start indices.
+// data is x, y, z and radius for spheres and the minimum then the maximum corner for boxes.
+typedef u32 (*PFN_frustum_cull)(const frustum* f, const f32* const data[6], u32 start, u32 end, u32* out);
+
+// The kernels of one simd_level
+typedef struct frustum_cull_kernels {
+    PFN_frustum_cull spheres;
+    PFN_frustum_cull aabbs;
+} frustum_cull_kernels;
+
+typedef struct frustum_cull_job {
+    PFN_frustum_cull kernel;
+    const frustum* f;
+    const f32* const* data;
+    u32 count;
+    u32 batch_size;
+    u32* out;
+    u32 batch_visible[FRUSTUM_CULL_MAX_BATCHES];
+} frustum_cull_job;
+
+// Writes base + j for the lanes j whose bit is set in the first lanes bits of mask. Most volumes of a scene are either
+// all culled or all visible within a register, so this spends little time on the others.
+FR_FORCE_INLINE u32 _frustum_append(u32 mask, u32 base, u32 lanes, u32* out) {
+    mask &= (1u << lanes) - 1;
+    u32 written = 0;
+    while (mask != 0) {
+        out[written++] = base + (u32)__builtin_ctz(mask);
+        mask &= mask - 1;
+    }
+    return written;
+}
+
+//--------------------------------------------------------------------------------------------
+// Scalar kernels, also used for the tails of the SSE kernels
+//--------------------------------------------------------------------------------------------
+
+static u32 _cull_spheres_scalar(const frustum* f, const f32* const data[6], u32 start, u32 end, u32* out) {
+    u32 visible = 0;
+    for (u32 i = start; i < end; ++i) {
+        u32 inside = 1;
+        for (u32 p = 0; p < FR_FRUSTUM_PLANE_COUNT; ++p) {
+            const vec4* plane = &f->planes[p];
+            f32 distance = plane->x * data[0][i] + plane->y * data[1][i] + plane->z * data[2][i] + plane->w;
+            inside &= distance >= -data[3][i];
+        }
+        out[visible] = i;
+        visible += inside;
+    }
+    return visible;
+}
+
+// A box is behind a plane when its corner furthest along the normal is, i.e. when the distance of its center is
+// below -dot(|normal|, half extents)
+static u32 _cull_aabbs_scalar(const frustum* f, const f32* const data[6], u32 start, u32 end, u32* out) {
+    u32 visible = 0;
+    for (u32 i = start; i < end; ++i) {
+        f32 center[3], extent[3];
+        for (u32 c = 0; c < 3; ++c) {
+            center[c] = (data[c][i] + data[3 + c][i]) * 0.5f;
+            extent[c] = (data[3 + c][i] - data[c][i]) * 0.5f;
+        }
+        u32 inside = 1;
+        for (u32 p = 0; p < FR_FRUSTUM_PLANE_COUNT; ++p) {
+            const vec4* plane = &f->planes[p];
+            f32 distance = plane->x * center[0] + plane->y * center[1] + plane->z * center[2] + plane->w;
+            f32 reach = fr_abs(plane->x) * extent[0] + fr_abs(plane->y) * extent[1] + fr_abs(plane->z) * extent[2];
+            inside &= distance >= -reach;
+        }
+        out[visible] = i;
+        visible += inside;
+    }
+    return visible;
+}
+
+#if FR_SIMD == 1
+
+//--------------------------------------------------------------------------------------------
+// SSE2 kernels, 4 volumes per iteration
+//--------------------------------------------------------------------------------------------
+
+static u32 _cull_spheres_sse(const frustum* f, const f32* const data[6], u32 start, u32 end, u32* out) {
+    __m128 planes[FR_FRUSTUM_PLANE_COUNT][4];
+    for (u32 p = 0; p < FR_FRUSTUM_PLANE_COUNT; ++p) {
+        for (u32 c = 0; c < 4; ++c) {
+            planes[p][c] = _mm_set1_ps(f->planes[p].data[c]);
+        }
+    }
+
+    u32 visible = 0;
+    u32 i = start;
+    for (; i + 4 <= end; i += 4) {
+        __m128 x = _mm_loadu_ps(data[0] + i);
+        __m128 y = _mm_loadu_ps(data[1] + i);
+        __m128 z = _mm_loadu_ps(data[2] + i);
+        __m128 neg_radius = _mm_xor_ps(_mm_loadu_ps(data[3] + i), FR_SIGN_BITf32x4);
+        __m128 outside = _mm_setzero_ps();
+        for (u32 p = 0; p < FR_FRUSTUM_PLANE_COUNT; ++p) {
+            __m128 distance = fr_simd_fmadd(planes[p][0], x, planes[p][3]);
+            distance = fr_simd_fmadd(planes[p][1], y, distance);
+            distance = fr_simd_fmadd(planes[p][2], z, distance);
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, neg_radius));
+        }
+        visible += _frustum_append(~_mm_movemask_ps(outside), i, 4, out + visible);
+    }
+    return visible + _cull_spheres_scalar(f, data, i, end, out + visible);
+}
+
+static u32 _cull_aabbs_sse(const frustum* f, const f32* const data[6], u32 start, u32 end, u32* out) {
+    __m128 planes[FR_FRUSTUM_PLANE_COUNT][4];
+    __m128 abs_normals[FR_FRUSTUM_PLANE_COUNT][3];
+    for (u32 p = 0; p < FR_FRUSTUM_PLANE_COUNT; ++p) {
+        for (u32 c = 0; c < 4; ++c) {
+            planes[p][c] = _mm_set1_ps(f->planes[p].data[c]);
+        }
+        for (u32 c = 0; c < 3; ++c) {
+            abs_normals[p][c] = fr_simd_abs(planes[p][c]);
+        }
+    }
+
+    __m128 half = _mm_set1_ps(0.5f);
+    u32 visible = 0;
+    u32 i = start;
+    for (; i + 4 <= end; i += 4) {
+        __m128 center[3], extent[3];
+        for (u32 c = 0; c < 3; ++c) {
+            __m128 min = _mm_loadu_ps(data[c] + i);
+            __m128 max = _mm_loadu_ps(data[3 + c] + i);
+            center[c] = _mm_mul_ps(_mm_add_ps(min, max), half);
+            extent[c] = _mm_mul_ps(_mm_sub_ps(max, min), half);
+        }
+        __m128 outside = _mm_setzero_ps();
+        for (u32 p = 0; p < FR_FRUSTUM_PLANE_COUNT; ++p) {
+            __m128 distance = fr_simd_fmadd(planes[p][0], center[0], planes[p][3]);
+            distance = fr_simd_fmadd(planes[p][1], center[1], distance);
+            distance = fr_simd_fmadd(planes[p][2], center[2], distance);
+            distance = fr_simd_fmadd(abs_normals[p][0], extent[0], distance);
+            distance = fr_simd_fmadd(abs_normals[p][1], extent[1], distance);
+            distance = fr_simd_fmadd(abs_normals[p][2], extent[2], distance);
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, _mm_setzero_ps()));
+        }
+        visible += _frustum_append(~_mm_movemask_ps(outside), i, 4, out + visible);
+    }
+    return visible + _cull_aabbs_scalar(f, data, i, end, out + visible);
+}
+
+//--------------------------------------------------------------------------------------------
+// AVX2 kernels, 8 volumes per iteration with masked tails
+//--------------------------------------------------------------------------------------------
+
+static FR_TARGET_AVX2_FMA u32
+_cull_spheres_avx2(const frustum* f, const f32* const data[6], u32 start, u32 end, u32* out) {
+    __m256 planes[FR_FRUSTUM_PLANE_COUNT][4];
+    for (u32 p = 0; p < FR_FRUSTUM_PLANE_COUNT; ++p) {
+        for (u32 c = 0; c < 4; ++c) {
+            planes[p][c] = _mm256_set1_ps(f->planes[p].data[c]);
+        }
+    }
+
+    u32 visible = 0;
+    for (u32 i = start; i < end; i += 8) {
+        __m256i mask = fr_simd256_tail_mask(end - i);
+        __m256 x = _mm256_maskload_ps(data[0] + i, mask);
+        __m256 y = _mm256_maskload_ps(data[1] + i, mask);
+        __m256 z = _mm256_maskload_ps(data[2] + i, mask);
+        __m256 neg_radius = _mm256_xor_ps(_mm256_maskload_ps(data[3] + i, mask), _mm256_set1_ps(-0.0f));
+        __m256 outside = _mm256_setzero_ps();
+        for (u32 p = 0; p < FR_FRUSTUM_PLANE_COUNT; ++p) {
+            __m256 distance = fr_simd256_fmadd(planes[p][0], x, planes[p][3]);
+            distance = fr_simd256_fmadd(planes[p][1], y, distance);
+            distance = fr_simd256_fmadd(planes[p][2], z, distance);
+            outside = _mm256_or_ps(outside, _mm256_cmp_ps(distance, neg_radius, _CMP_LT_OQ));
+        }
+        visible += _frustum_append(~_mm256_movemask_ps(outside), i, MIN(end - i, 8), out + visible);
+    }
+    return visible;
+}
+
+static FR_TARGET_AVX2_FMA u32
+_cull_aabbs_avx2(const frustum* f, const f32* const data[6], u32 start, u32 end, u32* out) {
+    __m256 planes[FR_FRUSTUM_PLANE_COUNT][4];
+    __m256 abs_normals[FR_FRUSTUM_PLANE_COUNT][3];
+    for (u32 p = 0; p < FR_FRUSTUM_PLANE_COUNT; ++p) {
+        for (u32 c = 0; c < 4; ++c) {
+            planes[p][c] = _mm256_set1_ps(f->planes[p].data[c]);
+        }
+        for (u32 c = 0; c < 3; ++c) {
+            abs_normals[p][c] = _mm256_set1_ps(fr_abs(f->planes[p].data[c]));
+        }
+    }
+
+    __m256 half = _mm256_set1_ps(0.5f);
+    u32 visible = 0;
+    for (u32 i = start; i < end; i += 8) {
+        __m256i mask = fr_simd256_tail_mask(end - i);
+        __m256 center[3], extent[3];
+        for (u32 c = 0; c < 3; ++c) {
+            __m256 min = _mm256_maskload_ps(data[c] + i, mask);
+            __m256 max = _mm256_maskload_ps(data[3 + c] + i, mask);
+            center[c] = _mm256_mul_ps(_mm256_add_ps(min, max), half);
+            extent[c] = _mm256_mul_ps(_mm256_sub_ps(max, min), half);
+        }
+        __m256 outside = _mm256_setzero_ps();
+        for (u32 p = 0; p < FR_FRUSTUM_PLANE_COUNT; ++p) {
+            __m256 distance = fr_simd256_fmadd(planes[p][0], center[0], planes[p][3]);
+            distance = fr_simd256_fmadd(planes[p][1], center[1], distance);
+            distance = fr_simd256_fmadd(planes[p][2], center[2], distance);
+            distance = fr_simd256_fmadd(abs_normals[p][0], extent[0], distance);
+            distance = fr_simd256_fmadd(abs_normals[p][1], extent[1], distance);
+            distance = fr_simd256_fmadd(abs_normals[p][2], extent[2], distance);
+            outside = _mm256_or_ps(outside, _mm256_cmp_ps(distance, _mm256_setzero_ps(), _CMP_LT_OQ));
+        }
+        visible += _frustum_append(~_mm256_movemask_ps(outside), i, MIN(end - i, 8), out + visible);
+    }
+    return visible;
+}
+
+//--------------------------------------------------------------------------------------------
+// AVX-512 kernels, 16 volumes per iteration. The visible indices are packed by a compress store instead of
+// _frustum_append.
+//--------------------------------------------------------------------------------------------
+
+static FR_TARGET_AVX512 u32
+_cull_spheres_avx512(const frustum* f, const f32* const data[6], u32 start, u32 end, u32* out) {
+    __m512 planes[FR_FRUSTUM_PLANE_COUNT][4];
+    for (u32 p = 0; p < FR_FRUSTUM_PLANE_COUNT; ++p) {
+        for (u32 c = 0; c < 4; ++c) {
+            planes[p][c] = _mm512_set1_ps(f->planes[p].data[c]);
+        }
+    }
+
+    __m512i lanes = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    u32 visible = 0;
+    for (u32 i = start; i < end; i += 16) {
+        __mmask16 inside = fr_simd512_tail_mask(end - i);
+        __m512 x = _mm512_maskz_loadu_ps(inside, data[0] + i);
+        __m512 y = _mm512_maskz_loadu_ps(inside, data[1] + i);
+        __m512 z = _mm512_maskz_loadu_ps(inside, data[2] + i);
+        __m512 neg_radius = _mm512_sub_ps(_mm512_setzero_ps(), _mm512_maskz_loadu_ps(inside, data[3] + i));
+        for (u32 p = 0; p < FR_FRUSTUM_PLANE_COUNT; ++p) {
+            __m512 distance = fr_simd512_fmadd(planes[p][0], x, planes[p][3]);
+            distance = fr_simd512_fmadd(planes[p][1], y, distance);
+            distance = fr_simd512_fmadd(planes[p][2], z, distance);
+            inside = _mm512_mask_cmp_ps_mask(inside, distance, neg_radius, _CMP_GE_OQ);
+        }
+        _mm512_mask_compressstoreu_epi32(out + visible, inside, _mm512_add_epi32(_mm512_set1_epi32((i32)i), lanes));
+        visible += (u32)__builtin_popcount(inside);
+    }
+    return visible;
+}
+
+static FR_TARGET_AVX512 u32
+_cull_aabbs_avx512(const frustum* f, const f32* const data[6], u32 start, u32 end, u32* out) {
+    __m512 planes[FR_FRUSTUM_PLANE_COUNT][4];
+    __m512 abs_normals[FR_FRUSTUM_PLANE_COUNT][3];
+    for (u32 p = 0; p < FR_FRUSTUM_PLANE_COUNT; ++p) {
+        for (u32 c = 0; c < 4; ++c) {
+            planes[p][c] = _mm512_set1_ps(f->planes[p].data[c]);
+        }
+        for (u32 c = 0; c < 3; ++c) {
+            abs_normals[p][c] = _mm512_set1_ps(fr_abs(f->planes[p].data[c]));
+        }
+    }
+
+    __m512i lanes = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    __m512 half = _mm512_set1_ps(0.5f);
+    u32 visible = 0;
+    for (u32 i = start; i < end; i += 16) {
+        __mmask16 inside = fr_simd512_tail_mask(end - i);
+        __m512 center[3], extent[3];
+        for (u32 c = 0; c < 3; ++c) {
+            __m512 min = _mm512_maskz_loadu_ps(inside, data[c] + i);
+            __m512 max = _mm512_maskz_loadu_ps(inside, data[3 + c] + i);
+            center[c] = _mm512_mul_ps(_mm512_add_ps(min, max), half);
+            extent[c] = _mm512_mul_ps(_mm512_sub_ps(max, min), half);
+        }
+        for (u32 p = 0; p < FR_FRUSTUM_PLANE_COUNT; ++p) {
+            __m512 distance = fr_simd512_fmadd(planes[p][0], center[0], planes[p][3]);
+            distance = fr_simd512_fmadd(planes[p][1], center[1], distance);
+            distance = fr_simd512_fmadd(planes[p][2], center[2], distance);
+            distance = fr_simd512_fmadd(abs_normals[p][0], extent[0], distance);
+            distance = fr_simd512_fmadd(abs_normals[p][1], extent[1], distance);
+            distance = fr_simd512_fmadd(abs_normals[p][2], extent[2], distance);
+            inside = _mm512_mask_cmp_ps_mask(inside, distance, _mm512_setzero_ps(), _CMP_GE_OQ);
+        }
+        _mm512_mask_compressstoreu_epi32(out + visible, inside, _mm512_add_epi32(_mm512_set1_epi32((i32)i), lanes));
+        visible += (u32)__builtin_popcount(inside);
+    }
+    return visible;
+}
+#endif
+
+//--------------------------------------------------------------------------------------------
+// Dispatch
+//--------------------------------------------------------------------------------------------
+
+static const frustum_cull_kernels cull_kernels[FR_SIMD_LEVEL_MAX] = {
+    [FR_SIMD_LEVEL_SCALAR] = {_cull_spheres_scalar, _cull_aabbs_scalar},
+#if FR_SIMD == 1
+    [FR_SIMD_LEVEL_SSE2] = {_cull_spheres_sse, _cull_aabbs_sse},
+    [FR_SIMD_LEVEL_AVX2] = {_cull_spheres_avx2, _cull_aabbs_avx2},
+    [FR_SIMD_LEVEL_AVX512] = {_cull_spheres_avx512, _cull_aabbs_avx512},
+#endif
+};
+
+static void _frustum_cull_batches(u32 start, u32 end, void* data) {
+    frustum_cull_job* job = (frustum_cull_job*)data;
+    for (u32 batch = start; batch < end; ++batch) {
+        u32 first = batch * job->batch_size;
+        u32 last = MIN(first + job->batch_size, job->count);
+        job->batch_visible[batch] = job->kernel(job->f, job->data, first, last, job->out + first);
+    }
+}
+
+// Every batch writes the indices it finds at the start of its own range of out, which are then moved together
+static u32 _frustum_cull(PFN_frustum_cull kernel, const frustum* f, const f32* const data[6], u32 count, u32* out) {
+    if (count <= FR_FRUSTUM_CULL_BATCH_SIZE) {
+        return kernel(f, data, 0, count, out);
+    }
+
+    frustum_cull_job job;
+    job.kernel = kernel;
+    job.f = f;
+    job.data = data;
+    job.count = count;
+    job.out = out;
+    u32 batch_count = MIN((count + FR_FRUSTUM_CULL_BATCH_SIZE - 1) / FR_FRUSTUM_CULL_BATCH_SIZE,
+                          FRUSTUM_CULL_MAX_BATCHES);
+    // Multiples of 16 keep every batch but the last free of vector tails
+    job.batch_size = ((count + batch_count - 1) / batch_count + 15) & ~15u;
+    batch_count = (count + job.batch_size - 1) / job.batch_size;
+    fr_job_parallel_for(batch_count, 1, _frustum_cull_batches, &job);
+
+    u32 visible = job.batch_visible[0];
+    for (u32 batch = 1; batch < batch_count; ++batch) {
+        const u32* found = out + batch * job.batch_size;
+        for (u32 i = 0; i < job.batch_visible[batch]; ++i) {
+            out[visible + i] = found[i];
+        }
+        visible += job.batch_visible[batch];
+    }
+    return visible;
+}
+
+void fr_frustum_from_mat4(const mat4* view_projection, frustum* out) {
+    // Gribb and Hartmann: -w <= x <= w gives the planes row3 + row0 and row3 - row0, and likewise for y and z
+    const f32* m = view_projection->data;
+    for (u32 p = 0; p < FR_FRUSTUM_PLANE_COUNT; ++p) {
+        u32 row = p / 2;
+        f32 sign = (p & 1) ? -1.0f : 1.0f;
+        vec4* plane = &out->planes[p];
+        for (u32 c = 0; c < 4; ++c) {
+            plane->data[c] = m[c * 4 + 3] + sign * m[c * 4 + row];
+        }
+
+        f32 length = fr_sqrt(plane->x * plane->x + plane->y * plane->y + plane->z * plane->z);
+        if (length > 0.0f) {
+            f32 inv_length = 1.0f / length;
+            for (u32 c = 0; c < 4; ++c) {
+                plane->data[c] *= inv_length;
+            }
+        } else {
+            plane->x = 0.0f;
+            plane->y = 0.0f;
+            plane->z = 0.0f;
+            plane->w = 1.0f;
+        }
+    }
+}
+
+b8 fr_frustum_sphere_visible(const frustum* f, const vec3* center, f32 radius) {
+    const f32* const data[6] = {&center->x, &center->y, &center->z, &radius, NULL_PTR, NULL_PTR};
+    u32 index;
+    return _cull_spheres_scalar(f, data, 0, 1, &index) == 1;
+}
+
+b8 fr_frustum_aabb_visible(const frustum* f, const vec3* min, const vec3* max) {
+    const f32* const data[6] = {&min->x, &min->y, &min->z, &max->x, &max->y, &max->z};
+    u32 index;
+    return _cull_aabbs_scalar(f, data, 0, 1, &index) == 1;
+}
+
+u32 fr_frustum_cull_spheres(
+    const frustum* f, const f32* const center[3], const f32* radius, u32 count, u32* out_visible) {
+    const f32* const data[6] = {center[0], center[1], center[2], radius, NULL_PTR, NULL_PTR};
+    return _frustum_cull(cull_kernels[fr_simd_get_level()].spheres, f, data, count, out_visible);
+}
+
+u32 fr_frustum_cull_aabbs(
+    const frustum* f, const f32* const min[3], const f32* const max[3], u32 count, u32* out_visible) {
+    const f32* const data[6] = {min[0], min[1], min[2], max[0], max[1], max[2]};
+    return _frustum_cull(cull_kernels[fr_simd_get_level()].aabbs, f, data, count, out_visible);
+}
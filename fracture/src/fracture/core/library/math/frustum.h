@@ -0,0 +1,106 @@
+/**
+ * @file frustum.h
+ * @author Aditya Rajagopal
+ * @brief View frustum planes and culling of arrays of bounding volumes.
+ * @details A frustum is extracted from a view projection matrix as six planes whose normals point inside. The cull
+ * functions test structures of arrays of bounding spheres or boxes against the planes 4 (SSE2), 8 (AVX2) or 16
+ * (AVX-512) at a time with the instruction set chosen by fr_simd_get_level, and write the indices of the visible ones
+ * in increasing order. Arrays larger than FR_FRUSTUM_CULL_BATCH_SIZE are split into batches that run in parallel on
+ * the job system, without one they run on the calling thread.
+ *
+ * The tests are conservative: a volume is only culled when it lies entirely behind one of the planes, so a few
+ * volumes near the corners of the frustum are reported visible while being outside of it.
+ * @version 0.0.1
+ * @date 2024-04-30
+ *
+ * @copyright Fracture Game Engine is Copyright (c) Aditya Rajagopal 2024-2024
+ *
+ */
+#pragma once
+
+#include "detail/matrix.h"
+#include "fracture/core/defines.h"
+
+/** @brief Number of volumes culled by a single job */
+#define FR_FRUSTUM_CULL_BATCH_SIZE 4096
+
+/**
+ * @brief The planes of a frustum.
+ *
+ */
+typedef enum frustum_plane {
+    FR_FRUSTUM_PLANE_LEFT = 0,
+    FR_FRUSTUM_PLANE_RIGHT,
+    FR_FRUSTUM_PLANE_BOTTOM,
+    FR_FRUSTUM_PLANE_TOP,
+    FR_FRUSTUM_PLANE_NEAR,
+    FR_FRUSTUM_PLANE_FAR,
+    FR_FRUSTUM_PLANE_COUNT,
+} frustum_plane;
+
+/**
+ * @brief A view frustum. Each plane holds its unit normal in x, y and z and its offset in w, so that a point p is on
+ * the inner side when dot(plane.xyz, p) + plane.w >= 0.
+ *
+ */
+typedef struct frustum {
+    vec4 planes[FR_FRUSTUM_PLANE_COUNT];
+} frustum;
+
+/**
+ * @brief Extracts the planes of the frustum of a view projection matrix.
+ * @details The clip space is the one of fr_camera_perspective and fr_camera_orthographic, -w <= z <= w. With a matrix
+ * that maps depth to [0, w] the near plane ends up behind the real one, which only makes the culling more
+ * conservative. A far plane at infinity gives a plane that every point is inside of.
+ *
+ * @param view_projection The projection matrix multiplied by the view matrix
+ * @param out The frustum in world space
+ */
+FR_API void fr_frustum_from_mat4(const mat4* view_projection, frustum* out);
+
+/**
+ * @brief Checks if a sphere is at least partly inside a frustum.
+ *
+ * @param f The frustum
+ * @param center The center of the sphere
+ * @param radius The radius of the sphere
+ * @return b8 TRUE if the sphere is not entirely behind any of the planes
+ */
+FR_API b8 fr_frustum_sphere_visible(const frustum* f, const vec3* center, f32 radius);
+
+/**
+ * @brief Checks if an axis aligned box is at least partly inside a frustum.
+ *
+ * @param f The frustum
+ * @param min The minimum corner of the box
+ * @param max The maximum corner of the box
+ * @return b8 TRUE if the box is not entirely behind any of the planes
+ */
+FR_API b8 fr_frustum_aabb_visible(const frustum* f, const vec3* min, const vec3* max);
+
+/**
+ * @brief Culls an array of bounding spheres stored as separate x, y, z and radius arrays.
+ *
+ * @param f The frustum
+ * @param center The x, y and z arrays of the centers of the spheres
+ * @param radius The radii of the spheres
+ * @param count The number of spheres
+ * @param out_visible The indices of the visible spheres in increasing order. Must hold count indices.
+ * @return u32 The number of visible spheres
+ */
+FR_API u32 fr_frustum_cull_spheres(
+    const frustum* f, const f32* const center[3], const f32* radius, u32 count, u32* out_visible);
+
+/**
+ * @brief Culls an array of axis aligned bounding boxes stored as separate arrays for each coordinate of their minimum
+ * and maximum corners.
+ *
+ * @param f The frustum
+ * @param min The x, y and z arrays of the minimum corners of the boxes
+ * @param max The x, y and z arrays of the maximum corners of the boxes
+ * @param count The number of boxes
+ * @param out_visible The indices of the visible boxes in increasing order. Must hold count indices.
+ * @return u32 The number of visible boxes
+ */
+FR_API u32 fr_frustum_cull_aabbs(
+    const frustum* f, const f32* const min[3], const f32* const max[3], u32 count, u32* out_visible);
@@ -0,0 +1,787 @@
+#include "geometry.h"
+
+#include "simd/avx.h"
+#include "simd/avx512.h"
+#include "simd/avx_math.h"
+#include "simd/dispatch.h"
+#include "simd/sse_math.h"
+#include "utils.h"
+
+// Triangles whose determinant is below this are parallel to the ray or degenerate and are never hit
+#define GEOMETRY_TRIANGLE_EPSILON 1e-12f
+
+// Index of the lanes of the triangle kernels that have not hit anything
+#define GEOMETRY_NO_HIT 0xFFFFFFFFu
+
+// Returns the mask of the rays of a packet hitting a box and writes the entry parameters of all FR_RAY_PACKET_SIZE
+// lanes to out_t
+typedef u32 (*PFN_ray_packet_intersect_aabb)(const ray_packet* packet, const aabb* box, f32* out_t);
+
+// Tests the triangles [start, end) and replaces best by the closest hit if it is closer. v holds the x, y and z arrays
+// of the first, second and third vertices.
+typedef b8 (*PFN_ray_intersect_triangles)(const ray* r, const f32* const v[9], u32 start, u32 end, ray_hit* best);
+
+// Writes the indices of the volumes of [start, end) overlapping the query to out. The query is the min then the max
+// corner of a box, or the center and the radius of a sphere, and data is laid out the same way.
+typedef u32 (*PFN_overlap_query)(const f32 query[6], const f32* const data[6], u32 start, u32 end, u32* out);
+
+// The kernels of one simd_level
+typedef struct geometry_kernels {
+    PFN_ray_packet_intersect_aabb packet_aabb;
+    PFN_ray_intersect_triangles triangles;
+    PFN_overlap_query aabbs;
+    PFN_overlap_query spheres;
+} geometry_kernels;
+
+// Writes base + j for the lanes j whose bit is set in the first lanes bits of mask, like _frustum_append
+FR_FORCE_INLINE u32 _geometry_append(u32 mask, u32 base, u32 lanes, u32* out) {
+    mask &= (1u << lanes) - 1;
+    u32 written = 0;
+    while (mask != 0) {
+        out[written++] = base + (u32)__builtin_ctz(mask);
+        mask &= mask - 1;
+    }
+    return written;
+}
+
+// Slab test of one ray against the box [min, max] in the same frame
+static b8 _geometry_slab(
+    const f32 origin[3], const f32 inv_direction[3], const f32 min[3], const f32 max[3], f32 t_max, f32* out_t) {
+    f32 t_near = 0.0f;
+    f32 t_far = t_max;
+    for (u32 c = 0; c < 3; ++c) {
+        f32 t0 = (min[c] - origin[c]) * inv_direction[c];
+        f32 t1 = (max[c] - origin[c]) * inv_direction[c];
+        t_near = fr_max(t_near, fr_min(t0, t1));
+        t_far = fr_min(t_far, fr_max(t0, t1));
+    }
+    if (t_near > t_far) {
+        return FALSE;
+    }
+    if (out_t) {
+        *out_t = t_near;
+    }
+    return TRUE;
+}
+
+//--------------------------------------------------------------------------------------------
+// Scalar kernels, also used for the tails of the SSE kernels
+//--------------------------------------------------------------------------------------------
+
+static u32 _packet_aabb_scalar(const ray_packet* packet, const aabb* box, f32* out_t) {
+    u32 hits = 0;
+    for (u32 i = 0; i < packet->count; ++i) {
+        const f32 origin[3] = {packet->origin[0][i], packet->origin[1][i], packet->origin[2][i]};
+        const f32 inv_direction[3] = {
+            packet->inv_direction[0][i], packet->inv_direction[1][i], packet->inv_direction[2][i]};
+        if (_geometry_slab(origin, inv_direction, box->min.data, box->max.data, packet->t_max[i], &out_t[i])) {
+            hits |= 1u << i;
+        }
+    }
+    return hits;
+}
+
+static b8 _ray_triangles_scalar(const ray* r, const f32* const v[9], u32 start, u32 end, ray_hit* best) {
+    const f32* o = r->origin.data;
+    const f32* d = r->direction.data;
+    b8 found = FALSE;
+    for (u32 i = start; i < end; ++i) {
+        f32 a[3], e1[3], e2[3];
+        for (u32 c = 0; c < 3; ++c) {
+            a[c] = v[c][i];
+            e1[c] = v[3 + c][i] - a[c];
+            e2[c] = v[6 + c][i] - a[c];
+        }
+        f32 p[3] = {d[1] * e2[2] - d[2] * e2[1], d[2] * e2[0] - d[0] * e2[2], d[0] * e2[1] - d[1] * e2[0]};
+        f32 det = e1[0] * p[0] + e1[1] * p[1] + e1[2] * p[2];
+        if (fr_abs(det) <= GEOMETRY_TRIANGLE_EPSILON) {
+            continue;
+        }
+        f32 inv_det = 1.0f / det;
+        f32 s[3] = {o[0] - a[0], o[1] - a[1], o[2] - a[2]};
+        f32 u = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) * inv_det;
+        if (u < 0.0f || u > 1.0f) {
+            continue;
+        }
+        f32 q[3] = {s[1] * e1[2] - s[2] * e1[1], s[2] * e1[0] - s[0] * e1[2], s[0] * e1[1] - s[1] * e1[0]};
+        f32 w = (d[0] * q[0] + d[1] * q[1] + d[2] * q[2]) * inv_det;
+        if (w < 0.0f || u + w > 1.0f) {
+            continue;
+        }
+        f32 t = (e2[0] * q[0] + e2[1] * q[1] + e2[2] * q[2]) * inv_det;
+        if (t < 0.0f || t >= best->t) {
+            continue;
+        }
+        best->t = t;
+        best->u = u;
+        best->v = w;
+        best->index = i;
+        found = TRUE;
+    }
+    return found;
+}
+
+static u32 _overlap_aabbs_scalar(const f32 query[6], const f32* const data[6], u32 start, u32 end, u32* out) {
+    u32 overlapping = 0;
+    for (u32 i = start; i < end; ++i) {
+        u32 overlap = 1;
+        for (u32 c = 0; c < 3; ++c) {
+            overlap &= (data[c][i] <= query[3 + c]) & (query[c] <= data[3 + c][i]);
+        }
+        out[overlapping] = i;
+        overlapping += overlap;
+    }
+    return overlapping;
+}
+
+static u32 _overlap_spheres_scalar(const f32 query[6], const f32* const data[6], u32 start, u32 end, u32* out) {
+    u32 overlapping = 0;
+    for (u32 i = start; i < end; ++i) {
+        f32 dx = data[0][i] - query[0];
+        f32 dy = data[1][i] - query[1];
+        f32 dz = data[2][i] - query[2];
+        f32 radius = data[3][i] + query[3];
+        out[overlapping] = i;
+        overlapping += dx * dx + dy * dy + dz * dz <= radius * radius;
+    }
+    return overlapping;
+}
+
+#if FR_SIMD == 1
+
+// Folds the closest hits found by the lanes of a kernel into best. Of equal parameters the lowest index wins, which is
+// the hit the scalar kernel finds first.
+static b8 _geometry_reduce_hits(const f32* t, const f32* u, const f32* v, const u32* index, u32 lanes, ray_hit* best) {
+    b8 found = FALSE;
+    for (u32 lane = 0; lane < lanes; ++lane) {
+        if (index[lane] == GEOMETRY_NO_HIT) {
+            continue;
+        }
+        if (!found || t[lane] < best->t || (t[lane] == best->t && index[lane] < best->index)) {
+            best->t = t[lane];
+            best->u = u[lane];
+            best->v = v[lane];
+            best->index = index[lane];
+            found = TRUE;
+        }
+    }
+    return found;
+}
+
+//--------------------------------------------------------------------------------------------
+// SSE2 kernels, 4 rays, triangles or volumes per iteration
+//--------------------------------------------------------------------------------------------
+
+static u32 _packet_aabb_sse(const ray_packet* packet, const aabb* box, f32* out_t) {
+    u32 hits = 0;
+    for (u32 i = 0; i < FR_RAY_PACKET_SIZE; i += 4) {
+        __m128 t_near = _mm_setzero_ps();
+        __m128 t_far = _mm_loadu_ps(packet->t_max + i);
+        for (u32 c = 0; c < 3; ++c) {
+            __m128 origin = _mm_loadu_ps(packet->origin[c] + i);
+            __m128 inv_direction = _mm_loadu_ps(packet->inv_direction[c] + i);
+            __m128 t0 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(box->min.data[c]), origin), inv_direction);
+            __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(box->max.data[c]), origin), inv_direction);
+            t_near = _mm_max_ps(t_near, _mm_min_ps(t0, t1));
+            t_far = _mm_min_ps(t_far, _mm_max_ps(t0, t1));
+        }
+        _mm_storeu_ps(out_t + i, t_near);
+        hits |= (u32)_mm_movemask_ps(_mm_cmple_ps(t_near, t_far)) << i;
+    }
+    return hits & ((1u << packet->count) - 1);
+}
+
+static b8 _ray_triangles_sse(const ray* r, const f32* const v[9], u32 start, u32 end, ray_hit* best) {
+    __m128 o[3], d[3];
+    for (u32 c = 0; c < 3; ++c) {
+        o[c] = _mm_set1_ps(r->origin.data[c]);
+        d[c] = _mm_set1_ps(r->direction.data[c]);
+    }
+    __m128 zero = _mm_setzero_ps();
+    __m128 one = _mm_set1_ps(1.0f);
+    __m128 epsilon = _mm_set1_ps(GEOMETRY_TRIANGLE_EPSILON);
+
+    __m128 best_t = _mm_set1_ps(best->t);
+    __m128 best_u = zero;
+    __m128 best_v = zero;
+    __m128i best_index = _mm_set1_epi32((i32)GEOMETRY_NO_HIT);
+    __m128i index = _mm_add_epi32(_mm_set1_epi32((i32)start), _mm_setr_epi32(0, 1, 2, 3));
+    u32 i = start;
+    for (; i + 4 <= end; i += 4) {
+        __m128 a[3], e1[3], e2[3], s[3];
+        for (u32 c = 0; c < 3; ++c) {
+            a[c] = _mm_loadu_ps(v[c] + i);
+            e1[c] = _mm_sub_ps(_mm_loadu_ps(v[3 + c] + i), a[c]);
+            e2[c] = _mm_sub_ps(_mm_loadu_ps(v[6 + c] + i), a[c]);
+            s[c] = _mm_sub_ps(o[c], a[c]);
+        }
+        __m128 px = _mm_sub_ps(_mm_mul_ps(d[1], e2[2]), _mm_mul_ps(d[2], e2[1]));
+        __m128 py = _mm_sub_ps(_mm_mul_ps(d[2], e2[0]), _mm_mul_ps(d[0], e2[2]));
+        __m128 pz = _mm_sub_ps(_mm_mul_ps(d[0], e2[1]), _mm_mul_ps(d[1], e2[0]));
+        __m128 det = fr_simd_fmadd(e1[2], pz, fr_simd_fmadd(e1[1], py, _mm_mul_ps(e1[0], px)));
+        __m128 inv_det = _mm_div_ps(one, det);
+        __m128 u = fr_simd_fmadd(s[2], pz, fr_simd_fmadd(s[1], py, _mm_mul_ps(s[0], px)));
+        u = _mm_mul_ps(u, inv_det);
+
+        __m128 qx = _mm_sub_ps(_mm_mul_ps(s[1], e1[2]), _mm_mul_ps(s[2], e1[1]));
+        __m128 qy = _mm_sub_ps(_mm_mul_ps(s[2], e1[0]), _mm_mul_ps(s[0], e1[2]));
+        __m128 qz = _mm_sub_ps(_mm_mul_ps(s[0], e1[1]), _mm_mul_ps(s[1], e1[0]));
+        __m128 w = fr_simd_fmadd(d[2], qz, fr_simd_fmadd(d[1], qy, _mm_mul_ps(d[0], qx)));
+        w = _mm_mul_ps(w, inv_det);
+        __m128 t = fr_simd_fmadd(e2[2], qz, fr_simd_fmadd(e2[1], qy, _mm_mul_ps(e2[0], qx)));
+        t = _mm_mul_ps(t, inv_det);
+
+        __m128 hit = _mm_cmpgt_ps(fr_simd_abs(det), epsilon);
+        hit = _mm_and_ps(hit, _mm_cmpge_ps(u, zero));
+        hit = _mm_and_ps(hit, _mm_cmpge_ps(w, zero));
+        hit = _mm_and_ps(hit, _mm_cmple_ps(_mm_add_ps(u, w), one));
+        hit = _mm_and_ps(hit, _mm_cmpge_ps(t, zero));
+        hit = _mm_and_ps(hit, _mm_cmplt_ps(t, best_t));
+        best_t = fr_simd_select(hit, t, best_t);
+        best_u = fr_simd_select(hit, u, best_u);
+        best_v = fr_simd_select(hit, w, best_v);
+        best_index = _mm_castps_si128(fr_simd_select(hit, _mm_castsi128_ps(index), _mm_castsi128_ps(best_index)));
+        index = _mm_add_epi32(index, _mm_set1_epi32(4));
+    }
+
+    FR_ALIGN(16) f32 lane_t[4], lane_u[4], lane_v[4];
+    FR_ALIGN(16) u32 lane_index[4];
+    _mm_store_ps(lane_t, best_t);
+    _mm_store_ps(lane_u, best_u);
+    _mm_store_ps(lane_v, best_v);
+    _mm_store_si128((__m128i*)lane_index, best_index);
+    b8 found = _geometry_reduce_hits(lane_t, lane_u, lane_v, lane_index, 4, best);
+    return _ray_triangles_scalar(r, v, i, end, best) || found;
+}
+
+static u32 _overlap_aabbs_sse(const f32 query[6], const f32* const data[6], u32 start, u32 end, u32* out) {
+    __m128 query_min[3], query_max[3];
+    for (u32 c = 0; c < 3; ++c) {
+        query_min[c] = _mm_set1_ps(query[c]);
+        query_max[c] = _mm_set1_ps(query[3 + c]);
+    }
+
+    u32 overlapping = 0;
+    u32 i = start;
+    for (; i + 4 <= end; i += 4) {
+        __m128 overlap = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (u32 c = 0; c < 3; ++c) {
+            overlap = _mm_and_ps(overlap, _mm_cmple_ps(_mm_loadu_ps(data[c] + i), query_max[c]));
+            overlap = _mm_and_ps(overlap, _mm_cmple_ps(query_min[c], _mm_loadu_ps(data[3 + c] + i)));
+        }
+        overlapping += _geometry_append(_mm_movemask_ps(overlap), i, 4, out + overlapping);
+    }
+    return overlapping + _overlap_aabbs_scalar(query, data, i, end, out + overlapping);
+}
+
+static u32 _overlap_spheres_sse(const f32 query[6], const f32* const data[6], u32 start, u32 end, u32* out) {
+    __m128 center[3];
+    for (u32 c = 0; c < 3; ++c) {
+        center[c] = _mm_set1_ps(query[c]);
+    }
+    __m128 query_radius = _mm_set1_ps(query[3]);
+
+    u32 overlapping = 0;
+    u32 i = start;
+    for (; i + 4 <= end; i += 4) {
+        __m128 dx = _mm_sub_ps(_mm_loadu_ps(data[0] + i), center[0]);
+        __m128 dy = _mm_sub_ps(_mm_loadu_ps(data[1] + i), center[1]);
+        __m128 dz = _mm_sub_ps(_mm_loadu_ps(data[2] + i), center[2]);
+        __m128 radius = _mm_add_ps(_mm_loadu_ps(data[3] + i), query_radius);
+        __m128 distance2 = fr_simd_fmadd(dz, dz, fr_simd_fmadd(dy, dy, _mm_mul_ps(dx, dx)));
+        __m128 overlap = _mm_cmple_ps(distance2, _mm_mul_ps(radius, radius));
+        overlapping += _geometry_append(_mm_movemask_ps(overlap), i, 4, out + overlapping);
+    }
+    return overlapping + _overlap_spheres_scalar(query, data, i, end, out + overlapping);
+}
+
+//--------------------------------------------------------------------------------------------
+// AVX2 kernels, 8 rays, triangles or volumes per iteration with masked tails
+//--------------------------------------------------------------------------------------------
+
+static FR_TARGET_AVX2_FMA u32 _packet_aabb_avx2(const ray_packet* packet, const aabb* box, f32* out_t) {
+    __m256 t_near = _mm256_setzero_ps();
+    __m256 t_far = _mm256_loadu_ps(packet->t_max);
+    for (u32 c = 0; c < 3; ++c) {
+        __m256 origin = _mm256_loadu_ps(packet->origin[c]);
+        __m256 inv_direction = _mm256_loadu_ps(packet->inv_direction[c]);
+        __m256 t0 = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(box->min.data[c]), origin), inv_direction);
+        __m256 t1 = _mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(box->max.data[c]), origin), inv_direction);
+        t_near = _mm256_max_ps(t_near, _mm256_min_ps(t0, t1));
+        t_far = _mm256_min_ps(t_far, _mm256_max_ps(t0, t1));
+    }
+    _mm256_storeu_ps(out_t, t_near);
+    u32 hits = (u32)_mm256_movemask_ps(_mm256_cmp_ps(t_near, t_far, _CMP_LE_OQ));
+    return hits & ((1u << packet->count) - 1);
+}
+
+static FR_TARGET_AVX2_FMA b8
+_ray_triangles_avx2(const ray* r, const f32* const v[9], u32 start, u32 end, ray_hit* best) {
+    __m256 o[3], d[3];
+    for (u32 c = 0; c < 3; ++c) {
+        o[c] = _mm256_set1_ps(r->origin.data[c]);
+        d[c] = _mm256_set1_ps(r->direction.data[c]);
+    }
+    __m256 zero = _mm256_setzero_ps();
+    __m256 one = _mm256_set1_ps(1.0f);
+    __m256 epsilon = _mm256_set1_ps(GEOMETRY_TRIANGLE_EPSILON);
+    __m256 sign = _mm256_set1_ps(-0.0f);
+
+    __m256 best_t = _mm256_set1_ps(best->t);
+    __m256 best_u = zero;
+    __m256 best_v = zero;
+    __m256i best_index = _mm256_set1_epi32((i32)GEOMETRY_NO_HIT);
+    __m256i index = _mm256_add_epi32(_mm256_set1_epi32((i32)start), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    for (u32 i = start; i < end; i += 8) {
+        __m256i mask = fr_simd256_tail_mask(end - i);
+        __m256 a[3], e1[3], e2[3], s[3];
+        for (u32 c = 0; c < 3; ++c) {
+            a[c] = _mm256_maskload_ps(v[c] + i, mask);
+            e1[c] = _mm256_sub_ps(_mm256_maskload_ps(v[3 + c] + i, mask), a[c]);
+            e2[c] = _mm256_sub_ps(_mm256_maskload_ps(v[6 + c] + i, mask), a[c]);
+            s[c] = _mm256_sub_ps(o[c], a[c]);
+        }
+        __m256 px = fr_simd256_fnmadd(d[2], e2[1], _mm256_mul_ps(d[1], e2[2]));
+        __m256 py = fr_simd256_fnmadd(d[0], e2[2], _mm256_mul_ps(d[2], e2[0]));
+        __m256 pz = fr_simd256_fnmadd(d[1], e2[0], _mm256_mul_ps(d[0], e2[1]));
+        __m256 det = fr_simd256_fmadd(e1[2], pz, fr_simd256_fmadd(e1[1], py, _mm256_mul_ps(e1[0], px)));
+        __m256 inv_det = _mm256_div_ps(one, det);
+        __m256 u = fr_simd256_fmadd(s[2], pz, fr_simd256_fmadd(s[1], py, _mm256_mul_ps(s[0], px)));
+        u = _mm256_mul_ps(u, inv_det);
+
+        __m256 qx = fr_simd256_fnmadd(s[2], e1[1], _mm256_mul_ps(s[1], e1[2]));
+        __m256 qy = fr_simd256_fnmadd(s[0], e1[2], _mm256_mul_ps(s[2], e1[0]));
+        __m256 qz = fr_simd256_fnmadd(s[1], e1[0], _mm256_mul_ps(s[0], e1[1]));
+        __m256 w = fr_simd256_fmadd(d[2], qz, fr_simd256_fmadd(d[1], qy, _mm256_mul_ps(d[0], qx)));
+        w = _mm256_mul_ps(w, inv_det);
+        __m256 t = fr_simd256_fmadd(e2[2], qz, fr_simd256_fmadd(e2[1], qy, _mm256_mul_ps(e2[0], qx)));
+        t = _mm256_mul_ps(t, inv_det);
+
+        __m256 hit = _mm256_and_ps(_mm256_castsi256_ps(mask),
+                                   _mm256_cmp_ps(_mm256_andnot_ps(sign, det), epsilon, _CMP_GT_OQ));
+        hit = _mm256_and_ps(hit, _mm256_cmp_ps(u, zero, _CMP_GE_OQ));
+        hit = _mm256_and_ps(hit, _mm256_cmp_ps(w, zero, _CMP_GE_OQ));
+        hit = _mm256_and_ps(hit, _mm256_cmp_ps(_mm256_add_ps(u, w), one, _CMP_LE_OQ));
+        hit = _mm256_and_ps(hit, _mm256_cmp_ps(t, zero, _CMP_GE_OQ));
+        hit = _mm256_and_ps(hit, _mm256_cmp_ps(t, best_t, _CMP_LT_OQ));
+        best_t = _mm256_blendv_ps(best_t, t, hit);
+        best_u = _mm256_blendv_ps(best_u, u, hit);
+        best_v = _mm256_blendv_ps(best_v, w, hit);
+        best_index = _mm256_blendv_epi8(best_index, index, _mm256_castps_si256(hit));
+        index = _mm256_add_epi32(index, _mm256_set1_epi32(8));
+    }
+
+    FR_ALIGN(32) f32 lane_t[8], lane_u[8], lane_v[8];
+    FR_ALIGN(32) u32 lane_index[8];
+    _mm256_store_ps(lane_t, best_t);
+    _mm256_store_ps(lane_u, best_u);
+    _mm256_store_ps(lane_v, best_v);
+    _mm256_store_si256((__m256i*)lane_index, best_index);
+    return _geometry_reduce_hits(lane_t, lane_u, lane_v, lane_index, 8, best);
+}
+
+static FR_TARGET_AVX2_FMA u32
+_overlap_aabbs_avx2(const f32 query[6], const f32* const data[6], u32 start, u32 end, u32* out) {
+    __m256 query_min[3], query_max[3];
+    for (u32 c = 0; c < 3; ++c) {
+        query_min[c] = _mm256_set1_ps(query[c]);
+        query_max[c] = _mm256_set1_ps(query[3 + c]);
+    }
+
+    u32 overlapping = 0;
+    for (u32 i = start; i < end; i += 8) {
+        __m256i mask = fr_simd256_tail_mask(end - i);
+        __m256 overlap = _mm256_castsi256_ps(mask);
+        for (u32 c = 0; c < 3; ++c) {
+            __m256 min = _mm256_maskload_ps(data[c] + i, mask);
+            __m256 max = _mm256_maskload_ps(data[3 + c] + i, mask);
+            overlap = _mm256_and_ps(overlap, _mm256_cmp_ps(min, query_max[c], _CMP_LE_OQ));
+            overlap = _mm256_and_ps(overlap, _mm256_cmp_ps(query_min[c], max, _CMP_LE_OQ));
+        }
+        overlapping += _geometry_append(_mm256_movemask_ps(overlap), i, 8, out + overlapping);
+    }
+    return overlapping;
+}
+
+static FR_TARGET_AVX2_FMA u32
+_overlap_spheres_avx2(const f32 query[6], const f32* const data[6], u32 start, u32 end, u32* out) {
+    __m256 center[3];
+    for (u32 c = 0; c < 3; ++c) {
+        center[c] = _mm256_set1_ps(query[c]);
+    }
+    __m256 query_radius = _mm256_set1_ps(query[3]);
+
+    u32 overlapping = 0;
+    for (u32 i = start; i < end; i += 8) {
+        __m256i mask = fr_simd256_tail_mask(end - i);
+        __m256 dx = _mm256_sub_ps(_mm256_maskload_ps(data[0] + i, mask), center[0]);
+        __m256 dy = _mm256_sub_ps(_mm256_maskload_ps(data[1] + i, mask), center[1]);
+        __m256 dz = _mm256_sub_ps(_mm256_maskload_ps(data[2] + i, mask), center[2]);
+        __m256 radius = _mm256_add_ps(_mm256_maskload_ps(data[3] + i, mask), query_radius);
+        __m256 distance2 = fr_simd256_fmadd(dz, dz, fr_simd256_fmadd(dy, dy, _mm256_mul_ps(dx, dx)));
+        __m256 overlap = _mm256_cmp_ps(distance2, _mm256_mul_ps(radius, radius), _CMP_LE_OQ);
+        overlapping += _geometry_append(_mm256_movemask_ps(overlap), i, MIN(end - i, 8), out + overlapping);
+    }
+    return overlapping;
+}
+
+//--------------------------------------------------------------------------------------------
+// AVX-512 kernels, 16 triangles or volumes per iteration. A packet holds 8 rays, which fit in one AVX2 register, so
+// the packet test is the AVX2 kernel.
+//--------------------------------------------------------------------------------------------
+
+static FR_TARGET_AVX512 b8
+_ray_triangles_avx512(const ray* r, const f32* const v[9], u32 start, u32 end, ray_hit* best) {
+    __m512 o[3], d[3];
+    for (u32 c = 0; c < 3; ++c) {
+        o[c] = _mm512_set1_ps(r->origin.data[c]);
+        d[c] = _mm512_set1_ps(r->direction.data[c]);
+    }
+    __m512 zero = _mm512_setzero_ps();
+    __m512 one = _mm512_set1_ps(1.0f);
+    __m512 epsilon = _mm512_set1_ps(GEOMETRY_TRIANGLE_EPSILON);
+
+    __m512 best_t = _mm512_set1_ps(best->t);
+    __m512 best_u = zero;
+    __m512 best_v = zero;
+    __m512i best_index = _mm512_set1_epi32((i32)GEOMETRY_NO_HIT);
+    __m512i index = _mm512_add_epi32(_mm512_set1_epi32((i32)start),
+                                     _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+    for (u32 i = start; i < end; i += 16) {
+        __mmask16 hit = fr_simd512_tail_mask(end - i);
+        __m512 a[3], e1[3], e2[3], s[3];
+        for (u32 c = 0; c < 3; ++c) {
+            a[c] = _mm512_maskz_loadu_ps(hit, v[c] + i);
+            e1[c] = _mm512_sub_ps(_mm512_maskz_loadu_ps(hit, v[3 + c] + i), a[c]);
+            e2[c] = _mm512_sub_ps(_mm512_maskz_loadu_ps(hit, v[6 + c] + i), a[c]);
+            s[c] = _mm512_sub_ps(o[c], a[c]);
+        }
+        __m512 px = fr_simd512_fnmadd(d[2], e2[1], _mm512_mul_ps(d[1], e2[2]));
+        __m512 py = fr_simd512_fnmadd(d[0], e2[2], _mm512_mul_ps(d[2], e2[0]));
+        __m512 pz = fr_simd512_fnmadd(d[1], e2[0], _mm512_mul_ps(d[0], e2[1]));
+        __m512 det = fr_simd512_fmadd(e1[2], pz, fr_simd512_fmadd(e1[1], py, _mm512_mul_ps(e1[0], px)));
+        __m512 inv_det = _mm512_div_ps(one, det);
+        __m512 u = fr_simd512_fmadd(s[2], pz, fr_simd512_fmadd(s[1], py, _mm512_mul_ps(s[0], px)));
+        u = _mm512_mul_ps(u, inv_det);
+
+        __m512 qx = fr_simd512_fnmadd(s[2], e1[1], _mm512_mul_ps(s[1], e1[2]));
+        __m512 qy = fr_simd512_fnmadd(s[0], e1[2], _mm512_mul_ps(s[2], e1[0]));
+        __m512 qz = fr_simd512_fnmadd(s[1], e1[0], _mm512_mul_ps(s[0], e1[1]));
+        __m512 w = fr_simd512_fmadd(d[2], qz, fr_simd512_fmadd(d[1], qy, _mm512_mul_ps(d[0], qx)));
+        w = _mm512_mul_ps(w, inv_det);
+        __m512 t = fr_simd512_fmadd(e2[2], qz, fr_simd512_fmadd(e2[1], qy, _mm512_mul_ps(e2[0], qx)));
+        t = _mm512_mul_ps(t, inv_det);
+
+        hit = _mm512_mask_cmp_ps_mask(hit, _mm512_abs_ps(det), epsilon, _CMP_GT_OQ);
+        hit = _mm512_mask_cmp_ps_mask(hit, u, zero, _CMP_GE_OQ);
+        hit = _mm512_mask_cmp_ps_mask(hit, w, zero, _CMP_GE_OQ);
+        hit = _mm512_mask_cmp_ps_mask(hit, _mm512_add_ps(u, w), one, _CMP_LE_OQ);
+        hit = _mm512_mask_cmp_ps_mask(hit, t, zero, _CMP_GE_OQ);
+        hit = _mm512_mask_cmp_ps_mask(hit, t, best_t, _CMP_LT_OQ);
+        best_t = _mm512_mask_mov_ps(best_t, hit, t);
+        best_u = _mm512_mask_mov_ps(best_u, hit, u);
+        best_v = _mm512_mask_mov_ps(best_v, hit, w);
+        best_index = _mm512_mask_mov_epi32(best_index, hit, index);
+        index = _mm512_add_epi32(index, _mm512_set1_epi32(16));
+    }
+
+    FR_ALIGN(64) f32 lane_t[16], lane_u[16], lane_v[16];
+    FR_ALIGN(64) u32 lane_index[16];
+    _mm512_store_ps(lane_t, best_t);
+    _mm512_store_ps(lane_u, best_u);
+    _mm512_store_ps(lane_v, best_v);
+    _mm512_store_si512(lane_index, best_index);
+    return _geometry_reduce_hits(lane_t, lane_u, lane_v, lane_index, 16, best);
+}
+
+static FR_TARGET_AVX512 u32
+_overlap_aabbs_avx512(const f32 query[6], const f32* const data[6], u32 start, u32 end, u32* out) {
+    __m512 query_min[3], query_max[3];
+    for (u32 c = 0; c < 3; ++c) {
+        query_min[c] = _mm512_set1_ps(query[c]);
+        query_max[c] = _mm512_set1_ps(query[3 + c]);
+    }
+
+    __m512i lanes = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    u32 overlapping = 0;
+    for (u32 i = start; i < end; i += 16) {
+        __mmask16 overlap = fr_simd512_tail_mask(end - i);
+        for (u32 c = 0; c < 3; ++c) {
+            __m512 min = _mm512_maskz_loadu_ps(overlap, data[c] + i);
+            __m512 max = _mm512_maskz_loadu_ps(overlap, data[3 + c] + i);
+            overlap = _mm512_mask_cmp_ps_mask(overlap, min, query_max[c], _CMP_LE_OQ);
+            overlap = _mm512_mask_cmp_ps_mask(overlap, query_min[c], max, _CMP_LE_OQ);
+        }
+        _mm512_mask_compressstoreu_epi32(
+            out + overlapping, overlap, _mm512_add_epi32(_mm512_set1_epi32((i32)i), lanes));
+        overlapping += (u32)__builtin_popcount(overlap);
+    }
+    return overlapping;
+}
+
+static FR_TARGET_AVX512 u32
+_overlap_spheres_avx512(const f32 query[6], const f32* const data[6], u32 start, u32 end, u32* out) {
+    __m512 center[3];
+    for (u32 c = 0; c < 3; ++c) {
+        center[c] = _mm512_set1_ps(query[c]);
+    }
+    __m512 query_radius = _mm512_set1_ps(query[3]);
+
+    __m512i lanes = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    u32 overlapping = 0;
+    for (u32 i = start; i < end; i += 16) {
+        __mmask16 overlap = fr_simd512_tail_mask(end - i);
+        __m512 dx = _mm512_sub_ps(_mm512_maskz_loadu_ps(overlap, data[0] + i), center[0]);
+        __m512 dy = _mm512_sub_ps(_mm512_maskz_loadu_ps(overlap, data[1] + i), center[1]);
+        __m512 dz = _mm512_sub_ps(_mm512_maskz_loadu_ps(overlap, data[2] + i), center[2]);
+        __m512 radius = _mm512_add_ps(_mm512_maskz_loadu_ps(overlap, data[3] + i), query_radius);
+        __m512 distance2 = fr_simd512_fmadd(dz, dz, fr_simd512_fmadd(dy, dy, _mm512_mul_ps(dx, dx)));
+        overlap = _mm512_mask_cmp_ps_mask(overlap, distance2, _mm512_mul_ps(radius, radius), _CMP_LE_OQ);
+        _mm512_mask_compressstoreu_epi32(
+            out + overlapping, overlap, _mm512_add_epi32(_mm512_set1_epi32((i32)i), lanes));
+        overlapping += (u32)__builtin_popcount(overlap);
+    }
+    return overlapping;
+}
+#endif
+
+//--------------------------------------------------------------------------------------------
+// Dispatch
+//--------------------------------------------------------------------------------------------
+
+static const geometry_kernels kernels[FR_SIMD_LEVEL_MAX] = {
+    [FR_SIMD_LEVEL_SCALAR] = {_packet_aabb_scalar, _ray_triangles_scalar, _overlap_aabbs_scalar,
+                              _overlap_spheres_scalar},
+#if FR_SIMD == 1
+    [FR_SIMD_LEVEL_SSE2] = {_packet_aabb_sse, _ray_triangles_sse, _overlap_aabbs_sse, _overlap_spheres_sse},
+    [FR_SIMD_LEVEL_AVX2] = {_packet_aabb_avx2, _ray_triangles_avx2, _overlap_aabbs_avx2, _overlap_spheres_avx2},
+    [FR_SIMD_LEVEL_AVX512] = {_packet_aabb_avx2, _ray_triangles_avx512, _overlap_aabbs_avx512,
+                              _overlap_spheres_avx512},
+#endif
+};
+
+b8 fr_ray_intersect_aabb(const ray* r, const aabb* box, f32 t_max, f32* out_t) {
+    const f32 inv_direction[3] = {
+        fr_ray_reciprocal(r->direction.x), fr_ray_reciprocal(r->direction.y), fr_ray_reciprocal(r->direction.z)};
+    return _geometry_slab(r->origin.data, inv_direction, box->min.data, box->max.data, t_max, out_t);
+}
+
+b8 fr_ray_intersect_obb(const ray* r, const obb* box, f32 t_max, f32* out_t) {
+    vec3 offset;
+    fr_vec3_sub(&r->origin, &box->center, &offset);
+    f32 origin[3], inv_direction[3], min[3], max[3];
+    for (u32 c = 0; c < 3; ++c) {
+        origin[c] = fr_vec3_dot(&offset, &box->axes[c]);
+        inv_direction[c] = fr_ray_reciprocal(fr_vec3_dot(&r->direction, &box->axes[c]));
+        min[c] = -box->half_extents.data[c];
+        max[c] = box->half_extents.data[c];
+    }
+    return _geometry_slab(origin, inv_direction, min, max, t_max, out_t);
+}
+
+b8 fr_ray_intersect_sphere(const ray* r, const sphere* s, f32 t_max, f32* out_t) {
+    vec3 offset;
+    fr_vec3_sub(&r->origin, &s->center, &offset);
+    f32 a = fr_vec3_norm2(&r->direction);
+    f32 b = fr_vec3_dot(&offset, &r->direction);
+    f32 c = fr_vec3_norm2(&offset) - s->radius * s->radius;
+    // Starting outside and pointing away
+    if (c > 0.0f && b > 0.0f) {
+        return FALSE;
+    }
+    f32 discriminant = b * b - a * c;
+    if (discriminant < 0.0f || a <= 0.0f) {
+        return FALSE;
+    }
+    f32 t = fr_max((-b - fr_sqrt(discriminant)) / a, 0.0f);
+    if (t > t_max) {
+        return FALSE;
+    }
+    if (out_t) {
+        *out_t = t;
+    }
+    return TRUE;
+}
+
+b8 fr_ray_intersect_plane(const ray* r, const plane* p, f32 t_max, f32* out_t) {
+    f32 denominator = fr_vec3_dot(&p->normal, &r->direction);
+    if (fr_abs(denominator) < FR_RAY_MIN_DIRECTION) {
+        return FALSE;
+    }
+    f32 t = -fr_plane_signed_distance(p, &r->origin) / denominator;
+    if (t < 0.0f || t > t_max) {
+        return FALSE;
+    }
+    if (out_t) {
+        *out_t = t;
+    }
+    return TRUE;
+}
+
+b8 fr_ray_intersect_triangle(
+    const ray* r, const vec3* v0, const vec3* v1, const vec3* v2, f32 t_max, ray_hit* out_hit) {
+    const f32* const v[9] = {&v0->x, &v0->y, &v0->z, &v1->x, &v1->y, &v1->z, &v2->x, &v2->y, &v2->z};
+    ray_hit hit = {.t = t_max};
+    if (!_ray_triangles_scalar(r, v, 0, 1, &hit)) {
+        return FALSE;
+    }
+    if (out_hit) {
+        *out_hit = hit;
+    }
+    return TRUE;
+}
+
+b8 fr_ray_intersect_triangles(const ray* r,
+                              const f32* const v0[3],
+                              const f32* const v1[3],
+                              const f32* const v2[3],
+                              u32 count,
+                              f32 t_max,
+                              ray_hit* out_hit) {
+    const f32* const v[9] = {v0[0], v0[1], v0[2], v1[0], v1[1], v1[2], v2[0], v2[1], v2[2]};
+    ray_hit hit = {.t = t_max};
+    if (!kernels[fr_simd_get_level()].triangles(r, v, 0, count, &hit)) {
+        return FALSE;
+    }
+    *out_hit = hit;
+    return TRUE;
+}
+
+void fr_ray_packet_create(const ray* rays, u32 count, f32 t_max, ray_packet* out) {
+    out->count = MIN(count, FR_RAY_PACKET_SIZE);
+    for (u32 i = 0; i < FR_RAY_PACKET_SIZE; ++i) {
+        // The unused lanes get a ray that misses everything and computes no NaN
+        b8 used = i < out->count;
+        for (u32 c = 0; c < 3; ++c) {
+            out->origin[c][i] = used ? rays[i].origin.data[c] : 0.0f;
+            out->inv_direction[c][i] = used ? fr_ray_reciprocal(rays[i].direction.data[c]) : 1.0f;
+        }
+        out->t_max[i] = used ? t_max : -1.0f;
+    }
+}
+
+u32 fr_ray_packet_intersect_aabb(const ray_packet* packet, const aabb* box, f32 out_t[FR_RAY_PACKET_SIZE]) {
+    f32 t[FR_RAY_PACKET_SIZE];
+    u32 hits = kernels[fr_simd_get_level()].packet_aabb(packet, box, t);
+    if (out_t) {
+        for (u32 mask = hits; mask != 0; mask &= mask - 1) {
+            u32 i = (u32)__builtin_ctz(mask);
+            out_t[i] = t[i];
+        }
+    }
+    return hits;
+}
+
+f32 fr_segment_closest_point(const vec3* a, const vec3* b, const vec3* point, vec3* out) {
+    vec3 ab, ap;
+    fr_vec3_sub(b, a, &ab);
+    fr_vec3_sub(point, a, &ap);
+    f32 length2 = fr_vec3_norm2(&ab);
+    f32 t = length2 > 0.0f ? fr_clamp_zo(fr_vec3_dot(&ap, &ab) / length2) : 0.0f;
+    vec3 closest;
+    fr_vec3_copy(a, &closest);
+    fr_vec3_fmadds(&ab, t, &closest);
+    fr_vec3_copy(&closest, out);
+    return t;
+}
+
+// Ericson, Real-Time Collision Detection 5.1.5: finds the Voronoi region of the triangle that holds the point and
+// projects it on that vertex, edge or face
+void fr_triangle_closest_point(const vec3* a, const vec3* b, const vec3* c, const vec3* point, vec3* out) {
+    vec3 ab, ac, ap;
+    fr_vec3_sub(b, a, &ab);
+    fr_vec3_sub(c, a, &ac);
+    fr_vec3_sub(point, a, &ap);
+    f32 d1 = fr_vec3_dot(&ab, &ap);
+    f32 d2 = fr_vec3_dot(&ac, &ap);
+    if (d1 <= 0.0f && d2 <= 0.0f) {
+        fr_vec3_copy(a, out);
+        return;
+    }
+
+    vec3 bp;
+    fr_vec3_sub(point, b, &bp);
+    f32 d3 = fr_vec3_dot(&ab, &bp);
+    f32 d4 = fr_vec3_dot(&ac, &bp);
+    if (d3 >= 0.0f && d4 <= d3) {
+        fr_vec3_copy(b, out);
+        return;
+    }
+
+    vec3 closest;
+    fr_vec3_copy(a, &closest);
+    f32 vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+        fr_vec3_fmadds(&ab, d1 / (d1 - d3), &closest);
+        fr_vec3_copy(&closest, out);
+        return;
+    }
+
+    vec3 cp;
+    fr_vec3_sub(point, c, &cp);
+    f32 d5 = fr_vec3_dot(&ab, &cp);
+    f32 d6 = fr_vec3_dot(&ac, &cp);
+    if (d6 >= 0.0f && d5 <= d6) {
+        fr_vec3_copy(c, out);
+        return;
+    }
+
+    f32 vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+        fr_vec3_fmadds(&ac, d2 / (d2 - d6), &closest);
+        fr_vec3_copy(&closest, out);
+        return;
+    }
+
+    f32 va = d3 * d6 - d5 * d4;
+    if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f) {
+        vec3 bc;
+        fr_vec3_sub(c, b, &bc);
+        fr_vec3_copy(b, &closest);
+        fr_vec3_fmadds(&bc, (d4 - d3) / ((d4 - d3) + (d5 - d6)), &closest);
+        fr_vec3_copy(&closest, out);
+        return;
+    }
+
+    f32 denominator = 1.0f / (va + vb + vc);
+    fr_vec3_fmadds(&ab, vb * denominator, &closest);
+    fr_vec3_fmadds(&ac, vc * denominator, &closest);
+    fr_vec3_copy(&closest, out);
+}
+
+// Arvo: each component of the new box is the transformed center plus or minus the extents weighted by the absolute
+// values of the matching row of the matrix
+void fr_aabb_transform(const aabb* box, const mat4* transform, aabb* out) {
+    const f32* m = transform->data;
+    vec3 center, extent;
+    fr_aabb_center(box, &center);
+    fr_aabb_half_extents(box, &extent);
+    for (u32 r = 0; r < 3; ++r) {
+        f32 new_center = m[12 + r];
+        f32 new_extent = 0.0f;
+        for (u32 c = 0; c < 3; ++c) {
+            new_center += m[c * 4 + r] * center.data[c];
+            new_extent += fr_abs(m[c * 4 + r]) * extent.data[c];
+        }
+        out->min.data[r] = new_center - new_extent;
+        out->max.data[r] = new_center + new_extent;
+    }
+#if FR_VEC3_SIMD == 1
+    out->min.padding = 0.0f;
+    out->max.padding = 0.0f;
+#endif
+}
+
+u32 fr_aabb_overlap_query(
+    const aabb* box, const f32* const min[3], const f32* const max[3], u32 count, u32* out_overlapping) {
+    const f32 query[6] = {box->min.x, box->min.y, box->min.z, box->max.x, box->max.y, box->max.z};
+    const f32* const data[6] = {min[0], min[1], min[2], max[0], max[1], max[2]};
+    return kernels[fr_simd_get_level()].aabbs(query, data, 0, count, out_overlapping);
+}
+
+u32 fr_sphere_overlap_query(
+    const sphere* s, const f32* const center[3], const f32* radius, u32 count, u32* out_overlapping) {
+    const f32 query[6] = {s->center.x, s->center.y, s->center.z, s->radius, 0.0f, 0.0f};
+    const f32* const data[6] = {center[0], center[1], center[2], radius, NULL_PTR, NULL_PTR};
+    return kernels[fr_simd_get_level()].spheres(query, data, 0, count, out_overlapping);
+}
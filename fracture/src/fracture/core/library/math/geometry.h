@@ -0,0 +1,569 @@
+/**
+ * @file geometry.h
+ * @author Aditya Rajagopal
+ * @brief Bounding volumes, rays and planes with their intersection and closest point queries.
+ * @details The tests between two volumes and the closest point queries are inline. The ray tests and the queries over
+ * arrays live in geometry.c, where the array versions run 4 (SSE2), 8 (AVX2) or 16 (AVX-512) elements at a time with
+ * the instruction set chosen by fr_simd_get_level:
+ * - fr_ray_packet_intersect_aabb tests up to FR_RAY_PACKET_SIZE rays against a box with the slab test, the primary
+ *   query when walking a bounding volume hierarchy with coherent rays such as those of a picking rectangle.
+ * - fr_ray_intersect_triangles finds the closest of an array of triangles hit by a ray with the Moller-Trumbore test.
+ * - fr_aabb_overlap_query and fr_sphere_overlap_query list the boxes or spheres of an array touching a query volume.
+ *
+ * Arrays are structures of arrays with one array per coordinate, like those of frustum.h. They need no particular
+ * alignment and their lengths need not be multiples of the vector width.
+ *
+ * Rays are points origin + t * direction with t >= 0. Directions need not be normalized, in which case t is measured in
+ * lengths of the direction. Volumes touching at a single point or face overlap.
+ * @version 0.0.1
+ * @date 2024-05-01
+ *
+ * @copyright Fracture Game Engine is Copyright (c) Aditya Rajagopal 2024-2024
+ *
+ */
+#pragma once
+
+#include "detail/matrix.h"
+#include "fracture/core/defines.h"
+#include "utils.h"
+#include "vec3.h"
+
+/** @brief Direction components smaller than this are treated as this by the slab tests, see fr_ray_reciprocal */
+#define FR_RAY_MIN_DIRECTION 1e-20f
+
+/** @brief Number of rays in a ray_packet */
+#define FR_RAY_PACKET_SIZE 8
+
+/**
+ * @brief An axis aligned bounding box. A box with any min component larger than the matching max component is empty.
+ *
+ */
+typedef struct aabb {
+    vec3 min;
+    vec3 max;
+} aabb;
+
+/**
+ * @brief An oriented bounding box.
+ *
+ */
+typedef struct obb {
+    vec3 center;
+    /** @brief Half the size of the box along each of its axes */
+    vec3 half_extents;
+    /** @brief The orthonormal axes of the box in world space */
+    vec3 axes[3];
+} obb;
+
+/**
+ * @brief A bounding sphere.
+ *
+ */
+typedef struct sphere {
+    vec3 center;
+    f32 radius;
+} sphere;
+
+/**
+ * @brief A plane through the points p for which dot(normal, p) + distance = 0, with the same convention as the planes
+ * of a frustum. The normal is a unit vector.
+ *
+ */
+typedef struct plane {
+    vec3 normal;
+    f32 distance;
+} plane;
+
+/**
+ * @brief A half line starting at origin.
+ *
+ */
+typedef struct ray {
+    vec3 origin;
+    vec3 direction;
+} ray;
+
+/**
+ * @brief The closest hit of a ray against an array of triangles.
+ *
+ */
+typedef struct ray_hit {
+    /** @brief The ray parameter of the hit point */
+    f32 t;
+    /** @brief The barycentric weight of the second vertex of the triangle at the hit point */
+    f32 u;
+    /** @brief The barycentric weight of the third vertex of the triangle at the hit point */
+    f32 v;
+    /** @brief The index of the triangle */
+    u32 index;
+} ray_hit;
+
+/**
+ * @brief Up to FR_RAY_PACKET_SIZE rays as a structure of arrays, with the reciprocals of their directions precomputed
+ * for the slab test. Create with fr_ray_packet_create.
+ *
+ */
+typedef FR_ALIGN(32) struct ray_packet {
+    f32 origin[3][FR_RAY_PACKET_SIZE];
+    f32 inv_direction[3][FR_RAY_PACKET_SIZE];
+    f32 t_max[FR_RAY_PACKET_SIZE];
+    u32 count;
+} ray_packet;
+
+//--------------------------------------------------------------------------------------------
+// Volumes
+//--------------------------------------------------------------------------------------------
+
+/**
+ * @brief Makes a box that contains nothing, to grow with fr_aabb_merge or fr_aabb_merge_point.
+ *
+ * @param out The empty box
+ */
+FR_FORCE_INLINE void fr_aabb_empty(aabb* out) {
+    fr_vec3_fill(FLOAT_MAX, &out->min);
+    fr_vec3_fill(-FLOAT_MAX, &out->max);
+}
+
+/**
+ * @brief Makes the smallest box containing two boxes.
+ *
+ * @param a The first box
+ * @param b The second box
+ * @param out The box containing both, may be a or b
+ */
+FR_FORCE_INLINE void fr_aabb_merge(const aabb* a, const aabb* b, aabb* out) {
+    fr_vec3_minv(&a->min, &b->min, &out->min);
+    fr_vec3_maxv(&a->max, &b->max, &out->max);
+}
+
+/**
+ * @brief Grows a box to contain a point.
+ *
+ * @param box The box to grow
+ * @param point The point
+ */
+FR_FORCE_INLINE void fr_aabb_merge_point(aabb* box, const vec3* point) {
+    fr_vec3_minv(&box->min, point, &box->min);
+    fr_vec3_maxv(&box->max, point, &box->max);
+}
+
+/**
+ * @brief Gets the center of a box.
+ *
+ * @param box The box
+ * @param out The center
+ */
+FR_FORCE_INLINE void fr_aabb_center(const aabb* box, vec3* out) { fr_vec3_center(&box->min, &box->max, out); }
+
+/**
+ * @brief Gets half the size of a box along each axis.
+ *
+ * @param box The box
+ * @param out The half extents
+ */
+FR_FORCE_INLINE void fr_aabb_half_extents(const aabb* box, vec3* out) {
+    fr_vec3_sub(&box->max, &box->min, out);
+    fr_vec3_scale(out, 0.5f, out);
+}
+
+/**
+ * @brief Gets the surface area of a box, the cost metric of bounding volume hierarchies.
+ *
+ * @param box The box
+ * @return f32 The surface area, 0 for an empty box
+ */
+FR_FORCE_INLINE f32 fr_aabb_surface_area(const aabb* box) {
+    f32 x = box->max.x - box->min.x;
+    f32 y = box->max.y - box->min.y;
+    f32 z = box->max.z - box->min.z;
+    if (x < 0.0f || y < 0.0f || z < 0.0f) {
+        return 0.0f;
+    }
+    return 2.0f * (x * y + y * z + z * x);
+}
+
+/**
+ * @brief Checks if two boxes overlap.
+ *
+ * @param a The first box
+ * @param b The second box
+ * @return b8 TRUE if the boxes share at least one point
+ */
+FR_FORCE_INLINE b8 fr_aabb_overlap(const aabb* a, const aabb* b) {
+    return a->min.x <= b->max.x && b->min.x <= a->max.x && a->min.y <= b->max.y && b->min.y <= a->max.y &&
+           a->min.z <= b->max.z && b->min.z <= a->max.z;
+}
+
+/**
+ * @brief Checks if a box contains a point.
+ *
+ * @param box The box
+ * @param point The point
+ * @return b8 TRUE if the point is inside the box or on its surface
+ */
+FR_FORCE_INLINE b8 fr_aabb_contains_point(const aabb* box, const vec3* point) {
+    return box->min.x <= point->x && point->x <= box->max.x && box->min.y <= point->y && point->y <= box->max.y &&
+           box->min.z <= point->z && point->z <= box->max.z;
+}
+
+/**
+ * @brief Gets the point of a box closest to a point.
+ *
+ * @param box The box
+ * @param point The point
+ * @param out The closest point, point itself when it is inside the box
+ */
+FR_FORCE_INLINE void fr_aabb_closest_point(const aabb* box, const vec3* point, vec3* out) {
+    fr_vec3_maxv(point, &box->min, out);
+    fr_vec3_minv(out, &box->max, out);
+}
+
+/**
+ * @brief Gets the squared distance between a box and a point.
+ *
+ * @param box The box
+ * @param point The point
+ * @return f32 The squared distance, 0 when the point is inside the box
+ */
+FR_FORCE_INLINE f32 fr_aabb_distance2(const aabb* box, const vec3* point) {
+    vec3 closest;
+    fr_aabb_closest_point(box, point, &closest);
+    return fr_vec3_distance2(&closest, point);
+}
+
+/**
+ * @brief Makes the bounding box of a sphere.
+ *
+ * @param s The sphere
+ * @param out The box
+ */
+FR_FORCE_INLINE void fr_aabb_from_sphere(const sphere* s, aabb* out) {
+    fr_vec3_subs(&s->center, s->radius, &out->min);
+    fr_vec3_adds(&s->center, s->radius, &out->max);
+}
+
+/**
+ * @brief Checks if two spheres overlap.
+ *
+ * @param a The first sphere
+ * @param b The second sphere
+ * @return b8 TRUE if the spheres share at least one point
+ */
+FR_FORCE_INLINE b8 fr_sphere_overlap(const sphere* a, const sphere* b) {
+    f32 radius = a->radius + b->radius;
+    return fr_vec3_distance2(&a->center, &b->center) <= radius * radius;
+}
+
+/**
+ * @brief Checks if a sphere and a box overlap.
+ *
+ * @param s The sphere
+ * @param box The box
+ * @return b8 TRUE if the sphere and the box share at least one point
+ */
+FR_FORCE_INLINE b8 fr_sphere_aabb_overlap(const sphere* s, const aabb* box) {
+    return fr_aabb_distance2(box, &s->center) <= s->radius * s->radius;
+}
+
+/**
+ * @brief Gets the point of a sphere closest to a point.
+ *
+ * @param s The sphere
+ * @param point The point
+ * @param out The closest point, point itself when it is inside the sphere
+ */
+FR_FORCE_INLINE void fr_sphere_closest_point(const sphere* s, const vec3* point, vec3* out) {
+    vec3 offset;
+    fr_vec3_sub(point, &s->center, &offset);
+    f32 distance2 = fr_vec3_norm2(&offset);
+    if (distance2 <= s->radius * s->radius) {
+        fr_vec3_copy(point, out);
+        return;
+    }
+    fr_vec3_scale(&offset, s->radius / fr_sqrt(distance2), &offset);
+    fr_vec3_add(&s->center, &offset, out);
+}
+
+/**
+ * @brief Gets the point of an oriented box closest to a point.
+ *
+ * @param box The box
+ * @param point The point
+ * @param out The closest point, point itself when it is inside the box
+ */
+FR_FORCE_INLINE void fr_obb_closest_point(const obb* box, const vec3* point, vec3* out) {
+    vec3 offset, closest;
+    fr_vec3_sub(point, &box->center, &offset);
+    fr_vec3_copy(&box->center, &closest);
+    for (u32 i = 0; i < 3; ++i) {
+        f32 extent = box->half_extents.data[i];
+        f32 distance = fr_clamp(fr_vec3_dot(&offset, &box->axes[i]), -extent, extent);
+        fr_vec3_fmadds(&box->axes[i], distance, &closest);
+    }
+    fr_vec3_copy(&closest, out);
+}
+
+//--------------------------------------------------------------------------------------------
+// Planes
+//--------------------------------------------------------------------------------------------
+
+/**
+ * @brief Makes the plane through a point with a normal.
+ *
+ * @param point A point of the plane
+ * @param normal The unit normal of the plane
+ * @param out The plane
+ */
+FR_FORCE_INLINE void fr_plane_from_point_normal(const vec3* point, const vec3* normal, plane* out) {
+    fr_vec3_copy(normal, &out->normal);
+    out->distance = -fr_vec3_dot(normal, point);
+}
+
+/**
+ * @brief Makes the plane through three points, whose normal points to the side the points are seen counter clockwise
+ * from.
+ *
+ * @param a The first point
+ * @param b The second point
+ * @param c The third point
+ * @param out The plane
+ * @return b8 FALSE if the points are on a line, in which case out is not written
+ */
+FR_FORCE_INLINE b8 fr_plane_from_points(const vec3* a, const vec3* b, const vec3* c, plane* out) {
+    vec3 ab, ac, normal;
+    fr_vec3_sub(b, a, &ab);
+    fr_vec3_sub(c, a, &ac);
+    fr_vec3_cross(&ab, &ac, &normal);
+    f32 norm2 = fr_vec3_norm2(&normal);
+    if (norm2 <= 0.0f) {
+        return FALSE;
+    }
+    fr_vec3_scale(&normal, 1.0f / fr_sqrt(norm2), &normal);
+    fr_plane_from_point_normal(a, &normal, out);
+    return TRUE;
+}
+
+/**
+ * @brief Gets the signed distance of a point to a plane.
+ *
+ * @param p The plane
+ * @param point The point
+ * @return f32 The distance, positive on the side the normal points to
+ */
+FR_FORCE_INLINE f32 fr_plane_signed_distance(const plane* p, const vec3* point) {
+    return fr_vec3_dot(&p->normal, point) + p->distance;
+}
+
+/**
+ * @brief Gets the point of a plane closest to a point.
+ *
+ * @param p The plane
+ * @param point The point
+ * @param out The projection of the point on the plane
+ */
+FR_FORCE_INLINE void fr_plane_closest_point(const plane* p, const vec3* point, vec3* out) {
+    f32 distance = fr_plane_signed_distance(p, point);
+    vec3 closest;
+    fr_vec3_copy(point, &closest);
+    fr_vec3_fmadds(&p->normal, -distance, &closest);
+    fr_vec3_copy(&closest, out);
+}
+
+//--------------------------------------------------------------------------------------------
+// Rays
+//--------------------------------------------------------------------------------------------
+
+/**
+ * @brief Gets the point of a ray at a parameter.
+ *
+ * @param r The ray
+ * @param t The parameter
+ * @param out origin + t * direction
+ */
+FR_FORCE_INLINE void fr_ray_at(const ray* r, f32 t, vec3* out) {
+    vec3 point;
+    fr_vec3_copy(&r->origin, &point);
+    fr_vec3_fmadds(&r->direction, t, &point);
+    fr_vec3_copy(&point, out);
+}
+
+/**
+ * @brief Gets the reciprocal of a component of a ray direction for slab tests. Components smaller than
+ * FR_RAY_MIN_DIRECTION get huge but finite reciprocals, so that rays starting on a face of a box compute 0 rather than
+ * 0 * inf = NaN.
+ *
+ * @param direction The component
+ * @return f32 The reciprocal
+ */
+FR_FORCE_INLINE f32 fr_ray_reciprocal(f32 direction) {
+    if (fr_abs(direction) < FR_RAY_MIN_DIRECTION) {
+        direction = direction < 0.0f ? -FR_RAY_MIN_DIRECTION : FR_RAY_MIN_DIRECTION;
+    }
+    return 1.0f / direction;
+}
+
+/**
+ * @brief Intersects a ray with a box using the slab test.
+ *
+ * @param r The ray
+ * @param box The box
+ * @param t_max The largest parameter of interest
+ * @param out_t The parameter where the ray enters the box, 0 when it starts inside. May be NULL_PTR.
+ * @return b8 TRUE if the ray hits the box at a parameter in [0, t_max]
+ */
+FR_API b8 fr_ray_intersect_aabb(const ray* r, const aabb* box, f32 t_max, f32* out_t);
+
+/**
+ * @brief Intersects a ray with an oriented box using the slab test in the frame of the box.
+ *
+ * @param r The ray
+ * @param box The box
+ * @param t_max The largest parameter of interest
+ * @param out_t The parameter where the ray enters the box, 0 when it starts inside. May be NULL_PTR.
+ * @return b8 TRUE if the ray hits the box at a parameter in [0, t_max]
+ */
+FR_API b8 fr_ray_intersect_obb(const ray* r, const obb* box, f32 t_max, f32* out_t);
+
+/**
+ * @brief Intersects a ray with a sphere.
+ *
+ * @param r The ray
+ * @param s The sphere
+ * @param t_max The largest parameter of interest
+ * @param out_t The parameter where the ray enters the sphere, 0 when it starts inside. May be NULL_PTR.
+ * @return b8 TRUE if the ray hits the sphere at a parameter in [0, t_max]
+ */
+FR_API b8 fr_ray_intersect_sphere(const ray* r, const sphere* s, f32 t_max, f32* out_t);
+
+/**
+ * @brief Intersects a ray with a plane, from either side.
+ *
+ * @param r The ray
+ * @param p The plane
+ * @param t_max The largest parameter of interest
+ * @param out_t The parameter of the hit. May be NULL_PTR.
+ * @return b8 TRUE if the ray crosses the plane at a parameter in [0, t_max], FALSE if it is parallel to it
+ */
+FR_API b8 fr_ray_intersect_plane(const ray* r, const plane* p, f32 t_max, f32* out_t);
+
+/**
+ * @brief Intersects a ray with both sides of a triangle using the Moller-Trumbore test.
+ *
+ * @param r The ray
+ * @param v0 The first vertex
+ * @param v1 The second vertex
+ * @param v2 The third vertex
+ * @param t_max The largest parameter of interest
+ * @param out_hit The hit, with an index of 0. May be NULL_PTR.
+ * @return b8 TRUE if the ray hits the triangle at a parameter in [0, t_max)
+ */
+FR_API b8 fr_ray_intersect_triangle(
+    const ray* r, const vec3* v0, const vec3* v1, const vec3* v2, f32 t_max, ray_hit* out_hit);
+
+/**
+ * @brief Finds the closest triangle of an array hit by a ray, testing both sides of the triangles.
+ * @details Of several triangles hit at the same parameter the one with the lowest index is reported.
+ *
+ * @param r The ray
+ * @param v0 The x, y and z arrays of the first vertices of the triangles
+ * @param v1 The x, y and z arrays of the second vertices of the triangles
+ * @param v2 The x, y and z arrays of the third vertices of the triangles
+ * @param count The number of triangles
+ * @param t_max The largest parameter of interest
+ * @param out_hit The closest hit, not written when there is none
+ * @return b8 TRUE if the ray hits a triangle at a parameter in [0, t_max)
+ */
+FR_API b8 fr_ray_intersect_triangles(const ray* r,
+                                     const f32* const v0[3],
+                                     const f32* const v1[3],
+                                     const f32* const v2[3],
+                                     u32 count,
+                                     f32 t_max,
+                                     ray_hit* out_hit);
+
+/**
+ * @brief Packs rays for fr_ray_packet_intersect_aabb.
+ *
+ * @param rays The rays
+ * @param count The number of rays, at most FR_RAY_PACKET_SIZE
+ * @param t_max The largest parameter of interest, shared by every ray. Lower it per ray in out->t_max as hits are
+ * found.
+ * @param out The packet
+ */
+FR_API void fr_ray_packet_create(const ray* rays, u32 count, f32 t_max, ray_packet* out);
+
+/**
+ * @brief Intersects every ray of a packet with a box using the slab test.
+ *
+ * @param packet The rays
+ * @param box The box
+ * @param out_t The parameters where the rays enter the box, 0 for rays starting inside. Only written for the rays that
+ * hit. May be NULL_PTR.
+ * @return u32 A mask with bit i set if ray i hits the box at a parameter in [0, packet->t_max[i]]
+ */
+FR_API u32 fr_ray_packet_intersect_aabb(const ray_packet* packet, const aabb* box, f32 out_t[FR_RAY_PACKET_SIZE]);
+
+//--------------------------------------------------------------------------------------------
+// Closest points
+//--------------------------------------------------------------------------------------------
+
+/**
+ * @brief Gets the point of a segment closest to a point.
+ *
+ * @param a The start of the segment
+ * @param b The end of the segment
+ * @param point The point
+ * @param out The closest point
+ * @return f32 The parameter of the closest point, 0 at a and 1 at b
+ */
+FR_API f32 fr_segment_closest_point(const vec3* a, const vec3* b, const vec3* point, vec3* out);
+
+/**
+ * @brief Gets the point of a triangle closest to a point.
+ *
+ * @param a The first vertex
+ * @param b The second vertex
+ * @param c The third vertex
+ * @param point The point
+ * @param out The closest point
+ */
+FR_API void fr_triangle_closest_point(const vec3* a, const vec3* b, const vec3* c, const vec3* point, vec3* out);
+
+/**
+ * @brief Makes the bounding box of a box transformed by a matrix.
+ *
+ * @param box The box
+ * @param transform The affine transform
+ * @param out The box containing the transformed box, must not be box
+ */
+FR_API void fr_aabb_transform(const aabb* box, const mat4* transform, aabb* out);
+
+//--------------------------------------------------------------------------------------------
+// Queries over arrays
+//--------------------------------------------------------------------------------------------
+
+/**
+ * @brief Lists the boxes of an array that overlap a box.
+ *
+ * @param box The query box
+ * @param min The x, y and z arrays of the minimum corners of the boxes
+ * @param max The x, y and z arrays of the maximum corners of the boxes
+ * @param count The number of boxes
+ * @param out_overlapping The indices of the overlapping boxes in increasing order. Must hold count indices.
+ * @return u32 The number of overlapping boxes
+ */
+FR_API u32 fr_aabb_overlap_query(
+    const aabb* box, const f32* const min[3], const f32* const max[3], u32 count, u32* out_overlapping);
+
+/**
+ * @brief Lists the spheres of an array that overlap a sphere.
+ *
+ * @param s The query sphere
+ * @param center The x, y and z arrays of the centers of the spheres
+ * @param radius The radii of the spheres
+ * @param count The number of spheres
+ * @param out_overlapping The indices of the overlapping spheres in increasing order. Must hold count indices.
+ * @return u32 The number of overlapping spheres
+ */
+FR_API u32 fr_sphere_overlap_query(
+    const sphere* s, const f32* const center[3], const f32* radius, u32 count, u32* out_overlapping);
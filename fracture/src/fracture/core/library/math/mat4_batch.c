@@ -0,0 +1,699 @@
+#include "mat4_batch.h"
+
+#include "mat4.h"
+#include "simd/avx.h"
+#include "simd/avx512.h"
+#include "simd/dispatch.h"
+
+#if FR_VEC3_SIMD == 1
+// The SIMD vec3 kernels load and store whole 16 byte vectors and zero the unused fourth component
+STATIC_ASSERT(sizeof(vec3) == 16, "vec3 must be padded to 16 bytes");
+#endif
+
+typedef void (*PFN_mat4_batch_soa3)(const f32 rows[3][4],
+                                    const f32* x,
+                                    const f32* y,
+                                    const f32* z,
+                                    f32* out_x,
+                                    f32* out_y,
+                                    f32* out_z,
+                                    u32 count);
+typedef void (*PFN_mat4_batch_soa4)(const mat4* m, const f32* const in[4], f32* const out[4], u32 count);
+typedef void (*PFN_mat4_batch_aos)(const f32 columns[4][4], b8 has_w, const f32* in, f32* out, u32 count);
+
+// One side of a batch of products: m[index[i]] when there is an index, otherwise m[i * stride]. A stride of 0
+// multiplies every matrix of the other side by the same matrix.
+typedef struct mat4_batch_operand {
+    const mat4* m;
+    u32 stride;
+    const u32* index;
+} mat4_batch_operand;
+
+typedef void (*PFN_mat4_batch_mul)(mat4_batch_operand a, mat4_batch_operand b, mat4* dst, u32 count);
+typedef void (*PFN_mat4_batch_inverse)(const mat4* m, mat4* dst, u32 count, b8 transpose);
+
+// The kernels of one simd_level
+typedef struct mat4_batch_kernels {
+    PFN_mat4_batch_soa3 soa3;
+    PFN_mat4_batch_soa4 soa4;
+    // Arrays of vec4, or of vec3 when has_w is FALSE. The columns of vec3 transforms have their fourth row cleared.
+    PFN_mat4_batch_aos aos;
+    PFN_mat4_batch_mul mul;
+    // Affine inverses, or their inverse transposes when transpose is TRUE
+    PFN_mat4_batch_inverse inverse;
+} mat4_batch_kernels;
+
+FR_FORCE_INLINE const f32* _operand_at(const mat4_batch_operand* operand, u32 i) {
+    return operand->index ? operand->m[operand->index[i]].data : operand->m[i * operand->stride].data;
+}
+
+// Rows of the upper 3x4 of the matrix with the translation scaled by w, so that points (w = 1) and directions
+// (w = 0) share the same kernels
+static void _mat4_batch_rows3(const mat4* m, f32 w, f32 rows[3][4]) {
+    for (u32 r = 0; r < 3; ++r) {
+        rows[r][0] = m->data[r];
+        rows[r][1] = m->data[4 + r];
+        rows[r][2] = m->data[8 + r];
+        rows[r][3] = m->data[12 + r] * w;
+    }
+}
+
+//--------------------------------------------------------------------------------------------
+// Scalar kernels, also used for the tails of the SSE kernels
+//--------------------------------------------------------------------------------------------
+
+static void _soa3_scalar(const f32 rows[3][4],
+                         const f32* x,
+                         const f32* y,
+                         const f32* z,
+                         f32* out_x,
+                         f32* out_y,
+                         f32* out_z,
+                         u32 count) {
+    for (u32 i = 0; i < count; ++i) {
+        f32 px = x[i];
+        f32 py = y[i];
+        f32 pz = z[i];
+        out_x[i] = rows[0][0] * px + rows[0][1] * py + rows[0][2] * pz + rows[0][3];
+        out_y[i] = rows[1][0] * px + rows[1][1] * py + rows[1][2] * pz + rows[1][3];
+        out_z[i] = rows[2][0] * px + rows[2][1] * py + rows[2][2] * pz + rows[2][3];
+    }
+}
+
+static void _soa4_scalar(const mat4* m, const f32* const in[4], f32* const out[4], u32 count) {
+    for (u32 i = 0; i < count; ++i) {
+        f32 v[4] = {in[0][i], in[1][i], in[2][i], in[3][i]};
+        for (u32 r = 0; r < 4; ++r) {
+            out[r][i] = m->data[r] * v[0] + m->data[4 + r] * v[1] + m->data[8 + r] * v[2] + m->data[12 + r] * v[3];
+        }
+    }
+}
+
+static void _aos_scalar(const f32 columns[4][4], b8 has_w, const f32* in, f32* out, u32 count) {
+    for (u32 i = 0; i < count; ++i) {
+        const f32* v = in + i * 4;
+        f32 px = v[0], py = v[1], pz = v[2], pw = has_w ? v[3] : 1.0f;
+        for (u32 r = 0; r < 4; ++r) {
+            out[i * 4 + r] = columns[0][r] * px + columns[1][r] * py + columns[2][r] * pz + columns[3][r] * pw;
+        }
+    }
+}
+
+static void _mul_scalar(mat4_batch_operand a, mat4_batch_operand b, mat4* dst, u32 count) {
+    for (u32 i = 0; i < count; ++i) {
+        const f32* am = _operand_at(&a, i);
+        const f32* bm = _operand_at(&b, i);
+        mat4 r;
+        for (u32 c = 0; c < 4; ++c) {
+            const f32* bc = bm + c * 4;
+            for (u32 row = 0; row < 4; ++row) {
+                const f32* ar = am + row;
+                r.data[c * 4 + row] = ar[0] * bc[0] + ar[4] * bc[1] + ar[8] * bc[2] + ar[12] * bc[3];
+            }
+        }
+        dst[i] = r;
+    }
+}
+
+// The rows of the inverse of the upper 3x3 are the cross products of its columns divided by the determinant, and the
+// translation of the inverse is the original translation moved back by them
+static void _inverse_scalar(const mat4* m, mat4* dst, u32 count, b8 transpose) {
+    for (u32 i = 0; i < count; ++i) {
+        const f32* c0 = m[i].data;
+        const f32* c1 = m[i].data + 4;
+        const f32* c2 = m[i].data + 8;
+        const f32* t = m[i].data + 12;
+        f32 r[3][3] = {
+            {c1[1] * c2[2] - c1[2] * c2[1], c1[2] * c2[0] - c1[0] * c2[2], c1[0] * c2[1] - c1[1] * c2[0]},
+            {c2[1] * c0[2] - c2[2] * c0[1], c2[2] * c0[0] - c2[0] * c0[2], c2[0] * c0[1] - c2[1] * c0[0]},
+            {c0[1] * c1[2] - c0[2] * c1[1], c0[2] * c1[0] - c0[0] * c1[2], c0[0] * c1[1] - c0[1] * c1[0]},
+        };
+        f32 inv_det = 1.0f / (c0[0] * r[0][0] + c0[1] * r[0][1] + c0[2] * r[0][2]);
+
+        mat4 out = {0};
+        for (u32 row = 0; row < 3; ++row) {
+            for (u32 col = 0; col < 3; ++col) {
+                r[row][col] *= inv_det;
+            }
+        }
+        for (u32 col = 0; col < 3; ++col) {
+            for (u32 row = 0; row < 3; ++row) {
+                out.data[col * 4 + row] = transpose ? r[col][row] : r[row][col];
+            }
+        }
+        if (!transpose) {
+            for (u32 row = 0; row < 3; ++row) {
+                out.data[12 + row] = -(r[row][0] * t[0] + r[row][1] * t[1] + r[row][2] * t[2]);
+            }
+        }
+        out.data[15] = 1.0f;
+        dst[i] = out;
+    }
+}
+
+#if FR_VEC3_SIMD == 0
+// vec3 without SIMD is 12 bytes and cannot go through the 4 float stride kernels
+static void _aos3_scalar(const f32 rows[3][4], const vec3* in, vec3* out, u32 count) {
+    for (u32 i = 0; i < count; ++i) {
+        f32 px = in[i].x, py = in[i].y, pz = in[i].z;
+        out[i].x = rows[0][0] * px + rows[0][1] * py + rows[0][2] * pz + rows[0][3];
+        out[i].y = rows[1][0] * px + rows[1][1] * py + rows[1][2] * pz + rows[1][3];
+        out[i].z = rows[2][0] * px + rows[2][1] * py + rows[2][2] * pz + rows[2][3];
+    }
+}
+#endif
+
+#if FR_SIMD == 1
+//--------------------------------------------------------------------------------------------
+// SSE2 kernels, 4 vectors per iteration for structures of arrays and 1 for arrays of structures
+//--------------------------------------------------------------------------------------------
+
+static void _soa3_sse(const f32 rows[3][4],
+                      const f32* x,
+                      const f32* y,
+                      const f32* z,
+                      f32* out_x,
+                      f32* out_y,
+                      f32* out_z,
+                      u32 count) {
+    __m128 r[3][4];
+    for (u32 row = 0; row < 3; ++row) {
+        for (u32 col = 0; col < 4; ++col) {
+            r[row][col] = _mm_set1_ps(rows[row][col]);
+        }
+    }
+
+    f32* out[3] = {out_x, out_y, out_z};
+    u32 i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 px = _mm_loadu_ps(x + i);
+        __m128 py = _mm_loadu_ps(y + i);
+        __m128 pz = _mm_loadu_ps(z + i);
+        for (u32 row = 0; row < 3; ++row) {
+            __m128 v = fr_simd_fmadd(r[row][2], pz, r[row][3]);
+            v = fr_simd_fmadd(r[row][1], py, v);
+            _mm_storeu_ps(out[row] + i, fr_simd_fmadd(r[row][0], px, v));
+        }
+    }
+    _soa3_scalar(rows, x + i, y + i, z + i, out_x + i, out_y + i, out_z + i, count - i);
+}
+
+static void _soa4_sse(const mat4* m, const f32* const in[4], f32* const out[4], u32 count) {
+    __m128 r[4][4];
+    for (u32 row = 0; row < 4; ++row) {
+        for (u32 col = 0; col < 4; ++col) {
+            r[row][col] = _mm_set1_ps(m->data[col * 4 + row]);
+        }
+    }
+
+    u32 i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 p[4];
+        for (u32 col = 0; col < 4; ++col) {
+            p[col] = _mm_loadu_ps(in[col] + i);
+        }
+        for (u32 row = 0; row < 4; ++row) {
+            __m128 v = _mm_mul_ps(r[row][3], p[3]);
+            v = fr_simd_fmadd(r[row][2], p[2], v);
+            v = fr_simd_fmadd(r[row][1], p[1], v);
+            _mm_storeu_ps(out[row] + i, fr_simd_fmadd(r[row][0], p[0], v));
+        }
+    }
+    const f32* const in_tail[4] = {in[0] + i, in[1] + i, in[2] + i, in[3] + i};
+    f32* const out_tail[4] = {out[0] + i, out[1] + i, out[2] + i, out[3] + i};
+    _soa4_scalar(m, in_tail, out_tail, count - i);
+}
+
+static void _aos_sse(const f32 columns[4][4], b8 has_w, const f32* in, f32* out, u32 count) {
+    __m128 c0 = _mm_loadu_ps(columns[0]);
+    __m128 c1 = _mm_loadu_ps(columns[1]);
+    __m128 c2 = _mm_loadu_ps(columns[2]);
+    __m128 c3 = _mm_loadu_ps(columns[3]);
+    for (u32 i = 0; i < count; ++i) {
+        __m128 v = _mm_loadu_ps(in + i * 4);
+        __m128 r = has_w ? _mm_mul_ps(c3, FR_SIMD_SPLAT_W(v)) : c3;
+        r = fr_simd_fmadd(c2, FR_SIMD_SPLAT_Z(v), r);
+        r = fr_simd_fmadd(c1, FR_SIMD_SPLAT_Y(v), r);
+        _mm_storeu_ps(out + i * 4, fr_simd_fmadd(c0, FR_SIMD_SPLAT_X(v), r));
+    }
+}
+
+static void _mul_sse(mat4_batch_operand a, mat4_batch_operand b, mat4* dst, u32 count) {
+    for (u32 i = 0; i < count; ++i) {
+        fr_mat4_mul((const mat4*)_operand_at(&a, i), (const mat4*)_operand_at(&b, i), &dst[i]);
+    }
+}
+
+// Inverts 4 affine matrices at once in a transposed layout: after _MM_TRANSPOSE4_PS every register holds the same
+// element of the 4 matrices, so the cross products and determinants are plain lane wise arithmetic with no shuffles.
+// All 4 matrices are loaded before any is stored so that dst may be m.
+static void _inverse4_sse(const mat4* m, mat4* dst, b8 transpose) {
+    // c[column][component]
+    __m128 c[4][4];
+    for (u32 col = 0; col < 4; ++col) {
+        for (u32 k = 0; k < 4; ++k) {
+            c[col][k] = _mm_loadu_ps(m[k].data + col * 4);
+        }
+        _MM_TRANSPOSE4_PS(c[col][0], c[col][1], c[col][2], c[col][3]);
+    }
+
+    // r[row of the inverse][column]
+    __m128 r[3][3];
+    for (u32 row = 0; row < 3; ++row) {
+        const __m128* a = c[(row + 1) % 3];
+        const __m128* b = c[(row + 2) % 3];
+        r[row][0] = fr_simd_fnmadd(a[2], b[1], _mm_mul_ps(a[1], b[2]));
+        r[row][1] = fr_simd_fnmadd(a[0], b[2], _mm_mul_ps(a[2], b[0]));
+        r[row][2] = fr_simd_fnmadd(a[1], b[0], _mm_mul_ps(a[0], b[1]));
+    }
+    __m128 det = _mm_mul_ps(c[0][0], r[0][0]);
+    det = fr_simd_fmadd(c[0][1], r[0][1], det);
+    det = fr_simd_fmadd(c[0][2], r[0][2], det);
+    __m128 inv_det = _mm_div_ps(_mm_set1_ps(1.0f), det);
+    for (u32 row = 0; row < 3; ++row) {
+        for (u32 col = 0; col < 3; ++col) {
+            r[row][col] = _mm_mul_ps(r[row][col], inv_det);
+        }
+    }
+
+    __m128 out[4][4];
+    for (u32 col = 0; col < 3; ++col) {
+        for (u32 row = 0; row < 3; ++row) {
+            out[col][row] = transpose ? r[col][row] : r[row][col];
+        }
+        out[col][3] = _mm_setzero_ps();
+    }
+    for (u32 row = 0; row < 3; ++row) {
+        __m128 moved = _mm_mul_ps(r[row][0], c[3][0]);
+        moved = fr_simd_fmadd(r[row][1], c[3][1], moved);
+        moved = fr_simd_fmadd(r[row][2], c[3][2], moved);
+        out[3][row] = transpose ? _mm_setzero_ps() : _mm_sub_ps(_mm_setzero_ps(), moved);
+    }
+    out[3][3] = _mm_set1_ps(1.0f);
+
+    for (u32 col = 0; col < 4; ++col) {
+        _MM_TRANSPOSE4_PS(out[col][0], out[col][1], out[col][2], out[col][3]);
+        for (u32 k = 0; k < 4; ++k) {
+            _mm_storeu_ps(dst[k].data + col * 4, out[col][k]);
+        }
+    }
+}
+
+static void _inverse_sse(const mat4* m, mat4* dst, u32 count, b8 transpose) {
+    u32 i = 0;
+    for (; i + 4 <= count; i += 4) {
+        _inverse4_sse(m + i, dst + i, transpose);
+    }
+    _inverse_scalar(m + i, dst + i, count - i, transpose);
+}
+
+//--------------------------------------------------------------------------------------------
+// AVX2 kernels, 8 vectors per iteration for structures of arrays and 2 for arrays of structures. The tails are
+// handled with masked loads and stores, which never touch the memory of the lanes that are masked off.
+//--------------------------------------------------------------------------------------------
+
+static FR_TARGET_AVX2_FMA void _soa3_avx2(const f32 rows[3][4],
+                                          const f32* x,
+                                          const f32* y,
+                                          const f32* z,
+                                          f32* out_x,
+                                          f32* out_y,
+                                          f32* out_z,
+                                          u32 count) {
+    __m256 r[3][4];
+    for (u32 row = 0; row < 3; ++row) {
+        for (u32 col = 0; col < 4; ++col) {
+            r[row][col] = _mm256_set1_ps(rows[row][col]);
+        }
+    }
+
+    f32* out[3] = {out_x, out_y, out_z};
+    u32 i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 px = _mm256_loadu_ps(x + i);
+        __m256 py = _mm256_loadu_ps(y + i);
+        __m256 pz = _mm256_loadu_ps(z + i);
+        for (u32 row = 0; row < 3; ++row) {
+            __m256 v = fr_simd256_fmadd(r[row][2], pz, r[row][3]);
+            v = fr_simd256_fmadd(r[row][1], py, v);
+            _mm256_storeu_ps(out[row] + i, fr_simd256_fmadd(r[row][0], px, v));
+        }
+    }
+
+    if (i < count) {
+        __m256i mask = fr_simd256_tail_mask(count - i);
+        __m256 px = _mm256_maskload_ps(x + i, mask);
+        __m256 py = _mm256_maskload_ps(y + i, mask);
+        __m256 pz = _mm256_maskload_ps(z + i, mask);
+        for (u32 row = 0; row < 3; ++row) {
+            __m256 v = fr_simd256_fmadd(r[row][2], pz, r[row][3]);
+            v = fr_simd256_fmadd(r[row][1], py, v);
+            _mm256_maskstore_ps(out[row] + i, mask, fr_simd256_fmadd(r[row][0], px, v));
+        }
+    }
+}
+
+static FR_TARGET_AVX2_FMA void _soa4_avx2(const mat4* m, const f32* const in[4], f32* const out[4], u32 count) {
+    __m256 r[4][4];
+    for (u32 row = 0; row < 4; ++row) {
+        for (u32 col = 0; col < 4; ++col) {
+            r[row][col] = _mm256_set1_ps(m->data[col * 4 + row]);
+        }
+    }
+
+    for (u32 i = 0; i < count; i += 8) {
+        __m256i mask = fr_simd256_tail_mask(count - i);
+        b8 full = count - i >= 8;
+        __m256 p[4];
+        for (u32 col = 0; col < 4; ++col) {
+            p[col] = full ? _mm256_loadu_ps(in[col] + i) : _mm256_maskload_ps(in[col] + i, mask);
+        }
+        for (u32 row = 0; row < 4; ++row) {
+            __m256 v = _mm256_mul_ps(r[row][3], p[3]);
+            v = fr_simd256_fmadd(r[row][2], p[2], v);
+            v = fr_simd256_fmadd(r[row][1], p[1], v);
+            v = fr_simd256_fmadd(r[row][0], p[0], v);
+            if (full) {
+                _mm256_storeu_ps(out[row] + i, v);
+            } else {
+                _mm256_maskstore_ps(out[row] + i, mask, v);
+            }
+        }
+    }
+}
+
+// Both 128 bit lanes hold the same column and each lane transforms its own vector
+static FR_TARGET_AVX2_FMA void _aos_avx2(const f32 columns[4][4], b8 has_w, const f32* in, f32* out, u32 count) {
+    __m256 c0 = fr_simd256_broadcast4(columns[0]);
+    __m256 c1 = fr_simd256_broadcast4(columns[1]);
+    __m256 c2 = fr_simd256_broadcast4(columns[2]);
+    __m256 c3 = fr_simd256_broadcast4(columns[3]);
+    __m256i half = fr_simd256_tail_mask(4);
+
+    for (u32 i = 0; i < count; i += 2) {
+        b8 full = count - i >= 2;
+        __m256 v = full ? _mm256_loadu_ps(in + i * 4) : _mm256_maskload_ps(in + i * 4, half);
+        __m256 r = has_w ? _mm256_mul_ps(c3, FR_SIMD256_SPLAT(v, 3)) : c3;
+        r = fr_simd256_fmadd(c2, FR_SIMD256_SPLAT(v, 2), r);
+        r = fr_simd256_fmadd(c1, FR_SIMD256_SPLAT(v, 1), r);
+        r = fr_simd256_fmadd(c0, FR_SIMD256_SPLAT(v, 0), r);
+        if (full) {
+            _mm256_storeu_ps(out + i * 4, r);
+        } else {
+            _mm256_maskstore_ps(out + i * 4, half, r);
+        }
+    }
+}
+
+// Each column of the product is a times the matching column of b, two columns per register
+static FR_TARGET_AVX2_FMA void _mul_avx2(mat4_batch_operand a, mat4_batch_operand b, mat4* dst, u32 count) {
+    for (u32 i = 0; i < count; ++i) {
+        const f32* am = _operand_at(&a, i);
+        const f32* bm = _operand_at(&b, i);
+        __m256 c0 = fr_simd256_broadcast4(am);
+        __m256 c1 = fr_simd256_broadcast4(am + 4);
+        __m256 c2 = fr_simd256_broadcast4(am + 8);
+        __m256 c3 = fr_simd256_broadcast4(am + 12);
+        __m256 b01 = _mm256_loadu_ps(bm);
+        __m256 b23 = _mm256_loadu_ps(bm + 8);
+        _mm256_storeu_ps(dst[i].data, fr_simd256_mat4_mulv(c0, c1, c2, c3, b01));
+        _mm256_storeu_ps(dst[i].data + 8, fr_simd256_mat4_mulv(c0, c1, c2, c3, b23));
+    }
+}
+
+// _inverse4_sse on 8 matrices, k in the low lanes and k + 4 in the high lanes
+static FR_TARGET_AVX2_FMA void _inverse8_avx2(const mat4* m, mat4* dst, b8 transpose) {
+    __m256 c[4][4];
+    for (u32 col = 0; col < 4; ++col) {
+        for (u32 k = 0; k < 4; ++k) {
+            __m256 low = _mm256_castps128_ps256(_mm_loadu_ps(m[k].data + col * 4));
+            c[col][k] = _mm256_insertf128_ps(low, _mm_loadu_ps(m[k + 4].data + col * 4), 1);
+        }
+        fr_simd256_transpose4(&c[col][0], &c[col][1], &c[col][2], &c[col][3]);
+    }
+
+    __m256 r[3][3];
+    for (u32 row = 0; row < 3; ++row) {
+        const __m256* a = c[(row + 1) % 3];
+        const __m256* b = c[(row + 2) % 3];
+        r[row][0] = fr_simd256_fnmadd(a[2], b[1], _mm256_mul_ps(a[1], b[2]));
+        r[row][1] = fr_simd256_fnmadd(a[0], b[2], _mm256_mul_ps(a[2], b[0]));
+        r[row][2] = fr_simd256_fnmadd(a[1], b[0], _mm256_mul_ps(a[0], b[1]));
+    }
+    __m256 det = _mm256_mul_ps(c[0][0], r[0][0]);
+    det = fr_simd256_fmadd(c[0][1], r[0][1], det);
+    det = fr_simd256_fmadd(c[0][2], r[0][2], det);
+    __m256 inv_det = _mm256_div_ps(_mm256_set1_ps(1.0f), det);
+    for (u32 row = 0; row < 3; ++row) {
+        for (u32 col = 0; col < 3; ++col) {
+            r[row][col] = _mm256_mul_ps(r[row][col], inv_det);
+        }
+    }
+
+    __m256 out[4][4];
+    for (u32 col = 0; col < 3; ++col) {
+        for (u32 row = 0; row < 3; ++row) {
+            out[col][row] = transpose ? r[col][row] : r[row][col];
+        }
+        out[col][3] = _mm256_setzero_ps();
+    }
+    for (u32 row = 0; row < 3; ++row) {
+        __m256 moved = _mm256_mul_ps(r[row][0], c[3][0]);
+        moved = fr_simd256_fmadd(r[row][1], c[3][1], moved);
+        moved = fr_simd256_fmadd(r[row][2], c[3][2], moved);
+        out[3][row] = transpose ? _mm256_setzero_ps() : _mm256_sub_ps(_mm256_setzero_ps(), moved);
+    }
+    out[3][3] = _mm256_set1_ps(1.0f);
+
+    for (u32 col = 0; col < 4; ++col) {
+        fr_simd256_transpose4(&out[col][0], &out[col][1], &out[col][2], &out[col][3]);
+        for (u32 k = 0; k < 4; ++k) {
+            _mm_storeu_ps(dst[k].data + col * 4, _mm256_castps256_ps128(out[col][k]));
+            _mm_storeu_ps(dst[k + 4].data + col * 4, _mm256_extractf128_ps(out[col][k], 1));
+        }
+    }
+}
+
+// Gathering 16 matrices into the lanes of 512 bit registers costs more shuffles than the wider arithmetic saves, so the
+// AVX-512 level uses this kernel as well
+static FR_TARGET_AVX2_FMA void _inverse_avx2(const mat4* m, mat4* dst, u32 count, b8 transpose) {
+    u32 i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _inverse8_avx2(m + i, dst + i, transpose);
+    }
+    _inverse_sse(m + i, dst + i, count - i, transpose);
+}
+
+//--------------------------------------------------------------------------------------------
+// AVX-512 kernels, 16 vectors per iteration for structures of arrays and 4 for arrays of structures, with masked
+// tails
+//--------------------------------------------------------------------------------------------
+
+static FR_TARGET_AVX512 void _soa3_avx512(const f32 rows[3][4],
+                                          const f32* x,
+                                          const f32* y,
+                                          const f32* z,
+                                          f32* out_x,
+                                          f32* out_y,
+                                          f32* out_z,
+                                          u32 count) {
+    __m512 r[3][4];
+    for (u32 row = 0; row < 3; ++row) {
+        for (u32 col = 0; col < 4; ++col) {
+            r[row][col] = _mm512_set1_ps(rows[row][col]);
+        }
+    }
+
+    f32* out[3] = {out_x, out_y, out_z};
+    for (u32 i = 0; i < count; i += 16) {
+        __mmask16 mask = fr_simd512_tail_mask(count - i);
+        __m512 px = _mm512_maskz_loadu_ps(mask, x + i);
+        __m512 py = _mm512_maskz_loadu_ps(mask, y + i);
+        __m512 pz = _mm512_maskz_loadu_ps(mask, z + i);
+        for (u32 row = 0; row < 3; ++row) {
+            __m512 v = fr_simd512_fmadd(r[row][2], pz, r[row][3]);
+            v = fr_simd512_fmadd(r[row][1], py, v);
+            _mm512_mask_storeu_ps(out[row] + i, mask, fr_simd512_fmadd(r[row][0], px, v));
+        }
+    }
+}
+
+static FR_TARGET_AVX512 void _soa4_avx512(const mat4* m, const f32* const in[4], f32* const out[4], u32 count) {
+    __m512 r[4][4];
+    for (u32 row = 0; row < 4; ++row) {
+        for (u32 col = 0; col < 4; ++col) {
+            r[row][col] = _mm512_set1_ps(m->data[col * 4 + row]);
+        }
+    }
+
+    for (u32 i = 0; i < count; i += 16) {
+        __mmask16 mask = fr_simd512_tail_mask(count - i);
+        __m512 p[4];
+        for (u32 col = 0; col < 4; ++col) {
+            p[col] = _mm512_maskz_loadu_ps(mask, in[col] + i);
+        }
+        for (u32 row = 0; row < 4; ++row) {
+            __m512 v = _mm512_mul_ps(r[row][3], p[3]);
+            v = fr_simd512_fmadd(r[row][2], p[2], v);
+            v = fr_simd512_fmadd(r[row][1], p[1], v);
+            _mm512_mask_storeu_ps(out[row] + i, mask, fr_simd512_fmadd(r[row][0], p[0], v));
+        }
+    }
+}
+
+static FR_TARGET_AVX512 void _aos_avx512(const f32 columns[4][4], b8 has_w, const f32* in, f32* out, u32 count) {
+    __m512 c0 = fr_simd512_broadcast4(columns[0]);
+    __m512 c1 = fr_simd512_broadcast4(columns[1]);
+    __m512 c2 = fr_simd512_broadcast4(columns[2]);
+    __m512 c3 = fr_simd512_broadcast4(columns[3]);
+
+    for (u32 i = 0; i < count; i += 4) {
+        __mmask16 mask = fr_simd512_tail_mask((count - i) * 4);
+        __m512 v = _mm512_maskz_loadu_ps(mask, in + i * 4);
+        __m512 r = has_w ? _mm512_mul_ps(c3, FR_SIMD512_SPLAT(v, 3)) : c3;
+        r = fr_simd512_fmadd(c2, FR_SIMD512_SPLAT(v, 2), r);
+        r = fr_simd512_fmadd(c1, FR_SIMD512_SPLAT(v, 1), r);
+        _mm512_mask_storeu_ps(out + i * 4, mask, fr_simd512_fmadd(c0, FR_SIMD512_SPLAT(v, 0), r));
+    }
+}
+
+// The whole of b fits in one register, one column per 128 bit lane
+static FR_TARGET_AVX512 void _mul_avx512(mat4_batch_operand a, mat4_batch_operand b, mat4* dst, u32 count) {
+    for (u32 i = 0; i < count; ++i) {
+        const f32* am = _operand_at(&a, i);
+        __m512 c0 = fr_simd512_broadcast4(am);
+        __m512 c1 = fr_simd512_broadcast4(am + 4);
+        __m512 c2 = fr_simd512_broadcast4(am + 8);
+        __m512 c3 = fr_simd512_broadcast4(am + 12);
+        __m512 columns = _mm512_loadu_ps(_operand_at(&b, i));
+        _mm512_storeu_ps(dst[i].data, fr_simd512_mat4_mulv(c0, c1, c2, c3, columns));
+    }
+}
+#endif
+
+//--------------------------------------------------------------------------------------------
+// Dispatch
+//--------------------------------------------------------------------------------------------
+
+static const mat4_batch_kernels batch_kernels[FR_SIMD_LEVEL_MAX] = {
+    [FR_SIMD_LEVEL_SCALAR] = {_soa3_scalar, _soa4_scalar, _aos_scalar, _mul_scalar, _inverse_scalar},
+#if FR_SIMD == 1
+    [FR_SIMD_LEVEL_SSE2] = {_soa3_sse, _soa4_sse, _aos_sse, _mul_sse, _inverse_sse},
+    [FR_SIMD_LEVEL_AVX2] = {_soa3_avx2, _soa4_avx2, _aos_avx2, _mul_avx2, _inverse_avx2},
+    [FR_SIMD_LEVEL_AVX512] = {_soa3_avx512, _soa4_avx512, _aos_avx512, _mul_avx512, _inverse_avx2},
+#endif
+};
+
+static const mat4_batch_kernels* _mat4_batch_kernels() { return &batch_kernels[fr_simd_get_level()]; }
+
+static void _mat4_batch_aos3(const mat4* m, f32 w, const vec3* v, vec3* dst, u32 count) {
+#if FR_VEC3_SIMD == 1
+    // The fourth row is cleared so that the padding of the results is zero
+    f32 columns[4][4];
+    for (u32 c = 0; c < 4; ++c) {
+        f32 scale = c == 3 ? w : 1.0f;
+        columns[c][0] = m->data[c * 4 + 0] * scale;
+        columns[c][1] = m->data[c * 4 + 1] * scale;
+        columns[c][2] = m->data[c * 4 + 2] * scale;
+        columns[c][3] = 0.0f;
+    }
+    _mat4_batch_kernels()->aos(columns, FALSE, v->data, dst->data, count);
+#else
+    f32 rows[3][4];
+    _mat4_batch_rows3(m, w, rows);
+    _aos3_scalar(rows, v, dst, count);
+#endif
+}
+
+void fr_mat4_transform_points_soa(const mat4* m,
+                                  const f32* x,
+                                  const f32* y,
+                                  const f32* z,
+                                  f32* out_x,
+                                  f32* out_y,
+                                  f32* out_z,
+                                  u32 count) {
+    f32 rows[3][4];
+    _mat4_batch_rows3(m, 1.0f, rows);
+    _mat4_batch_kernels()->soa3(rows, x, y, z, out_x, out_y, out_z, count);
+}
+
+void fr_mat4_transform_directions_soa(const mat4* m,
+                                      const f32* x,
+                                      const f32* y,
+                                      const f32* z,
+                                      f32* out_x,
+                                      f32* out_y,
+                                      f32* out_z,
+                                      u32 count) {
+    f32 rows[3][4];
+    _mat4_batch_rows3(m, 0.0f, rows);
+    _mat4_batch_kernels()->soa3(rows, x, y, z, out_x, out_y, out_z, count);
+}
+
+void fr_mat4_transform_vec4_soa(const mat4* m, const f32* const in[4], f32* const out[4], u32 count) {
+    _mat4_batch_kernels()->soa4(m, in, out, count);
+}
+
+void fr_mat4_transform_vec4_array(const mat4* m, const vec4* v, vec4* dst, u32 count) {
+    _mat4_batch_kernels()->aos((const f32(*)[4])m->data, TRUE, v->data, dst->data, count);
+}
+
+void fr_mat4_transform_points(const mat4* m, const vec3* v, vec3* dst, u32 count) {
+    _mat4_batch_aos3(m, 1.0f, v, dst, count);
+}
+
+void fr_mat4_transform_directions(const mat4* m, const vec3* v, vec3* dst, u32 count) {
+    _mat4_batch_aos3(m, 0.0f, v, dst, count);
+}
+
+void fr_mat4_mul_array(const mat4* a, const mat4* b, mat4* dst, u32 count) {
+    mat4_batch_operand left = {a, 1, NULL_PTR};
+    mat4_batch_operand right = {b, 1, NULL_PTR};
+    _mat4_batch_kernels()->mul(left, right, dst, count);
+}
+
+void fr_mat4_premul_array(const mat4* m, const mat4* b, mat4* dst, u32 count) {
+    mat4_batch_operand left = {m, 0, NULL_PTR};
+    mat4_batch_operand right = {b, 1, NULL_PTR};
+    _mat4_batch_kernels()->mul(left, right, dst, count);
+}
+
+void fr_mat4_postmul_array(const mat4* a, const mat4* m, mat4* dst, u32 count) {
+    mat4_batch_operand left = {a, 1, NULL_PTR};
+    mat4_batch_operand right = {m, 0, NULL_PTR};
+    _mat4_batch_kernels()->mul(left, right, dst, count);
+}
+
+void fr_mat4_inv_affine_array(const mat4* m, mat4* dst, u32 count) {
+    _mat4_batch_kernels()->inverse(m, dst, count, FALSE);
+}
+
+void fr_mat4_inv_transpose_affine_array(const mat4* m, mat4* dst, u32 count) {
+    _mat4_batch_kernels()->inverse(m, dst, count, TRUE);
+}
+
+void fr_mat4_flatten_hierarchy(const mat4* local, const u32* parents, mat4* world, u32 count) {
+    const mat4_batch_kernels* kernels = _mat4_batch_kernels();
+    u32 start = 0;
+    while (start < count) {
+        if (parents[start] == FR_MAT4_NO_PARENT) {
+            world[start] = local[start];
+            start++;
+            continue;
+        }
+
+        // The longest run of nodes whose parents are all finished goes through the kernel in one call. With the nodes
+        // in breadth first order that is every non root node of a depth.
+        u32 end = start + 1;
+        while (end < count && parents[end] != FR_MAT4_NO_PARENT && parents[end] < start) {
+            end++;
+        }
+        FR_ASSERT(parents[start] < start);
+
+        mat4_batch_operand left = {world, 0, parents + start};
+        mat4_batch_operand right = {local + start, 1, NULL_PTR};
+        kernels->mul(left, right, world + start, end - start);
+        start = end;
+    }
+}
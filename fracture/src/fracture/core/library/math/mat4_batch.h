@@ -0,0 +1,179 @@
+/**
+ * @file mat4_batch.h
+ * @author Aditya Rajagopal
+ * @brief Transforms of arrays of vectors by a single matrix.
+ * @details fr_mat4_mulv and friends transform one vector at a time through a single 128 bit register. Skinning,
+ * particles and bounding volumes transform thousands of vectors by the same matrix, which these kernels do several at
+ * a time with the instruction set chosen by fr_simd_get_level: SSE2 everywhere, AVX2 with FMA and AVX-512 on the
+ * processors that have them.
+ *
+ * Two layouts are supported. Structure of arrays (the _soa functions) takes one array per component and handles 4, 8
+ * or 16 vectors per instruction with no shuffling at all, so it is the layout to prefer for data that is only ever
+ * processed in bulk. Array of structures takes the engine's vec3 and vec4 and processes 1, 2 or 4 vectors per
+ * register. Counts need not be multiples of the vector width and the float arrays need no particular alignment.
+ *
+ * Points are transformed with w = 1 and directions with w = 0. Both assume an affine matrix and ignore its bottom
+ * row, use the vec4 functions for projections. The output may be the same array as the input but must not partially
+ * overlap it.
+ * @version 0.0.1
+ * @date 2024-04-26
+ *
+ * @copyright Fracture Game Engine is Copyright (c) Aditya Rajagopal 2024-2024
+ *
+ */
+#pragma once
+
+#include "detail/matrix.h"
+#include "fracture/core/defines.h"
+
+/** @brief Parent index of the roots of a hierarchy passed to fr_mat4_flatten_hierarchy */
+#define FR_MAT4_NO_PARENT 0xFFFFFFFFu
+
+/**
+ * @brief Transforms points stored as separate x, y and z arrays.
+ *
+ * @param m The affine transform
+ * @param x The x components of the points
+ * @param y The y components of the points
+ * @param z The z components of the points
+ * @param out_x The x components of the transformed points
+ * @param out_y The y components of the transformed points
+ * @param out_z The z components of the transformed points
+ * @param count The number of points
+ */
+FR_API void fr_mat4_transform_points_soa(const mat4* m,
+                                         const f32* x,
+                                         const f32* y,
+                                         const f32* z,
+                                         f32* out_x,
+                                         f32* out_y,
+                                         f32* out_z,
+                                         u32 count);
+
+/**
+ * @brief Transforms directions stored as separate x, y and z arrays. The translation of the matrix is ignored.
+ *
+ * @param m The affine transform
+ * @param x The x components of the directions
+ * @param y The y components of the directions
+ * @param z The z components of the directions
+ * @param out_x The x components of the transformed directions
+ * @param out_y The y components of the transformed directions
+ * @param out_z The z components of the transformed directions
+ * @param count The number of directions
+ */
+FR_API void fr_mat4_transform_directions_soa(const mat4* m,
+                                             const f32* x,
+                                             const f32* y,
+                                             const f32* z,
+                                             f32* out_x,
+                                             f32* out_y,
+                                             f32* out_z,
+                                             u32 count);
+
+/**
+ * @brief Multiplies vectors stored as separate x, y, z and w arrays by a matrix.
+ *
+ * @param m The matrix
+ * @param in The x, y, z and w arrays of the vectors
+ * @param out The x, y, z and w arrays of the results
+ * @param count The number of vectors
+ */
+FR_API void fr_mat4_transform_vec4_soa(const mat4* m, const f32* const in[4], f32* const out[4], u32 count);
+
+/**
+ * @brief Multiplies an array of vec4 by a matrix.
+ *
+ * @param m The matrix
+ * @param v The vectors
+ * @param dst The results
+ * @param count The number of vectors
+ */
+FR_API void fr_mat4_transform_vec4_array(const mat4* m, const vec4* v, vec4* dst, u32 count);
+
+/**
+ * @brief Transforms an array of points.
+ *
+ * @param m The affine transform
+ * @param v The points
+ * @param dst The transformed points
+ * @param count The number of points
+ */
+FR_API void fr_mat4_transform_points(const mat4* m, const vec3* v, vec3* dst, u32 count);
+
+/**
+ * @brief Transforms an array of directions. The translation of the matrix is ignored.
+ *
+ * @param m The affine transform
+ * @param v The directions
+ * @param dst The transformed directions
+ * @param count The number of directions
+ */
+FR_API void fr_mat4_transform_directions(const mat4* m, const vec3* v, vec3* dst, u32 count);
+
+/**
+ * @brief Multiplies two arrays of matrices pair by pair, dst[i] = a[i] * b[i].
+ * @details AVX2 computes two columns of a product per instruction and AVX-512 all four. dst may be a or b.
+ *
+ * @param a The matrices on the left
+ * @param b The matrices on the right
+ * @param dst The products
+ * @param count The number of matrices in each array
+ */
+FR_API void fr_mat4_mul_array(const mat4* a, const mat4* b, mat4* dst, u32 count);
+
+/**
+ * @brief Multiplies one matrix by an array of matrices, dst[i] = m * b[i], e.g. a world transform by local ones.
+ *
+ * @param m The matrix on the left
+ * @param b The matrices on the right
+ * @param dst The products. May be b but not m.
+ * @param count The number of matrices in b
+ */
+FR_API void fr_mat4_premul_array(const mat4* m, const mat4* b, mat4* dst, u32 count);
+
+/**
+ * @brief Multiplies an array of matrices by one matrix, dst[i] = a[i] * m.
+ *
+ * @param a The matrices on the left
+ * @param m The matrix on the right
+ * @param dst The products. May be a but not m.
+ * @param count The number of matrices in a
+ */
+FR_API void fr_mat4_postmul_array(const mat4* a, const mat4* m, mat4* dst, u32 count);
+
+/**
+ * @brief Inverts an array of affine matrices.
+ * @details Much cheaper than fr_mat4_inv since only the upper 3x3 is inverted, by the cross products of its columns.
+ * The SIMD kernels transpose 4 (SSE) or 8 (AVX2 and AVX-512) matrices so that each register holds one element of all
+ * of them and invert them together. The bottom row is assumed to be 0, 0, 0, 1 and the upper 3x3 to be invertible.
+ *
+ * @param m The matrices
+ * @param dst The inverses, may be m
+ * @param count The number of matrices
+ */
+FR_API void fr_mat4_inv_affine_array(const mat4* m, mat4* dst, u32 count);
+
+/**
+ * @brief Computes the inverse transposes of the upper 3x3 of an array of affine matrices, the matrices that transform
+ * normals. The translation of the results is zero.
+ *
+ * @param m The matrices
+ * @param dst The inverse transposes, may be m
+ * @param count The number of matrices
+ */
+FR_API void fr_mat4_inv_transpose_affine_array(const mat4* m, mat4* dst, u32 count);
+
+/**
+ * @brief Computes the world matrices of a hierarchy from the local ones, world[i] = world[parents[i]] * local[i].
+ * @details Every parent must come before its children, parents[i] < i, and roots have FR_MAT4_NO_PARENT and take
+ * their local matrix as is. Consecutive nodes whose parents are already computed are multiplied in one batch, so
+ * storing the nodes breadth first lets every depth of the hierarchy go through the SIMD kernels at once. Any other
+ * order with parents first gives the same result more slowly.
+ *
+ * @param local The local matrices
+ * @param parents The index of the parent of every node
+ * @param world The world matrices, must not overlap local
+ * @param count The number of nodes
+ */
+FR_API void fr_mat4_flatten_hierarchy(const mat4* local, const u32* parents, mat4* world, u32 count);
@@ -73,3 +73,6 @@
 #define FLOAT_EPSILON 1E-06f  // 1.19209290E-07f
 #define DOUBLE_EPSILON 2.2204460492503131E-16F
 #define LONG_DOUBLE_EPSILON 1.08420217248550443401E-19Lf
+
+// Largest finite float, the bounds of empty boxes and the parameters of rays that hit nothing.
+#define FLOAT_MAX 3.40282346638528859812E+38f
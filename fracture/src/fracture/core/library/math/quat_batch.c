@@ -0,0 +1,539 @@
+#include "quat_batch.h"
+
+#include "simd/avx.h"
+#include "simd/avx512.h"
+#include "simd/avx_math.h"
+#include "simd/dispatch.h"
+#include "simd/sse_math.h"
+#include "utils.h"
+
+// The matrix kernels write 12 or 16 floats per quaternion
+STATIC_ASSERT(sizeof(mat3x4) == 12 * sizeof(f32), "mat3x4 must be 3 rows of 4 floats");
+
+// The interpolations of the blend kernels
+typedef enum quat_blend {
+    QUAT_BLEND_NLERP = 0,
+    QUAT_BLEND_SLERP,
+    QUAT_BLEND_SLERP_FAST,
+} quat_blend;
+
+// Pairs whose sin(angle) is below this are lerped by slerp, as in fr_quat_slerp
+#define QUAT_SLERP_MIN_SIN 0.001f
+
+typedef void (*PFN_quat_batch_mul)(const f32* const a[4], const f32* const b[4], f32* const out[4], u32 count);
+typedef void (*PFN_quat_batch_blend)(
+    quat_blend mode, const f32* const from[4], const f32* const to[4], f32 t, f32* const out[4], u32 count);
+// Writes the rows of the rotations as mat3x4 or, when columns is TRUE, their columns followed by 0, 0, 0, 1 as mat4
+typedef void (*PFN_quat_batch_to_matrix)(const f32* const q[4], b8 columns, f32* out, u32 count);
+
+// The kernels of one simd_level
+typedef struct quat_batch_kernels {
+    PFN_quat_batch_mul mul;
+    PFN_quat_batch_blend blend;
+    PFN_quat_batch_to_matrix to_matrix;
+} quat_batch_kernels;
+
+// The constants of the weight correction of fast slerp that only depend on t. With d the absolute dot product of a
+// pair, the corrected weight is t + t (t - 0.5) (t - 1) (A(d) (t - 0.5)^2 + B(d)).
+typedef struct quat_slerp_fast_t {
+    f32 cubic;
+    f32 square;
+} quat_slerp_fast_t;
+
+static quat_slerp_fast_t _slerp_fast_t(f32 t) {
+    quat_slerp_fast_t c = {t * (t - 0.5f) * (t - 1.0f), (t - 0.5f) * (t - 0.5f)};
+    return c;
+}
+
+//--------------------------------------------------------------------------------------------
+// Scalar kernels, also used for the tails of the SSE kernels
+//--------------------------------------------------------------------------------------------
+
+static void _mul_scalar(const f32* const a[4], const f32* const b[4], f32* const out[4], u32 count) {
+    for (u32 i = 0; i < count; ++i) {
+        f32 ax = a[0][i], ay = a[1][i], az = a[2][i], aw = a[3][i];
+        f32 bx = b[0][i], by = b[1][i], bz = b[2][i], bw = b[3][i];
+        out[0][i] = aw * bx + ax * bw + ay * bz - az * by;
+        out[1][i] = aw * by - ax * bz + ay * bw + az * bx;
+        out[2][i] = aw * bz + ax * by - ay * bx + az * bw;
+        out[3][i] = aw * bw - ax * bx - ay * by - az * bz;
+    }
+}
+
+static void _blend_scalar(
+    quat_blend mode, const f32* const from[4], const f32* const to[4], f32 t, f32* const out[4], u32 count) {
+    quat_slerp_fast_t fast = _slerp_fast_t(t);
+    for (u32 i = 0; i < count; ++i) {
+        f32 a[4] = {from[0][i], from[1][i], from[2][i], from[3][i]};
+        f32 b[4] = {to[0][i], to[1][i], to[2][i], to[3][i]};
+        f32 d = a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3];
+        f32 sign = d < 0.0f ? -1.0f : 1.0f;
+        d *= sign;
+
+        f32 w0 = 1.0f - t;
+        f32 w1 = t;
+        if (mode == QUAT_BLEND_SLERP) {
+            f32 sin_theta = fr_sqrt(MAX((1.0f - d) * (1.0f + d), 0.0f));
+            if (sin_theta >= QUAT_SLERP_MIN_SIN) {
+                f32 theta = fr_atan2(sin_theta, d);
+                w0 = fr_sin((1.0f - t) * theta) / sin_theta;
+                w1 = fr_sin(t * theta) / sin_theta;
+            }
+        } else if (mode == QUAT_BLEND_SLERP_FAST) {
+            f32 k_a = 1.0904f + d * (-3.2452f + d * (3.55645f - d * 1.43519f));
+            f32 k_b = 0.848013f + d * (-1.06021f + d * 0.215638f);
+            w1 = t + fast.cubic * (k_a * fast.square + k_b);
+            w0 = 1.0f - w1;
+        }
+        w1 *= sign;
+
+        f32 r[4];
+        f32 norm2 = 0.0f;
+        for (u32 c = 0; c < 4; ++c) {
+            r[c] = w0 * a[c] + w1 * b[c];
+            norm2 += r[c] * r[c];
+        }
+        f32 scale = mode == QUAT_BLEND_SLERP ? 1.0f : 1.0f / fr_sqrt(norm2);
+        for (u32 c = 0; c < 4; ++c) {
+            out[c][i] = r[c] * scale;
+        }
+    }
+}
+
+// Scaling by 2 / |q|^2 instead of 2 gives the rotation of the normalized quaternion without normalizing it
+static void _to_matrix_scalar(const f32* const q[4], b8 columns, f32* out, u32 count) {
+    u32 stride = columns ? 16 : 12;
+    for (u32 i = 0; i < count; ++i) {
+        f32 x = q[0][i], y = q[1][i], z = q[2][i], w = q[3][i];
+        f32 norm2 = x * x + y * y + z * z + w * w;
+        f32 s = norm2 > 0.0f ? 2.0f / norm2 : 0.0f;
+        f32 r[3][3] = {
+            {1.0f - s * (y * y + z * z), s * (x * y - z * w), s * (x * z + y * w)},
+            {s * (x * y + z * w), 1.0f - s * (x * x + z * z), s * (y * z - x * w)},
+            {s * (x * z - y * w), s * (y * z + x * w), 1.0f - s * (x * x + y * y)},
+        };
+
+        f32* m = out + i * stride;
+        for (u32 k = 0; k < 3; ++k) {
+            for (u32 j = 0; j < 3; ++j) {
+                m[k * 4 + j] = columns ? r[j][k] : r[k][j];
+            }
+            m[k * 4 + 3] = 0.0f;
+        }
+        if (columns) {
+            m[12] = 0.0f;
+            m[13] = 0.0f;
+            m[14] = 0.0f;
+            m[15] = 1.0f;
+        }
+    }
+}
+
+#if FR_SIMD == 1
+
+//--------------------------------------------------------------------------------------------
+// SSE2 kernels, 4 quaternions per iteration
+//--------------------------------------------------------------------------------------------
+
+FR_FORCE_INLINE void _mul4_sse(const __m128 a[4], const __m128 b[4], __m128 out[4]) {
+    out[0] = fr_simd_fnmadd(a[2], b[1], fr_simd_fmadd(a[1], b[2], fr_simd_fmadd(a[0], b[3], _mm_mul_ps(a[3], b[0]))));
+    out[1] = fr_simd_fmadd(a[2], b[0], fr_simd_fmadd(a[1], b[3], fr_simd_fnmadd(a[0], b[2], _mm_mul_ps(a[3], b[1]))));
+    out[2] = fr_simd_fmadd(a[2], b[3], fr_simd_fnmadd(a[1], b[0], fr_simd_fmadd(a[0], b[1], _mm_mul_ps(a[3], b[2]))));
+    out[3] = fr_simd_fnmadd(a[2], b[2], fr_simd_fnmadd(a[1], b[1], fr_simd_fnmadd(a[0], b[0], _mm_mul_ps(a[3], b[3]))));
+}
+
+static void _mul_sse(const f32* const a[4], const f32* const b[4], f32* const out[4], u32 count) {
+    u32 i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 qa[4], qb[4], r[4];
+        for (u32 c = 0; c < 4; ++c) {
+            qa[c] = _mm_loadu_ps(a[c] + i);
+            qb[c] = _mm_loadu_ps(b[c] + i);
+        }
+        _mul4_sse(qa, qb, r);
+        for (u32 c = 0; c < 4; ++c) {
+            _mm_storeu_ps(out[c] + i, r[c]);
+        }
+    }
+    const f32* const a_tail[4] = {a[0] + i, a[1] + i, a[2] + i, a[3] + i};
+    const f32* const b_tail[4] = {b[0] + i, b[1] + i, b[2] + i, b[3] + i};
+    f32* const out_tail[4] = {out[0] + i, out[1] + i, out[2] + i, out[3] + i};
+    _mul_scalar(a_tail, b_tail, out_tail, count - i);
+}
+
+// Blends 4 pairs, mode is a constant at every call so that the other interpolations fold away
+FR_FORCE_INLINE void _blend4_sse(
+    quat_blend mode, const __m128 a[4], const __m128 b[4], __m128 t, quat_slerp_fast_t fast, __m128 out[4]) {
+    __m128 one = _mm_set1_ps(1.0f);
+    __m128 d = _mm_mul_ps(a[0], b[0]);
+    d = fr_simd_fmadd(a[1], b[1], d);
+    d = fr_simd_fmadd(a[2], b[2], d);
+    d = fr_simd_fmadd(a[3], b[3], d);
+    __m128 sign = _mm_and_ps(d, FR_SIGN_BITf32x4);
+    d = _mm_xor_ps(d, sign);
+
+    __m128 w0 = _mm_sub_ps(one, t);
+    __m128 w1 = t;
+    if (mode == QUAT_BLEND_SLERP) {
+        __m128 sin2 = _mm_mul_ps(_mm_sub_ps(one, d), _mm_add_ps(one, d));
+        __m128 sin_theta = _mm_sqrt_ps(_mm_max_ps(sin2, _mm_setzero_ps()));
+        __m128 theta = fr_simd_atan2(sin_theta, d);
+        __m128 inv_sin = _mm_div_ps(one, sin_theta);
+        __m128 lerp = _mm_cmplt_ps(sin_theta, _mm_set1_ps(QUAT_SLERP_MIN_SIN));
+        w0 = fr_simd_select(lerp, w0, _mm_mul_ps(fr_simd_sin(_mm_mul_ps(w0, theta)), inv_sin));
+        w1 = fr_simd_select(lerp, w1, _mm_mul_ps(fr_simd_sin(_mm_mul_ps(w1, theta)), inv_sin));
+    } else if (mode == QUAT_BLEND_SLERP_FAST) {
+        __m128 k_a = fr_simd_fnmadd(d, _mm_set1_ps(1.43519f), _mm_set1_ps(3.55645f));
+        k_a = fr_simd_fmadd(d, k_a, _mm_set1_ps(-3.2452f));
+        k_a = fr_simd_fmadd(d, k_a, _mm_set1_ps(1.0904f));
+        __m128 k_b = fr_simd_fmadd(d, _mm_set1_ps(0.215638f), _mm_set1_ps(-1.06021f));
+        k_b = fr_simd_fmadd(d, k_b, _mm_set1_ps(0.848013f));
+        __m128 k = fr_simd_fmadd(k_a, _mm_set1_ps(fast.square), k_b);
+        w1 = fr_simd_fmadd(_mm_set1_ps(fast.cubic), k, t);
+        w0 = _mm_sub_ps(one, w1);
+    }
+    w1 = _mm_xor_ps(w1, sign);
+
+    __m128 norm2 = _mm_setzero_ps();
+    for (u32 c = 0; c < 4; ++c) {
+        out[c] = fr_simd_fmadd(w1, b[c], _mm_mul_ps(w0, a[c]));
+        norm2 = fr_simd_fmadd(out[c], out[c], norm2);
+    }
+    if (mode != QUAT_BLEND_SLERP) {
+        __m128 scale = _mm_div_ps(one, _mm_sqrt_ps(norm2));
+        for (u32 c = 0; c < 4; ++c) {
+            out[c] = _mm_mul_ps(out[c], scale);
+        }
+    }
+}
+
+FR_FORCE_INLINE void _blend_loop_sse(
+    quat_blend mode, const f32* const from[4], const f32* const to[4], f32 t, f32* const out[4], u32 count) {
+    __m128 tv = _mm_set1_ps(t);
+    quat_slerp_fast_t fast = _slerp_fast_t(t);
+    u32 i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 a[4], b[4], r[4];
+        for (u32 c = 0; c < 4; ++c) {
+            a[c] = _mm_loadu_ps(from[c] + i);
+            b[c] = _mm_loadu_ps(to[c] + i);
+        }
+        _blend4_sse(mode, a, b, tv, fast, r);
+        for (u32 c = 0; c < 4; ++c) {
+            _mm_storeu_ps(out[c] + i, r[c]);
+        }
+    }
+    const f32* const from_tail[4] = {from[0] + i, from[1] + i, from[2] + i, from[3] + i};
+    const f32* const to_tail[4] = {to[0] + i, to[1] + i, to[2] + i, to[3] + i};
+    f32* const out_tail[4] = {out[0] + i, out[1] + i, out[2] + i, out[3] + i};
+    _blend_scalar(mode, from_tail, to_tail, t, out_tail, count - i);
+}
+
+static void _blend_sse(
+    quat_blend mode, const f32* const from[4], const f32* const to[4], f32 t, f32* const out[4], u32 count) {
+    switch (mode) {
+        case QUAT_BLEND_NLERP:
+            _blend_loop_sse(QUAT_BLEND_NLERP, from, to, t, out, count);
+            break;
+        case QUAT_BLEND_SLERP:
+            _blend_loop_sse(QUAT_BLEND_SLERP, from, to, t, out, count);
+            break;
+        case QUAT_BLEND_SLERP_FAST:
+            _blend_loop_sse(QUAT_BLEND_SLERP_FAST, from, to, t, out, count);
+            break;
+    }
+}
+
+// The elements r[row][col] of the rotations of 4 quaternions, see _to_matrix_scalar
+FR_FORCE_INLINE void _rotation4_sse(const __m128 q[4], __m128 r[3][3]) {
+    __m128 norm2 = _mm_mul_ps(q[0], q[0]);
+    norm2 = fr_simd_fmadd(q[1], q[1], norm2);
+    norm2 = fr_simd_fmadd(q[2], q[2], norm2);
+    norm2 = fr_simd_fmadd(q[3], q[3], norm2);
+    __m128 s = _mm_and_ps(_mm_cmpgt_ps(norm2, _mm_setzero_ps()), _mm_div_ps(_mm_set1_ps(2.0f), norm2));
+
+    __m128 xs = _mm_mul_ps(q[0], s), ys = _mm_mul_ps(q[1], s), zs = _mm_mul_ps(q[2], s);
+    __m128 xx = _mm_mul_ps(q[0], xs), yy = _mm_mul_ps(q[1], ys), zz = _mm_mul_ps(q[2], zs);
+    __m128 xy = _mm_mul_ps(q[0], ys), xz = _mm_mul_ps(q[0], zs), yz = _mm_mul_ps(q[1], zs);
+    __m128 wx = _mm_mul_ps(q[3], xs), wy = _mm_mul_ps(q[3], ys), wz = _mm_mul_ps(q[3], zs);
+    __m128 one = _mm_set1_ps(1.0f);
+
+    r[0][0] = _mm_sub_ps(one, _mm_add_ps(yy, zz));
+    r[0][1] = _mm_sub_ps(xy, wz);
+    r[0][2] = _mm_add_ps(xz, wy);
+    r[1][0] = _mm_add_ps(xy, wz);
+    r[1][1] = _mm_sub_ps(one, _mm_add_ps(xx, zz));
+    r[1][2] = _mm_sub_ps(yz, wx);
+    r[2][0] = _mm_sub_ps(xz, wy);
+    r[2][1] = _mm_add_ps(yz, wx);
+    r[2][2] = _mm_sub_ps(one, _mm_add_ps(xx, yy));
+}
+
+static void _to_matrix_sse(const f32* const q[4], b8 columns, f32* out, u32 count) {
+    u32 stride = columns ? 16 : 12;
+    __m128 last_column = _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f);
+    u32 i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 v[4] = {_mm_loadu_ps(q[0] + i), _mm_loadu_ps(q[1] + i), _mm_loadu_ps(q[2] + i), _mm_loadu_ps(q[3] + i)};
+        __m128 r[3][3];
+        _rotation4_sse(v, r);
+
+        f32* m = out + i * stride;
+        for (u32 k = 0; k < 3; ++k) {
+            __m128 e0 = columns ? r[0][k] : r[k][0];
+            __m128 e1 = columns ? r[1][k] : r[k][1];
+            __m128 e2 = columns ? r[2][k] : r[k][2];
+            __m128 e3 = _mm_setzero_ps();
+            _MM_TRANSPOSE4_PS(e0, e1, e2, e3);
+            _mm_storeu_ps(m + k * 4, e0);
+            _mm_storeu_ps(m + stride + k * 4, e1);
+            _mm_storeu_ps(m + stride * 2 + k * 4, e2);
+            _mm_storeu_ps(m + stride * 3 + k * 4, e3);
+        }
+        if (columns) {
+            for (u32 j = 0; j < 4; ++j) {
+                _mm_storeu_ps(m + j * stride + 12, last_column);
+            }
+        }
+    }
+    const f32* const q_tail[4] = {q[0] + i, q[1] + i, q[2] + i, q[3] + i};
+    _to_matrix_scalar(q_tail, columns, out + i * stride, count - i);
+}
+
+//--------------------------------------------------------------------------------------------
+// AVX2 kernels, 8 quaternions per iteration with masked tails
+//--------------------------------------------------------------------------------------------
+
+FR_SIMD256_INLINE void _mul8_avx2(const __m256 a[4], const __m256 b[4], __m256 out[4]) {
+    __m256 x = fr_simd256_fmadd(a[1], b[2], fr_simd256_fmadd(a[0], b[3], _mm256_mul_ps(a[3], b[0])));
+    __m256 y = fr_simd256_fmadd(a[1], b[3], fr_simd256_fnmadd(a[0], b[2], _mm256_mul_ps(a[3], b[1])));
+    __m256 z = fr_simd256_fnmadd(a[1], b[0], fr_simd256_fmadd(a[0], b[1], _mm256_mul_ps(a[3], b[2])));
+    __m256 w = fr_simd256_fnmadd(a[1], b[1], fr_simd256_fnmadd(a[0], b[0], _mm256_mul_ps(a[3], b[3])));
+    out[0] = fr_simd256_fnmadd(a[2], b[1], x);
+    out[1] = fr_simd256_fmadd(a[2], b[0], y);
+    out[2] = fr_simd256_fmadd(a[2], b[3], z);
+    out[3] = fr_simd256_fnmadd(a[2], b[2], w);
+}
+
+static FR_TARGET_AVX2_FMA void _mul_avx2(const f32* const a[4], const f32* const b[4], f32* const out[4], u32 count) {
+    for (u32 i = 0; i < count; i += 8) {
+        __m256i mask = fr_simd256_tail_mask(count - i);
+        __m256 qa[4], qb[4], r[4];
+        for (u32 c = 0; c < 4; ++c) {
+            qa[c] = _mm256_maskload_ps(a[c] + i, mask);
+            qb[c] = _mm256_maskload_ps(b[c] + i, mask);
+        }
+        _mul8_avx2(qa, qb, r);
+        for (u32 c = 0; c < 4; ++c) {
+            _mm256_maskstore_ps(out[c] + i, mask, r[c]);
+        }
+    }
+}
+
+// _blend4_sse on 8 pairs
+FR_SIMD256_INLINE void _blend8_avx2(
+    quat_blend mode, const __m256 a[4], const __m256 b[4], __m256 t, quat_slerp_fast_t fast, __m256 out[4]) {
+    __m256 one = _mm256_set1_ps(1.0f);
+    __m256 d = _mm256_mul_ps(a[0], b[0]);
+    d = fr_simd256_fmadd(a[1], b[1], d);
+    d = fr_simd256_fmadd(a[2], b[2], d);
+    d = fr_simd256_fmadd(a[3], b[3], d);
+    __m256 sign = _mm256_and_ps(d, _mm256_set1_ps(-0.0f));
+    d = _mm256_xor_ps(d, sign);
+
+    __m256 w0 = _mm256_sub_ps(one, t);
+    __m256 w1 = t;
+    if (mode == QUAT_BLEND_SLERP) {
+        __m256 sin2 = _mm256_mul_ps(_mm256_sub_ps(one, d), _mm256_add_ps(one, d));
+        __m256 sin_theta = _mm256_sqrt_ps(_mm256_max_ps(sin2, _mm256_setzero_ps()));
+        __m256 theta = fr_simd256_atan2(sin_theta, d);
+        __m256 inv_sin = _mm256_div_ps(one, sin_theta);
+        __m256 lerp = _mm256_cmp_ps(sin_theta, _mm256_set1_ps(QUAT_SLERP_MIN_SIN), _CMP_LT_OQ);
+        w0 = fr_simd256_select(lerp, w0, _mm256_mul_ps(fr_simd256_sin(_mm256_mul_ps(w0, theta)), inv_sin));
+        w1 = fr_simd256_select(lerp, w1, _mm256_mul_ps(fr_simd256_sin(_mm256_mul_ps(w1, theta)), inv_sin));
+    } else if (mode == QUAT_BLEND_SLERP_FAST) {
+        __m256 k_a = fr_simd256_fnmadd(d, _mm256_set1_ps(1.43519f), _mm256_set1_ps(3.55645f));
+        k_a = fr_simd256_fmadd(d, k_a, _mm256_set1_ps(-3.2452f));
+        k_a = fr_simd256_fmadd(d, k_a, _mm256_set1_ps(1.0904f));
+        __m256 k_b = fr_simd256_fmadd(d, _mm256_set1_ps(0.215638f), _mm256_set1_ps(-1.06021f));
+        k_b = fr_simd256_fmadd(d, k_b, _mm256_set1_ps(0.848013f));
+        __m256 k = fr_simd256_fmadd(k_a, _mm256_set1_ps(fast.square), k_b);
+        w1 = fr_simd256_fmadd(_mm256_set1_ps(fast.cubic), k, t);
+        w0 = _mm256_sub_ps(one, w1);
+    }
+    w1 = _mm256_xor_ps(w1, sign);
+
+    __m256 norm2 = _mm256_setzero_ps();
+    for (u32 c = 0; c < 4; ++c) {
+        out[c] = fr_simd256_fmadd(w1, b[c], _mm256_mul_ps(w0, a[c]));
+        norm2 = fr_simd256_fmadd(out[c], out[c], norm2);
+    }
+    if (mode != QUAT_BLEND_SLERP) {
+        __m256 scale = _mm256_div_ps(one, _mm256_sqrt_ps(norm2));
+        for (u32 c = 0; c < 4; ++c) {
+            out[c] = _mm256_mul_ps(out[c], scale);
+        }
+    }
+}
+
+FR_SIMD256_INLINE void _blend_loop_avx2(
+    quat_blend mode, const f32* const from[4], const f32* const to[4], f32 t, f32* const out[4], u32 count) {
+    __m256 tv = _mm256_set1_ps(t);
+    quat_slerp_fast_t fast = _slerp_fast_t(t);
+    for (u32 i = 0; i < count; i += 8) {
+        // The lanes past the end blend two zero quaternions and are never stored
+        __m256i mask = fr_simd256_tail_mask(count - i);
+        __m256 a[4], b[4], r[4];
+        for (u32 c = 0; c < 4; ++c) {
+            a[c] = _mm256_maskload_ps(from[c] + i, mask);
+            b[c] = _mm256_maskload_ps(to[c] + i, mask);
+        }
+        _blend8_avx2(mode, a, b, tv, fast, r);
+        for (u32 c = 0; c < 4; ++c) {
+            _mm256_maskstore_ps(out[c] + i, mask, r[c]);
+        }
+    }
+}
+
+// AVX-512 runs this kernel as well since slerp needs the transcendental functions, which have no 16 wide versions
+static FR_TARGET_AVX2_FMA void _blend_avx2(
+    quat_blend mode, const f32* const from[4], const f32* const to[4], f32 t, f32* const out[4], u32 count) {
+    switch (mode) {
+        case QUAT_BLEND_NLERP:
+            _blend_loop_avx2(QUAT_BLEND_NLERP, from, to, t, out, count);
+            break;
+        case QUAT_BLEND_SLERP:
+            _blend_loop_avx2(QUAT_BLEND_SLERP, from, to, t, out, count);
+            break;
+        case QUAT_BLEND_SLERP_FAST:
+            _blend_loop_avx2(QUAT_BLEND_SLERP_FAST, from, to, t, out, count);
+            break;
+    }
+}
+
+// _rotation4_sse on 8 quaternions
+FR_SIMD256_INLINE void _rotation8_avx2(const __m256 q[4], __m256 r[3][3]) {
+    __m256 norm2 = _mm256_mul_ps(q[0], q[0]);
+    norm2 = fr_simd256_fmadd(q[1], q[1], norm2);
+    norm2 = fr_simd256_fmadd(q[2], q[2], norm2);
+    norm2 = fr_simd256_fmadd(q[3], q[3], norm2);
+    __m256 positive = _mm256_cmp_ps(norm2, _mm256_setzero_ps(), _CMP_GT_OQ);
+    __m256 s = _mm256_and_ps(positive, _mm256_div_ps(_mm256_set1_ps(2.0f), norm2));
+
+    __m256 xs = _mm256_mul_ps(q[0], s), ys = _mm256_mul_ps(q[1], s), zs = _mm256_mul_ps(q[2], s);
+    __m256 xx = _mm256_mul_ps(q[0], xs), yy = _mm256_mul_ps(q[1], ys), zz = _mm256_mul_ps(q[2], zs);
+    __m256 xy = _mm256_mul_ps(q[0], ys), xz = _mm256_mul_ps(q[0], zs), yz = _mm256_mul_ps(q[1], zs);
+    __m256 wx = _mm256_mul_ps(q[3], xs), wy = _mm256_mul_ps(q[3], ys), wz = _mm256_mul_ps(q[3], zs);
+    __m256 one = _mm256_set1_ps(1.0f);
+
+    r[0][0] = _mm256_sub_ps(one, _mm256_add_ps(yy, zz));
+    r[0][1] = _mm256_sub_ps(xy, wz);
+    r[0][2] = _mm256_add_ps(xz, wy);
+    r[1][0] = _mm256_add_ps(xy, wz);
+    r[1][1] = _mm256_sub_ps(one, _mm256_add_ps(xx, zz));
+    r[1][2] = _mm256_sub_ps(yz, wx);
+    r[2][0] = _mm256_sub_ps(xz, wy);
+    r[2][1] = _mm256_add_ps(yz, wx);
+    r[2][2] = _mm256_sub_ps(one, _mm256_add_ps(xx, yy));
+}
+
+// Spreading 16 matrices over 512 bit registers costs more shuffles than it saves, so AVX-512 runs this kernel as well
+static FR_TARGET_AVX2_FMA void _to_matrix_avx2(const f32* const q[4], b8 columns, f32* out, u32 count) {
+    u32 stride = columns ? 16 : 12;
+    __m128 last_column = _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f);
+    u32 i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 v[4];
+        for (u32 c = 0; c < 4; ++c) {
+            v[c] = _mm256_loadu_ps(q[c] + i);
+        }
+        __m256 r[3][3];
+        _rotation8_avx2(v, r);
+
+        // After the transpose e[j] holds quaternion j in its low lane and j + 4 in its high lane
+        f32* m = out + i * stride;
+        for (u32 k = 0; k < 3; ++k) {
+            __m256 e[4] = {
+                columns ? r[0][k] : r[k][0],
+                columns ? r[1][k] : r[k][1],
+                columns ? r[2][k] : r[k][2],
+                _mm256_setzero_ps(),
+            };
+            fr_simd256_transpose4(&e[0], &e[1], &e[2], &e[3]);
+            for (u32 j = 0; j < 4; ++j) {
+                _mm_storeu_ps(m + j * stride + k * 4, _mm256_castps256_ps128(e[j]));
+                _mm_storeu_ps(m + (j + 4) * stride + k * 4, _mm256_extractf128_ps(e[j], 1));
+            }
+        }
+        if (columns) {
+            for (u32 j = 0; j < 8; ++j) {
+                _mm_storeu_ps(m + j * stride + 12, last_column);
+            }
+        }
+    }
+    const f32* const q_tail[4] = {q[0] + i, q[1] + i, q[2] + i, q[3] + i};
+    _to_matrix_sse(q_tail, columns, out + i * stride, count - i);
+}
+
+//--------------------------------------------------------------------------------------------
+// AVX-512 kernels, 16 quaternions per iteration with masked tails
+//--------------------------------------------------------------------------------------------
+
+static FR_TARGET_AVX512 void _mul_avx512(const f32* const a[4], const f32* const b[4], f32* const out[4], u32 count) {
+    for (u32 i = 0; i < count; i += 16) {
+        __mmask16 mask = fr_simd512_tail_mask(count - i);
+        __m512 qa[4], qb[4];
+        for (u32 c = 0; c < 4; ++c) {
+            qa[c] = _mm512_maskz_loadu_ps(mask, a[c] + i);
+            qb[c] = _mm512_maskz_loadu_ps(mask, b[c] + i);
+        }
+        __m512 x = fr_simd512_fmadd(qa[1], qb[2], fr_simd512_fmadd(qa[0], qb[3], _mm512_mul_ps(qa[3], qb[0])));
+        __m512 y = fr_simd512_fmadd(qa[1], qb[3], fr_simd512_fnmadd(qa[0], qb[2], _mm512_mul_ps(qa[3], qb[1])));
+        __m512 z = fr_simd512_fnmadd(qa[1], qb[0], fr_simd512_fmadd(qa[0], qb[1], _mm512_mul_ps(qa[3], qb[2])));
+        __m512 w = fr_simd512_fnmadd(qa[1], qb[1], fr_simd512_fnmadd(qa[0], qb[0], _mm512_mul_ps(qa[3], qb[3])));
+        _mm512_mask_storeu_ps(out[0] + i, mask, fr_simd512_fnmadd(qa[2], qb[1], x));
+        _mm512_mask_storeu_ps(out[1] + i, mask, fr_simd512_fmadd(qa[2], qb[0], y));
+        _mm512_mask_storeu_ps(out[2] + i, mask, fr_simd512_fmadd(qa[2], qb[3], z));
+        _mm512_mask_storeu_ps(out[3] + i, mask, fr_simd512_fnmadd(qa[2], qb[2], w));
+    }
+}
+#endif
+
+//--------------------------------------------------------------------------------------------
+// Dispatch
+//--------------------------------------------------------------------------------------------
+
+static const quat_batch_kernels batch_kernels[FR_SIMD_LEVEL_MAX] = {
+    [FR_SIMD_LEVEL_SCALAR] = {_mul_scalar, _blend_scalar, _to_matrix_scalar},
+#if FR_SIMD == 1
+    [FR_SIMD_LEVEL_SSE2] = {_mul_sse, _blend_sse, _to_matrix_sse},
+    [FR_SIMD_LEVEL_AVX2] = {_mul_avx2, _blend_avx2, _to_matrix_avx2},
+    [FR_SIMD_LEVEL_AVX512] = {_mul_avx512, _blend_avx2, _to_matrix_avx2},
+#endif
+};
+
+static const quat_batch_kernels* _quat_batch_kernels() { return &batch_kernels[fr_simd_get_level()]; }
+
+void fr_quat_mul_soa(const f32* const a[4], const f32* const b[4], f32* const out[4], u32 count) {
+    _quat_batch_kernels()->mul(a, b, out, count);
+}
+
+void fr_quat_nlerp_soa(const f32* const from[4], const f32* const to[4], f32 t, f32* const out[4], u32 count) {
+    _quat_batch_kernels()->blend(QUAT_BLEND_NLERP, from, to, t, out, count);
+}
+
+void fr_quat_slerp_soa(const f32* const from[4], const f32* const to[4], f32 t, f32* const out[4], u32 count) {
+    _quat_batch_kernels()->blend(QUAT_BLEND_SLERP, from, to, t, out, count);
+}
+
+void fr_quat_slerp_fast_soa(const f32* const from[4], const f32* const to[4], f32 t, f32* const out[4], u32 count) {
+    _quat_batch_kernels()->blend(QUAT_BLEND_SLERP_FAST, from, to, t, out, count);
+}
+
+void fr_quat_to_mat4_soa(const f32* const q[4], mat4* out, u32 count) {
+    _quat_batch_kernels()->to_matrix(q, TRUE, out->data, count);
+}
+
+void fr_quat_to_mat3x4_soa(const f32* const q[4], mat3x4* out, u32 count) {
+    _quat_batch_kernels()->to_matrix(q, FALSE, out->data, count);
+}
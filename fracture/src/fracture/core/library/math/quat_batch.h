@@ -0,0 +1,96 @@
+/**
+ * @file quat_batch.h
+ * @author Aditya Rajagopal
+ * @brief Products, blends and matrices of arrays of quaternions.
+ * @details Blending two animation poses evaluates the same quaternion operation for every bone of every animated
+ * character. These functions take the quaternions as a structure of arrays, one array each for x, y, z and w, so that
+ * the SIMD kernels work on 4 (SSE2) or 8 (AVX2 and AVX-512) quaternions per register with no shuffling, picking the
+ * instruction set with fr_simd_get_level.
+ *
+ * The blends take the shortest path like fr_quat_nlerp, negating the target of pairs whose dot product is negative.
+ * fr_quat_slerp_soa is exact up to the accuracy of fr_simd_atan2 and fr_simd_sin. fr_quat_slerp_fast_soa instead
+ * corrects the weight of an nlerp with a polynomial of the angle between the pair, which stays within about 1e-3
+ * radians of the exact slerp for a fraction of the cost and is what poses should normally be blended with.
+ *
+ * Counts need not be multiples of the vector width and the arrays need no particular alignment. The outputs may be
+ * the same arrays as the inputs but must not partially overlap them.
+ * @version 0.0.1
+ * @date 2024-04-29
+ *
+ * @copyright Fracture Game Engine is Copyright (c) Aditya Rajagopal 2024-2024
+ *
+ */
+#pragma once
+
+#include "detail/matrix.h"
+#include "fracture/core/defines.h"
+
+/**
+ * @brief Multiplies two arrays of quaternions pair by pair, out[i] = a[i] * b[i], like fr_quat_mul.
+ *
+ * @param a The x, y, z and w arrays of the quaternions on the left
+ * @param b The x, y, z and w arrays of the quaternions on the right
+ * @param out The x, y, z and w arrays of the products
+ * @param count The number of quaternions in each array
+ */
+FR_API void fr_quat_mul_soa(const f32* const a[4], const f32* const b[4], f32* const out[4], u32 count);
+
+/**
+ * @brief Blends two arrays of quaternions pair by pair with a normalized linear interpolation, like fr_quat_nlerp.
+ *
+ * @param from The x, y, z and w arrays of the quaternions at t = 0
+ * @param to The x, y, z and w arrays of the quaternions at t = 1
+ * @param t The blend weight of to, shared by every pair
+ * @param out The x, y, z and w arrays of the blended unit quaternions
+ * @param count The number of quaternions in each array
+ */
+FR_API void fr_quat_nlerp_soa(const f32* const from[4], const f32* const to[4], f32 t, f32* const out[4], u32 count);
+
+/**
+ * @brief Blends two arrays of unit quaternions pair by pair with a spherical linear interpolation, like fr_quat_slerp.
+ * @details Pairs less than about 0.1 degrees apart are linearly interpolated instead.
+ *
+ * @param from The x, y, z and w arrays of the quaternions at t = 0
+ * @param to The x, y, z and w arrays of the quaternions at t = 1
+ * @param t The blend weight of to, shared by every pair
+ * @param out The x, y, z and w arrays of the blended quaternions
+ * @param count The number of quaternions in each array
+ */
+FR_API void fr_quat_slerp_soa(const f32* const from[4], const f32* const to[4], f32 t, f32* const out[4], u32 count);
+
+/**
+ * @brief Approximates fr_quat_slerp_soa by an nlerp whose weight is corrected for the angle between each pair.
+ * @details The correction is the fit of "Approximating slerp" by Arseny Kapoulkine. The results are unit quaternions
+ * within about 1e-3 radians of the exact slerp at any angle, at about the cost of fr_quat_nlerp_soa.
+ *
+ * @param from The x, y, z and w arrays of the unit quaternions at t = 0
+ * @param to The x, y, z and w arrays of the unit quaternions at t = 1
+ * @param t The blend weight of to, shared by every pair
+ * @param out The x, y, z and w arrays of the blended unit quaternions
+ * @param count The number of quaternions in each array
+ */
+FR_API void fr_quat_slerp_fast_soa(const f32* const from[4],
+                                   const f32* const to[4],
+                                   f32 t,
+                                   f32* const out[4],
+                                   u32 count);
+
+/**
+ * @brief Converts an array of quaternions to rotation matrices, like fr_quat_to_mat4. The quaternions need not be
+ * normalized.
+ *
+ * @param q The x, y, z and w arrays of the quaternions
+ * @param out The rotation matrices
+ * @param count The number of quaternions
+ */
+FR_API void fr_quat_to_mat4_soa(const f32* const q[4], mat4* out, u32 count);
+
+/**
+ * @brief Converts an array of quaternions to the upper three rows of rotation matrices, the 48 byte form of bone
+ * matrices. The translations in the last column are zero. The quaternions need not be normalized.
+ *
+ * @param q The x, y, z and w arrays of the quaternions
+ * @param out The rotations
+ * @param count The number of quaternions
+ */
+FR_API void fr_quat_to_mat3x4_soa(const f32* const q[4], mat3x4* out, u32 count);
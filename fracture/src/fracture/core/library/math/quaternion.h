@@ -33,8 +33,8 @@ FR_FORCE_INLINE void fr_quat_conjugate(const quat* q, quat* out) {
 
 FR_FORCE_INLINE void fr_quat_inverse(const quat* q, quat* out) {
     fr_quat_conjugate(q, out);
-    __m128 invnorm = fr_simd_vinvnorm(q->simd);
-    out->simd = _mm_mul_ps(out->simd, invnorm);
+    __m128 invnorm2 = _mm_div_ps(_mm_set1_ps(1.0f), fr_simd_vnorm2(q->simd));
+    out->simd = _mm_mul_ps(out->simd, invnorm2);
 }
 
 FR_FORCE_INLINE f32 fr_quat_real(const quat* q) { return q->w; }
@@ -227,8 +227,8 @@ FR_FORCE_INLINE void fr_quat_slerp(const quat* from, const quat* to, f32 percent
     }
 
     f32 angle = fr_atan2(sinTheta, dot);
-    fr_vec4_scale(&target, fr_sin((1.0f - percentage) * angle), &target);
-    fr_vec4_scale(to, fr_sin(percentage * angle), out);
+    fr_vec4_scale(from, fr_sin((1.0f - percentage) * angle), out);
+    fr_vec4_scale(&target, fr_sin(percentage * angle), &target);
     fr_vec4_add(&target, out, out);
     fr_vec4_scale(out, 1.0f / sinTheta, out);
 }
@@ -0,0 +1,62 @@
+/**
+ * @file avx.h
+ * @author Aditya Rajagopal
+ * @brief 256 bit helpers for kernels that run on processors with AVX2 and FMA.
+ * @details The engine is compiled for SSE2, so these helpers carry FR_TARGET_AVX2_FMA and may only be used from
+ * functions with the same target attribute. Those functions must only be called when fr_simd_get_level is at least
+ * FR_SIMD_LEVEL_AVX2, see dispatch.h.
+ *
+ * Most helpers work on the two 128 bit lanes of a register independently, which lets kernels written for one vec4 or
+ * mat4 column per register process two at a time without crossing lanes.
+ * @version 0.0.1
+ * @date 2024-04-27
+ *
+ * @copyright Fracture Game Engine is Copyright (c) Aditya Rajagopal 2024-2024
+ *
+ */
+#pragma once
+
+#include "fracture/core/defines.h"
+#include "fracture/core/library/cpu_features.h"
+
+#if FR_SIMD == 1
+#include <immintrin.h>
+
+#define FR_SIMD256_INLINE FR_FORCE_INLINE FR_TARGET_AVX2_FMA
+
+// Splats component i of each 128 bit lane across that lane
+#define FR_SIMD256_SPLAT(mm, i) _mm256_permute_ps(mm, _MM_SHUFFLE(i, i, i, i))
+
+FR_SIMD256_INLINE __m256 fr_simd256_fmadd(__m256 a, __m256 b, __m256 c) { return _mm256_fmadd_ps(a, b, c); }
+
+FR_SIMD256_INLINE __m256 fr_simd256_fnmadd(__m256 a, __m256 b, __m256 c) { return _mm256_fnmadd_ps(a, b, c); }
+
+// Loads 4 floats into both 128 bit lanes
+FR_SIMD256_INLINE __m256 fr_simd256_broadcast4(const f32* ptr) { return _mm256_broadcast_ps((const __m128*)ptr); }
+
+// Mask for _mm256_maskload_ps and _mm256_maskstore_ps that selects the first MIN(count, 8) floats
+FR_SIMD256_INLINE __m256i fr_simd256_tail_mask(u32 count) {
+    return _mm256_cmpgt_epi32(_mm256_set1_epi32((i32)MIN(count, 8)), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+}
+
+// Transposes the 4x4 matrix in each 128 bit lane of the four registers, the lane wise _MM_TRANSPOSE4_PS
+FR_SIMD256_INLINE void fr_simd256_transpose4(__m256* r0, __m256* r1, __m256* r2, __m256* r3) {
+    __m256 t0 = _mm256_unpacklo_ps(*r0, *r1);
+    __m256 t1 = _mm256_unpacklo_ps(*r2, *r3);
+    __m256 t2 = _mm256_unpackhi_ps(*r0, *r1);
+    __m256 t3 = _mm256_unpackhi_ps(*r2, *r3);
+    *r0 = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0));
+    *r1 = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2));
+    *r2 = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(1, 0, 1, 0));
+    *r3 = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(3, 2, 3, 2));
+}
+
+// Multiplies the vec4 in each 128 bit lane of v by the matrix whose columns are broadcast into c0 to c3
+FR_SIMD256_INLINE __m256 fr_simd256_mat4_mulv(__m256 c0, __m256 c1, __m256 c2, __m256 c3, __m256 v) {
+    __m256 r = _mm256_mul_ps(c3, FR_SIMD256_SPLAT(v, 3));
+    r = _mm256_fmadd_ps(c2, FR_SIMD256_SPLAT(v, 2), r);
+    r = _mm256_fmadd_ps(c1, FR_SIMD256_SPLAT(v, 1), r);
+    return _mm256_fmadd_ps(c0, FR_SIMD256_SPLAT(v, 0), r);
+}
+
+#endif
@@ -0,0 +1,49 @@
+/**
+ * @file avx512.h
+ * @author Aditya Rajagopal
+ * @brief 512 bit helpers for kernels that run on processors with AVX-512F.
+ * @details Like avx.h the helpers carry their target attribute, FR_TARGET_AVX512, and may only be used from functions
+ * with the same attribute that are called when fr_simd_get_level is FR_SIMD_LEVEL_AVX512.
+ *
+ * The helpers work on the four 128 bit lanes of a register independently, so that a whole mat4 fits in one register
+ * and four vec4 are transformed at once.
+ * @version 0.0.1
+ * @date 2024-04-27
+ *
+ * @copyright Fracture Game Engine is Copyright (c) Aditya Rajagopal 2024-2024
+ *
+ */
+#pragma once
+
+#include "fracture/core/defines.h"
+#include "fracture/core/library/cpu_features.h"
+
+#if FR_SIMD == 1
+#include <immintrin.h>
+
+#define FR_SIMD512_INLINE FR_FORCE_INLINE FR_TARGET_AVX512
+
+// Splats component i of each 128 bit lane across that lane
+#define FR_SIMD512_SPLAT(mm, i) _mm512_permute_ps(mm, _MM_SHUFFLE(i, i, i, i))
+
+FR_SIMD512_INLINE __m512 fr_simd512_fmadd(__m512 a, __m512 b, __m512 c) { return _mm512_fmadd_ps(a, b, c); }
+
+FR_SIMD512_INLINE __m512 fr_simd512_fnmadd(__m512 a, __m512 b, __m512 c) { return _mm512_fnmadd_ps(a, b, c); }
+
+// Loads 4 floats into all four 128 bit lanes
+FR_SIMD512_INLINE __m512 fr_simd512_broadcast4(const f32* ptr) { return _mm512_broadcast_f32x4(_mm_loadu_ps(ptr)); }
+
+// Mask for the masked loads and stores that selects the first MIN(count, 16) floats
+FR_SIMD512_INLINE __mmask16 fr_simd512_tail_mask(u32 count) {
+    return count >= 16 ? (__mmask16)0xFFFF : (__mmask16)((1u << count) - 1);
+}
+
+// Multiplies the vec4 in each 128 bit lane of v by the matrix whose columns are broadcast into c0 to c3
+FR_SIMD512_INLINE __m512 fr_simd512_mat4_mulv(__m512 c0, __m512 c1, __m512 c2, __m512 c3, __m512 v) {
+    __m512 r = _mm512_mul_ps(c3, FR_SIMD512_SPLAT(v, 3));
+    r = _mm512_fmadd_ps(c2, FR_SIMD512_SPLAT(v, 2), r);
+    r = _mm512_fmadd_ps(c1, FR_SIMD512_SPLAT(v, 1), r);
+    return _mm512_fmadd_ps(c0, FR_SIMD512_SPLAT(v, 0), r);
+}
+
+#endif
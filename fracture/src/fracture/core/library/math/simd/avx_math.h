@@ -0,0 +1,393 @@
+/**
+ * @file avx_math.h
+ * @author Aditya Rajagopal
+ * @brief Transcendental functions of 8 floats at a time with AVX2 and FMA.
+ * @details The 8 wide versions of the functions in sse_math.h, with the same polynomials and accuracies. Like the
+ * helpers in avx.h they carry FR_TARGET_AVX2_FMA and may only be used from functions with the same target attribute
+ * that run when fr_simd_get_level is at least FR_SIMD_LEVEL_AVX2.
+ * @version 0.0.1
+ * @date 2024-04-28
+ *
+ * @copyright Fracture Game Engine is Copyright (c) Aditya Rajagopal 2024-2024
+ *
+ */
+#pragma once
+
+#include "avx.h"
+#include "fracture/core/library/math/math_constants.h"
+
+#if FR_SIMD == 1
+
+/**
+ * @brief Picks a where the mask is set and b elsewhere, for masks made by the comparison instructions.
+ *
+ */
+FR_SIMD256_INLINE __m256 fr_simd256_select(__m256 mask, __m256 a, __m256 b) { return _mm256_blendv_ps(b, a, mask); }
+
+FR_SIMD256_INLINE __m256 _fr_simd256_abs(__m256 x) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), x); }
+
+// x * 2^n for n in [-252, 254]. Scaling in two steps rounds results past the float range correctly to 0 or infinity.
+FR_SIMD256_INLINE __m256 _fr_simd256_ldexp(__m256 x, __m256i n) {
+    __m256i half = _mm256_srai_epi32(n, 1);
+    __m256i bias = _mm256_set1_epi32(127);
+    __m256 s0 = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(half, bias), 23));
+    __m256 s1 = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(_mm256_sub_epi32(n, half), bias), 23));
+    return _mm256_mul_ps(_mm256_mul_ps(x, s0), s1);
+}
+
+// Splits positive x, denormals included, into x = m * 2^e with m in [sqrt(0.5), sqrt(2)). Returns m and e as a float.
+FR_SIMD256_INLINE __m256 _fr_simd256_frexp(__m256 x, __m256* out_e) {
+    __m256 denormal = _mm256_cmp_ps(x, _mm256_set1_ps(1.17549435e-38f), _CMP_LT_OQ);
+    x = fr_simd256_select(denormal, _mm256_mul_ps(x, _mm256_set1_ps(33554432.0f)), x);
+    __m256i bits = _mm256_castps_si256(x);
+    __m256i e = _mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(127));
+    e = _mm256_sub_epi32(e, _mm256_and_si256(_mm256_castps_si256(denormal), _mm256_set1_epi32(25)));
+
+    __m256i mantissa = _mm256_and_si256(bits, _mm256_set1_epi32(0x007FFFFF));
+    __m256 m = _mm256_castsi256_ps(_mm256_or_si256(mantissa, _mm256_set1_epi32(0x3F800000)));
+    __m256 big = _mm256_cmp_ps(m, _mm256_set1_ps((f32)SQRT_TWO), _CMP_GT_OQ);
+    m = fr_simd256_select(big, _mm256_mul_ps(m, _mm256_set1_ps(0.5f)), m);
+    *out_e = _mm256_cvtepi32_ps(_mm256_sub_epi32(e, _mm256_castps_si256(big)));
+    return m;
+}
+
+// log2(1 + u) for u in [sqrt(0.5) - 1, sqrt(2) - 1], 2e-6 absolute error
+FR_SIMD256_INLINE __m256 _fr_simd256_log2p1_fast(__m256 u) {
+    __m256 p = fr_simd256_fmadd(_mm256_set1_ps(-0.20658988947433954f), u, _mm256_set1_ps(0.32215431876566214f));
+    p = fr_simd256_fmadd(p, u, _mm256_set1_ps(-0.36749025263918245f));
+    p = fr_simd256_fmadd(p, u, _mm256_set1_ps(0.4793480639404292f));
+    p = fr_simd256_fmadd(p, u, _mm256_set1_ps(-0.7211318479451333f));
+    p = fr_simd256_fmadd(p, u, _mm256_set1_ps(1.4427134809110966f));
+    return _mm256_mul_ps(p, u);
+}
+
+// 2^f for f in [-0.5, 0.5], 3e-6 relative error
+FR_SIMD256_INLINE __m256 _fr_simd256_exp2_poly_fast(__m256 f) {
+    __m256 p = fr_simd256_fmadd(_mm256_set1_ps(0.009681756349602158f), f, _mm256_set1_ps(0.05591975023605465f));
+    p = fr_simd256_fmadd(p, f, _mm256_set1_ps(0.24022024331471764f));
+    p = fr_simd256_fmadd(p, f, _mm256_set1_ps(0.693121515844782f));
+    return fr_simd256_fmadd(p, f, _mm256_set1_ps(1.0f));
+}
+
+// 2^t, 0 below -150 and infinity above 128
+FR_SIMD256_INLINE __m256 _fr_simd256_exp2_fast(__m256 t) {
+    // The operand order of min and max keeps NaN
+    t = _mm256_max_ps(_mm256_set1_ps(-151.0f), _mm256_min_ps(_mm256_set1_ps(129.0f), t));
+    __m256i n = _mm256_cvtps_epi32(t);
+    return _fr_simd256_ldexp(_fr_simd256_exp2_poly_fast(_mm256_sub_ps(t, _mm256_cvtepi32_ps(n))), n);
+}
+
+FR_SIMD256_INLINE void _fr_simd256_sincos(__m256 x, b8 fast, __m256* out_sin, __m256* out_cos) {
+    // x = q * pi / 2 + r with |r| <= pi / 4. pi / 2 is split into parts whose products with q are exact.
+    __m256i q = _mm256_cvtps_epi32(_mm256_mul_ps(x, _mm256_set1_ps((f32)(2.0 * INV_PI))));
+    __m256 qf = _mm256_cvtepi32_ps(q);
+    __m256 r = fr_simd256_fnmadd(qf, _mm256_set1_ps(1.5703125f), x);
+    __m256 s, c;
+    if (fast) {
+        // The short polynomials keep infinity infinite, sin and cos of infinity are NaN. All bits set is a NaN.
+        __m256 inf = _mm256_castsi256_ps(_mm256_set1_epi32(0x7F800000));
+        r = fr_simd256_fnmadd(qf, _mm256_set1_ps(4.8382679e-4f), r);
+        r = _mm256_or_ps(r, _mm256_cmp_ps(_fr_simd256_abs(x), inf, _CMP_EQ_OQ));
+        __m256 z = _mm256_mul_ps(r, r);
+        s = fr_simd256_fmadd(_mm256_set1_ps(0.008164608890986667f), z, _mm256_set1_ps(-0.16663458541717838f));
+        s = fr_simd256_fmadd(_mm256_mul_ps(s, z), r, r);
+        c = fr_simd256_fmadd(_mm256_set1_ps(-0.001359782376187895f), z, _mm256_set1_ps(0.041656294635450425f));
+        c = fr_simd256_fmadd(c, z, _mm256_set1_ps(-0.4999989478249502f));
+        c = fr_simd256_fmadd(c, z, _mm256_set1_ps(1.0f));
+    } else {
+        r = fr_simd256_fnmadd(qf, _mm256_set1_ps(4.837512969970703125e-4f), r);
+        r = fr_simd256_fnmadd(qf, _mm256_set1_ps(7.54978995489188216e-8f), r);
+        __m256 z = _mm256_mul_ps(r, r);
+        s = fr_simd256_fmadd(_mm256_set1_ps(-1.9515295891e-4f), z, _mm256_set1_ps(8.3321608736e-3f));
+        s = fr_simd256_fmadd(s, z, _mm256_set1_ps(-1.6666654611e-1f));
+        s = fr_simd256_fmadd(_mm256_mul_ps(s, z), r, r);
+        c = fr_simd256_fmadd(_mm256_set1_ps(2.443315711809948e-5f), z, _mm256_set1_ps(-1.388731625493765e-3f));
+        c = fr_simd256_fmadd(c, z, _mm256_set1_ps(4.166664568298827e-2f));
+        c = fr_simd256_fmadd(_mm256_mul_ps(c, z), z, fr_simd256_fnmadd(_mm256_set1_ps(0.5f), z, _mm256_set1_ps(1.0f)));
+    }
+
+    // Odd quadrants swap sin and cos, the sign of sin flips in quadrants 2 and 3 and that of cos in 1 and 2
+    __m256i one = _mm256_set1_epi32(1);
+    __m256i two = _mm256_set1_epi32(2);
+    __m256 swap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(q, one), one));
+    __m256 sin_sign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(q, two), 30));
+    __m256 cos_sign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(q, one), two), 30));
+    // The polynomial turns -0 into +0. sin is only exactly 0 at x = +-0, where it keeps the sign of x.
+    *out_sin = _mm256_xor_ps(fr_simd256_select(swap, c, s), sin_sign);
+    *out_sin = _mm256_or_ps(*out_sin, _mm256_and_ps(_mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_EQ_OQ), x));
+    *out_cos = _mm256_xor_ps(fr_simd256_select(swap, s, c), cos_sign);
+}
+
+FR_SIMD256_INLINE __m256 _fr_simd256_exp(__m256 x, b8 fast) {
+    // The operand order of min and max keeps NaN
+    x = _mm256_max_ps(_mm256_set1_ps(-104.0f), _mm256_min_ps(_mm256_set1_ps(89.0f), x));
+    __m256i n = _mm256_cvtps_epi32(_mm256_mul_ps(x, _mm256_set1_ps((f32)INV_LOG_TWO_BASE_E)));
+    __m256 nf = _mm256_cvtepi32_ps(n);
+    // x - n * log(2) with log(2) split in two, so that e^x = 2^n * e^r and |r| <= log(2) / 2
+    __m256 r = fr_simd256_fnmadd(nf, _mm256_set1_ps(0.693359375f), x);
+    r = fr_simd256_fnmadd(nf, _mm256_set1_ps(-2.12194440e-4f), r);
+    __m256 p;
+    if (fast) {
+        p = _fr_simd256_exp2_poly_fast(_mm256_mul_ps(r, _mm256_set1_ps((f32)INV_LOG_TWO_BASE_E)));
+    } else {
+        p = fr_simd256_fmadd(_mm256_set1_ps(1.9875691500e-4f), r, _mm256_set1_ps(1.3981999507e-3f));
+        p = fr_simd256_fmadd(p, r, _mm256_set1_ps(8.3334519073e-3f));
+        p = fr_simd256_fmadd(p, r, _mm256_set1_ps(4.1665795894e-2f));
+        p = fr_simd256_fmadd(p, r, _mm256_set1_ps(1.6666665459e-1f));
+        p = fr_simd256_fmadd(p, r, _mm256_set1_ps(5.0000001201e-1f));
+        p = fr_simd256_fmadd(p, _mm256_mul_ps(r, r), _mm256_add_ps(r, _mm256_set1_ps(1.0f)));
+    }
+    return _fr_simd256_ldexp(p, n);
+}
+
+FR_SIMD256_INLINE __m256 _fr_simd256_log(__m256 x, b8 fast) {
+    __m256 e;
+    __m256 u = _mm256_sub_ps(_fr_simd256_frexp(x, &e), _mm256_set1_ps(1.0f));
+    __m256 r;
+    if (fast) {
+        __m256 ln2 = _mm256_set1_ps((f32)LOG_TWO_BASE_E);
+        r = fr_simd256_fmadd(e, ln2, _mm256_mul_ps(_fr_simd256_log2p1_fast(u), ln2));
+    } else {
+        __m256 p = fr_simd256_fmadd(_mm256_set1_ps(7.0376836292e-2f), u, _mm256_set1_ps(-1.1514610310e-1f));
+        p = fr_simd256_fmadd(p, u, _mm256_set1_ps(1.1676998740e-1f));
+        p = fr_simd256_fmadd(p, u, _mm256_set1_ps(-1.2420140846e-1f));
+        p = fr_simd256_fmadd(p, u, _mm256_set1_ps(1.4249322787e-1f));
+        p = fr_simd256_fmadd(p, u, _mm256_set1_ps(-1.6668057665e-1f));
+        p = fr_simd256_fmadd(p, u, _mm256_set1_ps(2.0000714765e-1f));
+        p = fr_simd256_fmadd(p, u, _mm256_set1_ps(-2.4999993993e-1f));
+        p = fr_simd256_fmadd(p, u, _mm256_set1_ps(3.3333331174e-1f));
+        __m256 z = _mm256_mul_ps(u, u);
+        // log(2) is split in two so that e * log(2) adds no rounding error
+        __m256 y = fr_simd256_fmadd(e, _mm256_set1_ps(-2.12194440e-4f), _mm256_mul_ps(_mm256_mul_ps(p, u), z));
+        y = fr_simd256_fnmadd(_mm256_set1_ps(0.5f), z, y);
+        r = fr_simd256_fmadd(e, _mm256_set1_ps(0.693359375f), _mm256_add_ps(u, y));
+    }
+    __m256 inf = _mm256_castsi256_ps(_mm256_set1_epi32(0x7F800000));
+    __m256 zero = _mm256_setzero_ps();
+    r = fr_simd256_select(_mm256_cmp_ps(x, zero, _CMP_EQ_OQ), _mm256_xor_ps(inf, _mm256_set1_ps(-0.0f)), r);
+    r = fr_simd256_select(_mm256_cmp_ps(x, inf, _CMP_EQ_OQ), x, r);
+    // Negative numbers and NaN, all bits set is a NaN
+    return _mm256_or_ps(r, _mm256_cmp_ps(x, zero, _CMP_NGE_UQ));
+}
+
+FR_SIMD256_INLINE __m256 _fr_simd256_atan2(__m256 y, __m256 x, b8 fast) {
+    __m256 ax = _fr_simd256_abs(x);
+    __m256 ay = _fr_simd256_abs(y);
+    __m256 lo = _mm256_min_ps(ax, ay);
+    __m256 hi = _mm256_max_ps(ax, ay);
+    // atan of a in [0, 1]. Both zero gives 0 and both infinite 1.
+    __m256 nonzero = _mm256_cmp_ps(hi, _mm256_setzero_ps(), _CMP_NEQ_UQ);
+    __m256 a = fr_simd256_select(
+        _mm256_cmp_ps(lo, hi, _CMP_EQ_OQ), _mm256_and_ps(nonzero, _mm256_set1_ps(1.0f)), _mm256_div_ps(lo, hi));
+    __m256 r;
+    if (fast) {
+        __m256 z = _mm256_mul_ps(a, a);
+        __m256 p = fr_simd256_fmadd(_mm256_set1_ps(-0.011719123154470826f), z, _mm256_set1_ps(0.052647329870010084f));
+        p = fr_simd256_fmadd(p, z, _mm256_set1_ps(-0.1164264781830172f));
+        p = fr_simd256_fmadd(p, z, _mm256_set1_ps(0.19354038585723182f));
+        p = fr_simd256_fmadd(p, z, _mm256_set1_ps(-0.3326228329836512f));
+        p = fr_simd256_fmadd(p, z, _mm256_set1_ps(0.9999772196789498f));
+        r = _mm256_mul_ps(p, a);
+    } else {
+        // Past tan(pi / 8), atan(a) = pi / 4 + atan((a - 1) / (a + 1))
+        __m256 big = _mm256_cmp_ps(a, _mm256_set1_ps(0.4142135623730950f), _CMP_GT_OQ);
+        __m256 one = _mm256_set1_ps(1.0f);
+        __m256 t = fr_simd256_select(big, _mm256_div_ps(_mm256_sub_ps(a, one), _mm256_add_ps(a, one)), a);
+        __m256 z = _mm256_mul_ps(t, t);
+        __m256 p = fr_simd256_fmadd(_mm256_set1_ps(8.05374449538e-2f), z, _mm256_set1_ps(-1.38776856032e-1f));
+        p = fr_simd256_fmadd(p, z, _mm256_set1_ps(1.99777106478e-1f));
+        p = fr_simd256_fmadd(p, z, _mm256_set1_ps(-3.33329491539e-1f));
+        r = fr_simd256_fmadd(_mm256_mul_ps(p, z), t, t);
+        r = _mm256_add_ps(r, _mm256_and_ps(big, _mm256_set1_ps((f32)PI_4)));
+    }
+    r = fr_simd256_select(_mm256_cmp_ps(ay, ax, _CMP_GT_OQ), _mm256_sub_ps(_mm256_set1_ps((f32)PI_2), r), r);
+    r = _mm256_blendv_ps(r, _mm256_sub_ps(_mm256_set1_ps(F_PI), r), x);
+    r = _mm256_or_ps(r, _mm256_and_ps(y, _mm256_set1_ps(-0.0f)));
+    return _mm256_or_ps(r, _mm256_cmp_ps(x, y, _CMP_UNORD_Q));
+}
+
+// log2 of 4 doubles in [sqrt(0.5), sqrt(2)) from the series of atanh, 1e-12 relative error. The series is evaluated
+// in independent halves, pow is bound by the latency of these polynomials.
+FR_SIMD256_INLINE __m256d _fr_simd256_log2_pd(__m256d m) {
+    __m256d one = _mm256_set1_pd(1.0);
+    __m256d s = _mm256_div_pd(_mm256_sub_pd(m, one), _mm256_add_pd(m, one));
+    __m256d z = _mm256_mul_pd(s, s);
+    __m256d z2 = _mm256_mul_pd(z, z);
+    __m256d lo = _mm256_fmadd_pd(_mm256_set1_pd(1.0 / 3.0), z, one);
+    lo = _mm256_fmadd_pd(_mm256_fmadd_pd(_mm256_set1_pd(1.0 / 7.0), z, _mm256_set1_pd(1.0 / 5.0)), z2, lo);
+    __m256d hi = _mm256_fmadd_pd(_mm256_set1_pd(1.0 / 11.0), z, _mm256_set1_pd(1.0 / 9.0));
+    hi = _mm256_fmadd_pd(_mm256_set1_pd(1.0 / 13.0), z2, hi);
+    __m256d p = _mm256_fmadd_pd(hi, _mm256_mul_pd(z2, z2), lo);
+    return _mm256_mul_pd(_mm256_mul_pd(p, s), _mm256_set1_pd(2.0 * INV_LOG_TWO_BASE_E));
+}
+
+// 2^t of 4 doubles clamped to [-160, 130], enough for any float result, 1e-11 relative error
+FR_SIMD256_INLINE __m256d _fr_simd256_exp2_pd(__m256d t) {
+    t = _mm256_max_pd(_mm256_set1_pd(-160.0), _mm256_min_pd(_mm256_set1_pd(130.0), t));
+    __m128i n = _mm256_cvtpd_epi32(t);
+    __m256d f = _mm256_mul_pd(_mm256_sub_pd(t, _mm256_cvtepi32_pd(n)), _mm256_set1_pd(LOG_TWO_BASE_E));
+    // Taylor series of e^f for |f| <= log(2) / 2, in pairs of terms
+    __m256d f2 = _mm256_mul_pd(f, f);
+    __m256d f4 = _mm256_mul_pd(f2, f2);
+    __m256d p0 = _mm256_fmadd_pd(_mm256_set1_pd(1.0), f, _mm256_set1_pd(1.0));
+    __m256d p1 = _mm256_fmadd_pd(_mm256_set1_pd(1.0 / 6.0), f, _mm256_set1_pd(1.0 / 2.0));
+    __m256d p2 = _mm256_fmadd_pd(_mm256_set1_pd(1.0 / 120.0), f, _mm256_set1_pd(1.0 / 24.0));
+    __m256d p3 = _mm256_fmadd_pd(_mm256_set1_pd(1.0 / 5040.0), f, _mm256_set1_pd(1.0 / 720.0));
+    __m256d p4 = _mm256_fmadd_pd(_mm256_set1_pd(1.0 / 362880.0), f, _mm256_set1_pd(1.0 / 40320.0));
+    __m256d p = _mm256_fmadd_pd(_mm256_fmadd_pd(p3, f2, p2), f4, _mm256_fmadd_pd(p1, f2, p0));
+    p = _mm256_fmadd_pd(p4, _mm256_mul_pd(f4, f4), p);
+    __m256i e = _mm256_cvtepi32_epi64(_mm_add_epi32(n, _mm_set1_epi32(1023)));
+    return _mm256_mul_pd(p, _mm256_castsi256_pd(_mm256_slli_epi64(e, 52)));
+}
+
+FR_SIMD256_INLINE __m256 _fr_simd256_pow(__m256 x, __m256 y, b8 fast) {
+    __m256 ax = _fr_simd256_abs(x);
+    __m256 e;
+    __m256 m = _fr_simd256_frexp(ax, &e);
+    __m256 r;
+    if (fast) {
+        __m256 l = _mm256_add_ps(e, _fr_simd256_log2p1_fast(_mm256_sub_ps(m, _mm256_set1_ps(1.0f))));
+        r = _fr_simd256_exp2_fast(_mm256_mul_ps(y, l));
+    } else {
+        // y * log2(x) is needed to 1e-10 for a result within 1 ulp, which takes double precision
+        __m256d t0 = _mm256_cvtps_pd(_mm256_castps256_ps128(e));
+        __m256d t1 = _mm256_cvtps_pd(_mm256_extractf128_ps(e, 1));
+        t0 = _mm256_add_pd(t0, _fr_simd256_log2_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(m))));
+        t1 = _mm256_add_pd(t1, _fr_simd256_log2_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(m, 1))));
+        t0 = _mm256_mul_pd(t0, _mm256_cvtps_pd(_mm256_castps256_ps128(y)));
+        t1 = _mm256_mul_pd(t1, _mm256_cvtps_pd(_mm256_extractf128_ps(y, 1)));
+        __m128 r0 = _mm256_cvtpd_ps(_fr_simd256_exp2_pd(t0));
+        __m128 r1 = _mm256_cvtpd_ps(_fr_simd256_exp2_pd(t1));
+        r = _mm256_insertf128_ps(_mm256_castps128_ps256(r0), r1, 1);
+    }
+
+    // 0 and infinity raised to a positive power stay as they are, to a negative one they swap
+    __m256 zero = _mm256_setzero_ps();
+    __m256 inf = _mm256_castsi256_ps(_mm256_set1_epi32(0x7F800000));
+    __m256 ax_inf = _mm256_cmp_ps(ax, inf, _CMP_EQ_OQ);
+    __m256 extreme = _mm256_or_ps(ax_inf, _mm256_cmp_ps(ax, zero, _CMP_EQ_OQ));
+    __m256 to_inf = _mm256_xor_ps(ax_inf, _mm256_cmp_ps(y, zero, _CMP_LT_OQ));
+    r = fr_simd256_select(extreme, _mm256_and_ps(to_inf, inf), r);
+
+    // A negative base has a real power only for integer exponents, negative when the exponent is odd. Floats past 2^24
+    // are all even integers.
+    __m256 large = _mm256_cmp_ps(_fr_simd256_abs(y), _mm256_set1_ps(16777216.0f), _CMP_GE_OQ);
+    __m256i yi = _mm256_cvttps_epi32(y);
+    __m256 is_int = _mm256_or_ps(large, _mm256_cmp_ps(_mm256_cvtepi32_ps(yi), y, _CMP_EQ_OQ));
+    __m256 odd = _mm256_andnot_ps(large, _mm256_castsi256_ps(_mm256_slli_epi32(yi, 31)));
+    __m256 one = _mm256_set1_ps(1.0f);
+    r = fr_simd256_select(_mm256_cmp_ps(ax, one, _CMP_EQ_OQ), one, r);
+    r = _mm256_xor_ps(r, _mm256_and_ps(_mm256_and_ps(x, _mm256_set1_ps(-0.0f)), odd));
+    r = _mm256_or_ps(r, _mm256_andnot_ps(_mm256_or_ps(is_int, ax_inf), _mm256_cmp_ps(x, zero, _CMP_LT_OQ)));
+
+    r = _mm256_or_ps(r, _mm256_cmp_ps(x, y, _CMP_UNORD_Q));
+    // pow(x, 0) and pow(1, y) are 1 even for NaN
+    __m256 unit = _mm256_or_ps(_mm256_cmp_ps(y, zero, _CMP_EQ_OQ), _mm256_cmp_ps(x, one, _CMP_EQ_OQ));
+    return fr_simd256_select(unit, one, r);
+}
+
+/**
+ * @brief Sine of 8 floats, within 1e-7 for |x| < 8192.
+ *
+ */
+FR_SIMD256_INLINE __m256 fr_simd256_sin(__m256 x) {
+    __m256 s, c;
+    _fr_simd256_sincos(x, FALSE, &s, &c);
+    return s;
+}
+
+/**
+ * @brief Sine of 8 floats, within 1.5e-6.
+ *
+ */
+FR_SIMD256_INLINE __m256 fr_simd256_sin_fast(__m256 x) {
+    __m256 s, c;
+    _fr_simd256_sincos(x, TRUE, &s, &c);
+    return s;
+}
+
+/**
+ * @brief Cosine of 8 floats, within 1e-7 for |x| < 8192.
+ *
+ */
+FR_SIMD256_INLINE __m256 fr_simd256_cos(__m256 x) {
+    __m256 s, c;
+    _fr_simd256_sincos(x, FALSE, &s, &c);
+    return c;
+}
+
+/**
+ * @brief Cosine of 8 floats, within 1.5e-6.
+ *
+ */
+FR_SIMD256_INLINE __m256 fr_simd256_cos_fast(__m256 x) {
+    __m256 s, c;
+    _fr_simd256_sincos(x, TRUE, &s, &c);
+    return c;
+}
+
+/**
+ * @brief Sine and cosine of 8 floats for little more than the cost of one, within 1e-7 for |x| < 8192.
+ *
+ */
+FR_SIMD256_INLINE void fr_simd256_sincos(__m256 x, __m256* out_sin, __m256* out_cos) {
+    _fr_simd256_sincos(x, FALSE, out_sin, out_cos);
+}
+
+/**
+ * @brief Sine and cosine of 8 floats, within 1.5e-6.
+ *
+ */
+FR_SIMD256_INLINE void fr_simd256_sincos_fast(__m256 x, __m256* out_sin, __m256* out_cos) {
+    _fr_simd256_sincos(x, TRUE, out_sin, out_cos);
+}
+
+/**
+ * @brief e^x of 8 floats, within 1.5 ulp.
+ *
+ */
+FR_SIMD256_INLINE __m256 fr_simd256_exp(__m256 x) { return _fr_simd256_exp(x, FALSE); }
+
+/**
+ * @brief e^x of 8 floats, within 4e-6 relative.
+ *
+ */
+FR_SIMD256_INLINE __m256 fr_simd256_exp_fast(__m256 x) { return _fr_simd256_exp(x, TRUE); }
+
+/**
+ * @brief Natural logarithm of 8 floats, within 1 ulp.
+ *
+ */
+FR_SIMD256_INLINE __m256 fr_simd256_log(__m256 x) { return _fr_simd256_log(x, FALSE); }
+
+/**
+ * @brief Natural logarithm of 8 floats, within 2e-6 or 2e-7 relative.
+ *
+ */
+FR_SIMD256_INLINE __m256 fr_simd256_log_fast(__m256 x) { return _fr_simd256_log(x, TRUE); }
+
+/**
+ * @brief Angle of the points (x, y) in [-pi, pi], within 3 ulp.
+ *
+ */
+FR_SIMD256_INLINE __m256 fr_simd256_atan2(__m256 y, __m256 x) { return _fr_simd256_atan2(y, x, FALSE); }
+
+/**
+ * @brief Angle of the points (x, y) in [-pi, pi], within 2e-6.
+ *
+ */
+FR_SIMD256_INLINE __m256 fr_simd256_atan2_fast(__m256 y, __m256 x) { return _fr_simd256_atan2(y, x, TRUE); }
+
+/**
+ * @brief x^y of 8 pairs of floats, within 1 ulp.
+ *
+ */
+FR_SIMD256_INLINE __m256 fr_simd256_pow(__m256 x, __m256 y) { return _fr_simd256_pow(x, y, FALSE); }
+
+/**
+ * @brief x^y of 8 pairs of floats, within 3e-6 + 5e-7 * |y * log2(x)| relative.
+ *
+ */
+FR_SIMD256_INLINE __m256 fr_simd256_pow_fast(__m256 x, __m256 y) { return _fr_simd256_pow(x, y, TRUE); }
+
+#endif
@@ -0,0 +1,43 @@
+#include "dispatch.h"
+
+#include "fracture/core/library/atomics.h"
+#include "fracture/core/library/cpu_features.h"
+
+static volatile i32 active_level = FR_SIMD_LEVEL_AUTO;
+
+simd_level fr_simd_supported_level() {
+#if FR_SIMD == 1
+    u32 features = fr_cpu_features();
+    u32 avx2 = FR_CPU_FEATURE_AVX2 | FR_CPU_FEATURE_FMA;
+    if ((features & avx2) != avx2) {
+        return FR_SIMD_LEVEL_SSE2;
+    }
+    // Kernels that gain nothing from 512 bit registers fall back to their AVX2 version at this level
+    return (features & FR_CPU_FEATURE_AVX512F) ? FR_SIMD_LEVEL_AVX512 : FR_SIMD_LEVEL_AVX2;
+#else
+    return FR_SIMD_LEVEL_SCALAR;
+#endif
+}
+
+simd_level fr_simd_set_level(simd_level level) {
+    simd_level supported = fr_simd_supported_level();
+    if (level == FR_SIMD_LEVEL_AUTO || level >= FR_SIMD_LEVEL_MAX || level > supported) {
+        level = supported;
+    }
+    fr_atomic_store_i32(&active_level, (i32)level, FR_MEMORY_ORDER_RELAXED);
+    return level;
+}
+
+simd_level fr_simd_get_level() {
+    i32 level = fr_atomic_load_i32(&active_level, FR_MEMORY_ORDER_RELAXED);
+    if (level == FR_SIMD_LEVEL_AUTO) {
+        // Every thread resolves it to the same level so racing callers can all store it
+        return fr_simd_set_level(FR_SIMD_LEVEL_AUTO);
+    }
+    return (simd_level)level;
+}
+
+const char* fr_simd_level_name(simd_level level) {
+    static const char* names[FR_SIMD_LEVEL_MAX] = {"auto", "scalar", "SSE2", "AVX2", "AVX-512"};
+    return level < FR_SIMD_LEVEL_MAX ? names[level] : "unknown";
+}
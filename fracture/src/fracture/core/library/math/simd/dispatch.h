@@ -0,0 +1,69 @@
+/**
+ * @file dispatch.h
+ * @author Aditya Rajagopal
+ * @brief Selection of the instruction set used by the batch kernels of the math library.
+ * @details The inline math functions are compiled for the SSE2 baseline. Kernels that process arrays, such as those in
+ * mat4_batch.h, are compiled once per instruction set and pick one through fr_simd_get_level, so a single binary uses
+ * AVX2 or AVX-512 on the processors that have them.
+ *
+ * The engine sets the level once at startup from application_config.simd_level. Tools that do not start the engine get
+ * the widest supported level on first use. Lowering the level is meant for testing and benchmarking the narrower
+ * kernels, or for processors that slow down their clock when running 512 bit instructions.
+ * @version 0.0.1
+ * @date 2024-04-27
+ *
+ * @copyright Fracture Game Engine is Copyright (c) Aditya Rajagopal 2024-2024
+ *
+ */
+#pragma once
+
+#include "fracture/core/defines.h"
+
+/**
+ * @brief Instruction sets of the batch kernels, from the narrowest to the widest.
+ *
+ */
+typedef enum simd_level {
+    /** @brief Use the widest level the processor supports */
+    FR_SIMD_LEVEL_AUTO = 0,
+    /** @brief Plain C, the only level when the engine is built without _SIMD */
+    FR_SIMD_LEVEL_SCALAR,
+    /** @brief 128 bit SSE2 */
+    FR_SIMD_LEVEL_SSE2,
+    /** @brief 256 bit AVX2 with FMA */
+    FR_SIMD_LEVEL_AVX2,
+    /** @brief 512 bit AVX-512F, on top of AVX2 and FMA */
+    FR_SIMD_LEVEL_AVX512,
+    FR_SIMD_LEVEL_MAX,
+} simd_level;
+
+/**
+ * @brief Gets the widest level supported by the processor and the build.
+ *
+ * @return simd_level The widest supported level
+ */
+FR_API simd_level fr_simd_supported_level();
+
+/**
+ * @brief Sets the level of the batch kernels. Levels the processor does not support are lowered to the widest one it
+ * does.
+ *
+ * @param level The level to use, FR_SIMD_LEVEL_AUTO for the widest supported
+ * @return simd_level The level in use
+ */
+FR_API simd_level fr_simd_set_level(simd_level level);
+
+/**
+ * @brief Gets the level of the batch kernels.
+ *
+ * @return simd_level The level in use, never FR_SIMD_LEVEL_AUTO
+ */
+FR_API simd_level fr_simd_get_level();
+
+/**
+ * @brief Gets the name of a level for logging.
+ *
+ * @param level The level
+ * @return const char* The name
+ */
+FR_API const char* fr_simd_level_name(simd_level level);
@@ -14,7 +14,11 @@
 
 #if FR_SIMD == 1
 #include <emmintrin.h>
+#if defined(_MSC_VER) || defined(_WIN32)
 #include <intrin.h>
+#else
+#include <immintrin.h>
+#endif
 #include <xmmintrin.h>
 
 #include "fracture/core/library/math/math_constants.h"
@@ -128,7 +132,7 @@ FR_FORCE_INLINE __m128 fr_simd_vnorm(__m128 a) { return _mm_sqrt_ps(fr_simd_vdot
 
 FR_FORCE_INLINE __m128 fr_simd_vinvnorm_fast(__m128 a) { return _mm_rsqrt_ps(fr_simd_vdot(a, a)); }
 
-FR_FORCE_INLINE __m128 fr_simd_vinvnorm(__m128 a) { return _mm_div_ps(_mm_set1_ps(1.0), fr_simd_vdot(a, a)); }
+FR_FORCE_INLINE __m128 fr_simd_vinvnorm(__m128 a) { return _mm_div_ps(_mm_set1_ps(1.0), fr_simd_vnorm(a)); }
 
 FR_FORCE_INLINE __m128 fr_simd_vnorm1(__m128 a) { return fr_simd_vhadd(fr_simd_abs(a)); }
 
@@ -168,9 +172,23 @@ FR_FORCE_INLINE __m128 fr_simd_vneq(__m128 a, __m128 b) {
     return _mm_cmpge_ps(abs_diff, threshold);
 }
 
-FR_FORCE_INLINE __m128 fr_simd_fmadd(__m128 a, __m128 b, __m128 c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+// A fused multiply add when the build targets processors with FMA (e.g. -mfma or -march=haswell), otherwise a multiply
+// followed by an add. The batch kernels of the math library use FMA through runtime dispatch either way.
+FR_FORCE_INLINE __m128 fr_simd_fmadd(__m128 a, __m128 b, __m128 c) {
+#if defined(__FMA__)
+    return _mm_fmadd_ps(a, b, c);
+#else
+    return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+}
 
-FR_FORCE_INLINE __m128 fr_simd_fnmadd(__m128 a, __m128 b, __m128 c) { return _mm_sub_ps(c, _mm_mul_ps(a, b)); }
+FR_FORCE_INLINE __m128 fr_simd_fnmadd(__m128 a, __m128 b, __m128 c) {
+#if defined(__FMA__)
+    return _mm_fnmadd_ps(a, b, c);
+#else
+    return _mm_sub_ps(c, _mm_mul_ps(a, b));
+#endif
+}
 
 FR_FORCE_INLINE __m128 fr_simd_sign01(__m128 a) {
     __m128 sign = _mm_and_ps(FR_SIGN_BITf32x4, a);
@@ -0,0 +1,400 @@
+/**
+ * @file sse_math.h
+ * @author Aditya Rajagopal
+ * @brief Transcendental functions of 4 floats at a time with SSE2.
+ * @details Every function comes in two accuracies. The plain versions are within a few ulp of the correctly rounded
+ * result, close to the float functions of the C library, and the _fast versions use shorter polynomials for about
+ * 6 correct digits at roughly half the cost:
+ *
+ *              precise                                     fast
+ *     sin/cos  1e-7 absolute for |x| < 8192                1.5e-6 absolute
+ *     exp      1.5 ulp, 0 below -103.9, inf above 88.7     4e-6 relative
+ *     log      1 ulp, -inf at 0, NaN below 0               2e-6 absolute or 2e-7 relative
+ *     atan2    3 ulp, quadrants and signed zeros of atan2  2e-6 absolute
+ *     pow      1 ulp, special cases of pow                 3e-6 + 5e-7 * |y * log2(x)| relative
+ *
+ * The argument reduction of sin and cos loses accuracy past |x| = 8192, reduce larger angles before calling them. pow
+ * works in double precision internally. The fast pow is exp2(y * log2(x)) with the same special cases.
+ *
+ * NaN inputs give NaN. The array versions in transcendental.h dispatch these to the widest instruction set, see
+ * avx_math.h for the 8 wide versions.
+ * @version 0.0.1
+ * @date 2024-04-28
+ *
+ * @copyright Fracture Game Engine is Copyright (c) Aditya Rajagopal 2024-2024
+ *
+ */
+#pragma once
+
+#include "sse.h"
+
+#if FR_SIMD == 1
+
+/**
+ * @brief Picks a where the mask is set and b elsewhere, for masks made by the comparison instructions.
+ *
+ */
+FR_FORCE_INLINE __m128 fr_simd_select(__m128 mask, __m128 a, __m128 b) {
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+// x * 2^n for n in [-252, 254]. Scaling in two steps rounds results past the float range correctly to 0 or infinity.
+FR_FORCE_INLINE __m128 _fr_simd_ldexp(__m128 x, __m128i n) {
+    __m128i half = _mm_srai_epi32(n, 1);
+    __m128i bias = _mm_set1_epi32(127);
+    __m128 s0 = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(half, bias), 23));
+    __m128 s1 = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(_mm_sub_epi32(n, half), bias), 23));
+    return _mm_mul_ps(_mm_mul_ps(x, s0), s1);
+}
+
+// Splits positive x, denormals included, into x = m * 2^e with m in [sqrt(0.5), sqrt(2)). Returns m and e as a float.
+FR_FORCE_INLINE __m128 _fr_simd_frexp(__m128 x, __m128* out_e) {
+    __m128 denormal = _mm_cmplt_ps(x, _mm_set1_ps(1.17549435e-38f));
+    x = fr_simd_select(denormal, _mm_mul_ps(x, _mm_set1_ps(33554432.0f)), x);
+    __m128i bits = _mm_castps_si128(x);
+    __m128i e = _mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127));
+    e = _mm_sub_epi32(e, _mm_and_si128(_mm_castps_si128(denormal), _mm_set1_epi32(25)));
+
+    __m128i mantissa = _mm_and_si128(bits, _mm_set1_epi32(0x007FFFFF));
+    __m128 m = _mm_castsi128_ps(_mm_or_si128(mantissa, _mm_set1_epi32(0x3F800000)));
+    __m128 big = _mm_cmpgt_ps(m, _mm_set1_ps((f32)SQRT_TWO));
+    m = fr_simd_select(big, _mm_mul_ps(m, _mm_set1_ps(0.5f)), m);
+    *out_e = _mm_cvtepi32_ps(_mm_sub_epi32(e, _mm_castps_si128(big)));
+    return m;
+}
+
+// log2(1 + u) for u in [sqrt(0.5) - 1, sqrt(2) - 1], 2e-6 absolute error
+FR_FORCE_INLINE __m128 _fr_simd_log2p1_fast(__m128 u) {
+    __m128 p = fr_simd_fmadd(_mm_set1_ps(-0.20658988947433954f), u, _mm_set1_ps(0.32215431876566214f));
+    p = fr_simd_fmadd(p, u, _mm_set1_ps(-0.36749025263918245f));
+    p = fr_simd_fmadd(p, u, _mm_set1_ps(0.4793480639404292f));
+    p = fr_simd_fmadd(p, u, _mm_set1_ps(-0.7211318479451333f));
+    p = fr_simd_fmadd(p, u, _mm_set1_ps(1.4427134809110966f));
+    return _mm_mul_ps(p, u);
+}
+
+// 2^f for f in [-0.5, 0.5], 3e-6 relative error
+FR_FORCE_INLINE __m128 _fr_simd_exp2_poly_fast(__m128 f) {
+    __m128 p = fr_simd_fmadd(_mm_set1_ps(0.009681756349602158f), f, _mm_set1_ps(0.05591975023605465f));
+    p = fr_simd_fmadd(p, f, _mm_set1_ps(0.24022024331471764f));
+    p = fr_simd_fmadd(p, f, _mm_set1_ps(0.693121515844782f));
+    return fr_simd_fmadd(p, f, _mm_set1_ps(1.0f));
+}
+
+// 2^t, 0 below -150 and infinity above 128
+FR_FORCE_INLINE __m128 _fr_simd_exp2_fast(__m128 t) {
+    // The operand order of min and max keeps NaN
+    t = _mm_max_ps(_mm_set1_ps(-151.0f), _mm_min_ps(_mm_set1_ps(129.0f), t));
+    __m128i n = _mm_cvtps_epi32(t);
+    return _fr_simd_ldexp(_fr_simd_exp2_poly_fast(_mm_sub_ps(t, _mm_cvtepi32_ps(n))), n);
+}
+
+FR_FORCE_INLINE void _fr_simd_sincos(__m128 x, b8 fast, __m128* out_sin, __m128* out_cos) {
+    // x = q * pi / 2 + r with |r| <= pi / 4. pi / 2 is split into parts whose products with q are exact.
+    __m128i q = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps((f32)(2.0 * INV_PI))));
+    __m128 qf = _mm_cvtepi32_ps(q);
+    __m128 r = fr_simd_fnmadd(qf, _mm_set1_ps(1.5703125f), x);
+    __m128 s, c;
+    if (fast) {
+        // The short polynomials keep infinity infinite, sin and cos of infinity are NaN. All bits set is a NaN.
+        __m128 inf = _mm_castsi128_ps(_mm_set1_epi32(0x7F800000));
+        r = fr_simd_fnmadd(qf, _mm_set1_ps(4.8382679e-4f), r);
+        r = _mm_or_ps(r, _mm_cmpeq_ps(fr_simd_abs(x), inf));
+        __m128 z = _mm_mul_ps(r, r);
+        s = fr_simd_fmadd(_mm_set1_ps(0.008164608890986667f), z, _mm_set1_ps(-0.16663458541717838f));
+        s = fr_simd_fmadd(_mm_mul_ps(s, z), r, r);
+        c = fr_simd_fmadd(_mm_set1_ps(-0.001359782376187895f), z, _mm_set1_ps(0.041656294635450425f));
+        c = fr_simd_fmadd(c, z, _mm_set1_ps(-0.4999989478249502f));
+        c = fr_simd_fmadd(c, z, _mm_set1_ps(1.0f));
+    } else {
+        r = fr_simd_fnmadd(qf, _mm_set1_ps(4.837512969970703125e-4f), r);
+        r = fr_simd_fnmadd(qf, _mm_set1_ps(7.54978995489188216e-8f), r);
+        __m128 z = _mm_mul_ps(r, r);
+        s = fr_simd_fmadd(_mm_set1_ps(-1.9515295891e-4f), z, _mm_set1_ps(8.3321608736e-3f));
+        s = fr_simd_fmadd(s, z, _mm_set1_ps(-1.6666654611e-1f));
+        s = fr_simd_fmadd(_mm_mul_ps(s, z), r, r);
+        c = fr_simd_fmadd(_mm_set1_ps(2.443315711809948e-5f), z, _mm_set1_ps(-1.388731625493765e-3f));
+        c = fr_simd_fmadd(c, z, _mm_set1_ps(4.166664568298827e-2f));
+        c = fr_simd_fmadd(_mm_mul_ps(c, z), z, fr_simd_fnmadd(_mm_set1_ps(0.5f), z, _mm_set1_ps(1.0f)));
+    }
+
+    // Odd quadrants swap sin and cos, the sign of sin flips in quadrants 2 and 3 and that of cos in 1 and 2
+    __m128i one = _mm_set1_epi32(1);
+    __m128i two = _mm_set1_epi32(2);
+    __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(q, one), one));
+    __m128 sin_sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(q, two), 30));
+    __m128 cos_sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(q, one), two), 30));
+    // The polynomial turns -0 into +0. sin is only exactly 0 at x = +-0, where it keeps the sign of x.
+    *out_sin = _mm_xor_ps(fr_simd_select(swap, c, s), sin_sign);
+    *out_sin = _mm_or_ps(*out_sin, _mm_and_ps(_mm_cmpeq_ps(x, _mm_setzero_ps()), x));
+    *out_cos = _mm_xor_ps(fr_simd_select(swap, s, c), cos_sign);
+}
+
+FR_FORCE_INLINE __m128 _fr_simd_exp(__m128 x, b8 fast) {
+    // The operand order of min and max keeps NaN
+    x = _mm_max_ps(_mm_set1_ps(-104.0f), _mm_min_ps(_mm_set1_ps(89.0f), x));
+    __m128i n = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps((f32)INV_LOG_TWO_BASE_E)));
+    __m128 nf = _mm_cvtepi32_ps(n);
+    // x - n * log(2) with log(2) split in two, so that e^x = 2^n * e^r and |r| <= log(2) / 2
+    __m128 r = fr_simd_fnmadd(nf, _mm_set1_ps(0.693359375f), x);
+    r = fr_simd_fnmadd(nf, _mm_set1_ps(-2.12194440e-4f), r);
+    __m128 p;
+    if (fast) {
+        p = _fr_simd_exp2_poly_fast(_mm_mul_ps(r, _mm_set1_ps((f32)INV_LOG_TWO_BASE_E)));
+    } else {
+        p = fr_simd_fmadd(_mm_set1_ps(1.9875691500e-4f), r, _mm_set1_ps(1.3981999507e-3f));
+        p = fr_simd_fmadd(p, r, _mm_set1_ps(8.3334519073e-3f));
+        p = fr_simd_fmadd(p, r, _mm_set1_ps(4.1665795894e-2f));
+        p = fr_simd_fmadd(p, r, _mm_set1_ps(1.6666665459e-1f));
+        p = fr_simd_fmadd(p, r, _mm_set1_ps(5.0000001201e-1f));
+        p = fr_simd_fmadd(p, _mm_mul_ps(r, r), _mm_add_ps(r, _mm_set1_ps(1.0f)));
+    }
+    return _fr_simd_ldexp(p, n);
+}
+
+FR_FORCE_INLINE __m128 _fr_simd_log(__m128 x, b8 fast) {
+    __m128 e;
+    __m128 u = _mm_sub_ps(_fr_simd_frexp(x, &e), _mm_set1_ps(1.0f));
+    __m128 r;
+    if (fast) {
+        __m128 ln2 = _mm_set1_ps((f32)LOG_TWO_BASE_E);
+        r = fr_simd_fmadd(e, ln2, _mm_mul_ps(_fr_simd_log2p1_fast(u), ln2));
+    } else {
+        __m128 p = fr_simd_fmadd(_mm_set1_ps(7.0376836292e-2f), u, _mm_set1_ps(-1.1514610310e-1f));
+        p = fr_simd_fmadd(p, u, _mm_set1_ps(1.1676998740e-1f));
+        p = fr_simd_fmadd(p, u, _mm_set1_ps(-1.2420140846e-1f));
+        p = fr_simd_fmadd(p, u, _mm_set1_ps(1.4249322787e-1f));
+        p = fr_simd_fmadd(p, u, _mm_set1_ps(-1.6668057665e-1f));
+        p = fr_simd_fmadd(p, u, _mm_set1_ps(2.0000714765e-1f));
+        p = fr_simd_fmadd(p, u, _mm_set1_ps(-2.4999993993e-1f));
+        p = fr_simd_fmadd(p, u, _mm_set1_ps(3.3333331174e-1f));
+        __m128 z = _mm_mul_ps(u, u);
+        // log(2) is split in two so that e * log(2) adds no rounding error
+        __m128 y = fr_simd_fmadd(e, _mm_set1_ps(-2.12194440e-4f), _mm_mul_ps(_mm_mul_ps(p, u), z));
+        y = fr_simd_fnmadd(_mm_set1_ps(0.5f), z, y);
+        r = fr_simd_fmadd(e, _mm_set1_ps(0.693359375f), _mm_add_ps(u, y));
+    }
+    __m128 inf = _mm_castsi128_ps(_mm_set1_epi32(0x7F800000));
+    r = fr_simd_select(_mm_cmpeq_ps(x, _mm_setzero_ps()), _mm_xor_ps(inf, FR_SIGN_BITf32x4), r);
+    r = fr_simd_select(_mm_cmpeq_ps(x, inf), x, r);
+    // Negative numbers and NaN, all bits set is a NaN
+    return _mm_or_ps(r, _mm_cmpnge_ps(x, _mm_setzero_ps()));
+}
+
+FR_FORCE_INLINE __m128 _fr_simd_atan2(__m128 y, __m128 x, b8 fast) {
+    __m128 ax = fr_simd_abs(x);
+    __m128 ay = fr_simd_abs(y);
+    __m128 lo = _mm_min_ps(ax, ay);
+    __m128 hi = _mm_max_ps(ax, ay);
+    // atan of a in [0, 1]. Both zero gives 0 and both infinite 1.
+    __m128 a = fr_simd_select(_mm_cmpeq_ps(lo, hi),
+                              _mm_and_ps(_mm_cmpneq_ps(hi, _mm_setzero_ps()), _mm_set1_ps(1.0f)),
+                              _mm_div_ps(lo, hi));
+    __m128 r;
+    if (fast) {
+        __m128 z = _mm_mul_ps(a, a);
+        __m128 p = fr_simd_fmadd(_mm_set1_ps(-0.011719123154470826f), z, _mm_set1_ps(0.052647329870010084f));
+        p = fr_simd_fmadd(p, z, _mm_set1_ps(-0.1164264781830172f));
+        p = fr_simd_fmadd(p, z, _mm_set1_ps(0.19354038585723182f));
+        p = fr_simd_fmadd(p, z, _mm_set1_ps(-0.3326228329836512f));
+        p = fr_simd_fmadd(p, z, _mm_set1_ps(0.9999772196789498f));
+        r = _mm_mul_ps(p, a);
+    } else {
+        // Past tan(pi / 8), atan(a) = pi / 4 + atan((a - 1) / (a + 1))
+        __m128 big = _mm_cmpgt_ps(a, _mm_set1_ps(0.4142135623730950f));
+        __m128 one = _mm_set1_ps(1.0f);
+        __m128 t = fr_simd_select(big, _mm_div_ps(_mm_sub_ps(a, one), _mm_add_ps(a, one)), a);
+        __m128 z = _mm_mul_ps(t, t);
+        __m128 p = fr_simd_fmadd(_mm_set1_ps(8.05374449538e-2f), z, _mm_set1_ps(-1.38776856032e-1f));
+        p = fr_simd_fmadd(p, z, _mm_set1_ps(1.99777106478e-1f));
+        p = fr_simd_fmadd(p, z, _mm_set1_ps(-3.33329491539e-1f));
+        r = fr_simd_fmadd(_mm_mul_ps(p, z), t, t);
+        r = _mm_add_ps(r, _mm_and_ps(big, _mm_set1_ps((f32)PI_4)));
+    }
+    r = fr_simd_select(_mm_cmpgt_ps(ay, ax), _mm_sub_ps(_mm_set1_ps((f32)PI_2), r), r);
+    r = fr_simd_select(_mm_castsi128_ps(_mm_srai_epi32(_mm_castps_si128(x), 31)), _mm_sub_ps(_mm_set1_ps(F_PI), r), r);
+    r = _mm_or_ps(r, _mm_and_ps(y, FR_SIGN_BITf32x4));
+    return _mm_or_ps(r, _mm_cmpunord_ps(x, y));
+}
+
+// a * b + c on two doubles
+FR_FORCE_INLINE __m128d _fr_simd_fmadd_pd(__m128d a, __m128d b, __m128d c) { return _mm_add_pd(_mm_mul_pd(a, b), c); }
+
+// log2 of two doubles in [sqrt(0.5), sqrt(2)) from the series of atanh, 1e-12 relative error. The series is evaluated
+// in independent halves, pow is bound by the latency of these polynomials.
+FR_FORCE_INLINE __m128d _fr_simd_log2_pd(__m128d m) {
+    __m128d one = _mm_set1_pd(1.0);
+    __m128d s = _mm_div_pd(_mm_sub_pd(m, one), _mm_add_pd(m, one));
+    __m128d z = _mm_mul_pd(s, s);
+    __m128d z2 = _mm_mul_pd(z, z);
+    __m128d lo = _fr_simd_fmadd_pd(_mm_set1_pd(1.0 / 3.0), z, one);
+    lo = _fr_simd_fmadd_pd(_fr_simd_fmadd_pd(_mm_set1_pd(1.0 / 7.0), z, _mm_set1_pd(1.0 / 5.0)), z2, lo);
+    __m128d hi = _fr_simd_fmadd_pd(_mm_set1_pd(1.0 / 11.0), z, _mm_set1_pd(1.0 / 9.0));
+    hi = _fr_simd_fmadd_pd(_mm_set1_pd(1.0 / 13.0), z2, hi);
+    __m128d p = _fr_simd_fmadd_pd(hi, _mm_mul_pd(z2, z2), lo);
+    return _mm_mul_pd(_mm_mul_pd(p, s), _mm_set1_pd(2.0 * INV_LOG_TWO_BASE_E));
+}
+
+// 2^t of two doubles clamped to [-160, 130], enough for any float result, 1e-11 relative error
+FR_FORCE_INLINE __m128d _fr_simd_exp2_pd(__m128d t) {
+    t = _mm_max_pd(_mm_set1_pd(-160.0), _mm_min_pd(_mm_set1_pd(130.0), t));
+    __m128i n = _mm_cvtpd_epi32(t);
+    __m128d f = _mm_mul_pd(_mm_sub_pd(t, _mm_cvtepi32_pd(n)), _mm_set1_pd(LOG_TWO_BASE_E));
+    // Taylor series of e^f for |f| <= log(2) / 2, in pairs of terms
+    __m128d f2 = _mm_mul_pd(f, f);
+    __m128d f4 = _mm_mul_pd(f2, f2);
+    __m128d p0 = _fr_simd_fmadd_pd(_mm_set1_pd(1.0), f, _mm_set1_pd(1.0));
+    __m128d p1 = _fr_simd_fmadd_pd(_mm_set1_pd(1.0 / 6.0), f, _mm_set1_pd(1.0 / 2.0));
+    __m128d p2 = _fr_simd_fmadd_pd(_mm_set1_pd(1.0 / 120.0), f, _mm_set1_pd(1.0 / 24.0));
+    __m128d p3 = _fr_simd_fmadd_pd(_mm_set1_pd(1.0 / 5040.0), f, _mm_set1_pd(1.0 / 720.0));
+    __m128d p4 = _fr_simd_fmadd_pd(_mm_set1_pd(1.0 / 362880.0), f, _mm_set1_pd(1.0 / 40320.0));
+    __m128d p = _fr_simd_fmadd_pd(_fr_simd_fmadd_pd(p3, f2, p2), f4, _fr_simd_fmadd_pd(p1, f2, p0));
+    p = _fr_simd_fmadd_pd(p4, _mm_mul_pd(f4, f4), p);
+    __m128i e = _mm_unpacklo_epi32(_mm_add_epi32(n, _mm_set1_epi32(1023)), _mm_setzero_si128());
+    return _mm_mul_pd(p, _mm_castsi128_pd(_mm_slli_epi64(e, 52)));
+}
+
+FR_FORCE_INLINE __m128 _fr_simd_pow(__m128 x, __m128 y, b8 fast) {
+    __m128 ax = fr_simd_abs(x);
+    __m128 e;
+    __m128 m = _fr_simd_frexp(ax, &e);
+    __m128 r;
+    if (fast) {
+        r = _fr_simd_exp2_fast(_mm_mul_ps(y, _mm_add_ps(e, _fr_simd_log2p1_fast(_mm_sub_ps(m, _mm_set1_ps(1.0f))))));
+    } else {
+        // y * log2(x) is needed to 1e-10 for a result within 1 ulp, which takes double precision
+        __m128d t0 = _mm_add_pd(_mm_cvtps_pd(e), _fr_simd_log2_pd(_mm_cvtps_pd(m)));
+        __m128d t1 = _mm_add_pd(_mm_cvtps_pd(_mm_movehl_ps(e, e)), _fr_simd_log2_pd(_mm_cvtps_pd(_mm_movehl_ps(m, m))));
+        __m128d r0 = _fr_simd_exp2_pd(_mm_mul_pd(t0, _mm_cvtps_pd(y)));
+        __m128d r1 = _fr_simd_exp2_pd(_mm_mul_pd(t1, _mm_cvtps_pd(_mm_movehl_ps(y, y))));
+        r = _mm_movelh_ps(_mm_cvtpd_ps(r0), _mm_cvtpd_ps(r1));
+    }
+
+    // 0 and infinity raised to a positive power stay as they are, to a negative one they swap
+    __m128 inf = _mm_castsi128_ps(_mm_set1_epi32(0x7F800000));
+    __m128 ax_inf = _mm_cmpeq_ps(ax, inf);
+    __m128 extreme = _mm_or_ps(ax_inf, _mm_cmpeq_ps(ax, _mm_setzero_ps()));
+    __m128 to_inf = _mm_xor_ps(ax_inf, _mm_cmplt_ps(y, _mm_setzero_ps()));
+    r = fr_simd_select(extreme, _mm_and_ps(to_inf, inf), r);
+
+    // A negative base has a real power only for integer exponents, negative when the exponent is odd. Floats past 2^24
+    // are all even integers.
+    __m128 large = _mm_cmpge_ps(fr_simd_abs(y), _mm_set1_ps(16777216.0f));
+    __m128i yi = _mm_cvttps_epi32(y);
+    __m128 is_int = _mm_or_ps(large, _mm_cmpeq_ps(_mm_cvtepi32_ps(yi), y));
+    __m128 odd = _mm_andnot_ps(large, _mm_castsi128_ps(_mm_slli_epi32(yi, 31)));
+    __m128 one = _mm_set1_ps(1.0f);
+    r = fr_simd_select(_mm_cmpeq_ps(ax, one), one, r);
+    r = _mm_xor_ps(r, _mm_and_ps(_mm_and_ps(x, FR_SIGN_BITf32x4), odd));
+    r = _mm_or_ps(r, _mm_andnot_ps(_mm_or_ps(is_int, ax_inf), _mm_cmplt_ps(x, _mm_setzero_ps())));
+
+    r = _mm_or_ps(r, _mm_cmpunord_ps(x, y));
+    // pow(x, 0) and pow(1, y) are 1 even for NaN
+    return fr_simd_select(_mm_or_ps(_mm_cmpeq_ps(y, _mm_setzero_ps()), _mm_cmpeq_ps(x, one)), one, r);
+}
+
+/**
+ * @brief Sine of 4 floats, within 1e-7 for |x| < 8192.
+ *
+ */
+FR_FORCE_INLINE __m128 fr_simd_sin(__m128 x) {
+    __m128 s, c;
+    _fr_simd_sincos(x, FALSE, &s, &c);
+    return s;
+}
+
+/**
+ * @brief Sine of 4 floats, within 1.5e-6.
+ *
+ */
+FR_FORCE_INLINE __m128 fr_simd_sin_fast(__m128 x) {
+    __m128 s, c;
+    _fr_simd_sincos(x, TRUE, &s, &c);
+    return s;
+}
+
+/**
+ * @brief Cosine of 4 floats, within 1e-7 for |x| < 8192.
+ *
+ */
+FR_FORCE_INLINE __m128 fr_simd_cos(__m128 x) {
+    __m128 s, c;
+    _fr_simd_sincos(x, FALSE, &s, &c);
+    return c;
+}
+
+/**
+ * @brief Cosine of 4 floats, within 1.5e-6.
+ *
+ */
+FR_FORCE_INLINE __m128 fr_simd_cos_fast(__m128 x) {
+    __m128 s, c;
+    _fr_simd_sincos(x, TRUE, &s, &c);
+    return c;
+}
+
+/**
+ * @brief Sine and cosine of 4 floats for little more than the cost of one, within 1e-7 for |x| < 8192.
+ *
+ */
+FR_FORCE_INLINE void fr_simd_sincos(__m128 x, __m128* out_sin, __m128* out_cos) {
+    _fr_simd_sincos(x, FALSE, out_sin, out_cos);
+}
+
+/**
+ * @brief Sine and cosine of 4 floats, within 1.5e-6.
+ *
+ */
+FR_FORCE_INLINE void fr_simd_sincos_fast(__m128 x, __m128* out_sin, __m128* out_cos) {
+    _fr_simd_sincos(x, TRUE, out_sin, out_cos);
+}
+
+/**
+ * @brief e^x of 4 floats, within 1.5 ulp.
+ *
+ */
+FR_FORCE_INLINE __m128 fr_simd_exp(__m128 x) { return _fr_simd_exp(x, FALSE); }
+
+/**
+ * @brief e^x of 4 floats, within 4e-6 relative.
+ *
+ */
+FR_FORCE_INLINE __m128 fr_simd_exp_fast(__m128 x) { return _fr_simd_exp(x, TRUE); }
+
+/**
+ * @brief Natural logarithm of 4 floats, within 1 ulp.
+ *
+ */
+FR_FORCE_INLINE __m128 fr_simd_log(__m128 x) { return _fr_simd_log(x, FALSE); }
+
+/**
+ * @brief Natural logarithm of 4 floats, within 2e-6 or 2e-7 relative.
+ *
+ */
+FR_FORCE_INLINE __m128 fr_simd_log_fast(__m128 x) { return _fr_simd_log(x, TRUE); }
+
+/**
+ * @brief Angle of the points (x, y) in [-pi, pi], within 3 ulp.
+ *
+ */
+FR_FORCE_INLINE __m128 fr_simd_atan2(__m128 y, __m128 x) { return _fr_simd_atan2(y, x, FALSE); }
+
+/**
+ * @brief Angle of the points (x, y) in [-pi, pi], within 2e-6.
+ *
+ */
+FR_FORCE_INLINE __m128 fr_simd_atan2_fast(__m128 y, __m128 x) { return _fr_simd_atan2(y, x, TRUE); }
+
+/**
+ * @brief x^y of 4 pairs of floats, within 1 ulp.
+ *
+ */
+FR_FORCE_INLINE __m128 fr_simd_pow(__m128 x, __m128 y) { return _fr_simd_pow(x, y, FALSE); }
+
+/**
+ * @brief x^y of 4 pairs of floats, within 3e-6 + 5e-7 * |y * log2(x)| relative.
+ *
+ */
+FR_FORCE_INLINE __m128 fr_simd_pow_fast(__m128 x, __m128 y) { return _fr_simd_pow(x, y, TRUE); }
+
+#endif
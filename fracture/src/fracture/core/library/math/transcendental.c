@@ -0,0 +1,322 @@
+#include "transcendental.h"
+
+#include "simd/avx_math.h"
+#include "simd/dispatch.h"
+#include "simd/sse_math.h"
+#include "utils.h"
+
+// The functions of the kernels. Every fast function follows the precise one so that adding the accuracy selects it.
+typedef enum transcendental_op {
+    TRANSCENDENTAL_SIN = 0,
+    TRANSCENDENTAL_SIN_FAST,
+    TRANSCENDENTAL_COS,
+    TRANSCENDENTAL_COS_FAST,
+    TRANSCENDENTAL_SINCOS,
+    TRANSCENDENTAL_SINCOS_FAST,
+    TRANSCENDENTAL_EXP,
+    TRANSCENDENTAL_EXP_FAST,
+    TRANSCENDENTAL_LOG,
+    TRANSCENDENTAL_LOG_FAST,
+    TRANSCENDENTAL_ATAN2,
+    TRANSCENDENTAL_ATAN2_FAST,
+    TRANSCENDENTAL_POW,
+    TRANSCENDENTAL_POW_FAST,
+} transcendental_op;
+
+// Evaluates op on count values. a holds the argument, or the first of atan2 and pow whose second is in b. Functions
+// of one argument get a in b as well. The cosines of sincos go to out_cos.
+typedef void (*PFN_transcendental)(transcendental_op op, const f32* a, const f32* b, f32* out, f32* out_cos, u32 count);
+
+//--------------------------------------------------------------------------------------------
+// Scalar kernel, the C library through the wrappers of utils.h. It has a single accuracy.
+//--------------------------------------------------------------------------------------------
+
+static void _transcendental_scalar(
+    transcendental_op op, const f32* a, const f32* b, f32* out, f32* out_cos, u32 count) {
+    for (u32 i = 0; i < count; ++i) {
+        f32 v = a[i];
+        switch (op) {
+            case TRANSCENDENTAL_SIN:
+            case TRANSCENDENTAL_SIN_FAST:
+                out[i] = fr_sin(v);
+                break;
+            case TRANSCENDENTAL_COS:
+            case TRANSCENDENTAL_COS_FAST:
+                out[i] = fr_cos(v);
+                break;
+            case TRANSCENDENTAL_SINCOS:
+            case TRANSCENDENTAL_SINCOS_FAST:
+                out[i] = fr_sin(v);
+                out_cos[i] = fr_cos(v);
+                break;
+            case TRANSCENDENTAL_EXP:
+            case TRANSCENDENTAL_EXP_FAST:
+                out[i] = fr_exp(v);
+                break;
+            case TRANSCENDENTAL_LOG:
+            case TRANSCENDENTAL_LOG_FAST:
+                out[i] = fr_log(v);
+                break;
+            case TRANSCENDENTAL_ATAN2:
+            case TRANSCENDENTAL_ATAN2_FAST:
+                out[i] = fr_atan2(v, b[i]);
+                break;
+            case TRANSCENDENTAL_POW:
+            case TRANSCENDENTAL_POW_FAST:
+                out[i] = fr_pow(v, b[i]);
+                break;
+        }
+    }
+}
+
+#if FR_SIMD == 1
+
+// Calls loop with every op as a constant, so that the switch on the op inside the loop folds away and each function
+// gets a loop of its own
+#define TRANSCENDENTAL_DISPATCH(loop, op, ...)             \
+    switch (op) {                                          \
+        case TRANSCENDENTAL_SIN:                           \
+            loop(TRANSCENDENTAL_SIN, __VA_ARGS__);         \
+            break;                                         \
+        case TRANSCENDENTAL_SIN_FAST:                      \
+            loop(TRANSCENDENTAL_SIN_FAST, __VA_ARGS__);    \
+            break;                                         \
+        case TRANSCENDENTAL_COS:                           \
+            loop(TRANSCENDENTAL_COS, __VA_ARGS__);         \
+            break;                                         \
+        case TRANSCENDENTAL_COS_FAST:                      \
+            loop(TRANSCENDENTAL_COS_FAST, __VA_ARGS__);    \
+            break;                                         \
+        case TRANSCENDENTAL_SINCOS:                        \
+            loop(TRANSCENDENTAL_SINCOS, __VA_ARGS__);      \
+            break;                                         \
+        case TRANSCENDENTAL_SINCOS_FAST:                   \
+            loop(TRANSCENDENTAL_SINCOS_FAST, __VA_ARGS__); \
+            break;                                         \
+        case TRANSCENDENTAL_EXP:                           \
+            loop(TRANSCENDENTAL_EXP, __VA_ARGS__);         \
+            break;                                         \
+        case TRANSCENDENTAL_EXP_FAST:                      \
+            loop(TRANSCENDENTAL_EXP_FAST, __VA_ARGS__);    \
+            break;                                         \
+        case TRANSCENDENTAL_LOG:                           \
+            loop(TRANSCENDENTAL_LOG, __VA_ARGS__);         \
+            break;                                         \
+        case TRANSCENDENTAL_LOG_FAST:                      \
+            loop(TRANSCENDENTAL_LOG_FAST, __VA_ARGS__);    \
+            break;                                         \
+        case TRANSCENDENTAL_ATAN2:                         \
+            loop(TRANSCENDENTAL_ATAN2, __VA_ARGS__);       \
+            break;                                         \
+        case TRANSCENDENTAL_ATAN2_FAST:                    \
+            loop(TRANSCENDENTAL_ATAN2_FAST, __VA_ARGS__);  \
+            break;                                         \
+        case TRANSCENDENTAL_POW:                           \
+            loop(TRANSCENDENTAL_POW, __VA_ARGS__);         \
+            break;                                         \
+        case TRANSCENDENTAL_POW_FAST:                      \
+            loop(TRANSCENDENTAL_POW_FAST, __VA_ARGS__);    \
+            break;                                         \
+    }
+
+//--------------------------------------------------------------------------------------------
+// SSE2 kernel, 4 values per iteration
+//--------------------------------------------------------------------------------------------
+
+FR_FORCE_INLINE __m128 _transcendental_op_sse(transcendental_op op, __m128 a, __m128 b, __m128* out_cos) {
+    __m128 s;
+    switch (op) {
+        case TRANSCENDENTAL_SIN:
+            return fr_simd_sin(a);
+        case TRANSCENDENTAL_SIN_FAST:
+            return fr_simd_sin_fast(a);
+        case TRANSCENDENTAL_COS:
+            return fr_simd_cos(a);
+        case TRANSCENDENTAL_COS_FAST:
+            return fr_simd_cos_fast(a);
+        case TRANSCENDENTAL_SINCOS:
+            fr_simd_sincos(a, &s, out_cos);
+            return s;
+        case TRANSCENDENTAL_SINCOS_FAST:
+            fr_simd_sincos_fast(a, &s, out_cos);
+            return s;
+        case TRANSCENDENTAL_EXP:
+            return fr_simd_exp(a);
+        case TRANSCENDENTAL_EXP_FAST:
+            return fr_simd_exp_fast(a);
+        case TRANSCENDENTAL_LOG:
+            return fr_simd_log(a);
+        case TRANSCENDENTAL_LOG_FAST:
+            return fr_simd_log_fast(a);
+        case TRANSCENDENTAL_ATAN2:
+            return fr_simd_atan2(a, b);
+        case TRANSCENDENTAL_ATAN2_FAST:
+            return fr_simd_atan2_fast(a, b);
+        case TRANSCENDENTAL_POW:
+            return fr_simd_pow(a, b);
+        case TRANSCENDENTAL_POW_FAST:
+            return fr_simd_pow_fast(a, b);
+    }
+    return a;
+}
+
+FR_FORCE_INLINE void _transcendental_loop_sse(
+    transcendental_op op, const f32* a, const f32* b, f32* out, f32* out_cos, u32 count) {
+    b8 sincos = op == TRANSCENDENTAL_SINCOS || op == TRANSCENDENTAL_SINCOS_FAST;
+    __m128 c = _mm_setzero_ps();
+    u32 i = 0;
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(out + i, _transcendental_op_sse(op, _mm_loadu_ps(a + i), _mm_loadu_ps(b + i), &c));
+        if (sincos) {
+            _mm_storeu_ps(out_cos + i, c);
+        }
+    }
+
+    if (i < count) {
+        f32 tail_a[4] = {0};
+        f32 tail_b[4] = {0};
+        f32 tail_out[4];
+        f32 tail_cos[4];
+        for (u32 j = 0; j < count - i; ++j) {
+            tail_a[j] = a[i + j];
+            tail_b[j] = b[i + j];
+        }
+        _mm_storeu_ps(tail_out, _transcendental_op_sse(op, _mm_loadu_ps(tail_a), _mm_loadu_ps(tail_b), &c));
+        _mm_storeu_ps(tail_cos, c);
+        for (u32 j = 0; j < count - i; ++j) {
+            out[i + j] = tail_out[j];
+            if (sincos) {
+                out_cos[i + j] = tail_cos[j];
+            }
+        }
+    }
+}
+
+static void _transcendental_sse(transcendental_op op, const f32* a, const f32* b, f32* out, f32* out_cos, u32 count) {
+    TRANSCENDENTAL_DISPATCH(_transcendental_loop_sse, op, a, b, out, out_cos, count)
+}
+
+//--------------------------------------------------------------------------------------------
+// AVX2 kernel, 8 values per iteration
+//--------------------------------------------------------------------------------------------
+
+FR_SIMD256_INLINE __m256 _transcendental_op_avx2(transcendental_op op, __m256 a, __m256 b, __m256* out_cos) {
+    __m256 s;
+    switch (op) {
+        case TRANSCENDENTAL_SIN:
+            return fr_simd256_sin(a);
+        case TRANSCENDENTAL_SIN_FAST:
+            return fr_simd256_sin_fast(a);
+        case TRANSCENDENTAL_COS:
+            return fr_simd256_cos(a);
+        case TRANSCENDENTAL_COS_FAST:
+            return fr_simd256_cos_fast(a);
+        case TRANSCENDENTAL_SINCOS:
+            fr_simd256_sincos(a, &s, out_cos);
+            return s;
+        case TRANSCENDENTAL_SINCOS_FAST:
+            fr_simd256_sincos_fast(a, &s, out_cos);
+            return s;
+        case TRANSCENDENTAL_EXP:
+            return fr_simd256_exp(a);
+        case TRANSCENDENTAL_EXP_FAST:
+            return fr_simd256_exp_fast(a);
+        case TRANSCENDENTAL_LOG:
+            return fr_simd256_log(a);
+        case TRANSCENDENTAL_LOG_FAST:
+            return fr_simd256_log_fast(a);
+        case TRANSCENDENTAL_ATAN2:
+            return fr_simd256_atan2(a, b);
+        case TRANSCENDENTAL_ATAN2_FAST:
+            return fr_simd256_atan2_fast(a, b);
+        case TRANSCENDENTAL_POW:
+            return fr_simd256_pow(a, b);
+        case TRANSCENDENTAL_POW_FAST:
+            return fr_simd256_pow_fast(a, b);
+    }
+    return a;
+}
+
+FR_SIMD256_INLINE void _transcendental_loop_avx2(
+    transcendental_op op, const f32* a, const f32* b, f32* out, f32* out_cos, u32 count) {
+    b8 sincos = op == TRANSCENDENTAL_SINCOS || op == TRANSCENDENTAL_SINCOS_FAST;
+    __m256 c = _mm256_setzero_ps();
+    u32 i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(out + i, _transcendental_op_avx2(op, _mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), &c));
+        if (sincos) {
+            _mm256_storeu_ps(out_cos + i, c);
+        }
+    }
+
+    if (i < count) {
+        // The lanes past the end are loaded as 0, which every function accepts
+        __m256i mask = fr_simd256_tail_mask(count - i);
+        __m256 r = _transcendental_op_avx2(op, _mm256_maskload_ps(a + i, mask), _mm256_maskload_ps(b + i, mask), &c);
+        _mm256_maskstore_ps(out + i, mask, r);
+        if (sincos) {
+            _mm256_maskstore_ps(out_cos + i, mask, c);
+        }
+    }
+}
+
+static FR_TARGET_AVX2_FMA void _transcendental_avx2(
+    transcendental_op op, const f32* a, const f32* b, f32* out, f32* out_cos, u32 count) {
+    TRANSCENDENTAL_DISPATCH(_transcendental_loop_avx2, op, a, b, out, out_cos, count)
+}
+
+#endif
+
+//--------------------------------------------------------------------------------------------
+// Dispatch
+//--------------------------------------------------------------------------------------------
+
+// AVX-512 runs the AVX2 kernel. The double precision steps of pow and the blends would have to be rewritten around
+// mask registers, which is left for when a profile asks for it.
+static const PFN_transcendental transcendental_kernels[FR_SIMD_LEVEL_MAX] = {
+    [FR_SIMD_LEVEL_SCALAR] = _transcendental_scalar,
+#if FR_SIMD == 1
+    [FR_SIMD_LEVEL_SSE2] = _transcendental_sse,
+    [FR_SIMD_LEVEL_AVX2] = _transcendental_avx2,
+    [FR_SIMD_LEVEL_AVX512] = _transcendental_avx2,
+#endif
+};
+
+static void _transcendental(transcendental_op op,
+                            math_accuracy accuracy,
+                            const f32* a,
+                            const f32* b,
+                            f32* out,
+                            f32* out_cos,
+                            u32 count) {
+    op += accuracy == FR_MATH_ACCURACY_FAST ? 1 : 0;
+    transcendental_kernels[fr_simd_get_level()](op, a, b, out, out_cos, count);
+}
+
+void fr_sin_array(const f32* x, f32* out, u32 count, math_accuracy accuracy) {
+    _transcendental(TRANSCENDENTAL_SIN, accuracy, x, x, out, NULL_PTR, count);
+}
+
+void fr_cos_array(const f32* x, f32* out, u32 count, math_accuracy accuracy) {
+    _transcendental(TRANSCENDENTAL_COS, accuracy, x, x, out, NULL_PTR, count);
+}
+
+void fr_sincos_array(const f32* x, f32* out_sin, f32* out_cos, u32 count, math_accuracy accuracy) {
+    _transcendental(TRANSCENDENTAL_SINCOS, accuracy, x, x, out_sin, out_cos, count);
+}
+
+void fr_exp_array(const f32* x, f32* out, u32 count, math_accuracy accuracy) {
+    _transcendental(TRANSCENDENTAL_EXP, accuracy, x, x, out, NULL_PTR, count);
+}
+
+void fr_log_array(const f32* x, f32* out, u32 count, math_accuracy accuracy) {
+    _transcendental(TRANSCENDENTAL_LOG, accuracy, x, x, out, NULL_PTR, count);
+}
+
+void fr_atan2_array(const f32* y, const f32* x, f32* out, u32 count, math_accuracy accuracy) {
+    _transcendental(TRANSCENDENTAL_ATAN2, accuracy, y, x, out, NULL_PTR, count);
+}
+
+void fr_pow_array(const f32* base, const f32* exponent, f32* out, u32 count, math_accuracy accuracy) {
+    _transcendental(TRANSCENDENTAL_POW, accuracy, base, exponent, out, NULL_PTR, count);
+}
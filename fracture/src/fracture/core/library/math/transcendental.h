@@ -0,0 +1,106 @@
+/**
+ * @file transcendental.h
+ * @author Aditya Rajagopal
+ * @brief Transcendental functions of arrays of floats.
+ * @details fr_sin, fr_exp and the other wrappers in utils.h call the C library one value at a time. Animation curves,
+ * particle systems and procedural noise evaluate the same function over thousands of values, which these functions do
+ * 4 or 8 at a time with the polynomial approximations of simd/sse_math.h and simd/avx_math.h, picking the instruction
+ * set with fr_simd_get_level. The scalar level and builds without _SIMD fall back to the C library.
+ *
+ * Each function takes the accuracy to compute with. FR_MATH_ACCURACY_PRECISE is within a few ulp, close to the C
+ * library, and FR_MATH_ACCURACY_FAST keeps about 6 correct digits for roughly half the cost. The bounds of every
+ * function are listed in sse_math.h. Counts need not be multiples of the vector width and the arrays need no particular
+ * alignment. The outputs may be the same arrays as the inputs but must not partially overlap them.
+ * @version 0.0.1
+ * @date 2024-04-28
+ *
+ * @copyright Fracture Game Engine is Copyright (c) Aditya Rajagopal 2024-2024
+ *
+ */
+#pragma once
+
+#include "fracture/core/defines.h"
+
+/**
+ * @brief Accuracy of the array functions.
+ *
+ */
+typedef enum math_accuracy {
+    /** @brief Within a few ulp of the correctly rounded result */
+    FR_MATH_ACCURACY_PRECISE = 0,
+    /** @brief About 6 correct digits with shorter polynomials */
+    FR_MATH_ACCURACY_FAST,
+} math_accuracy;
+
+/**
+ * @brief Computes the sines of an array of angles. The precise version is accurate for |x| < 8192.
+ *
+ * @param x The angles in radians
+ * @param out The sines
+ * @param count The number of angles
+ * @param accuracy The accuracy to compute with
+ */
+FR_API void fr_sin_array(const f32* x, f32* out, u32 count, math_accuracy accuracy);
+
+/**
+ * @brief Computes the cosines of an array of angles. The precise version is accurate for |x| < 8192.
+ *
+ * @param x The angles in radians
+ * @param out The cosines
+ * @param count The number of angles
+ * @param accuracy The accuracy to compute with
+ */
+FR_API void fr_cos_array(const f32* x, f32* out, u32 count, math_accuracy accuracy);
+
+/**
+ * @brief Computes the sines and cosines of an array of angles for little more than the cost of either.
+ *
+ * @param x The angles in radians
+ * @param out_sin The sines
+ * @param out_cos The cosines
+ * @param count The number of angles
+ * @param accuracy The accuracy to compute with
+ */
+FR_API void fr_sincos_array(const f32* x, f32* out_sin, f32* out_cos, u32 count, math_accuracy accuracy);
+
+/**
+ * @brief Computes e raised to an array of values.
+ *
+ * @param x The exponents
+ * @param out The powers of e
+ * @param count The number of values
+ * @param accuracy The accuracy to compute with
+ */
+FR_API void fr_exp_array(const f32* x, f32* out, u32 count, math_accuracy accuracy);
+
+/**
+ * @brief Computes the natural logarithms of an array of values.
+ *
+ * @param x The values
+ * @param out The logarithms
+ * @param count The number of values
+ * @param accuracy The accuracy to compute with
+ */
+FR_API void fr_log_array(const f32* x, f32* out, u32 count, math_accuracy accuracy);
+
+/**
+ * @brief Computes the angles of an array of points in [-pi, pi], like fr_atan2.
+ *
+ * @param y The y coordinates of the points
+ * @param x The x coordinates of the points
+ * @param out The angles
+ * @param count The number of points
+ * @param accuracy The accuracy to compute with
+ */
+FR_API void fr_atan2_array(const f32* y, const f32* x, f32* out, u32 count, math_accuracy accuracy);
+
+/**
+ * @brief Raises an array of bases to an array of exponents, like fr_pow.
+ *
+ * @param base The bases
+ * @param exponent The exponents
+ * @param out The powers
+ * @param count The number of pairs
+ * @param accuracy The accuracy to compute with
+ */
+FR_API void fr_pow_array(const f32* base, const f32* exponent, f32* out, u32 count, math_accuracy accuracy);
@@ -0,0 +1,822 @@
+#include "bvh.h"
+
+#include <string.h>
+
+#include "fracture/core/library/atomics.h"
+#include "fracture/core/library/math/simd/sse.h"
+#include "fracture/core/library/math/utils.h"
+#include "fracture/core/systems/fracture_memory.h"
+#include "fracture/core/systems/job_system.h"
+#include "fracture/core/systems/logging.h"
+
+// Nodes with fewer primitives than this are built whole by a single job, larger ones are split on the calling thread
+// with their binning spread over the job system
+#define BVH_SUBTREE_SIZE 8192
+
+// Largest number of jobs the binning of a large node is spread over
+#define BVH_BIN_BATCHES 64
+
+// Smallest number of primitives binned by one of those jobs
+#define BVH_MIN_BIN_BATCH_SIZE 1024
+
+// Down to this depth of the binary tree nodes are split with the surface area heuristic and below it they are halved,
+// which bounds the depth of the tree and with it the size of the stacks. Halving 2^32 primitives takes 32 levels.
+#define BVH_MAX_SAH_DEPTH 48
+#define BVH_MAX_DEPTH (BVH_MAX_SAH_DEPTH + 33)
+
+// A node pops one entry and pushes at most FR_BVH_WIDTH, so the stacks never hold more than this
+#define BVH_STACK_SIZE ((FR_BVH_WIDTH - 1) * BVH_MAX_DEPTH + FR_BVH_WIDTH)
+
+// Costs of the surface area heuristic
+#define BVH_TRAVERSAL_COST 1.0f
+#define BVH_INTERSECTION_COST 1.0f
+
+// Widens the exit parameter of the ray box tests by the worst rounding error of the slab test, so that rays grazing a
+// box, or aimed at a corner of a primitive that lies on its bounds, are not missed
+#define BVH_RAY_EXIT_SCALE 1.0000004f
+
+// Primitives whose centroids fall in the same bin along an axis
+typedef struct bvh_bin {
+    aabb bounds;
+    aabb centroid_bounds;
+    u32 count;
+} bvh_bin;
+
+// A node of the binary tree the 4 wide tree is collapsed from
+typedef struct bvh_build_node {
+    aabb bounds;
+    aabb centroid_bounds;
+    // The primitives of the node are indices[first, first + count)
+    u32 first;
+    u32 count;
+    // Index of the left child, followed by the right child. 0 for leaves, as the root is no node's child.
+    u32 left;
+    u32 depth;
+} bvh_build_node;
+
+typedef struct bvh_builder {
+    const aabb* bounds;
+    vec3* centroids;
+    u32* indices;
+    u32 count;
+
+    bvh_build_node* nodes;
+    u32 node_capacity;
+    volatile i32 node_count;
+
+    // The nodes that are built by one job each
+    u32* subtrees;
+    u32 subtree_capacity;
+    u32 subtree_count;
+
+    // The bins of each batch of the node binned in parallel, BVH_BIN_BATCHES * 3 * FR_BVH_BIN_COUNT of them
+    bvh_bin* batch_bins;
+    const bvh_build_node* batch_node;
+    vec3 batch_scale;
+    u32 batch_size;
+} bvh_builder;
+
+typedef struct bvh_collapse_entry {
+    u32 binary;
+    u32 node;
+} bvh_collapse_entry;
+
+typedef struct bvh_ray_entry {
+    u32 node;
+    f32 t;
+} bvh_ray_entry;
+
+typedef struct bvh_range_entry {
+    u32 node;
+    u32 first;
+} bvh_range_entry;
+
+//--------------------------------------------------------------------------------------------
+// Binned surface area heuristic
+//--------------------------------------------------------------------------------------------
+
+static void _bvh_bins_clear(bvh_bin bins[3][FR_BVH_BIN_COUNT]) {
+    for (u32 axis = 0; axis < 3; ++axis) {
+        for (u32 i = 0; i < FR_BVH_BIN_COUNT; ++i) {
+            fr_aabb_empty(&bins[axis][i].bounds);
+            fr_aabb_empty(&bins[axis][i].centroid_bounds);
+            bins[axis][i].count = 0;
+        }
+    }
+}
+
+static void _bvh_bin_merge(bvh_bin* bin, const bvh_bin* other) {
+    fr_aabb_merge(&bin->bounds, &other->bounds, &bin->bounds);
+    fr_aabb_merge(&bin->centroid_bounds, &other->centroid_bounds, &bin->centroid_bounds);
+    bin->count += other->count;
+}
+
+// Maps the centroids of a node to [0, FR_BVH_BIN_COUNT) along each axis, with a scale of 0 for flat axes
+static void _bvh_bin_scale(const bvh_build_node* node, vec3* out_scale) {
+    fr_vec3_zeros(out_scale);
+    for (u32 axis = 0; axis < 3; ++axis) {
+        f32 extent = node->centroid_bounds.max.data[axis] - node->centroid_bounds.min.data[axis];
+        if (extent > 0.0f) {
+            out_scale->data[axis] = FR_BVH_BIN_COUNT * 0.99999f / extent;
+        }
+    }
+}
+
+FR_FORCE_INLINE u32 _bvh_bin_index(const bvh_build_node* node, const vec3* scale, const vec3* centroid, u32 axis) {
+    u32 bin = (u32)((centroid->data[axis] - node->centroid_bounds.min.data[axis]) * scale->data[axis]);
+    return MIN(bin, FR_BVH_BIN_COUNT - 1);
+}
+
+static void _bvh_bin_range(const bvh_builder* b,
+                           const bvh_build_node* node,
+                           const vec3* scale,
+                           u32 start,
+                           u32 end,
+                           bvh_bin bins[3][FR_BVH_BIN_COUNT]) {
+    for (u32 i = start; i < end; ++i) {
+        u32 primitive = b->indices[i];
+        const vec3* centroid = &b->centroids[primitive];
+        for (u32 axis = 0; axis < 3; ++axis) {
+            bvh_bin* bin = &bins[axis][_bvh_bin_index(node, scale, centroid, axis)];
+            fr_aabb_merge(&bin->bounds, &b->bounds[primitive], &bin->bounds);
+            fr_aabb_merge_point(&bin->centroid_bounds, centroid);
+            bin->count++;
+        }
+    }
+}
+
+static void _bvh_bin_batches(u32 start, u32 end, void* data) {
+    bvh_builder* b = (bvh_builder*)data;
+    const bvh_build_node* node = b->batch_node;
+    for (u32 batch = start; batch < end; ++batch) {
+        u32 first = node->first + batch * b->batch_size;
+        u32 last = MIN(first + b->batch_size, node->first + node->count);
+        bvh_bin(*bins)[FR_BVH_BIN_COUNT] = (bvh_bin(*)[FR_BVH_BIN_COUNT])(b->batch_bins + batch * 3 * FR_BVH_BIN_COUNT);
+        _bvh_bins_clear(bins);
+        _bvh_bin_range(b, node, &b->batch_scale, first, last, bins);
+    }
+}
+
+// Computes the centroids of the primitives and the bounds of each batch, kept in the first bin of the batch
+static void _bvh_centroid_batches(u32 start, u32 end, void* data) {
+    bvh_builder* b = (bvh_builder*)data;
+    for (u32 batch = start; batch < end; ++batch) {
+        u32 first = batch * b->batch_size;
+        u32 last = MIN(first + b->batch_size, b->count);
+        bvh_bin* bin = &b->batch_bins[batch * 3 * FR_BVH_BIN_COUNT];
+        fr_aabb_empty(&bin->bounds);
+        fr_aabb_empty(&bin->centroid_bounds);
+        for (u32 i = first; i < last; ++i) {
+            b->indices[i] = i;
+            fr_aabb_center(&b->bounds[i], &b->centroids[i]);
+            fr_aabb_merge(&bin->bounds, &b->bounds[i], &bin->bounds);
+            fr_aabb_merge_point(&bin->centroid_bounds, &b->centroids[i]);
+        }
+        bin->count = last - first;
+    }
+}
+
+// Finds the cheapest split between two bins of the same axis. Returns the axis, or 3 if no split leaves primitives on
+// both sides.
+static u32 _bvh_find_split(
+    const bvh_build_node* node, bvh_bin bins[3][FR_BVH_BIN_COUNT], u32* out_split, f32* out_cost) {
+    f32 area = fr_aabb_surface_area(&node->bounds);
+    f32 inv_area = area > 0.0f ? 1.0f / area : 1.0f;
+    u32 best_axis = 3;
+    f32 best_cost = FLOAT_MAX;
+    for (u32 axis = 0; axis < 3; ++axis) {
+        if (node->centroid_bounds.max.data[axis] <= node->centroid_bounds.min.data[axis]) {
+            continue;
+        }
+
+        // right_area[i] and right_count[i] describe the bins [i, FR_BVH_BIN_COUNT)
+        f32 right_area[FR_BVH_BIN_COUNT];
+        u32 right_count[FR_BVH_BIN_COUNT];
+        aabb side;
+        fr_aabb_empty(&side);
+        u32 count = 0;
+        for (u32 i = FR_BVH_BIN_COUNT - 1; i > 0; --i) {
+            fr_aabb_merge(&side, &bins[axis][i].bounds, &side);
+            count += bins[axis][i].count;
+            right_area[i] = fr_aabb_surface_area(&side);
+            right_count[i] = count;
+        }
+
+        fr_aabb_empty(&side);
+        count = 0;
+        for (u32 i = 0; i < FR_BVH_BIN_COUNT - 1; ++i) {
+            fr_aabb_merge(&side, &bins[axis][i].bounds, &side);
+            count += bins[axis][i].count;
+            if (count == 0 || right_count[i + 1] == 0) {
+                continue;
+            }
+            f32 cost = fr_aabb_surface_area(&side) * count + right_area[i + 1] * right_count[i + 1];
+            cost = BVH_TRAVERSAL_COST + BVH_INTERSECTION_COST * cost * inv_area;
+            if (cost < best_cost) {
+                best_cost = cost;
+                best_axis = axis;
+                *out_split = i;
+            }
+        }
+    }
+    *out_cost = best_cost;
+    return best_axis;
+}
+
+static void _bvh_node_bounds(const bvh_builder* b, bvh_build_node* node) {
+    fr_aabb_empty(&node->bounds);
+    fr_aabb_empty(&node->centroid_bounds);
+    for (u32 i = node->first; i < node->first + node->count; ++i) {
+        u32 primitive = b->indices[i];
+        fr_aabb_merge(&node->bounds, &b->bounds[primitive], &node->bounds);
+        fr_aabb_merge_point(&node->centroid_bounds, &b->centroids[primitive]);
+    }
+}
+
+// Splits a node in two, spreading the binning over the job system when parallel is set. Returns FALSE if the node is
+// cheaper as a leaf.
+static b8 _bvh_split(bvh_builder* b, u32 index, b8 parallel) {
+    bvh_build_node* node = &b->nodes[index];
+    if (node->count <= 1) {
+        return FALSE;
+    }
+
+    bvh_bin bins[3][FR_BVH_BIN_COUNT];
+    vec3 scale;
+    u32 axis = 3;
+    u32 split = 0;
+    f32 split_cost = FLOAT_MAX;
+    if (node->depth < BVH_MAX_SAH_DEPTH) {
+        _bvh_bin_scale(node, &scale);
+        _bvh_bins_clear(bins);
+        if (parallel && node->count >= BVH_SUBTREE_SIZE) {
+            b->batch_node = node;
+            b->batch_scale = scale;
+            b->batch_size = MAX((node->count + BVH_BIN_BATCHES - 1) / BVH_BIN_BATCHES, BVH_MIN_BIN_BATCH_SIZE);
+            u32 batch_count = (node->count + b->batch_size - 1) / b->batch_size;
+            fr_job_parallel_for(batch_count, 1, _bvh_bin_batches, b);
+            for (u32 batch = 0; batch < batch_count; ++batch) {
+                const bvh_bin* batch_bins = b->batch_bins + batch * 3 * FR_BVH_BIN_COUNT;
+                for (u32 i = 0; i < 3 * FR_BVH_BIN_COUNT; ++i) {
+                    _bvh_bin_merge(&bins[i / FR_BVH_BIN_COUNT][i % FR_BVH_BIN_COUNT], &batch_bins[i]);
+                }
+            }
+        } else {
+            _bvh_bin_range(b, node, &scale, node->first, node->first + node->count, bins);
+        }
+        axis = _bvh_find_split(node, bins, &split, &split_cost);
+    }
+
+    if (node->count <= FR_BVH_MAX_LEAF_SIZE && (axis == 3 || BVH_INTERSECTION_COST * node->count <= split_cost)) {
+        return FALSE;
+    }
+
+    u32 left_index = (u32)fr_atomic_fetch_add_i32(&b->node_count, 2, FR_MEMORY_ORDER_RELAXED);
+    bvh_build_node* left = &b->nodes[left_index];
+    bvh_build_node* right = left + 1;
+    left->first = node->first;
+    left->left = 0;
+    left->depth = node->depth + 1;
+    right->left = 0;
+    right->depth = node->depth + 1;
+
+    if (axis < 3) {
+        u32 i = node->first;
+        u32 j = node->first + node->count;
+        while (i < j) {
+            if (_bvh_bin_index(node, &scale, &b->centroids[b->indices[i]], axis) <= split) {
+                ++i;
+            } else {
+                --j;
+                u32 swap = b->indices[i];
+                b->indices[i] = b->indices[j];
+                b->indices[j] = swap;
+            }
+        }
+        left->count = i - node->first;
+
+        bvh_bin side = bins[axis][0];
+        for (u32 bin = 1; bin <= split; ++bin) {
+            _bvh_bin_merge(&side, &bins[axis][bin]);
+        }
+        left->bounds = side.bounds;
+        left->centroid_bounds = side.centroid_bounds;
+        side = bins[axis][split + 1];
+        for (u32 bin = split + 2; bin < FR_BVH_BIN_COUNT; ++bin) {
+            _bvh_bin_merge(&side, &bins[axis][bin]);
+        }
+        right->bounds = side.bounds;
+        right->centroid_bounds = side.centroid_bounds;
+    } else {
+        // Too deep, or every centroid in the same place: any split is as good as the other
+        left->count = node->count / 2;
+        _bvh_node_bounds(b, left);
+    }
+    right->first = left->first + left->count;
+    right->count = node->count - left->count;
+    if (axis == 3) {
+        _bvh_node_bounds(b, right);
+    }
+    node->left = left_index;
+    return TRUE;
+}
+
+static void _bvh_build_subtrees(u32 start, u32 end, void* data) {
+    bvh_builder* b = (bvh_builder*)data;
+    u32 stack[BVH_MAX_DEPTH + 2];
+    for (u32 subtree = start; subtree < end; ++subtree) {
+        u32 size = 0;
+        stack[size++] = b->subtrees[subtree];
+        while (size > 0) {
+            u32 index = stack[--size];
+            if (_bvh_split(b, index, FALSE)) {
+                stack[size++] = b->nodes[index].left;
+                stack[size++] = b->nodes[index].left + 1;
+            }
+        }
+    }
+}
+
+// Turns the binary tree into the 4 wide one by opening the child with the largest surface area until a node has four
+// children. Opening replaces a child by its two children in place, which keeps the primitives of the children of each
+// node in order.
+static void _bvh_collapse(const bvh_builder* b, bvh* out) {
+    bvh_collapse_entry stack[BVH_STACK_SIZE];
+    u32 size = 0;
+    stack[size++] = (bvh_collapse_entry){0, 0};
+    out->node_count = 1;
+    while (size > 0) {
+        bvh_collapse_entry entry = stack[--size];
+        const bvh_build_node* parent = &b->nodes[entry.binary];
+
+        u32 slots[FR_BVH_WIDTH];
+        u32 slot_count = 0;
+        if (parent->left == 0) {
+            // Only a root with few primitives is a leaf
+            slots[slot_count++] = entry.binary;
+        } else {
+            slots[slot_count++] = parent->left;
+            slots[slot_count++] = parent->left + 1;
+        }
+        while (slot_count < FR_BVH_WIDTH) {
+            u32 widest = FR_BVH_WIDTH;
+            f32 widest_area = -1.0f;
+            for (u32 i = 0; i < slot_count; ++i) {
+                const bvh_build_node* child = &b->nodes[slots[i]];
+                f32 area = fr_aabb_surface_area(&child->bounds);
+                if (child->left != 0 && area > widest_area) {
+                    widest = i;
+                    widest_area = area;
+                }
+            }
+            if (widest == FR_BVH_WIDTH) {
+                break;
+            }
+            u32 left = b->nodes[slots[widest]].left;
+            memmove(&slots[widest + 2], &slots[widest + 1], (slot_count - widest - 1) * sizeof(u32));
+            slots[widest] = left;
+            slots[widest + 1] = left + 1;
+            ++slot_count;
+        }
+
+        bvh_node* node = &out->nodes[entry.node];
+        for (u32 i = 0; i < FR_BVH_WIDTH; ++i) {
+            if (i >= slot_count) {
+                // Inverted bounds that no query overlaps
+                for (u32 c = 0; c < 3; ++c) {
+                    node->min[c][i] = FLOAT_MAX;
+                    node->max[c][i] = -FLOAT_MAX;
+                }
+                node->children[i] = 0;
+                node->counts[i] = 0;
+                continue;
+            }
+            const bvh_build_node* child = &b->nodes[slots[i]];
+            for (u32 c = 0; c < 3; ++c) {
+                node->min[c][i] = child->bounds.min.data[c];
+                node->max[c][i] = child->bounds.max.data[c];
+            }
+            node->counts[i] = child->count;
+            if (child->left == 0) {
+                node->children[i] = FR_BVH_LEAF_BIT | child->first;
+            } else {
+                node->children[i] = out->node_count;
+                stack[size++] = (bvh_collapse_entry){slots[i], out->node_count++};
+            }
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------
+// Node tests, the four children of a node at once
+//--------------------------------------------------------------------------------------------
+
+// The planes of a frustum in the form the node tests use
+typedef struct bvh_planes {
+#if FR_SIMD == 1
+    __m128 planes[FR_FRUSTUM_PLANE_COUNT][4];
+    __m128 abs_normals[FR_FRUSTUM_PLANE_COUNT][3];
+#else
+    vec4 planes[FR_FRUSTUM_PLANE_COUNT];
+#endif
+} bvh_planes;
+
+static void _bvh_planes_create(const frustum* f, bvh_planes* out) {
+    for (u32 p = 0; p < FR_FRUSTUM_PLANE_COUNT; ++p) {
+#if FR_SIMD == 1
+        for (u32 c = 0; c < 4; ++c) {
+            out->planes[p][c] = _mm_set1_ps(f->planes[p].data[c]);
+        }
+        for (u32 c = 0; c < 3; ++c) {
+            out->abs_normals[p][c] = fr_simd_abs(out->planes[p][c]);
+        }
+#else
+        out->planes[p] = f->planes[p];
+#endif
+    }
+}
+
+// Returns the mask of the children hit by a ray below t_max and writes their entry parameters to out_t
+FR_FORCE_INLINE u32 _bvh_node_ray(
+    const bvh_node* node, const f32 origin[3], const f32 inv_direction[3], f32 t_max, f32 out_t[FR_BVH_WIDTH]) {
+#if FR_SIMD == 1
+    __m128 t_near = _mm_setzero_ps();
+    __m128 t_far = _mm_set1_ps(t_max);
+    for (u32 c = 0; c < 3; ++c) {
+        __m128 o = _mm_set1_ps(origin[c]);
+        __m128 inv = _mm_set1_ps(inv_direction[c]);
+        __m128 t0 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node->min[c]), o), inv);
+        __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node->max[c]), o), inv);
+        t_near = _mm_max_ps(t_near, _mm_min_ps(t0, t1));
+        t_far = _mm_min_ps(t_far, _mm_max_ps(t0, t1));
+    }
+    t_far = _mm_mul_ps(t_far, _mm_set1_ps(BVH_RAY_EXIT_SCALE));
+    _mm_storeu_ps(out_t, t_near);
+    __m128i used = _mm_cmpgt_epi32(_mm_load_si128((const __m128i*)node->counts), _mm_setzero_si128());
+    return (u32)_mm_movemask_ps(_mm_and_ps(_mm_cmple_ps(t_near, t_far), _mm_castsi128_ps(used)));
+#else
+    u32 mask = 0;
+    for (u32 i = 0; i < FR_BVH_WIDTH; ++i) {
+        f32 t_near = 0.0f;
+        f32 t_far = t_max;
+        for (u32 c = 0; c < 3; ++c) {
+            f32 t0 = (node->min[c][i] - origin[c]) * inv_direction[c];
+            f32 t1 = (node->max[c][i] - origin[c]) * inv_direction[c];
+            t_near = fr_max(t_near, fr_min(t0, t1));
+            t_far = fr_min(t_far, fr_max(t0, t1));
+        }
+        t_far *= BVH_RAY_EXIT_SCALE;
+        out_t[i] = t_near;
+        mask |= (u32)(t_near <= t_far && node->counts[i] != 0) << i;
+    }
+    return mask;
+#endif
+}
+
+// Returns the mask of the children that are not entirely behind a plane, with out_inside the mask of those entirely in
+// front of every plane
+FR_FORCE_INLINE u32 _bvh_node_frustum(const bvh_node* node, const bvh_planes* planes, u32* out_inside) {
+#if FR_SIMD == 1
+    __m128 half = _mm_set1_ps(0.5f);
+    __m128 center[3], extent[3];
+    for (u32 c = 0; c < 3; ++c) {
+        __m128 min = _mm_load_ps(node->min[c]);
+        __m128 max = _mm_load_ps(node->max[c]);
+        center[c] = _mm_mul_ps(_mm_add_ps(min, max), half);
+        extent[c] = _mm_mul_ps(_mm_sub_ps(max, min), half);
+    }
+    __m128 outside = _mm_setzero_ps();
+    __m128 crossing = _mm_setzero_ps();
+    for (u32 p = 0; p < FR_FRUSTUM_PLANE_COUNT; ++p) {
+        __m128 distance = fr_simd_fmadd(planes->planes[p][0], center[0], planes->planes[p][3]);
+        distance = fr_simd_fmadd(planes->planes[p][1], center[1], distance);
+        distance = fr_simd_fmadd(planes->planes[p][2], center[2], distance);
+        __m128 reach = _mm_mul_ps(planes->abs_normals[p][0], extent[0]);
+        reach = fr_simd_fmadd(planes->abs_normals[p][1], extent[1], reach);
+        reach = fr_simd_fmadd(planes->abs_normals[p][2], extent[2], reach);
+        outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, reach), _mm_setzero_ps()));
+        crossing = _mm_or_ps(crossing, _mm_cmplt_ps(_mm_sub_ps(distance, reach), _mm_setzero_ps()));
+    }
+    __m128i used = _mm_cmpgt_epi32(_mm_load_si128((const __m128i*)node->counts), _mm_setzero_si128());
+    __m128 visible = _mm_andnot_ps(outside, _mm_castsi128_ps(used));
+    *out_inside = (u32)_mm_movemask_ps(_mm_andnot_ps(crossing, visible));
+    return (u32)_mm_movemask_ps(visible);
+#else
+    u32 visible = 0;
+    u32 inside = 0;
+    for (u32 i = 0; i < FR_BVH_WIDTH; ++i) {
+        f32 center[3], extent[3];
+        for (u32 c = 0; c < 3; ++c) {
+            center[c] = (node->min[c][i] + node->max[c][i]) * 0.5f;
+            extent[c] = (node->max[c][i] - node->min[c][i]) * 0.5f;
+        }
+        b8 outside = node->counts[i] == 0;
+        b8 crossing = FALSE;
+        for (u32 p = 0; p < FR_FRUSTUM_PLANE_COUNT; ++p) {
+            const vec4* plane = &planes->planes[p];
+            f32 distance = plane->x * center[0] + plane->y * center[1] + plane->z * center[2] + plane->w;
+            f32 reach = fr_abs(plane->x) * extent[0] + fr_abs(plane->y) * extent[1] + fr_abs(plane->z) * extent[2];
+            outside |= distance + reach < 0.0f;
+            crossing |= distance - reach < 0.0f;
+        }
+        visible |= (u32)!outside << i;
+        inside |= (u32)(!outside && !crossing) << i;
+    }
+    *out_inside = inside;
+    return visible;
+#endif
+}
+
+// Returns the mask of the children that overlap a box, with out_inside the mask of those inside it
+FR_FORCE_INLINE u32 _bvh_node_aabb(const bvh_node* node, const aabb* box, u32* out_inside) {
+#if FR_SIMD == 1
+    __m128 overlap = _mm_castsi128_ps(
+        _mm_cmpgt_epi32(_mm_load_si128((const __m128i*)node->counts), _mm_setzero_si128()));
+    __m128 inside = overlap;
+    for (u32 c = 0; c < 3; ++c) {
+        __m128 min = _mm_load_ps(node->min[c]);
+        __m128 max = _mm_load_ps(node->max[c]);
+        __m128 box_min = _mm_set1_ps(box->min.data[c]);
+        __m128 box_max = _mm_set1_ps(box->max.data[c]);
+        overlap = _mm_and_ps(overlap, _mm_and_ps(_mm_cmple_ps(min, box_max), _mm_cmple_ps(box_min, max)));
+        inside = _mm_and_ps(inside, _mm_and_ps(_mm_cmple_ps(box_min, min), _mm_cmple_ps(max, box_max)));
+    }
+    *out_inside = (u32)_mm_movemask_ps(inside);
+    return (u32)_mm_movemask_ps(overlap);
+#else
+    u32 overlap = 0;
+    u32 inside = 0;
+    for (u32 i = 0; i < FR_BVH_WIDTH; ++i) {
+        b8 child_overlap = node->counts[i] != 0;
+        b8 child_inside = child_overlap;
+        for (u32 c = 0; c < 3; ++c) {
+            child_overlap &= node->min[c][i] <= box->max.data[c] && box->min.data[c] <= node->max[c][i];
+            child_inside &= box->min.data[c] <= node->min[c][i] && node->max[c][i] <= box->max.data[c];
+        }
+        overlap |= (u32)child_overlap << i;
+        inside |= (u32)child_inside << i;
+    }
+    *out_inside = inside;
+    return overlap;
+#endif
+}
+
+FR_FORCE_INLINE u32 _bvh_emit(const bvh* b, u32 first, u32 count, u32* out) {
+    memcpy(out, b->primitives + first, count * sizeof(u32));
+    return count;
+}
+
+//--------------------------------------------------------------------------------------------
+// Build and queries
+//--------------------------------------------------------------------------------------------
+
+b8 fr_bvh_build(const aabb* bounds, u32 count, bvh* out_bvh) {
+    if (count >= FR_BVH_LEAF_BIT) {
+        FR_CORE_ERROR("Cannot build a BVH of %u primitives, the limit is %u", count, FR_BVH_LEAF_BIT - 1);
+        return FALSE;
+    }
+
+    memset(out_bvh, 0, sizeof(bvh));
+    out_bvh->primitive_count = count;
+    if (count == 0) {
+        out_bvh->node_capacity = 1;
+        out_bvh->node_count = 1;
+        out_bvh->nodes = fr_memory_allocate_aligned(sizeof(bvh_node), FR_CACHE_LINE_SIZE, MEMORY_TYPE_TREE);
+        for (u32 i = 0; i < FR_BVH_WIDTH; ++i) {
+            for (u32 c = 0; c < 3; ++c) {
+                out_bvh->nodes->min[c][i] = FLOAT_MAX;
+                out_bvh->nodes->max[c][i] = -FLOAT_MAX;
+            }
+        }
+        return TRUE;
+    }
+
+    bvh_builder b = {0};
+    b.bounds = bounds;
+    b.count = count;
+    b.centroids = fr_memory_allocate_aligned(sizeof(vec3) * count, FR_CACHE_LINE_SIZE, MEMORY_TYPE_TREE);
+    b.indices = fr_memory_allocate(sizeof(u32) * count, MEMORY_TYPE_TREE);
+    b.node_capacity = 2 * count;
+    b.nodes =
+        fr_memory_allocate_aligned(sizeof(bvh_build_node) * b.node_capacity, FR_CACHE_LINE_SIZE, MEMORY_TYPE_TREE);
+    // Subtree roots hold disjoint primitives, and at each depth at most count / BVH_SUBTREE_SIZE nodes are split on
+    // the calling thread, each making at most two of them
+    b.subtree_capacity = MIN(count, 2 * (count / BVH_SUBTREE_SIZE + 1) * BVH_MAX_DEPTH);
+    b.subtrees = fr_memory_allocate(sizeof(u32) * b.subtree_capacity, MEMORY_TYPE_TREE);
+    b.batch_bins = fr_memory_allocate_aligned(
+        sizeof(bvh_bin) * BVH_BIN_BATCHES * 3 * FR_BVH_BIN_COUNT, FR_CACHE_LINE_SIZE, MEMORY_TYPE_TREE);
+
+    b.batch_size = MAX((count + BVH_BIN_BATCHES - 1) / BVH_BIN_BATCHES, BVH_MIN_BIN_BATCH_SIZE);
+    u32 batch_count = (count + b.batch_size - 1) / b.batch_size;
+    fr_job_parallel_for(batch_count, 1, _bvh_centroid_batches, &b);
+
+    bvh_build_node* root = &b.nodes[0];
+    root->first = 0;
+    root->left = 0;
+    root->depth = 0;
+    bvh_bin root_bin = b.batch_bins[0];
+    for (u32 batch = 1; batch < batch_count; ++batch) {
+        _bvh_bin_merge(&root_bin, &b.batch_bins[batch * 3 * FR_BVH_BIN_COUNT]);
+    }
+    root->bounds = root_bin.bounds;
+    root->centroid_bounds = root_bin.centroid_bounds;
+    root->count = root_bin.count;
+    b.node_count = 1;
+
+    // The top of the tree, where there are too few nodes to keep the job system busy
+    u32 stack[BVH_MAX_DEPTH + 2];
+    u32 size = 0;
+    stack[size++] = 0;
+    while (size > 0) {
+        u32 index = stack[--size];
+        if (b.nodes[index].count < BVH_SUBTREE_SIZE) {
+            b.subtrees[b.subtree_count++] = index;
+        } else if (_bvh_split(&b, index, TRUE)) {
+            stack[size++] = b.nodes[index].left;
+            stack[size++] = b.nodes[index].left + 1;
+        }
+    }
+    fr_job_parallel_for(b.subtree_count, 1, _bvh_build_subtrees, &b);
+
+    // Every 4 wide node stands for a distinct inner node of the binary tree, or the root
+    out_bvh->node_capacity = MAX(((u32)b.node_count - 1) / 2, 1);
+    out_bvh->nodes =
+        fr_memory_allocate_aligned(sizeof(bvh_node) * out_bvh->node_capacity, FR_CACHE_LINE_SIZE, MEMORY_TYPE_TREE);
+    _bvh_collapse(&b, out_bvh);
+    out_bvh->primitives = b.indices;
+
+    fr_memory_free_aligned(b.centroids, sizeof(vec3) * count, FR_CACHE_LINE_SIZE, MEMORY_TYPE_TREE);
+    fr_memory_free_aligned(b.nodes, sizeof(bvh_build_node) * b.node_capacity, FR_CACHE_LINE_SIZE, MEMORY_TYPE_TREE);
+    fr_memory_free(b.subtrees, sizeof(u32) * b.subtree_capacity, MEMORY_TYPE_TREE);
+    fr_memory_free_aligned(
+        b.batch_bins, sizeof(bvh_bin) * BVH_BIN_BATCHES * 3 * FR_BVH_BIN_COUNT, FR_CACHE_LINE_SIZE, MEMORY_TYPE_TREE);
+    return TRUE;
+}
+
+void fr_bvh_destroy(bvh* b) {
+    if (b->nodes) {
+        fr_memory_free_aligned(b->nodes, sizeof(bvh_node) * b->node_capacity, FR_CACHE_LINE_SIZE, MEMORY_TYPE_TREE);
+    }
+    if (b->primitives) {
+        fr_memory_free(b->primitives, sizeof(u32) * b->primitive_count, MEMORY_TYPE_TREE);
+    }
+    memset(b, 0, sizeof(bvh));
+}
+
+void fr_bvh_refit(bvh* b, const aabb* bounds) {
+    // Children come after their parents, so walking backwards refits every child before its parent
+    for (u32 n = b->node_count; n-- > 0;) {
+        bvh_node* node = &b->nodes[n];
+        for (u32 i = 0; i < FR_BVH_WIDTH; ++i) {
+            if (node->counts[i] == 0) {
+                continue;
+            }
+            aabb box;
+            fr_aabb_empty(&box);
+            if (node->children[i] & FR_BVH_LEAF_BIT) {
+                u32 first = node->children[i] & ~FR_BVH_LEAF_BIT;
+                for (u32 p = first; p < first + node->counts[i]; ++p) {
+                    fr_aabb_merge(&box, &bounds[b->primitives[p]], &box);
+                }
+            } else {
+                // The unused children of a node have inverted bounds, which leave the merge as it is
+                const bvh_node* child = &b->nodes[node->children[i]];
+                for (u32 j = 0; j < FR_BVH_WIDTH; ++j) {
+                    for (u32 c = 0; c < 3; ++c) {
+                        box.min.data[c] = fr_min(box.min.data[c], child->min[c][j]);
+                        box.max.data[c] = fr_max(box.max.data[c], child->max[c][j]);
+                    }
+                }
+            }
+            for (u32 c = 0; c < 3; ++c) {
+                node->min[c][i] = box.min.data[c];
+                node->max[c][i] = box.max.data[c];
+            }
+        }
+    }
+}
+
+b8 fr_bvh_raycast(
+    const bvh* b, const ray* r, f32 t_max, PFN_bvh_intersect intersect, void* user_data, ray_hit* out_hit) {
+    if (b->primitive_count == 0) {
+        return FALSE;
+    }
+
+    const f32 inv_direction[3] = {
+        fr_ray_reciprocal(r->direction.x), fr_ray_reciprocal(r->direction.y), fr_ray_reciprocal(r->direction.z)};
+    ray_hit best = {.t = t_max};
+    b8 found = FALSE;
+
+    bvh_ray_entry stack[BVH_STACK_SIZE];
+    u32 size = 0;
+    stack[size++] = (bvh_ray_entry){0, 0.0f};
+    while (size > 0) {
+        bvh_ray_entry entry = stack[--size];
+        if (entry.t > best.t) {
+            continue;
+        }
+        const bvh_node* node = &b->nodes[entry.node];
+        f32 t[FR_BVH_WIDTH];
+        u32 mask = _bvh_node_ray(node, r->origin.data, inv_direction, best.t, t);
+
+        // Sort the children that are hit from the nearest to the farthest
+        u32 order[FR_BVH_WIDTH];
+        u32 hit_count = 0;
+        for (; mask != 0; mask &= mask - 1) {
+            u32 i = (u32)__builtin_ctz(mask);
+            u32 j = hit_count++;
+            for (; j > 0 && t[order[j - 1]] > t[i]; --j) {
+                order[j] = order[j - 1];
+            }
+            order[j] = i;
+        }
+
+        // Leaves are intersected nearest first, inner children pushed farthest first so the nearest is popped first
+        for (u32 k = 0; k < hit_count; ++k) {
+            u32 i = order[k];
+            if (!(node->children[i] & FR_BVH_LEAF_BIT) || t[i] > best.t) {
+                continue;
+            }
+            u32 first = node->children[i] & ~FR_BVH_LEAF_BIT;
+            for (u32 p = first; p < first + node->counts[i]; ++p) {
+                ray_hit hit;
+                if (intersect(b->primitives[p], r, best.t, &hit, user_data)) {
+                    best = hit;
+                    best.index = b->primitives[p];
+                    found = TRUE;
+                }
+            }
+        }
+        for (u32 k = hit_count; k-- > 0;) {
+            u32 i = order[k];
+            if (!(node->children[i] & FR_BVH_LEAF_BIT)) {
+                stack[size++] = (bvh_ray_entry){node->children[i], t[i]};
+            }
+        }
+    }
+
+    if (found) {
+        *out_hit = best;
+    }
+    return found;
+}
+
+u32 fr_bvh_cull_frustum(const bvh* b, const frustum* f, u32* out_primitives) {
+    if (b->primitive_count == 0) {
+        return 0;
+    }
+
+    bvh_planes planes;
+    _bvh_planes_create(f, &planes);
+    u32 visible = 0;
+    bvh_range_entry stack[BVH_STACK_SIZE];
+    u32 size = 0;
+    stack[size++] = (bvh_range_entry){0, 0};
+    while (size > 0) {
+        bvh_range_entry entry = stack[--size];
+        const bvh_node* node = &b->nodes[entry.node];
+        u32 inside;
+        u32 mask = _bvh_node_frustum(node, &planes, &inside);
+        u32 first = entry.first;
+        for (u32 i = 0; i < FR_BVH_WIDTH; first += node->counts[i], ++i) {
+            if (!(mask & (1u << i))) {
+                continue;
+            }
+            if ((inside & (1u << i)) || (node->children[i] & FR_BVH_LEAF_BIT)) {
+                visible += _bvh_emit(b, first, node->counts[i], out_primitives + visible);
+            } else {
+                stack[size++] = (bvh_range_entry){node->children[i], first};
+            }
+        }
+    }
+    return visible;
+}
+
+u32 fr_bvh_query_aabb(const bvh* b, const aabb* box, u32* out_primitives) {
+    if (b->primitive_count == 0) {
+        return 0;
+    }
+
+    u32 overlapping = 0;
+    bvh_range_entry stack[BVH_STACK_SIZE];
+    u32 size = 0;
+    stack[size++] = (bvh_range_entry){0, 0};
+    while (size > 0) {
+        bvh_range_entry entry = stack[--size];
+        const bvh_node* node = &b->nodes[entry.node];
+        u32 inside;
+        u32 mask = _bvh_node_aabb(node, box, &inside);
+        u32 first = entry.first;
+        for (u32 i = 0; i < FR_BVH_WIDTH; first += node->counts[i], ++i) {
+            if (!(mask & (1u << i))) {
+                continue;
+            }
+            if ((inside & (1u << i)) || (node->children[i] & FR_BVH_LEAF_BIT)) {
+                overlapping += _bvh_emit(b, first, node->counts[i], out_primitives + overlapping);
+            } else {
+                stack[size++] = (bvh_range_entry){node->children[i], first};
+            }
+        }
+    }
+    return overlapping;
+}
@@ -0,0 +1,156 @@
+/**
+ * @file bvh.h
+ * @author Aditya Rajagopal
+ * @brief Bounding volume hierarchy over the bounding boxes of a set of primitives.
+ * @details The hierarchy is built with the binned surface area heuristic: the centroids of the primitives of a node are
+ * sorted into FR_BVH_BIN_COUNT bins along each axis and the node is split at the bin boundary that minimizes the
+ * expected cost of a ray query. The first levels are split on the calling thread with the binning of each node spread
+ * over the job system, after which the remaining subtrees are built in parallel by one job each. Without a job system
+ * everything runs on the calling thread.
+ *
+ * The binary tree is then collapsed into a 4 wide tree whose nodes store the bounds of their four children as a
+ * structure of arrays, so a query tests all four children of a node with one SSE register per coordinate. Nodes are
+ * laid out depth first with every child after its parent, which lets fr_bvh_refit update the bounds of moving
+ * primitives with a single backwards pass over the nodes. Refitting keeps the topology, so the hierarchy of primitives
+ * that move far from where they were built gets slower to query and should be rebuilt from time to time.
+ *
+ * The queries walk the tree with a fixed size stack. The primitives of a leaf are contiguous in bvh.primitives, and so
+ * are those of any subtree, which lets the frustum and box queries report whole subtrees that are fully inside the
+ * query volume without visiting them.
+ * @version 0.0.1
+ * @date 2024-05-02
+ *
+ * @copyright Fracture Game Engine is Copyright (c) Aditya Rajagopal 2024-2024
+ *
+ */
+#pragma once
+
+#include "fracture/core/defines.h"
+#include "fracture/core/library/math/frustum.h"
+#include "fracture/core/library/math/geometry.h"
+
+/** @brief Number of children of a node */
+#define FR_BVH_WIDTH 4
+
+/** @brief Largest number of primitives in a leaf */
+#define FR_BVH_MAX_LEAF_SIZE 4
+
+/** @brief Number of bins per axis of the surface area heuristic */
+#define FR_BVH_BIN_COUNT 16
+
+/** @brief Set in bvh_node.children for the children that are leaves, the other bits being their first primitive */
+#define FR_BVH_LEAF_BIT 0x80000000u
+
+/**
+ * @brief A node of the hierarchy, one cache line pair holding the bounds of its four children.
+ *
+ */
+typedef FR_ALIGN(64) struct bvh_node {
+    /** @brief The x, y and z of the minimum corners of the children */
+    f32 min[3][FR_BVH_WIDTH];
+
+    /** @brief The x, y and z of the maximum corners of the children */
+    f32 max[3][FR_BVH_WIDTH];
+
+    /** @brief The index of each child node, or FR_BVH_LEAF_BIT with the index of its first primitive for leaves */
+    u32 children[FR_BVH_WIDTH];
+
+    /** @brief The number of primitives under each child, 0 for the unused children */
+    u32 counts[FR_BVH_WIDTH];
+} bvh_node;
+
+/**
+ * @brief A bounding volume hierarchy. The root is nodes[0].
+ *
+ */
+typedef struct bvh {
+    /** @brief The nodes, each after its parent */
+    bvh_node* nodes;
+
+    /** @brief The number of nodes */
+    u32 node_count;
+
+    /** @brief The number of allocated nodes */
+    u32 node_capacity;
+
+    /** @brief The indices of the primitives in the order of the leaves */
+    u32* primitives;
+
+    /** @brief The number of primitives */
+    u32 primitive_count;
+} bvh;
+
+/**
+ * @brief Intersects a ray with a primitive for fr_bvh_raycast.
+ *
+ * @param primitive The index of the primitive
+ * @param r The ray
+ * @param t_max The parameter of the closest hit found so far
+ * @param out_hit The hit, whose index is set by the caller
+ * @param user_data The user data passed to fr_bvh_raycast
+ * @return b8 TRUE if the ray hits the primitive at a parameter below t_max
+ */
+typedef b8 (*PFN_bvh_intersect)(u32 primitive, const ray* r, f32 t_max, ray_hit* out_hit, void* user_data);
+
+/**
+ * @brief Builds the hierarchy of a set of primitives.
+ *
+ * @param bounds The bounding boxes of the primitives
+ * @param count The number of primitives, below FR_BVH_LEAF_BIT
+ * @param out_bvh The hierarchy, destroy with fr_bvh_destroy
+ * @return b8 TRUE if the hierarchy was built, FALSE if there are too many primitives
+ */
+FR_API b8 fr_bvh_build(const aabb* bounds, u32 count, bvh* out_bvh);
+
+/**
+ * @brief Frees a hierarchy.
+ *
+ * @param b The hierarchy
+ */
+FR_API void fr_bvh_destroy(bvh* b);
+
+/**
+ * @brief Updates the bounds of the nodes after primitives moved, keeping the structure of the tree.
+ *
+ * @param b The hierarchy
+ * @param bounds The new bounding boxes of the primitives, in the order they were given to fr_bvh_build
+ */
+FR_API void fr_bvh_refit(bvh* b, const aabb* bounds);
+
+/**
+ * @brief Finds the closest primitive hit by a ray.
+ * @details Children are visited from the nearest to the farthest and subtrees further than the closest hit so far are
+ * skipped.
+ *
+ * @param b The hierarchy
+ * @param r The ray
+ * @param t_max The largest parameter of interest
+ * @param intersect Intersects the ray with a primitive
+ * @param user_data User data passed to intersect
+ * @param out_hit The closest hit with the index of the primitive, not written when there is none
+ * @return b8 TRUE if the ray hits a primitive at a parameter below t_max
+ */
+FR_API b8 fr_bvh_raycast(
+    const bvh* b, const ray* r, f32 t_max, PFN_bvh_intersect intersect, void* user_data, ray_hit* out_hit);
+
+/**
+ * @brief Lists the primitives that may be inside a frustum. The test is done on the bounds of the leaves, so some of
+ * the listed primitives can be outside the frustum when the other primitives of their leaf are not.
+ *
+ * @param b The hierarchy
+ * @param f The frustum
+ * @param out_primitives The indices of the primitives, in no particular order. Must hold b->primitive_count indices.
+ * @return u32 The number of listed primitives
+ */
+FR_API u32 fr_bvh_cull_frustum(const bvh* b, const frustum* f, u32* out_primitives);
+
+/**
+ * @brief Lists the primitives that may overlap a box, the broadphase candidates of a query volume. The test is done
+ * on the bounds of the leaves like for fr_bvh_cull_frustum.
+ *
+ * @param b The hierarchy
+ * @param box The query box
+ * @param out_primitives The indices of the primitives, in no particular order. Must hold b->primitive_count indices.
+ * @return u32 The number of listed primitives
+ */
+FR_API u32 fr_bvh_query_aabb(const bvh* b, const aabb* box, u32* out_primitives);
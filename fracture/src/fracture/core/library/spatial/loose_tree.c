@@ -0,0 +1,509 @@
+#include "loose_tree.h"
+
+#include <string.h>
+
+#include "fracture/core/library/math/utils.h"
+#include "fracture/core/systems/fracture_memory.h"
+#include "fracture/core/systems/logging.h"
+
+// Number of nodes allocated with a tree
+#define LOOSE_TREE_INITIAL_NODE_CAPACITY 64
+
+// A node pops one entry and pushes at most all of its children, so the stacks never hold more than this
+#define LOOSE_TREE_STACK_SIZE \
+    ((FR_LOOSE_TREE_MAX_CHILDREN - 1) * FR_LOOSE_TREE_MAX_DEPTH + FR_LOOSE_TREE_MAX_CHILDREN)
+
+// How a box relates to a query volume
+typedef enum loose_tree_overlap {
+    LOOSE_TREE_OUTSIDE = 0,
+    LOOSE_TREE_INTERSECTS,
+    LOOSE_TREE_INSIDE,
+} loose_tree_overlap;
+
+typedef loose_tree_overlap (*PFN_loose_tree_test)(const aabb* box, const void* query);
+
+typedef struct loose_tree_entry {
+    u32 node;
+    // TRUE when the whole node is inside the query volume, or for the nearest query the distance to the node
+    union {
+        b8 inside;
+        f32 distance2;
+    };
+} loose_tree_entry;
+
+//--------------------------------------------------------------------------------------------
+// Nodes and slots
+//--------------------------------------------------------------------------------------------
+
+// Gets the cell of a node grown by half a cell on every side
+static void _loose_tree_node_bounds(const loose_tree* tree, const vec3* center, u32 depth, aabb* out) {
+    vec3 half;
+    fr_vec3_add(&tree->cell_half_extents[depth], &tree->cell_half_extents[depth], &half);
+    fr_vec3_sub(center, &half, &out->min);
+    fr_vec3_add(center, &half, &out->max);
+}
+
+static b8 _loose_tree_node_fits(const loose_tree* tree, const vec3* center, u32 depth, const aabb* bounds) {
+    aabb loose;
+    _loose_tree_node_bounds(tree, center, depth, &loose);
+    return loose.min.x <= bounds->min.x && loose.min.y <= bounds->min.y && loose.min.z <= bounds->min.z &&
+           bounds->max.x <= loose.max.x && bounds->max.y <= loose.max.y && bounds->max.z <= loose.max.z;
+}
+
+static void _loose_tree_child_center(const loose_tree* tree, const loose_tree_node* node, u32 child, vec3* out) {
+    const vec3* half = &tree->cell_half_extents[node->depth + 1];
+    *out = node->center;
+    for (u32 i = 0; i < tree->axis_count; ++i) {
+        u32 axis = tree->axes[i];
+        out->data[axis] += (child & (1u << i)) ? half->data[axis] : -half->data[axis];
+    }
+}
+
+// Gets the deepest level whose cells are at least as large as an object, 0 when it is outside the world or larger
+static u32 _loose_tree_depth(const loose_tree* tree, const aabb* bounds, vec3* out_center) {
+    vec3 half;
+    fr_aabb_center(bounds, out_center);
+    fr_aabb_half_extents(bounds, &half);
+
+    const vec3* root_center = &tree->nodes[0].center;
+    const vec3* root_half = &tree->cell_half_extents[0];
+    for (u32 axis = 0; axis < 3; ++axis) {
+        if (fr_abs(out_center->data[axis] - root_center->data[axis]) > root_half->data[axis] ||
+            half.data[axis] > root_half->data[axis]) {
+            return 0;
+        }
+    }
+
+    u32 depth = 0;
+    while (depth < tree->max_depth) {
+        const vec3* cell = &tree->cell_half_extents[depth + 1];
+        for (u32 i = 0; i < tree->axis_count; ++i) {
+            if (half.data[tree->axes[i]] > cell->data[tree->axes[i]]) {
+                return depth;
+            }
+        }
+        ++depth;
+    }
+    return depth;
+}
+
+static u32 _loose_tree_node_create(loose_tree* tree, u32 parent, u32 child) {
+    u32 index;
+    if (tree->free_node != FR_LOOSE_TREE_INVALID) {
+        index = tree->free_node;
+        tree->free_node = tree->nodes[index].parent;
+    } else {
+        if (tree->node_count == tree->node_capacity) {
+            tree->nodes = fr_memory_reallocate(tree->nodes,
+                                               sizeof(loose_tree_node) * tree->node_capacity,
+                                               sizeof(loose_tree_node) * tree->node_capacity * 2,
+                                               MEMORY_TYPE_TREE);
+            tree->node_capacity *= 2;
+        }
+        index = tree->node_count++;
+    }
+
+    loose_tree_node* node = &tree->nodes[index];
+    loose_tree_node* parent_node = &tree->nodes[parent];
+    memset(node, 0, sizeof(loose_tree_node));
+    node->parent = parent;
+    node->depth = parent_node->depth + 1;
+    node->first_object = FR_LOOSE_TREE_INVALID;
+    _loose_tree_child_center(tree, parent_node, child, &node->center);
+    parent_node->children[child] = index;
+    parent_node->child_count++;
+    return index;
+}
+
+// Returns the empty nodes from a node up to the root to the pool
+static void _loose_tree_prune(loose_tree* tree, u32 index) {
+    while (index != 0 && tree->nodes[index].object_count == 0 && tree->nodes[index].child_count == 0) {
+        loose_tree_node* node = &tree->nodes[index];
+        loose_tree_node* parent = &tree->nodes[node->parent];
+        for (u32 child = 0; child < tree->child_count; ++child) {
+            if (parent->children[child] == index) {
+                parent->children[child] = 0;
+                break;
+            }
+        }
+        parent->child_count--;
+
+        u32 next = node->parent;
+        node->parent = tree->free_node;
+        tree->free_node = index;
+        index = next;
+    }
+}
+
+// Finds the node an object belongs in, creating the nodes on the way to it
+static u32 _loose_tree_place(loose_tree* tree, const aabb* bounds) {
+    vec3 center;
+    u32 target_depth = _loose_tree_depth(tree, bounds, &center);
+    u32 index = 0;
+    for (u32 depth = 0; depth < target_depth; ++depth) {
+        const loose_tree_node* node = &tree->nodes[index];
+        u32 child = 0;
+        for (u32 i = 0; i < tree->axis_count; ++i) {
+            u32 axis = tree->axes[i];
+            child |= (u32)(center.data[axis] >= node->center.data[axis]) << i;
+        }
+
+        u32 next = node->children[child];
+        if (next == 0) {
+            // Rounding can leave an object on the boundary of its cell a hair outside the loose bounds of the child, in
+            // which case it stays in the parent
+            vec3 child_center;
+            _loose_tree_child_center(tree, node, child, &child_center);
+            if (!_loose_tree_node_fits(tree, &child_center, depth + 1, bounds)) {
+                break;
+            }
+            next = _loose_tree_node_create(tree, index, child);
+        } else if (!_loose_tree_node_fits(tree, &tree->nodes[next].center, depth + 1, bounds)) {
+            break;
+        }
+        index = next;
+    }
+    return index;
+}
+
+static void _loose_tree_link(loose_tree* tree, u32 slot, u32 index) {
+    loose_tree_object* object = &tree->objects[slot];
+    loose_tree_node* node = &tree->nodes[index];
+    object->node = index;
+    object->previous = FR_LOOSE_TREE_INVALID;
+    object->next = node->first_object;
+    if (object->next != FR_LOOSE_TREE_INVALID) {
+        tree->objects[object->next].previous = slot;
+    }
+    node->first_object = slot;
+    node->object_count++;
+}
+
+static void _loose_tree_unlink(loose_tree* tree, u32 slot) {
+    loose_tree_object* object = &tree->objects[slot];
+    loose_tree_node* node = &tree->nodes[object->node];
+    if (object->previous != FR_LOOSE_TREE_INVALID) {
+        tree->objects[object->previous].next = object->next;
+    } else {
+        node->first_object = object->next;
+    }
+    if (object->next != FR_LOOSE_TREE_INVALID) {
+        tree->objects[object->next].previous = object->previous;
+    }
+    node->object_count--;
+}
+
+// Gets the slot of a handle, FR_LOOSE_TREE_INVALID if the handle is invalid
+static u32 _loose_tree_slot(const loose_tree* tree, spatial_handle handle) {
+    if (handle.generation == 0 || handle.index >= tree->slot_count) {
+        return FR_LOOSE_TREE_INVALID;
+    }
+    const loose_tree_object* object = &tree->objects[handle.index];
+    if (object->node == FR_LOOSE_TREE_INVALID || object->generation != handle.generation) {
+        return FR_LOOSE_TREE_INVALID;
+    }
+    return handle.index;
+}
+
+//--------------------------------------------------------------------------------------------
+// Query volumes
+//--------------------------------------------------------------------------------------------
+
+static loose_tree_overlap _loose_tree_test_aabb(const aabb* box, const void* query) {
+    const aabb* q = (const aabb*)query;
+    if (!fr_aabb_overlap(box, q)) {
+        return LOOSE_TREE_OUTSIDE;
+    }
+    b8 inside = q->min.x <= box->min.x && q->min.y <= box->min.y && q->min.z <= box->min.z &&
+                box->max.x <= q->max.x && box->max.y <= q->max.y && box->max.z <= q->max.z;
+    return inside ? LOOSE_TREE_INSIDE : LOOSE_TREE_INTERSECTS;
+}
+
+static loose_tree_overlap _loose_tree_test_sphere(const aabb* box, const void* query) {
+    const sphere* s = (const sphere*)query;
+    if (!fr_sphere_aabb_overlap(s, box)) {
+        return LOOSE_TREE_OUTSIDE;
+    }
+    // The box is inside when its corner farthest from the center is
+    f32 distance2 = 0.0f;
+    for (u32 axis = 0; axis < 3; ++axis) {
+        f32 d = fr_max(fr_abs(box->min.data[axis] - s->center.data[axis]),
+                       fr_abs(box->max.data[axis] - s->center.data[axis]));
+        distance2 += d * d;
+    }
+    return distance2 <= s->radius * s->radius ? LOOSE_TREE_INSIDE : LOOSE_TREE_INTERSECTS;
+}
+
+static loose_tree_overlap _loose_tree_test_frustum(const aabb* box, const void* query) {
+    const frustum* f = (const frustum*)query;
+    vec3 center, extent;
+    fr_aabb_center(box, &center);
+    fr_aabb_half_extents(box, &extent);
+    loose_tree_overlap result = LOOSE_TREE_INSIDE;
+    for (u32 p = 0; p < FR_FRUSTUM_PLANE_COUNT; ++p) {
+        const vec4* plane = &f->planes[p];
+        f32 distance = plane->x * center.x + plane->y * center.y + plane->z * center.z + plane->w;
+        f32 reach = fr_abs(plane->x) * extent.x + fr_abs(plane->y) * extent.y + fr_abs(plane->z) * extent.z;
+        if (distance + reach < 0.0f) {
+            return LOOSE_TREE_OUTSIDE;
+        }
+        if (distance - reach < 0.0f) {
+            result = LOOSE_TREE_INTERSECTS;
+        }
+    }
+    return result;
+}
+
+// Lists the objects of the nodes that are not outside the query volume. The root is never culled, as the objects
+// outside the world do not fit in its bounds.
+static u32 _loose_tree_query(
+    const loose_tree* tree, PFN_loose_tree_test test, const void* query, spatial_handle* out_handles) {
+    u32 found = 0;
+    loose_tree_entry stack[LOOSE_TREE_STACK_SIZE];
+    u32 size = 0;
+    stack[size++] = (loose_tree_entry){.node = 0, .inside = FALSE};
+    while (size > 0) {
+        loose_tree_entry entry = stack[--size];
+        const loose_tree_node* node = &tree->nodes[entry.node];
+        if (!entry.inside && entry.node != 0) {
+            aabb loose;
+            _loose_tree_node_bounds(tree, &node->center, node->depth, &loose);
+            loose_tree_overlap overlap = test(&loose, query);
+            if (overlap == LOOSE_TREE_OUTSIDE) {
+                continue;
+            }
+            entry.inside = overlap == LOOSE_TREE_INSIDE;
+        }
+
+        for (u32 slot = node->first_object; slot != FR_LOOSE_TREE_INVALID; slot = tree->objects[slot].next) {
+            const loose_tree_object* object = &tree->objects[slot];
+            if (entry.inside || test(&object->bounds, query) != LOOSE_TREE_OUTSIDE) {
+                out_handles[found++] = (spatial_handle){slot, object->generation};
+            }
+        }
+        for (u32 child = 0; child < tree->child_count; ++child) {
+            if (node->children[child] != 0) {
+                stack[size++] = (loose_tree_entry){.node = node->children[child], .inside = entry.inside};
+            }
+        }
+    }
+    return found;
+}
+
+//--------------------------------------------------------------------------------------------
+// Tree
+//--------------------------------------------------------------------------------------------
+
+b8 fr_loose_tree_create(const loose_tree_config* config, loose_tree* out_tree) {
+    u32 max_depth = config->max_depth ? config->max_depth : FR_LOOSE_TREE_DEFAULT_MAX_DEPTH;
+    if (max_depth > FR_LOOSE_TREE_MAX_DEPTH) {
+        FR_CORE_ERROR("Loose tree depth %u is above the limit of %u", max_depth, FR_LOOSE_TREE_MAX_DEPTH);
+        return FALSE;
+    }
+    if (fr_aabb_surface_area(&config->bounds) <= 0.0f) {
+        FR_CORE_ERROR("Loose tree bounds must have a volume");
+        return FALSE;
+    }
+
+    memset(out_tree, 0, sizeof(loose_tree));
+    out_tree->type = config->type;
+    out_tree->max_depth = max_depth;
+    if (config->type == LOOSE_TREE_TYPE_QUADTREE) {
+        out_tree->axes[0] = 0;
+        out_tree->axes[1] = 2;
+        out_tree->axis_count = 2;
+    } else {
+        out_tree->axes[0] = 0;
+        out_tree->axes[1] = 1;
+        out_tree->axes[2] = 2;
+        out_tree->axis_count = 3;
+    }
+    out_tree->child_count = 1u << out_tree->axis_count;
+
+    fr_aabb_half_extents(&config->bounds, &out_tree->cell_half_extents[0]);
+    for (u32 depth = 1; depth <= max_depth; ++depth) {
+        out_tree->cell_half_extents[depth] = out_tree->cell_half_extents[depth - 1];
+        for (u32 i = 0; i < out_tree->axis_count; ++i) {
+            out_tree->cell_half_extents[depth].data[out_tree->axes[i]] *= 0.5f;
+        }
+    }
+
+    out_tree->node_capacity = LOOSE_TREE_INITIAL_NODE_CAPACITY;
+    out_tree->nodes = fr_memory_allocate(sizeof(loose_tree_node) * out_tree->node_capacity, MEMORY_TYPE_TREE);
+    out_tree->node_count = 1;
+    out_tree->free_node = FR_LOOSE_TREE_INVALID;
+    fr_aabb_center(&config->bounds, &out_tree->nodes[0].center);
+    out_tree->nodes[0].first_object = FR_LOOSE_TREE_INVALID;
+
+    out_tree->slot_capacity = config->initial_capacity ? config->initial_capacity : FR_LOOSE_TREE_DEFAULT_CAPACITY;
+    out_tree->objects = fr_memory_allocate(sizeof(loose_tree_object) * out_tree->slot_capacity, MEMORY_TYPE_TREE);
+    out_tree->free_slot = FR_LOOSE_TREE_INVALID;
+    return TRUE;
+}
+
+void fr_loose_tree_destroy(loose_tree* tree) {
+    if (tree->nodes) {
+        fr_memory_free(tree->nodes, sizeof(loose_tree_node) * tree->node_capacity, MEMORY_TYPE_TREE);
+    }
+    if (tree->objects) {
+        fr_memory_free(tree->objects, sizeof(loose_tree_object) * tree->slot_capacity, MEMORY_TYPE_TREE);
+    }
+    memset(tree, 0, sizeof(loose_tree));
+}
+
+spatial_handle fr_loose_tree_insert(loose_tree* tree, const aabb* bounds) {
+    u32 slot;
+    if (tree->free_slot != FR_LOOSE_TREE_INVALID) {
+        slot = tree->free_slot;
+        tree->free_slot = tree->objects[slot].next;
+    } else {
+        if (tree->slot_count == tree->slot_capacity) {
+            tree->objects = fr_memory_reallocate(tree->objects,
+                                                 sizeof(loose_tree_object) * tree->slot_capacity,
+                                                 sizeof(loose_tree_object) * tree->slot_capacity * 2,
+                                                 MEMORY_TYPE_TREE);
+            tree->slot_capacity *= 2;
+        }
+        slot = tree->slot_count++;
+        tree->objects[slot].generation = 1;
+    }
+
+    tree->objects[slot].bounds = *bounds;
+    _loose_tree_link(tree, slot, _loose_tree_place(tree, bounds));
+    tree->object_count++;
+    return (spatial_handle){slot, tree->objects[slot].generation};
+}
+
+b8 fr_loose_tree_remove(loose_tree* tree, spatial_handle handle) {
+    u32 slot = _loose_tree_slot(tree, handle);
+    if (slot == FR_LOOSE_TREE_INVALID) {
+        return FALSE;
+    }
+
+    loose_tree_object* object = &tree->objects[slot];
+    u32 node = object->node;
+    _loose_tree_unlink(tree, slot);
+    _loose_tree_prune(tree, node);
+    object->node = FR_LOOSE_TREE_INVALID;
+    if (++object->generation == 0) {
+        object->generation = 1;
+    }
+    object->next = tree->free_slot;
+    tree->free_slot = slot;
+    tree->object_count--;
+    return TRUE;
+}
+
+b8 fr_loose_tree_update(loose_tree* tree, spatial_handle handle, const aabb* bounds) {
+    u32 slot = _loose_tree_slot(tree, handle);
+    if (slot == FR_LOOSE_TREE_INVALID) {
+        return FALSE;
+    }
+
+    loose_tree_object* object = &tree->objects[slot];
+    object->bounds = *bounds;
+    const loose_tree_node* node = &tree->nodes[object->node];
+    vec3 center;
+    if (_loose_tree_depth(tree, bounds, &center) == node->depth &&
+        (object->node == 0 || _loose_tree_node_fits(tree, &node->center, node->depth, bounds))) {
+        return TRUE;
+    }
+
+    u32 previous = object->node;
+    _loose_tree_unlink(tree, slot);
+    // Placing before pruning keeps the nodes the object moves through from going back and forth to the pool
+    _loose_tree_link(tree, slot, _loose_tree_place(tree, bounds));
+    _loose_tree_prune(tree, previous);
+    return TRUE;
+}
+
+b8 fr_loose_tree_get_bounds(const loose_tree* tree, spatial_handle handle, aabb* out_bounds) {
+    u32 slot = _loose_tree_slot(tree, handle);
+    if (slot == FR_LOOSE_TREE_INVALID) {
+        return FALSE;
+    }
+    *out_bounds = tree->objects[slot].bounds;
+    return TRUE;
+}
+
+u32 fr_loose_tree_query_aabb(const loose_tree* tree, const aabb* box, spatial_handle* out_handles) {
+    return _loose_tree_query(tree, _loose_tree_test_aabb, box, out_handles);
+}
+
+u32 fr_loose_tree_query_sphere(const loose_tree* tree, const sphere* s, spatial_handle* out_handles) {
+    return _loose_tree_query(tree, _loose_tree_test_sphere, s, out_handles);
+}
+
+u32 fr_loose_tree_cull_frustum(const loose_tree* tree, const frustum* f, spatial_handle* out_handles) {
+    return _loose_tree_query(tree, _loose_tree_test_frustum, f, out_handles);
+}
+
+u32 fr_loose_tree_query_nearest(const loose_tree* tree,
+                                const vec3* point,
+                                u32 k,
+                                f32 max_distance,
+                                spatial_handle* out_handles,
+                                f32* out_distances) {
+    if (k == 0) {
+        return 0;
+    }
+
+    // out_distances holds the squared distances of the closest objects so far, sorted, until the end
+    u32 found = 0;
+    f32 limit = max_distance * max_distance;
+    loose_tree_entry stack[LOOSE_TREE_STACK_SIZE];
+    u32 size = 0;
+    stack[size++] = (loose_tree_entry){.node = 0, .distance2 = 0.0f};
+    while (size > 0) {
+        loose_tree_entry entry = stack[--size];
+        if (entry.distance2 > (found == k ? out_distances[k - 1] : limit)) {
+            continue;
+        }
+
+        const loose_tree_node* node = &tree->nodes[entry.node];
+        for (u32 slot = node->first_object; slot != FR_LOOSE_TREE_INVALID; slot = tree->objects[slot].next) {
+            const loose_tree_object* object = &tree->objects[slot];
+            f32 distance2 = fr_aabb_distance2(&object->bounds, point);
+            if (distance2 > (found == k ? out_distances[k - 1] : limit)) {
+                continue;
+            }
+            u32 i = found < k ? found++ : k - 1;
+            for (; i > 0 && out_distances[i - 1] > distance2; --i) {
+                out_distances[i] = out_distances[i - 1];
+                out_handles[i] = out_handles[i - 1];
+            }
+            out_distances[i] = distance2;
+            out_handles[i] = (spatial_handle){slot, object->generation};
+        }
+
+        // Push the children in range from the farthest to the nearest, so the nearest is searched first and its
+        // objects prune the others
+        loose_tree_entry children[FR_LOOSE_TREE_MAX_CHILDREN];
+        u32 child_count = 0;
+        f32 worst = found == k ? out_distances[k - 1] : limit;
+        for (u32 child = 0; child < tree->child_count; ++child) {
+            if (node->children[child] == 0) {
+                continue;
+            }
+            const loose_tree_node* child_node = &tree->nodes[node->children[child]];
+            aabb loose;
+            _loose_tree_node_bounds(tree, &child_node->center, child_node->depth, &loose);
+            f32 distance2 = fr_aabb_distance2(&loose, point);
+            if (distance2 > worst) {
+                continue;
+            }
+            u32 i = child_count++;
+            for (; i > 0 && children[i - 1].distance2 < distance2; --i) {
+                children[i] = children[i - 1];
+            }
+            children[i] = (loose_tree_entry){.node = node->children[child], .distance2 = distance2};
+        }
+        memcpy(&stack[size], children, child_count * sizeof(loose_tree_entry));
+        size += child_count;
+    }
+
+    for (u32 i = 0; i < found; ++i) {
+        out_distances[i] = fr_sqrt(out_distances[i]);
+    }
+    return found;
+}
@@ -0,0 +1,288 @@
+/**
+ * @file loose_tree.h
+ * @author Aditya Rajagopal
+ * @brief Loose octree and quadtree over the bounding boxes of moving objects.
+ * @details The tree divides the world bounds into cells, 8 per node for the octree and 4 for the quadtree, which
+ * splits the x and z axes and keeps the full height of the world along y. The bounds of a node are its cell grown by
+ * half a cell on every side, so an object fits in any node whose cell contains its center and that is at least as
+ * large as the object. The depth of an object follows from its size alone and its node from its center, so an
+ * insertion walks straight down from the root without comparing against other objects.
+ *
+ * Moving an object only touches the tree when it leaves the bounds of its node or changes size enough to belong at
+ * another depth, and then costs one removal and one insertion. Each node keeps its objects in a linked list through
+ * the object slots, so removals do not search. Nodes are taken from a pool as objects arrive and returned to it when
+ * their subtree empties, and both pools grow by doubling.
+ *
+ * Objects are referred to by handles that hold the index of their slot and its generation, which changes when the
+ * slot is freed, so handles to removed objects are detected instead of aliasing the objects that reuse the slot.
+ * Objects outside the world bounds or larger than them live in the root, whose objects every query tests.
+ * @version 0.0.1
+ * @date 2024-05-03
+ *
+ * @copyright Fracture Game Engine is Copyright (c) Aditya Rajagopal 2024-2024
+ *
+ */
+#pragma once
+
+#include "fracture/core/defines.h"
+#include "fracture/core/library/math/frustum.h"
+#include "fracture/core/library/math/geometry.h"
+
+/** @brief Deepest level of a tree below the root */
+#define FR_LOOSE_TREE_MAX_DEPTH 16
+
+/** @brief Depth used when the configuration leaves it at 0 */
+#define FR_LOOSE_TREE_DEFAULT_MAX_DEPTH 8
+
+/** @brief Number of object slots allocated when the configuration leaves it at 0 */
+#define FR_LOOSE_TREE_DEFAULT_CAPACITY 256
+
+/** @brief Largest number of children of a node */
+#define FR_LOOSE_TREE_MAX_CHILDREN 8
+
+/** @brief Index of no node or object */
+#define FR_LOOSE_TREE_INVALID 0xFFFFFFFFu
+
+/**
+ * @brief The kinds of tree.
+ *
+ */
+typedef enum loose_tree_type {
+    /** @brief Splits the x and z axes into 4 children per node */
+    LOOSE_TREE_TYPE_QUADTREE = 0,
+
+    /** @brief Splits all three axes into 8 children per node */
+    LOOSE_TREE_TYPE_OCTREE,
+} loose_tree_type;
+
+/**
+ * @brief Handle to an object of a spatial structure. A zero initialized handle is invalid.
+ *
+ */
+typedef struct spatial_handle {
+    /** @brief Index of the slot of the object */
+    u32 index;
+
+    /** @brief Generation of the slot when the handle was created. Never 0 for a valid handle. */
+    u32 generation;
+} spatial_handle;
+
+/**
+ * @brief Loose tree configuration
+ *
+ */
+typedef struct loose_tree_config {
+    /** @brief Quadtree or octree */
+    loose_tree_type type;
+
+    /** @brief Bounds of the world, the cell of the root */
+    aabb bounds;
+
+    /** @brief Deepest level below the root, at most FR_LOOSE_TREE_MAX_DEPTH. 0 uses FR_LOOSE_TREE_DEFAULT_MAX_DEPTH */
+    u32 max_depth;
+
+    /** @brief Number of object slots to start with. 0 uses FR_LOOSE_TREE_DEFAULT_CAPACITY */
+    u32 initial_capacity;
+} loose_tree_config;
+
+/**
+ * @brief A node of a loose tree.
+ *
+ */
+typedef struct loose_tree_node {
+    /** @brief Center of the cell of the node */
+    vec3 center;
+
+    /** @brief Index of the parent node. For nodes in the pool, the index of the next free node. */
+    u32 parent;
+
+    /** @brief Index of each child node, 0 where there is none since the root is nobody's child */
+    u32 children[FR_LOOSE_TREE_MAX_CHILDREN];
+
+    /** @brief Number of children */
+    u32 child_count;
+
+    /** @brief Slot of the first object of the node */
+    u32 first_object;
+
+    /** @brief Number of objects in the node */
+    u32 object_count;
+
+    /** @brief Level of the node, 0 for the root */
+    u32 depth;
+} loose_tree_node;
+
+/**
+ * @brief The slot of an object of a loose tree.
+ *
+ */
+typedef struct loose_tree_object {
+    /** @brief Bounds of the object */
+    aabb bounds;
+
+    /** @brief Node holding the object, FR_LOOSE_TREE_INVALID for free slots */
+    u32 node;
+
+    /** @brief Next object of the node. For free slots, the next free slot. */
+    u32 next;
+
+    /** @brief Previous object of the node */
+    u32 previous;
+
+    /** @brief Generation of the slot */
+    u32 generation;
+} loose_tree_object;
+
+/**
+ * @brief A loose octree or quadtree. The root is nodes[0].
+ *
+ */
+typedef struct loose_tree {
+    /** @brief Quadtree or octree */
+    loose_tree_type type;
+
+    /** @brief The axes split by the nodes, 0 for x, 1 for y and 2 for z */
+    u32 axes[3];
+
+    /** @brief Number of split axes */
+    u32 axis_count;
+
+    /** @brief Number of children of a node, 2 to the power of axis_count */
+    u32 child_count;
+
+    /** @brief Deepest level below the root */
+    u32 max_depth;
+
+    /** @brief Half the size of the cells at each depth */
+    vec3 cell_half_extents[FR_LOOSE_TREE_MAX_DEPTH + 1];
+
+    /** @brief The nodes */
+    loose_tree_node* nodes;
+
+    /** @brief Number of nodes in use or in the pool */
+    u32 node_count;
+
+    /** @brief Number of allocated nodes */
+    u32 node_capacity;
+
+    /** @brief First node of the pool */
+    u32 free_node;
+
+    /** @brief The object slots */
+    loose_tree_object* objects;
+
+    /** @brief Number of objects in the tree */
+    u32 object_count;
+
+    /** @brief Number of slots in use or freed */
+    u32 slot_count;
+
+    /** @brief Number of allocated slots */
+    u32 slot_capacity;
+
+    /** @brief First free slot */
+    u32 free_slot;
+} loose_tree;
+
+/**
+ * @brief Creates an empty tree.
+ *
+ * @param config The configuration
+ * @param out_tree The tree, destroy with fr_loose_tree_destroy
+ * @return b8 TRUE if the tree was created, FALSE if the bounds are empty or the depth is too large
+ */
+FR_API b8 fr_loose_tree_create(const loose_tree_config* config, loose_tree* out_tree);
+
+/**
+ * @brief Frees a tree. Its handles become invalid.
+ *
+ * @param tree The tree
+ */
+FR_API void fr_loose_tree_destroy(loose_tree* tree);
+
+/**
+ * @brief Adds an object to a tree.
+ *
+ * @param tree The tree
+ * @param bounds The bounds of the object
+ * @return spatial_handle Handle to the object
+ */
+FR_API spatial_handle fr_loose_tree_insert(loose_tree* tree, const aabb* bounds);
+
+/**
+ * @brief Removes an object from a tree.
+ *
+ * @param tree The tree
+ * @param handle Handle to the object
+ * @return b8 TRUE if the object was removed, FALSE if the handle is invalid
+ */
+FR_API b8 fr_loose_tree_remove(loose_tree* tree, spatial_handle handle);
+
+/**
+ * @brief Changes the bounds of an object. The object keeps its node while it fits in it and its size still belongs at
+ * the depth of the node.
+ *
+ * @param tree The tree
+ * @param handle Handle to the object
+ * @param bounds The new bounds
+ * @return b8 TRUE if the object was updated, FALSE if the handle is invalid
+ */
+FR_API b8 fr_loose_tree_update(loose_tree* tree, spatial_handle handle, const aabb* bounds);
+
+/**
+ * @brief Gets the bounds of an object.
+ *
+ * @param tree The tree
+ * @param handle Handle to the object
+ * @param out_bounds The bounds of the object
+ * @return b8 TRUE if the handle is valid
+ */
+FR_API b8 fr_loose_tree_get_bounds(const loose_tree* tree, spatial_handle handle, aabb* out_bounds);
+
+/**
+ * @brief Lists the objects whose bounds overlap a box.
+ *
+ * @param tree The tree
+ * @param box The query box
+ * @param out_handles The handles of the objects, in no particular order. Must hold tree->object_count handles.
+ * @return u32 The number of listed objects
+ */
+FR_API u32 fr_loose_tree_query_aabb(const loose_tree* tree, const aabb* box, spatial_handle* out_handles);
+
+/**
+ * @brief Lists the objects whose bounds overlap a sphere.
+ *
+ * @param tree The tree
+ * @param s The query sphere
+ * @param out_handles The handles of the objects, in no particular order. Must hold tree->object_count handles.
+ * @return u32 The number of listed objects
+ */
+FR_API u32 fr_loose_tree_query_sphere(const loose_tree* tree, const sphere* s, spatial_handle* out_handles);
+
+/**
+ * @brief Lists the objects whose bounds are not entirely behind a plane of a frustum.
+ *
+ * @param tree The tree
+ * @param f The frustum
+ * @param out_handles The handles of the objects, in no particular order. Must hold tree->object_count handles.
+ * @return u32 The number of listed objects
+ */
+FR_API u32 fr_loose_tree_cull_frustum(const loose_tree* tree, const frustum* f, spatial_handle* out_handles);
+
+/**
+ * @brief Finds the objects closest to a point, measured to their bounds.
+ *
+ * @param tree The tree
+ * @param point The point
+ * @param k The largest number of objects to find
+ * @param max_distance Objects further away than this are ignored
+ * @param out_handles The handles of the objects from the closest to the farthest. Must hold k handles.
+ * @param out_distances The distances of the objects. Must hold k distances.
+ * @return u32 The number of objects found, at most k
+ */
+FR_API u32 fr_loose_tree_query_nearest(const loose_tree* tree,
+                                       const vec3* point,
+                                       u32 k,
+                                       f32 max_distance,
+                                       spatial_handle* out_handles,
+                                       f32* out_distances);
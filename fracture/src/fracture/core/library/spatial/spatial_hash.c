@@ -0,0 +1,433 @@
+#include "spatial_hash.h"
+
+#include <string.h>
+
+#include "fracture/core/library/atomics.h"
+#include "fracture/core/library/math/simd/sse.h"
+#include "fracture/core/library/math/utils.h"
+#include "fracture/core/systems/fracture_memory.h"
+#include "fracture/core/systems/job_system.h"
+#include "fracture/core/systems/logging.h"
+
+// Number of objects or entries processed by one job
+#define SPATIAL_HASH_BATCH_SIZE 4096
+
+// Number of buckets summed by one job of the prefix sum
+#define SPATIAL_HASH_SCAN_BLOCK_SIZE 16384
+
+// The cells a query looks at span at most 3 per axis, and one more when rounding puts both ends of the query range
+// right on cell boundaries
+#define SPATIAL_HASH_MAX_NEIGHBOR_BUCKETS 64
+
+typedef struct spatial_hash_build {
+    spatial_hash* grid;
+    const vec3* positions;
+    u32* block_sums;
+    u32 block_count;
+} spatial_hash_build;
+
+typedef struct spatial_hash_pairs {
+    const spatial_hash* grid;
+    f32 distance;
+    spatial_pair* out_pairs;
+    u32 capacity;
+    // The number of pairs of each batch, then the index of the first pair of each batch
+    u32* batch_offsets;
+    b8 write;
+} spatial_hash_pairs;
+
+// A point and a squared distance ready for the tests of 4 entries at a time
+typedef struct spatial_hash_point {
+#if FR_SIMD == 1
+    __m128 x, y, z;
+    __m128 distance2;
+#else
+    f32 x, y, z;
+    f32 distance2;
+#endif
+} spatial_hash_point;
+
+//--------------------------------------------------------------------------------------------
+// Build
+//--------------------------------------------------------------------------------------------
+
+static void _spatial_hash_count(u32 start, u32 end, void* data) {
+    spatial_hash_build* build = (spatial_hash_build*)data;
+    spatial_hash* grid = build->grid;
+    for (u32 i = start; i < end; ++i) {
+        ivec3 cell;
+        fr_spatial_hash_cell(grid, &build->positions[i], &cell);
+        u32 bucket = fr_spatial_hash_bucket(grid, &cell);
+        grid->object_buckets[i] = bucket;
+        fr_atomic_fetch_add_i32((volatile i32*)&grid->cursors[bucket], 1, FR_MEMORY_ORDER_RELAXED);
+    }
+}
+
+static void _spatial_hash_sum_blocks(u32 start, u32 end, void* data) {
+    spatial_hash_build* build = (spatial_hash_build*)data;
+    const spatial_hash* grid = build->grid;
+    for (u32 block = start; block < end; ++block) {
+        u32 first = block * SPATIAL_HASH_SCAN_BLOCK_SIZE;
+        u32 last = MIN(first + SPATIAL_HASH_SCAN_BLOCK_SIZE, grid->bucket_count);
+        u32 sum = 0;
+        for (u32 bucket = first; bucket < last; ++bucket) {
+            sum += grid->cursors[bucket];
+        }
+        build->block_sums[block] = sum;
+    }
+}
+
+// Turns the counts of the buckets into the offsets of their first entries, which are also where the scatter starts
+static void _spatial_hash_offset_blocks(u32 start, u32 end, void* data) {
+    spatial_hash_build* build = (spatial_hash_build*)data;
+    spatial_hash* grid = build->grid;
+    for (u32 block = start; block < end; ++block) {
+        u32 first = block * SPATIAL_HASH_SCAN_BLOCK_SIZE;
+        u32 last = MIN(first + SPATIAL_HASH_SCAN_BLOCK_SIZE, grid->bucket_count);
+        u32 offset = build->block_sums[block];
+        for (u32 bucket = first; bucket < last; ++bucket) {
+            u32 count = grid->cursors[bucket];
+            grid->bucket_starts[bucket] = offset;
+            grid->cursors[bucket] = offset;
+            offset += count;
+        }
+    }
+}
+
+static void _spatial_hash_scatter(u32 start, u32 end, void* data) {
+    spatial_hash* grid = ((spatial_hash_build*)data)->grid;
+    for (u32 i = start; i < end; ++i) {
+        u32 entry = (u32)fr_atomic_fetch_add_i32(
+            (volatile i32*)&grid->cursors[grid->object_buckets[i]], 1, FR_MEMORY_ORDER_RELAXED);
+        grid->entries[entry] = i;
+    }
+}
+
+// Sorts the entries of each bucket, whose order depends on the order the scatter jobs ran in, and copies their
+// positions next to them
+static void _spatial_hash_sort_buckets(u32 start, u32 end, void* data) {
+    spatial_hash_build* build = (spatial_hash_build*)data;
+    spatial_hash* grid = build->grid;
+    u32 first = grid->bucket_starts[start];
+    u32 last = grid->bucket_starts[end];
+    for (u32 bucket = start; bucket < end; ++bucket) {
+        u32* entries = grid->entries + grid->bucket_starts[bucket];
+        u32 count = grid->bucket_starts[bucket + 1] - grid->bucket_starts[bucket];
+        for (u32 i = 1; i < count; ++i) {
+            u32 entry = entries[i];
+            u32 j = i;
+            for (; j > 0 && entries[j - 1] > entry; --j) {
+                entries[j] = entries[j - 1];
+            }
+            entries[j] = entry;
+        }
+    }
+    for (u32 k = first; k < last; ++k) {
+        const vec3* position = &build->positions[grid->entries[k]];
+        grid->positions[0][k] = position->x;
+        grid->positions[1][k] = position->y;
+        grid->positions[2][k] = position->z;
+    }
+}
+
+//--------------------------------------------------------------------------------------------
+// Queries
+//--------------------------------------------------------------------------------------------
+
+static void _spatial_hash_point_create(f32 x, f32 y, f32 z, f32 distance, spatial_hash_point* out) {
+#if FR_SIMD == 1
+    out->x = _mm_set1_ps(x);
+    out->y = _mm_set1_ps(y);
+    out->z = _mm_set1_ps(z);
+    out->distance2 = _mm_set1_ps(distance * distance);
+#else
+    out->x = x;
+    out->y = y;
+    out->z = z;
+    out->distance2 = distance * distance;
+#endif
+}
+
+// Returns the mask of the 4 entries from k within the distance of a point. The position arrays are padded, so the
+// entries past the end of the grid are read but must be masked out by the caller.
+FR_FORCE_INLINE u32 _spatial_hash_match(const spatial_hash* grid, u32 k, const spatial_hash_point* p) {
+#if FR_SIMD == 1
+    __m128 dx = _mm_sub_ps(_mm_loadu_ps(grid->positions[0] + k), p->x);
+    __m128 dy = _mm_sub_ps(_mm_loadu_ps(grid->positions[1] + k), p->y);
+    __m128 dz = _mm_sub_ps(_mm_loadu_ps(grid->positions[2] + k), p->z);
+    __m128 d2 = _mm_mul_ps(dx, dx);
+    d2 = fr_simd_fmadd(dy, dy, d2);
+    d2 = fr_simd_fmadd(dz, dz, d2);
+    return (u32)_mm_movemask_ps(_mm_cmple_ps(d2, p->distance2));
+#else
+    u32 mask = 0;
+    for (u32 i = 0; i < 4; ++i) {
+        f32 dx = grid->positions[0][k + i] - p->x;
+        f32 dy = grid->positions[1][k + i] - p->y;
+        f32 dz = grid->positions[2][k + i] - p->z;
+        mask |= (u32)(dx * dx + dy * dy + dz * dz <= p->distance2) << i;
+    }
+    return mask;
+#endif
+}
+
+// Gets the buckets of a box of cells, sorted and without repeats
+static u32 _spatial_hash_neighbor_buckets(
+    const spatial_hash* grid, const ivec3* min, const ivec3* max, u32 out[SPATIAL_HASH_MAX_NEIGHBOR_BUCKETS]) {
+    u32 count = 0;
+    ivec3 cell;
+    for (cell.z = min->z; cell.z <= max->z; ++cell.z) {
+        for (cell.y = min->y; cell.y <= max->y; ++cell.y) {
+            for (cell.x = min->x; cell.x <= max->x; ++cell.x) {
+                u32 bucket = fr_spatial_hash_bucket(grid, &cell);
+                u32 i = count;
+                while (i > 0 && out[i - 1] > bucket) {
+                    --i;
+                }
+                if (i > 0 && out[i - 1] == bucket) {
+                    continue;
+                }
+                memmove(&out[i + 1], &out[i], (count - i) * sizeof(u32));
+                out[i] = bucket;
+                ++count;
+            }
+        }
+    }
+    return count;
+}
+
+// Gets the cells of the points within a distance of a point
+static void _spatial_hash_range(
+    const spatial_hash* grid, const vec3* point, f32 distance, ivec3* out_min, ivec3* out_max) {
+    vec3 offset, corner;
+    fr_vec3_fill(distance, &offset);
+    fr_vec3_sub(point, &offset, &corner);
+    fr_spatial_hash_cell(grid, &corner, out_min);
+    fr_vec3_add(point, &offset, &corner);
+    fr_spatial_hash_cell(grid, &corner, out_max);
+}
+
+static void _spatial_hash_pairs_batches(u32 start, u32 end, void* data) {
+    spatial_hash_pairs* pairs = (spatial_hash_pairs*)data;
+    const spatial_hash* grid = pairs->grid;
+    for (u32 batch = start; batch < end; ++batch) {
+        u32 found = pairs->write ? pairs->batch_offsets[batch] : 0;
+        u32 first = batch * SPATIAL_HASH_BATCH_SIZE;
+        u32 last = MIN(first + SPATIAL_HASH_BATCH_SIZE, grid->count);
+
+        // Entries of the same cell share their neighbors, and the entries of a bucket are mostly of the same cell
+        u32 buckets[SPATIAL_HASH_MAX_NEIGHBOR_BUCKETS];
+        u32 bucket_count = 0;
+        ivec3 cached_min = {.x = 1, .y = 1, .z = 1};
+        ivec3 cached_max = {.x = 0, .y = 0, .z = 0};
+        for (u32 k = first; k < last; ++k) {
+            vec3 point;
+            fr_vec3_zeros(&point);
+            point.x = grid->positions[0][k];
+            point.y = grid->positions[1][k];
+            point.z = grid->positions[2][k];
+            ivec3 min, max;
+            _spatial_hash_range(grid, &point, pairs->distance, &min, &max);
+            if (memcmp(&min, &cached_min, sizeof(ivec3)) != 0 || memcmp(&max, &cached_max, sizeof(ivec3)) != 0) {
+                bucket_count = _spatial_hash_neighbor_buckets(grid, &min, &max, buckets);
+                cached_min = min;
+                cached_max = max;
+            }
+
+            spatial_hash_point p;
+            _spatial_hash_point_create(point.x, point.y, point.z, pairs->distance, &p);
+            for (u32 i = 0; i < bucket_count; ++i) {
+                // Each pair is found from its entry that comes first
+                u32 bucket_end = grid->bucket_starts[buckets[i] + 1];
+                for (u32 m = MAX(grid->bucket_starts[buckets[i]], k + 1); m < bucket_end; m += 4) {
+                    u32 mask = _spatial_hash_match(grid, m, &p);
+                    if (bucket_end - m < 4) {
+                        mask &= (1u << (bucket_end - m)) - 1;
+                    }
+                    if (!pairs->write) {
+                        found += (u32)__builtin_popcount(mask);
+                        continue;
+                    }
+                    for (; mask != 0; mask &= mask - 1) {
+                        u32 a = grid->entries[k];
+                        u32 b = grid->entries[m + (u32)__builtin_ctz(mask)];
+                        if (found < pairs->capacity) {
+                            pairs->out_pairs[found] = (spatial_pair){MIN(a, b), MAX(a, b)};
+                        }
+                        ++found;
+                    }
+                }
+            }
+        }
+        if (!pairs->write) {
+            pairs->batch_offsets[batch] = found;
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------------------
+// Grid
+//--------------------------------------------------------------------------------------------
+
+static void _spatial_hash_free_objects(spatial_hash* grid) {
+    if (grid->capacity == 0) {
+        return;
+    }
+    u64 padded = grid->capacity + 3;
+    fr_memory_free(grid->entries, sizeof(u32) * grid->capacity, MEMORY_TYPE_HASH_TABLE);
+    fr_memory_free(grid->object_buckets, sizeof(u32) * grid->capacity, MEMORY_TYPE_HASH_TABLE);
+    for (u32 c = 0; c < 3; ++c) {
+        fr_memory_free(grid->positions[c], sizeof(f32) * padded, MEMORY_TYPE_HASH_TABLE);
+    }
+}
+
+// The position arrays get 3 more floats so the last entries can be loaded 4 at a time
+static void _spatial_hash_allocate_objects(spatial_hash* grid, u32 capacity) {
+    _spatial_hash_free_objects(grid);
+    grid->capacity = capacity;
+    u64 padded = capacity + 3;
+    grid->entries = fr_memory_allocate(sizeof(u32) * capacity, MEMORY_TYPE_HASH_TABLE);
+    grid->object_buckets = fr_memory_allocate(sizeof(u32) * capacity, MEMORY_TYPE_HASH_TABLE);
+    for (u32 c = 0; c < 3; ++c) {
+        grid->positions[c] = fr_memory_allocate(sizeof(f32) * padded, MEMORY_TYPE_HASH_TABLE);
+    }
+}
+
+static void _spatial_hash_free_buckets(spatial_hash* grid) {
+    if (grid->bucket_capacity == 0) {
+        return;
+    }
+    fr_memory_free(grid->bucket_starts, sizeof(u32) * (grid->bucket_capacity + 1), MEMORY_TYPE_HASH_TABLE);
+    fr_memory_free(grid->cursors, sizeof(u32) * grid->bucket_capacity, MEMORY_TYPE_HASH_TABLE);
+}
+
+b8 fr_spatial_hash_create(f32 cell_size, u32 capacity, spatial_hash* out_grid) {
+    if (!(cell_size > 0.0f)) {
+        FR_CORE_ERROR("Spatial hash cell size must be positive, got %f", cell_size);
+        return FALSE;
+    }
+
+    memset(out_grid, 0, sizeof(spatial_hash));
+    out_grid->cell_size = cell_size;
+    out_grid->inv_cell_size = 1.0f / cell_size;
+    if (capacity > 0) {
+        _spatial_hash_allocate_objects(out_grid, capacity);
+    }
+    fr_spatial_hash_build(out_grid, NULL_PTR, 0);
+    return TRUE;
+}
+
+void fr_spatial_hash_destroy(spatial_hash* grid) {
+    _spatial_hash_free_objects(grid);
+    _spatial_hash_free_buckets(grid);
+    memset(grid, 0, sizeof(spatial_hash));
+}
+
+void fr_spatial_hash_build(spatial_hash* grid, const vec3* positions, u32 count) {
+    if (count > grid->capacity) {
+        _spatial_hash_allocate_objects(grid, MAX(count, grid->capacity * 2));
+    }
+
+    u32 bucket_count = MAX((u32)fr_next_pow2((i32)(MAX(count, 1) * 2)), FR_SPATIAL_HASH_MIN_BUCKETS);
+    if (bucket_count > grid->bucket_capacity) {
+        _spatial_hash_free_buckets(grid);
+        grid->bucket_capacity = bucket_count;
+        grid->bucket_starts = fr_memory_allocate(sizeof(u32) * (bucket_count + 1), MEMORY_TYPE_HASH_TABLE);
+        grid->cursors = fr_memory_allocate(sizeof(u32) * bucket_count, MEMORY_TYPE_HASH_TABLE);
+    }
+    grid->count = count;
+    grid->bucket_count = bucket_count;
+    memset(grid->cursors, 0, sizeof(u32) * bucket_count);
+    if (count == 0) {
+        memset(grid->bucket_starts, 0, sizeof(u32) * (bucket_count + 1));
+        return;
+    }
+
+    spatial_hash_build build = {.grid = grid, .positions = positions};
+    build.block_count = (bucket_count + SPATIAL_HASH_SCAN_BLOCK_SIZE - 1) / SPATIAL_HASH_SCAN_BLOCK_SIZE;
+    build.block_sums = fr_memory_allocate(sizeof(u32) * build.block_count, MEMORY_TYPE_HASH_TABLE);
+
+    fr_job_parallel_for(count, SPATIAL_HASH_BATCH_SIZE, _spatial_hash_count, &build);
+    fr_job_parallel_for(build.block_count, 1, _spatial_hash_sum_blocks, &build);
+    u32 offset = 0;
+    for (u32 block = 0; block < build.block_count; ++block) {
+        u32 sum = build.block_sums[block];
+        build.block_sums[block] = offset;
+        offset += sum;
+    }
+    fr_job_parallel_for(build.block_count, 1, _spatial_hash_offset_blocks, &build);
+    grid->bucket_starts[bucket_count] = count;
+    fr_job_parallel_for(count, SPATIAL_HASH_BATCH_SIZE, _spatial_hash_scatter, &build);
+    fr_job_parallel_for(bucket_count, SPATIAL_HASH_BATCH_SIZE, _spatial_hash_sort_buckets, &build);
+
+    fr_memory_free(build.block_sums, sizeof(u32) * build.block_count, MEMORY_TYPE_HASH_TABLE);
+}
+
+const u32* fr_spatial_hash_bucket_entries(const spatial_hash* grid, const ivec3* cell, u32* out_count) {
+    u32 bucket = fr_spatial_hash_bucket(grid, cell);
+    *out_count = grid->bucket_starts[bucket + 1] - grid->bucket_starts[bucket];
+    return grid->entries + grid->bucket_starts[bucket];
+}
+
+u32 fr_spatial_hash_query(const spatial_hash* grid, const vec3* point, f32 radius, u32* out_indices, u32 capacity) {
+    if (grid->count == 0) {
+        return 0;
+    }
+
+    radius = fr_min(radius, grid->cell_size);
+    ivec3 min, max;
+    _spatial_hash_range(grid, point, radius, &min, &max);
+    u32 buckets[SPATIAL_HASH_MAX_NEIGHBOR_BUCKETS];
+    u32 bucket_count = _spatial_hash_neighbor_buckets(grid, &min, &max, buckets);
+
+    spatial_hash_point p;
+    _spatial_hash_point_create(point->x, point->y, point->z, radius, &p);
+    u32 found = 0;
+    for (u32 i = 0; i < bucket_count; ++i) {
+        u32 bucket_end = grid->bucket_starts[buckets[i] + 1];
+        for (u32 k = grid->bucket_starts[buckets[i]]; k < bucket_end; k += 4) {
+            u32 mask = _spatial_hash_match(grid, k, &p);
+            if (bucket_end - k < 4) {
+                mask &= (1u << (bucket_end - k)) - 1;
+            }
+            for (; mask != 0; mask &= mask - 1) {
+                if (found < capacity) {
+                    out_indices[found] = grid->entries[k + (u32)__builtin_ctz(mask)];
+                }
+                ++found;
+            }
+        }
+    }
+    return found;
+}
+
+u32 fr_spatial_hash_find_pairs(const spatial_hash* grid, f32 distance, spatial_pair* out_pairs, u32 capacity) {
+    if (grid->count == 0) {
+        return 0;
+    }
+
+    u32 batch_count = (grid->count + SPATIAL_HASH_BATCH_SIZE - 1) / SPATIAL_HASH_BATCH_SIZE;
+    spatial_hash_pairs pairs = {
+        .grid = grid,
+        .distance = fr_min(distance, grid->cell_size),
+        .out_pairs = out_pairs,
+        .capacity = capacity,
+        .batch_offsets = fr_memory_allocate(sizeof(u32) * batch_count, MEMORY_TYPE_HASH_TABLE),
+    };
+
+    // Count the pairs of each batch, then search again writing them where their batch starts
+    fr_job_parallel_for(batch_count, 1, _spatial_hash_pairs_batches, &pairs);
+    u32 found = 0;
+    for (u32 batch = 0; batch < batch_count; ++batch) {
+        u32 count = pairs.batch_offsets[batch];
+        pairs.batch_offsets[batch] = found;
+        found += count;
+    }
+    if (capacity > 0) {
+        pairs.write = TRUE;
+        fr_job_parallel_for(batch_count, 1, _spatial_hash_pairs_batches, &pairs);
+    }
+
+    fr_memory_free(pairs.batch_offsets, sizeof(u32) * batch_count, MEMORY_TYPE_HASH_TABLE);
+    return found;
+}
@@ -0,0 +1,168 @@
+/**
+ * @file spatial_hash.h
+ * @author Aditya Rajagopal
+ * @brief Uniform grid over a set of points, hashed into a fixed number of buckets, for neighbor queries and the
+ * broadphase of many objects of similar size such as crowds and particles.
+ * @details The grid is rebuilt from scratch from the positions of the objects, in parallel on the job system, with a
+ * counting sort: the objects of each bucket are counted, the counts are turned into the offset of the first entry of
+ * each bucket, and the objects are scattered to their bucket. The entries of a bucket end up packed next to each other
+ * in bucket_starts[b] to bucket_starts[b + 1], sorted by object index so that the layout does not depend on the order
+ * the jobs ran in, with a copy of their positions as a structure of arrays that the queries test 4 at a time.
+ *
+ * The cell size is the interaction distance: queries look at most one cell away from a point, so their radius is at
+ * most the cell size. Cells that hash to the same bucket share it, which only costs distance tests. There are twice as
+ * many buckets as objects, rounded up to a power of two.
+ * @version 0.0.1
+ * @date 2024-05-04
+ *
+ * @copyright Fracture Game Engine is Copyright (c) Aditya Rajagopal 2024-2024
+ *
+ */
+#pragma once
+
+#include "fracture/core/defines.h"
+#include "fracture/core/library/math/vec3.h"
+
+/** @brief Smallest number of buckets of a grid */
+#define FR_SPATIAL_HASH_MIN_BUCKETS 64
+
+/**
+ * @brief A pair of objects closer than the query distance.
+ *
+ */
+typedef struct spatial_pair {
+    /** @brief The smaller index of the two */
+    u32 a;
+
+    /** @brief The larger index of the two */
+    u32 b;
+} spatial_pair;
+
+/**
+ * @brief A hashed uniform grid.
+ *
+ */
+typedef struct spatial_hash {
+    /** @brief Size of the cells, and the largest query distance */
+    f32 cell_size;
+
+    /** @brief 1 / cell_size */
+    f32 inv_cell_size;
+
+    /** @brief Number of objects */
+    u32 count;
+
+    /** @brief Number of objects the buffers can hold */
+    u32 capacity;
+
+    /** @brief Number of buckets, a power of two */
+    u32 bucket_count;
+
+    /** @brief Number of buckets the offsets can hold */
+    u32 bucket_capacity;
+
+    /** @brief Index of the first entry of each bucket, bucket_count + 1 of them */
+    u32* bucket_starts;
+
+    /** @brief The indices of the objects, grouped by bucket */
+    u32* entries;
+
+    /** @brief The x, y and z of the positions of the entries, padded to a multiple of 4 */
+    f32* positions[3];
+
+    /** @brief The bucket of each object */
+    u32* object_buckets;
+
+    /** @brief The number of entries of each bucket while building, then the next entry to fill */
+    u32* cursors;
+} spatial_hash;
+
+/**
+ * @brief Gets the cell of a point.
+ *
+ * @param grid The grid
+ * @param point The point, whose coordinates divided by the cell size must fit in an i32
+ * @param out The coordinates of the cell
+ */
+FR_FORCE_INLINE void fr_spatial_hash_cell(const spatial_hash* grid, const vec3* point, ivec3* out) {
+    for (u32 i = 0; i < 3; ++i) {
+        f32 v = point->data[i] * grid->inv_cell_size;
+        i32 cell = (i32)v;
+        out->data[i] = cell - (v < (f32)cell);
+    }
+}
+
+/**
+ * @brief Gets the bucket of a cell.
+ *
+ * @param grid The grid
+ * @param cell The coordinates of the cell
+ * @return u32 The bucket
+ */
+FR_FORCE_INLINE u32 fr_spatial_hash_bucket(const spatial_hash* grid, const ivec3* cell) {
+    u32 hash = ((u32)cell->x * 73856093u) ^ ((u32)cell->y * 19349663u) ^ ((u32)cell->z * 83492791u);
+    return hash & (grid->bucket_count - 1);
+}
+
+/**
+ * @brief Creates an empty grid.
+ *
+ * @param cell_size The size of the cells, larger than 0
+ * @param capacity The number of objects to allocate for, the grid grows past it when needed
+ * @param out_grid The grid, destroy with fr_spatial_hash_destroy
+ * @return b8 TRUE if the grid was created, FALSE if the cell size is not positive
+ */
+FR_API b8 fr_spatial_hash_create(f32 cell_size, u32 capacity, spatial_hash* out_grid);
+
+/**
+ * @brief Frees a grid.
+ *
+ * @param grid The grid
+ */
+FR_API void fr_spatial_hash_destroy(spatial_hash* grid);
+
+/**
+ * @brief Replaces the objects of a grid.
+ *
+ * @param grid The grid
+ * @param positions The positions of the objects
+ * @param count The number of objects
+ */
+FR_API void fr_spatial_hash_build(spatial_hash* grid, const vec3* positions, u32 count);
+
+/**
+ * @brief Gets the entries of the bucket of a cell, which also holds the objects of the cells that share the bucket.
+ * The positions of entry i are grid->positions[0..2][start + i], start being the returned pointer minus
+ * grid->entries.
+ *
+ * @param grid The grid
+ * @param cell The coordinates of the cell
+ * @param out_count The number of entries
+ * @return const u32* The indices of the objects of the bucket
+ */
+FR_API const u32* fr_spatial_hash_bucket_entries(const spatial_hash* grid, const ivec3* cell, u32* out_count);
+
+/**
+ * @brief Lists the objects within a distance of a point.
+ *
+ * @param grid The grid
+ * @param point The point
+ * @param radius The distance, clamped to the cell size
+ * @param out_indices The indices of the objects in the order of their buckets
+ * @param capacity The number of indices out_indices can hold
+ * @return u32 The number of objects found, of which the first capacity are written
+ */
+FR_API u32 fr_spatial_hash_query(
+    const spatial_hash* grid, const vec3* point, f32 radius, u32* out_indices, u32 capacity);
+
+/**
+ * @brief Lists the pairs of objects within a distance of each other, each pair once. The pairs are searched in
+ * parallel on the job system and come out in the same order on every run.
+ *
+ * @param grid The grid
+ * @param distance The distance, clamped to the cell size
+ * @param out_pairs The pairs
+ * @param capacity The number of pairs out_pairs can hold
+ * @return u32 The number of pairs found, of which the first capacity are written
+ */
+FR_API u32 fr_spatial_hash_find_pairs(const spatial_hash* grid, f32 distance, spatial_pair* out_pairs, u32 capacity);
@@ -0,0 +1,258 @@
+#include "file_io.h"
+
+#include <platform.h>
+
+#include "fracture/core/library/atomics.h"
+#include "fracture/core/systems/fracture_memory.h"
+#include "fracture/core/systems/logging.h"
+
+// Number of finished requests collected from the platform layer at a time
+#define FILE_IO_POLL_BATCH 32
+
+// The engine enums are passed straight through to the platform layer
+STATIC_ASSERT(FILE_MODE_READ == (i32)PLATFORM_FILE_MODE_READ && FILE_MODE_WRITE == (i32)PLATFORM_FILE_MODE_WRITE,
+              "file_modes do not match");
+STATIC_ASSERT(FILE_MAP_COPY_ON_WRITE == (i32)PLATFORM_FILE_MAP_COPY_ON_WRITE, "file_map_modes do not match");
+STATIC_ASSERT(FILE_ACCESS_WILL_NEED == (i32)PLATFORM_FILE_ACCESS_WILL_NEED, "file_access_hints do not match");
+
+typedef struct file_io_request {
+    platform_io_request request;
+    PFN_file_io_complete callback;
+    void* user_data;
+} file_io_request;
+
+typedef struct file_io_state {
+    // Guards the free list. Requests can be submitted from any thread.
+    platform_mutex lock;
+    u32 free_count;
+    u32 free_indices[FILE_IO_MAX_REQUESTS];
+    file_io_request requests[FILE_IO_MAX_REQUESTS];
+
+    volatile i32 pending_count;
+} file_io_state;
+
+static file_io_state* state = NULL_PTR;
+
+static b8 _file_io_submit(file_handle* handle,
+                          platform_io_operation operation,
+                          u64 offset,
+                          u64 size,
+                          void* buffer,
+                          PFN_file_io_complete callback,
+                          void* user_data);
+static void _file_io_release(file_io_request* request);
+
+b8 fr_file_io_initialize() {
+    if (state != NULL_PTR) {
+        FR_CORE_WARN("File I/O system already initialized");
+        return FALSE;
+    }
+
+    state = fr_memory_allocate(sizeof(file_io_state), MEMORY_TYPE_SYSTEM);
+    if (!platform_mutex_create(&state->lock)) {
+        FR_CORE_ERROR("Failed to create the file I/O lock");
+        fr_memory_free(state, sizeof(file_io_state), MEMORY_TYPE_SYSTEM);
+        state = NULL_PTR;
+        return FALSE;
+    }
+
+    if (!platform_io_initialize(FILE_IO_MAX_REQUESTS)) {
+        FR_CORE_ERROR("Failed to initialize the platform file I/O queue");
+        platform_mutex_destroy(&state->lock);
+        fr_memory_free(state, sizeof(file_io_state), MEMORY_TYPE_SYSTEM);
+        state = NULL_PTR;
+        return FALSE;
+    }
+
+    // Hand out low indices first
+    state->free_count = FILE_IO_MAX_REQUESTS;
+    for (u32 i = 0; i < FILE_IO_MAX_REQUESTS; ++i) {
+        state->free_indices[i] = FILE_IO_MAX_REQUESTS - 1 - i;
+    }
+
+    FR_CORE_INFO("File I/O initialized with the %s backend", platform_io_backend_name());
+    return TRUE;
+}
+
+void fr_file_io_shutdown() {
+    if (state == NULL_PTR) {
+        return;
+    }
+
+    fr_file_io_wait_all();
+    platform_io_shutdown();
+    platform_mutex_destroy(&state->lock);
+    fr_memory_free(state, sizeof(file_io_state), MEMORY_TYPE_SYSTEM);
+    state = NULL_PTR;
+}
+
+void fr_file_io_update() {
+    if (state == NULL_PTR) {
+        return;
+    }
+
+    platform_io_request* completed[FILE_IO_POLL_BATCH];
+    u32 count = 0;
+    do {
+        count = platform_io_poll(completed, FILE_IO_POLL_BATCH);
+        for (u32 i = 0; i < count; ++i) {
+            file_io_request* request = (file_io_request*)completed[i]->user_data;
+            file_io_result result = {
+                .file = {request->request.file.internal_handle},
+                .buffer = request->request.buffer,
+                .offset = request->request.offset,
+                .size = request->request.size,
+                .bytes_transferred = request->request.bytes_transferred,
+                .succeeded = request->request.succeeded,
+            };
+            PFN_file_io_complete callback = request->callback;
+            void* user_data = request->user_data;
+
+            // Release the slot first so that the callback can queue the next request
+            _file_io_release(request);
+            if (callback != NULL_PTR) {
+                callback(&result, user_data);
+            }
+        }
+    } while (count == FILE_IO_POLL_BATCH);
+}
+
+b8 fr_file_open(const char* path, u32 mode, file_handle* out_handle) {
+    platform_file file = {0};
+    if (!platform_file_open(path, mode, &file)) {
+        FR_CORE_ERROR("Failed to open file: %s", path);
+        return FALSE;
+    }
+    out_handle->internal_handle = file.internal_handle;
+    return TRUE;
+}
+
+void fr_file_close(file_handle* handle) {
+    platform_file file = {handle->internal_handle};
+    platform_file_close(&file);
+    handle->internal_handle = NULL_PTR;
+}
+
+b8 fr_file_size(file_handle* handle, u64* out_size) {
+    platform_file file = {handle->internal_handle};
+    return platform_file_size(&file, out_size);
+}
+
+b8 fr_file_read(file_handle* handle, u64 offset, u64 size, void* buffer, u64* out_bytes_read) {
+    platform_file file = {handle->internal_handle};
+    return platform_file_read(&file, offset, size, buffer, out_bytes_read);
+}
+
+b8 fr_file_write(file_handle* handle, u64 offset, u64 size, const void* buffer, u64* out_bytes_written) {
+    platform_file file = {handle->internal_handle};
+    return platform_file_write(&file, offset, size, buffer, out_bytes_written);
+}
+
+b8 fr_file_map(file_handle* handle, file_map_modes mode, file_mapping* out_mapping) {
+    platform_file file = {handle->internal_handle};
+    platform_file_mapping mapping = {0};
+    if (!platform_file_map(&file, (platform_file_map_mode)mode, &mapping)) {
+        return FALSE;
+    }
+    out_mapping->data = mapping.data;
+    out_mapping->size = mapping.size;
+    out_mapping->mode = mode;
+    out_mapping->internal_handle = mapping.internal_handle;
+    return TRUE;
+}
+
+void fr_file_unmap(file_mapping* mapping) {
+    platform_file_mapping platform_mapping = {
+        mapping->data, mapping->size, (platform_file_map_mode)mapping->mode, mapping->internal_handle};
+    platform_file_unmap(&platform_mapping);
+    mapping->data = NULL_PTR;
+    mapping->size = 0;
+    mapping->internal_handle = NULL_PTR;
+}
+
+void fr_file_advise(file_mapping* mapping, u64 offset, u64 size, file_access_hints hint) {
+    platform_file_mapping platform_mapping = {
+        mapping->data, mapping->size, (platform_file_map_mode)mapping->mode, mapping->internal_handle};
+    platform_file_mapping_advise(&platform_mapping, offset, size, (platform_file_access_hint)hint);
+}
+
+b8 fr_file_read_async(
+    file_handle* handle, u64 offset, u64 size, void* buffer, PFN_file_io_complete callback, void* user_data) {
+    return _file_io_submit(handle, PLATFORM_IO_OPERATION_READ, offset, size, buffer, callback, user_data);
+}
+
+b8 fr_file_write_async(
+    file_handle* handle, u64 offset, u64 size, const void* buffer, PFN_file_io_complete callback, void* user_data) {
+    return _file_io_submit(handle, PLATFORM_IO_OPERATION_WRITE, offset, size, (void*)buffer, callback, user_data);
+}
+
+void fr_file_io_wait_all() {
+    if (state == NULL_PTR) {
+        return;
+    }
+
+    fr_file_io_update();
+    while (fr_atomic_load_i32(&state->pending_count, FR_MEMORY_ORDER_ACQUIRE) > 0) {
+        platform_thread_yield();
+        fr_file_io_update();
+    }
+}
+
+u32 fr_file_io_pending_count() {
+    if (state == NULL_PTR) {
+        return 0;
+    }
+    return (u32)fr_atomic_load_i32(&state->pending_count, FR_MEMORY_ORDER_ACQUIRE);
+}
+
+// -----------------------------------------------------------------------
+// PRIVATE FUNCTIONS
+// -----------------------------------------------------------------------
+
+static b8 _file_io_submit(file_handle* handle,
+                          platform_io_operation operation,
+                          u64 offset,
+                          u64 size,
+                          void* buffer,
+                          PFN_file_io_complete callback,
+                          void* user_data) {
+    if (state == NULL_PTR) {
+        FR_CORE_ERROR("File I/O system is not initialized");
+        return FALSE;
+    }
+
+    platform_mutex_lock(&state->lock);
+    if (state->free_count == 0) {
+        platform_mutex_unlock(&state->lock);
+        return FALSE;
+    }
+    file_io_request* request = &state->requests[state->free_indices[--state->free_count]];
+    platform_mutex_unlock(&state->lock);
+
+    request->request.file.internal_handle = handle->internal_handle;
+    request->request.operation = operation;
+    request->request.offset = offset;
+    request->request.size = size;
+    request->request.buffer = buffer;
+    request->request.bytes_transferred = 0;
+    request->request.succeeded = FALSE;
+    request->request.user_data = request;
+    request->callback = callback;
+    request->user_data = user_data;
+
+    fr_atomic_fetch_add_i32(&state->pending_count, 1, FR_MEMORY_ORDER_RELEASE);
+    if (!platform_io_submit(&request->request)) {
+        // Both queues hold FILE_IO_MAX_REQUESTS so this only happens if the platform queue failed
+        FR_CORE_ERROR("Failed to submit a file I/O request");
+        _file_io_release(request);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+static void _file_io_release(file_io_request* request) {
+    platform_mutex_lock(&state->lock);
+    state->free_indices[state->free_count++] = (u32)(request - state->requests);
+    platform_mutex_unlock(&state->lock);
+    fr_atomic_fetch_add_i32(&state->pending_count, -1, FR_MEMORY_ORDER_RELEASE);
+}
@@ -0,0 +1,254 @@
+/**
+ * @file file_io.h
+ * @author Aditya Rajagopal
+ * @brief File access for the engine and the client application: blocking reads and writes at explicit offsets, read
+ * only or copy on write memory mapping and an asynchronous request queue with completion callbacks.
+ * @details Asynchronous requests are handed to the platform layer (io_uring on linux, a pool of I/O threads elsewhere)
+ * so that loading assets and writing logs overlap with the frame instead of stalling it. Requests can be submitted
+ * from any thread, including jobs. Their callbacks always run on the main thread from fr_file_io_update, which the
+ * engine calls once per frame before the application update.
+ * @version 0.0.1
+ * @date 2024-04-20
+ *
+ * @copyright Fracture Game Engine is Copyright (c) Aditya Rajagopal 2024-2024
+ *
+ */
+#pragma once
+
+#include "fracture/core/defines.h"
+
+// Maximum number of asynchronous requests that can be in flight at once
+#define FILE_IO_MAX_REQUESTS 256
+
+/**
+ * @brief Flags to open a file with. A file opened with only FILE_MODE_WRITE is created if it does not exist and
+ * truncated if it does. Opening with both flags creates the file if it does not exist and keeps its contents.
+ *
+ */
+typedef enum file_modes {
+    FILE_MODE_READ = 0x1,
+    FILE_MODE_WRITE = 0x2,
+} file_modes;
+
+/**
+ * @brief Handle to an open file.
+ *
+ */
+typedef struct file_handle {
+    /** @brief Platform specific handle to the file. NULL_PTR if the file is not open. */
+    void* internal_handle;
+} file_handle;
+
+/**
+ * @brief How the pages of a file mapping can be accessed.
+ *
+ */
+typedef enum file_map_modes {
+    /** @brief The contents can only be read */
+    FILE_MAP_READ_ONLY = 0,
+
+    /** @brief The contents can be modified in place. Changes stay private to the mapping and never reach the file. */
+    FILE_MAP_COPY_ON_WRITE,
+} file_map_modes;
+
+/**
+ * @brief Hints about how a range of a mapping is going to be accessed.
+ *
+ */
+typedef enum file_access_hints {
+    /** @brief Default read ahead */
+    FILE_ACCESS_NORMAL = 0,
+
+    /** @brief The range is read front to back */
+    FILE_ACCESS_SEQUENTIAL,
+
+    /** @brief The range is read in no particular order */
+    FILE_ACCESS_RANDOM,
+
+    /** @brief The range is needed soon and is read in the background */
+    FILE_ACCESS_WILL_NEED,
+} file_access_hints;
+
+/**
+ * @brief A view of the whole contents of a file. Loaders can parse data in place instead of reading it into a buffer
+ * first.
+ *
+ */
+typedef struct file_mapping {
+    /** @brief Start of the contents of the file. Only writable for FILE_MAP_COPY_ON_WRITE mappings. */
+    void* data;
+
+    /** @brief Size of the contents in bytes */
+    u64 size;
+
+    /** @brief The mode the mapping was created with */
+    file_map_modes mode;
+
+    /** @brief Platform specific handle to the mapping */
+    void* internal_handle;
+} file_mapping;
+
+/**
+ * @brief Outcome of an asynchronous request, passed to its completion callback.
+ *
+ */
+typedef struct file_io_result {
+    /** @brief The file the request read from or wrote to */
+    file_handle file;
+
+    /** @brief The buffer the request read into or wrote from */
+    void* buffer;
+
+    /** @brief The offset in the file the request started at */
+    u64 offset;
+
+    /** @brief The number of bytes the request asked for */
+    u64 size;
+
+    /** @brief The number of bytes that were transferred. Less than size for reads that reached the end of the file. */
+    u64 bytes_transferred;
+
+    /** @brief FALSE if the operating system reported an error */
+    b8 succeeded;
+} file_io_result;
+
+// Function pointer to the completion callback of an asynchronous request. Runs on the main thread.
+typedef void (*PFN_file_io_complete)(const file_io_result* result, void* user_data);
+
+/**
+ * @brief Initializes the asynchronous request queue.
+ *
+ * @return b8 TRUE if the file I/O system was initialized successfully, FALSE otherwise
+ */
+b8 fr_file_io_initialize();
+
+/**
+ * @brief Waits for the requests in flight, runs their callbacks and shuts the file I/O system down.
+ *
+ */
+void fr_file_io_shutdown();
+
+/**
+ * @brief Runs the callbacks of the requests that have finished. Called by the engine once per frame.
+ *
+ */
+void fr_file_io_update();
+
+/**
+ * @brief Opens a file.
+ *
+ * @param path The path of the file
+ * @param mode Combination of file_modes flags
+ * @param out_handle The handle to write to
+ * @return b8 TRUE if the file was opened, FALSE otherwise
+ */
+FR_API b8 fr_file_open(const char* path, u32 mode, file_handle* out_handle);
+
+/**
+ * @brief Closes a file. The file must not have asynchronous requests in flight.
+ *
+ * @param handle The file to close
+ */
+FR_API void fr_file_close(file_handle* handle);
+
+/**
+ * @brief Gets the size of a file.
+ *
+ * @param handle The file to query
+ * @param out_size The size of the file in bytes
+ * @return b8 TRUE if the size was queried, FALSE otherwise
+ */
+FR_API b8 fr_file_size(file_handle* handle, u64* out_size);
+
+/**
+ * @brief Reads from a file at the given offset, blocking until the data is read.
+ *
+ * @param handle The file to read from
+ * @param offset The offset in the file to read from
+ * @param size The number of bytes to read
+ * @param buffer The buffer to read into
+ * @param out_bytes_read The number of bytes that were read. Can be NULL_PTR.
+ * @return b8 TRUE if the read succeeded, FALSE otherwise
+ */
+FR_API b8 fr_file_read(file_handle* handle, u64 offset, u64 size, void* buffer, u64* out_bytes_read);
+
+/**
+ * @brief Writes to a file at the given offset, blocking until the data is written.
+ *
+ * @param handle The file to write to
+ * @param offset The offset in the file to write to
+ * @param size The number of bytes to write
+ * @param buffer The data to write
+ * @param out_bytes_written The number of bytes that were written. Can be NULL_PTR.
+ * @return b8 TRUE if all the bytes were written, FALSE otherwise
+ */
+FR_API b8 fr_file_write(file_handle* handle, u64 offset, u64 size, const void* buffer, u64* out_bytes_written);
+
+/**
+ * @brief Maps the whole file into memory. The mapping stays valid after the file is closed.
+ *
+ * @param handle The file to map. Must have been opened for reading and must not be empty.
+ * @param mode How the contents can be accessed
+ * @param out_mapping The mapping to write to
+ * @return b8 TRUE if the file was mapped, FALSE otherwise
+ */
+FR_API b8 fr_file_map(file_handle* handle, file_map_modes mode, file_mapping* out_mapping);
+
+/**
+ * @brief Unmaps a mapping created with fr_file_map.
+ *
+ * @param mapping The mapping to unmap
+ */
+FR_API void fr_file_unmap(file_mapping* mapping);
+
+/**
+ * @brief Tells the operating system how a range of a mapping is going to be accessed, e.g. to start reading the
+ * contents of a pack entry before it is parsed.
+ *
+ * @param mapping The mapping the range belongs to
+ * @param offset The offset of the range from the start of the mapping
+ * @param size The size of the range in bytes
+ * @param hint How the range is going to be accessed
+ */
+FR_API void fr_file_advise(file_mapping* mapping, u64 offset, u64 size, file_access_hints hint);
+
+/**
+ * @brief Queues an asynchronous read. The file and the buffer have to stay valid until the callback runs.
+ *
+ * @param handle The file to read from
+ * @param offset The offset in the file to read from
+ * @param size The number of bytes to read
+ * @param buffer The buffer to read into
+ * @param callback Called on the main thread once the read finished. Can be NULL_PTR.
+ * @param user_data User data passed to the callback
+ * @return b8 TRUE if the read was queued, FALSE if FILE_IO_MAX_REQUESTS requests are in flight
+ */
+FR_API b8 fr_file_read_async(
+    file_handle* handle, u64 offset, u64 size, void* buffer, PFN_file_io_complete callback, void* user_data);
+
+/**
+ * @brief Queues an asynchronous write. The file and the buffer have to stay valid until the callback runs.
+ *
+ * @param handle The file to write to
+ * @param offset The offset in the file to write to
+ * @param size The number of bytes to write
+ * @param buffer The data to write
+ * @param callback Called on the main thread once the write finished. Can be NULL_PTR.
+ * @param user_data User data passed to the callback
+ * @return b8 TRUE if the write was queued, FALSE if FILE_IO_MAX_REQUESTS requests are in flight
+ */
+FR_API b8 fr_file_write_async(
+    file_handle* handle, u64 offset, u64 size, const void* buffer, PFN_file_io_complete callback, void* user_data);
+
+/**
+ * @brief Blocks until every request in flight has finished and runs their callbacks. Must be called on the main thread.
+ *
+ */
+FR_API void fr_file_io_wait_all();
+
+/**
+ * @brief Gets the number of asynchronous requests whose callbacks have not run yet.
+ *
+ * @return u32 The number of requests in flight
+ */
+FR_API u32 fr_file_io_pending_count();
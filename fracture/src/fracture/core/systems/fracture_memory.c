@@ -3,14 +3,16 @@
 #include <platform.h>
 #include <stdio.h>
 
+#include "fracture/core/library/atomics.h"
 #include "fracture/core/library/fracture_string.h"
 #include "fracture/core/systems/logging.h"
 
+// Updated with atomics since jobs allocate and free memory on the worker threads
 typedef struct memory_statictics {
-    u64 current_allocated;
-    u64 current_allocated_per_type[TOTAL_MEMORY_TYPES];
-    u64 peak_allocated;
-    u64 peak_allocated_per_type[TOTAL_MEMORY_TYPES];
+    volatile i64 current_allocated;
+    volatile i64 current_allocated_per_type[TOTAL_MEMORY_TYPES];
+    volatile i64 peak_allocated;
+    volatile i64 peak_allocated_per_type[TOTAL_MEMORY_TYPES];
 } memory_statictics;
 
 static const char* memory_type_strings[] = {
@@ -20,10 +22,15 @@ static const char* memory_type_strings[] = {
     "JOB",     "THREAD",     "RENDERER", "TEXTURE",   "MATERIAL_INSTANCE",
     "MESH",    "TRANSFORM",  "ENTITY",   "COMPONENT", "SYSTEM",
     "SCENE",   "PHYSICS",    "AUDIO",    "PARTICLE",  "UI",
+    "RESOURCE",
 };
 
 static memory_statictics stats = {0};
 
+static void _memory_track_allocation(u64 size, memory_types tag);
+static void _memory_track_free(u64 size, memory_types tag);
+static void _memory_update_peak(volatile i64* peak, i64 value);
+
 b8 fr_memory_initialize() {
     platform_zero_memory(&stats, sizeof(memory_statictics));
     return TRUE;
@@ -31,7 +38,7 @@ b8 fr_memory_initialize() {
 
 b8 fr_memory_shutdown() {
     if (stats.current_allocated != 0) {
-        FR_CORE_FATAL("Memory leak detected: %llu bytes still allocated", stats.current_allocated);
+        FR_CORE_FATAL("Memory leak detected: %llu bytes still allocated", (u64)stats.current_allocated);
         FR_CORE_FATAL("Memory statistics: ");
         FR_CORE_FATAL("%s", fr_memory_get_stats());
     }
@@ -40,64 +47,58 @@ b8 fr_memory_shutdown() {
     return TRUE;
 }
 
-void* fr_memory_allocate(u64 size, memory_types tag) {
+void* fr_memory_allocate(u64 size, memory_types tag) { return fr_memory_allocate_aligned(size, 0, tag); }
+
+void* fr_memory_allocate_aligned(u64 size, u64 alignment, memory_types tag) {
     if (tag == MEMORY_TYPE_UNKNOWN) {
         FR_CORE_FATAL("Allocating unknown memory type: %llu bytes", size);
         return NULL_PTR;
     }
 
-    void* ptr = platform_allocate(size, FALSE);
+    if ((alignment & (alignment - 1)) != 0) {
+        FR_CORE_FATAL("Alignment must be a power of 2: %llu", alignment);
+        return NULL_PTR;
+    }
+
+    void* ptr = platform_allocate(size, alignment);
     if (ptr == NULL_PTR) {
         FR_CORE_FATAL("Failed to allocate memory: %llu bytes", size);
         return NULL_PTR;
     }
 
     platform_zero_memory(ptr, size);
-
-#if defined(FR_DEBUG)
-    stats.current_allocated += size;
-    stats.current_allocated_per_type[tag] += size;
-
-    if (stats.current_allocated > stats.peak_allocated) {
-        stats.peak_allocated = stats.current_allocated;
-    }
-
-    if (stats.current_allocated_per_type[tag] > stats.peak_allocated_per_type[tag]) {
-        stats.peak_allocated_per_type[tag] = stats.current_allocated_per_type[tag];
-    }
-#endif
+    _memory_track_allocation(size, tag);
     return ptr;
 }
 
-void fr_memory_free(void* ptr, u64 size, memory_types tag) {
+void fr_memory_free(void* ptr, u64 size, memory_types tag) { fr_memory_free_aligned(ptr, size, 0, tag); }
+
+void fr_memory_free_aligned(void* ptr, u64 size, u64 alignment, memory_types tag) {
     if (ptr == NULL_PTR) {
         FR_CORE_FATAL("Attempting to free NULL pointer");
         return;
     }
 
-    platform_free(ptr, FALSE);
-
-#if defined(FR_DEBUG)
-    stats.current_allocated -= size;
-    stats.current_allocated_per_type[tag] -= size;
-
-    if (stats.current_allocated < 0) {
-        FR_CORE_FATAL("Memory corruption detected: %llu bytes freed", size);
-    }
-
-    if (stats.current_allocated_per_type[tag] < 0) {
-        FR_CORE_FATAL("Memory corruption detected: %llu bytes freed of type %d", size, tag);
-    }
-#endif
+    platform_free(ptr, alignment);
+    _memory_track_free(size, tag);
 }
 
 void* fr_memory_reallocate(void* ptr, u64 size, u64 new_size, memory_types tag) {
+    return fr_memory_reallocate_aligned(ptr, size, new_size, 0, tag);
+}
+
+void* fr_memory_reallocate_aligned(void* ptr, u64 size, u64 new_size, u64 alignment, memory_types tag) {
     if (ptr == NULL_PTR) {
         FR_CORE_FATAL("Attempting to reallocate NULL pointer");
         return NULL_PTR;
     }
 
-    void* new_ptr = platform_allocate(new_size, FALSE);
+    if ((alignment & (alignment - 1)) != 0) {
+        FR_CORE_FATAL("Alignment must be a power of 2: %llu", alignment);
+        return NULL_PTR;
+    }
+
+    void* new_ptr = platform_allocate(new_size, alignment);
     if (new_ptr == NULL_PTR) {
         FR_CORE_FATAL("Failed to reallocate memory: %llu bytes", size);
         return NULL_PTR;
@@ -105,19 +106,8 @@ void* fr_memory_reallocate(void* ptr, u64 size, u64 new_size, memory_types tag)
 
     platform_zero_memory(new_ptr, new_size);
     platform_copy_memory(new_ptr, ptr, size);
-    fr_memory_free(ptr, size, tag);
-#if defined(FR_DEBUG)
-    stats.current_allocated += new_size;
-    stats.current_allocated_per_type[tag] += new_size;
-
-    if (stats.current_allocated > stats.peak_allocated) {
-        stats.peak_allocated = stats.current_allocated;
-    }
-
-    if (stats.current_allocated_per_type[tag] > stats.peak_allocated_per_type[tag]) {
-        stats.peak_allocated_per_type[tag] = stats.current_allocated_per_type[tag];
-    }
-#endif
+    fr_memory_free_aligned(ptr, size, alignment, tag);
+    _memory_track_allocation(new_size, tag);
     return new_ptr;
 }
 
@@ -244,3 +234,47 @@ u64 fr_memory_get_peak_usage() { return stats.peak_allocated; }
 u64 fr_memory_get_current_usage_per_type(memory_types type) { return stats.current_allocated_per_type[type]; }
 
 u64 fr_memory_get_peak_usage_per_type(memory_types type) { return stats.peak_allocated_per_type[type]; }
+
+// -----------------------------------------------------------------------
+// PRIVATE FUNCTIONS
+// -----------------------------------------------------------------------
+
+static void _memory_track_allocation(u64 size, memory_types tag) {
+#if defined(FR_DEBUG)
+    i64 current = fr_atomic_fetch_add_i64(&stats.current_allocated, (i64)size, FR_MEMORY_ORDER_RELAXED) + (i64)size;
+    i64 current_for_type =
+        fr_atomic_fetch_add_i64(&stats.current_allocated_per_type[tag], (i64)size, FR_MEMORY_ORDER_RELAXED) +
+        (i64)size;
+    _memory_update_peak(&stats.peak_allocated, current);
+    _memory_update_peak(&stats.peak_allocated_per_type[tag], current_for_type);
+#else
+    (void)size;
+    (void)tag;
+#endif
+}
+
+static void _memory_track_free(u64 size, memory_types tag) {
+#if defined(FR_DEBUG)
+    i64 current = fr_atomic_fetch_add_i64(&stats.current_allocated, -(i64)size, FR_MEMORY_ORDER_RELAXED) - (i64)size;
+    i64 current_for_type =
+        fr_atomic_fetch_add_i64(&stats.current_allocated_per_type[tag], -(i64)size, FR_MEMORY_ORDER_RELAXED) -
+        (i64)size;
+
+    if (current < 0) {
+        FR_CORE_FATAL("Memory corruption detected: %llu bytes freed", size);
+    }
+
+    if (current_for_type < 0) {
+        FR_CORE_FATAL("Memory corruption detected: %llu bytes freed of type %d", size, tag);
+    }
+#else
+    (void)size;
+    (void)tag;
+#endif
+}
+
+static void _memory_update_peak(volatile i64* peak, i64 value) {
+    i64 previous = fr_atomic_load_i64(peak, FR_MEMORY_ORDER_RELAXED);
+    while (value > previous && !fr_atomic_compare_exchange_i64(peak, &previous, value, FR_MEMORY_ORDER_RELAXED)) {
+    }
+}
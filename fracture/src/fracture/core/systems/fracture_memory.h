@@ -51,6 +51,9 @@ typedef enum memory_types {
     MEMORY_TYPE_PARTICLE,
     MEMORY_TYPE_UI,
 
+    // Memory types for the resource system
+    MEMORY_TYPE_RESOURCE,
+
     TOTAL_MEMORY_TYPES
 } memory_types;
 
@@ -75,6 +78,18 @@ FR_API b8 fr_memory_shutdown();
  */
 FR_API void* fr_memory_allocate(u64 size, memory_types type);
 
+/**
+ * @brief Allocates memory aligned to the given alignment and zeroes it.
+ * @details Use 16 for SSE types, 32 for AVX, FR_CACHE_LINE_SIZE for arrays streamed through SIMD loops or written by
+ * different threads and FR_PAGE_SIZE for blocks that should start on their own page.
+ *
+ * @param size The size of the memory to allocate.
+ * @param alignment The alignment in bytes. Must be a power of 2. 0 uses the default alignment of 16 bytes.
+ * @param type The type of memory to allocate.
+ * @return void* A pointer to the allocated memory.
+ */
+FR_API void* fr_memory_allocate_aligned(u64 size, u64 alignment, memory_types type);
+
 /**
  * @brief Frees memory at the given pointer.
  *
@@ -84,9 +99,20 @@ FR_API void* fr_memory_allocate(u64 size, memory_types type);
  */
 FR_API void fr_memory_free(void* ptr, u64 size, memory_types type);
 
+/**
+ * @brief Frees memory that was allocated with fr_memory_allocate_aligned.
+ *
+ * @param ptr A pointer to the memory to free.
+ * @param size The size of the memory to free.
+ * @param alignment The alignment the memory was allocated with.
+ * @param type The type of memory to free.
+ */
+FR_API void fr_memory_free_aligned(void* ptr, u64 size, u64 alignment, memory_types type);
+
 /**
  * @brief Reallocates memory to a new location with the new_size and frees the old memory.
- * When new_size = size this function just moves the memory to a new location and frees the old memory.
+ * When new_size = size this function just moves the memory to a new location and frees the old memory. Memory from
+ * fr_memory_allocate_aligned has to be reallocated with fr_memory_reallocate_aligned.
  *
  * @param ptr A pointer to the memory to reallocate.
  * @param size The size of the memory to reallocate.
@@ -96,6 +122,19 @@ FR_API void fr_memory_free(void* ptr, u64 size, memory_types type);
  */
 FR_API void* fr_memory_reallocate(void* ptr, u64 size, u64 new_size, memory_types type);
 
+/**
+ * @brief Reallocates memory that was allocated with fr_memory_allocate_aligned. The new block has the same alignment.
+ * See fr_memory_reallocate.
+ *
+ * @param ptr A pointer to the memory to reallocate.
+ * @param size The size of the memory to reallocate.
+ * @param new_size The new size of the memory to reallocate.
+ * @param alignment The alignment the memory was allocated with.
+ * @param type The type of memory to reallocate.
+ * @return void* A pointer to the reallocated memory.
+ */
+FR_API void* fr_memory_reallocate_aligned(void* ptr, u64 size, u64 new_size, u64 alignment, memory_types type);
+
 /**
  * @brief Allocates zeroed memory for the Fracture Game Engine.
  *
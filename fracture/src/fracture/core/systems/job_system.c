@@ -0,0 +1,758 @@
+#include "job_system.h"
+
+#include <platform.h>
+#include <stdio.h>
+
+#include "fracture/core/library/atomics.h"
+#include "fracture/core/systems/fracture_memory.h"
+#include "fracture/core/systems/logging.h"
+
+#define INVALID_THREAD_INDEX 0xFFFFFFFF
+#define JOB_QUEUE_MASK (JOB_QUEUE_SIZE - 1)
+
+// Number of batches a parallel for creates per thread when no batch size is given. More than one so that threads that
+// finish early can steal the remaining work.
+#define PARALLEL_FOR_BATCHES_PER_THREAD 4
+
+// Number of failed attempts to find a job before a waiting thread yields its time slice
+#define WAIT_SPIN_COUNT 64
+
+typedef struct job {
+    PFN_job_entry entry;
+    PFN_job_range_entry range_entry;
+    void* data;
+    job_counter* counter;
+    u32 range_start;
+    u32 range_end;
+} job;
+
+/**
+ * @brief Chase-Lev work stealing deque. The owning thread pushes and pops at the bottom and other threads steal from
+ * the top. top and bottom are kept on separate cache lines since they are written by different threads.
+ * @details Jobs are stored by value so that there is nothing to free once a job has been taken. The owner can only
+ * overwrite a slot once top has moved past it, so a thief whose compare exchange on top succeeds always read a
+ * complete job.
+ *
+ */
+typedef struct job_deque {
+    volatile i64 top;
+    u8 top_padding[FR_CACHE_LINE_SIZE - sizeof(i64)];
+    volatile i64 bottom;
+    u8 bottom_padding[FR_CACHE_LINE_SIZE - sizeof(i64)];
+    job* buffer;
+} job_deque;
+
+/**
+ * @brief A fiber that jobs run on. Pool fibers can resume on any thread, the fibers the threads were converted to are
+ * pinned to their thread.
+ *
+ */
+typedef struct job_fiber {
+    platform_fiber handle;
+    u32 pinned_thread;
+    job_counter* waiting_on;
+} job_fiber;
+
+/**
+ * @brief What the fiber that was switched to has to do with the fiber that was switched away from. This can only be
+ * done once we are no longer running on the stack of the previous fiber.
+ *
+ */
+typedef enum job_fiber_action {
+    JOB_FIBER_ACTION_NONE = 0,
+    JOB_FIBER_ACTION_FREE,
+    JOB_FIBER_ACTION_WAIT,
+} job_fiber_action;
+
+// Cache line aligned so that neighbouring workers in the workers array never share a line
+typedef FR_ALIGN(FR_CACHE_LINE_SIZE) struct job_worker {
+    job_deque deque;
+    u32 random_state;
+    u32 index;
+    platform_thread thread;
+
+    // Fiber mode only
+    job_fiber thread_fiber;
+    job_fiber* current_fiber;
+    job_fiber* pending_fiber;
+    job_counter* pending_counter;
+    job_fiber_action pending_action;
+    // A pinned fiber whose counter reached zero. Only ever the thread fiber of this worker.
+    job_fiber* volatile pinned_resume;
+} job_worker;
+
+typedef struct job_system_state {
+    // Index 0 is the main thread, the rest are worker threads
+    job_worker* workers;
+    u32 thread_count;
+    volatile i32 is_running;
+    volatile i32 sleeping_count;
+    platform_semaphore wake_semaphore;
+
+    // Fiber mode only
+    b8 use_fibers;
+    u32 fiber_count;
+    job_fiber* fibers;
+
+    volatile i32 free_lock;
+    u32 free_count;
+    job_fiber** free_fibers;
+
+    // Fibers waiting on counters. Includes the thread fiber of the main thread, hence fiber_count + 1 entries.
+    volatile i32 wait_lock;
+    u32 wait_count;
+    job_fiber** waiting_fibers;
+
+    // Ring buffer of fibers whose counters reached zero
+    volatile i32 ready_lock;
+    volatile i32 ready_count;
+    u32 ready_head;
+    job_fiber** ready_fibers;
+} job_system_state;
+
+static job_system_state* state = NULL_PTR;
+static _Thread_local u32 thread_index = INVALID_THREAD_INDEX;
+
+u32 _job_worker_thread(void* data);
+static void _job_worker_loop();
+static b8 _job_deque_push(job_deque* deque, const job* new_job);
+static b8 _job_deque_pop(job_deque* deque, job* out_job);
+static b8 _job_deque_steal(job_deque* deque, job* out_job);
+static job_worker* _job_current_worker();
+static b8 _job_get(job_worker* worker, job* out_job);
+static void _job_execute(const job* current_job);
+static void _job_counter_decrement(job_counter* counter);
+static void _job_wake_workers(u32 count);
+static void _job_worker_sleep();
+
+static b8 _job_fibers_create(const job_system_config* config);
+static void _job_fibers_destroy();
+static void _job_fiber_entry(void* data);
+static void _job_fiber_scheduler();
+static void _job_fiber_switch(job_fiber* next, job_fiber_action action, job_counter* counter);
+static void _job_fiber_post_switch();
+static job_fiber* _job_fiber_pop_free();
+static job_fiber* _job_fiber_pop_ready(job_worker* worker);
+static void _job_fiber_make_ready(job_fiber* fiber);
+static void _job_fiber_add_waiter(job_fiber* fiber, job_counter* counter);
+static void _job_fiber_resume_waiters(job_counter* counter);
+static void _job_spin_lock(volatile i32* lock);
+static void _job_spin_unlock(volatile i32* lock);
+
+b8 fr_job_system_initialize(const job_system_config* config) {
+    if (state != NULL_PTR) {
+        FR_CORE_WARN("Job system already initialized");
+        return FALSE;
+    }
+
+    u32 worker_count = config->worker_count;
+    if (worker_count == 0) {
+        u32 processor_count = platform_get_processor_count();
+        worker_count = processor_count > 1 ? processor_count - 1 : 0;
+    }
+    if (worker_count > JOB_MAX_WORKER_THREADS) {
+        worker_count = JOB_MAX_WORKER_THREADS;
+    }
+
+    state = fr_memory_allocate(sizeof(job_system_state), MEMORY_TYPE_SYSTEM);
+    state->thread_count = worker_count + 1;
+    state->workers =
+        fr_memory_allocate_aligned(sizeof(job_worker) * state->thread_count, FR_CACHE_LINE_SIZE, MEMORY_TYPE_THREAD);
+    for (u32 i = 0; i < state->thread_count; ++i) {
+        job_worker* worker = &state->workers[i];
+        worker->index = i;
+        worker->random_state = (i + 1) * 2654435761U;
+        worker->deque.buffer = fr_memory_allocate(sizeof(job) * JOB_QUEUE_SIZE, MEMORY_TYPE_JOB);
+    }
+
+    if (!platform_semaphore_create(0, 0x7FFFFFFF, &state->wake_semaphore)) {
+        FR_CORE_ERROR("Failed to create the job system wake semaphore");
+        fr_job_system_shutdown();
+        return FALSE;
+    }
+
+    fr_atomic_store_i32(&state->is_running, TRUE, FR_MEMORY_ORDER_RELEASE);
+    thread_index = 0;
+
+    if (config->use_fibers && !_job_fibers_create(config)) {
+        FR_CORE_ERROR("Failed to create the job system fibers");
+        fr_job_system_shutdown();
+        return FALSE;
+    }
+
+    for (u32 i = 1; i < state->thread_count; ++i) {
+        if (!platform_thread_create(_job_worker_thread, &state->workers[i], &state->workers[i].thread)) {
+            FR_CORE_ERROR("Failed to create job worker thread %u", i);
+            fr_job_system_shutdown();
+            return FALSE;
+        }
+    }
+
+    if (state->use_fibers) {
+        FR_CORE_INFO("Job system initialized with %u worker threads and %u fibers", worker_count, state->fiber_count);
+    } else {
+        FR_CORE_INFO("Job system initialized with %u worker threads", worker_count);
+    }
+    return TRUE;
+}
+
+void fr_job_system_shutdown() {
+    if (state == NULL_PTR) {
+        return;
+    }
+
+    fr_atomic_store_i32(&state->is_running, FALSE, FR_MEMORY_ORDER_RELEASE);
+    if (state->wake_semaphore.internal_handle != NULL_PTR) {
+        platform_semaphore_signal(&state->wake_semaphore, state->thread_count);
+    }
+
+    for (u32 i = 1; i < state->thread_count; ++i) {
+        platform_thread_join(&state->workers[i].thread);
+    }
+
+    _job_fibers_destroy();
+
+    for (u32 i = 0; i < state->thread_count; ++i) {
+        job_worker* worker = &state->workers[i];
+        fr_memory_free(worker->deque.buffer, sizeof(job) * JOB_QUEUE_SIZE, MEMORY_TYPE_JOB);
+    }
+
+    platform_semaphore_destroy(&state->wake_semaphore);
+    fr_memory_free_aligned(
+        state->workers, sizeof(job_worker) * state->thread_count, FR_CACHE_LINE_SIZE, MEMORY_TYPE_THREAD);
+    fr_memory_free(state, sizeof(job_system_state), MEMORY_TYPE_SYSTEM);
+    state = NULL_PTR;
+    thread_index = INVALID_THREAD_INDEX;
+}
+
+u32 fr_job_system_worker_count() {
+    if (state == NULL_PTR) {
+        return 0;
+    }
+    return state->thread_count - 1;
+}
+
+void fr_job_run(const job_desc* jobs, u32 count, job_counter* counter) {
+    if (count == 0) {
+        return;
+    }
+
+    if (counter != NULL_PTR) {
+        fr_atomic_fetch_add_i32(&counter->value, (i32)count, FR_MEMORY_ORDER_RELAXED);
+    }
+
+    job_worker* worker = _job_current_worker();
+    if (worker == NULL_PTR) {
+        // Not a job system thread so there is no deque to push to
+        for (u32 i = 0; i < count; ++i) {
+            jobs[i].entry(jobs[i].data);
+            if (counter != NULL_PTR) {
+                _job_counter_decrement(counter);
+            }
+        }
+        return;
+    }
+
+    for (u32 i = 0; i < count; ++i) {
+        job new_job = {0};
+        new_job.entry = jobs[i].entry;
+        new_job.data = jobs[i].data;
+        new_job.counter = counter;
+        if (!_job_deque_push(&worker->deque, &new_job)) {
+            _job_execute(&new_job);
+            // The job may have waited and resumed this fiber on another thread
+            worker = _job_current_worker();
+        }
+    }
+    _job_wake_workers(count);
+}
+
+void fr_job_wait(job_counter* counter) {
+    if (fr_atomic_load_i32(&counter->value, FR_MEMORY_ORDER_ACQUIRE) <= 0) {
+        return;
+    }
+
+    job_worker* worker = _job_current_worker();
+    if (worker != NULL_PTR && worker->current_fiber != NULL_PTR) {
+        // Park this fiber and keep the thread busy with another one. We only come back once the counter is zero.
+        job_fiber* next = _job_fiber_pop_ready(worker);
+        if (next == NULL_PTR) {
+            next = _job_fiber_pop_free();
+        }
+        if (next != NULL_PTR) {
+            _job_fiber_switch(next, JOB_FIBER_ACTION_WAIT, counter);
+            return;
+        }
+        // The fiber pool is exhausted. Fall back to running jobs on this stack.
+    }
+
+    u32 failed_attempts = 0;
+    while (fr_atomic_load_i32(&counter->value, FR_MEMORY_ORDER_ACQUIRE) > 0) {
+        worker = _job_current_worker();
+        job next_job;
+        if (worker != NULL_PTR && _job_get(worker, &next_job)) {
+            _job_execute(&next_job);
+            failed_attempts = 0;
+            continue;
+        }
+
+        // The remaining jobs are running on other threads
+        if (++failed_attempts < WAIT_SPIN_COUNT) {
+            fr_atomic_pause();
+        } else {
+            platform_thread_yield();
+            failed_attempts = 0;
+        }
+    }
+}
+
+void fr_job_parallel_for(u32 count, u32 batch_size, PFN_job_range_entry entry, void* data) {
+    if (count == 0 || entry == NULL_PTR) {
+        return;
+    }
+
+    job_worker* worker = _job_current_worker();
+    if (batch_size == 0) {
+        u32 target_batches = (worker != NULL_PTR ? state->thread_count : 1) * PARALLEL_FOR_BATCHES_PER_THREAD;
+        batch_size = (count + target_batches - 1) / target_batches;
+    }
+    if (worker == NULL_PTR || count <= batch_size) {
+        entry(0, count, data);
+        return;
+    }
+
+    u32 batch_count = (count + batch_size - 1) / batch_size;
+    job_counter counter = {0};
+    fr_atomic_store_i32(&counter.value, (i32)batch_count, FR_MEMORY_ORDER_RELAXED);
+    for (u64 start = 0; start < count; start += batch_size) {
+        job new_job = {0};
+        new_job.range_entry = entry;
+        new_job.data = data;
+        new_job.counter = &counter;
+        new_job.range_start = (u32)start;
+        new_job.range_end = (u32)MIN(start + batch_size, (u64)count);
+        if (!_job_deque_push(&worker->deque, &new_job)) {
+            _job_execute(&new_job);
+            worker = _job_current_worker();
+        }
+    }
+    _job_wake_workers(batch_count);
+
+    fr_job_wait(&counter);
+}
+
+// -----------------------------------------------------------------------
+// PRIVATE FUNCTIONS
+// -----------------------------------------------------------------------
+
+u32 _job_worker_thread(void* data) {
+    job_worker* worker = (job_worker*)data;
+    thread_index = worker->index;
+
+    // Named threads are much easier to tell apart in debuggers and profilers
+    char name[16];
+    snprintf(name, sizeof(name), "fr_worker_%u", worker->index);
+    platform_thread_set_name(NULL_PTR, name);
+
+    if (!state->use_fibers) {
+        _job_worker_loop();
+        return 0;
+    }
+
+    // Run the scheduler on a pool fiber. It switches back to the thread fiber once the job system shuts down.
+    platform_fiber_convert_thread(&worker->thread_fiber.handle);
+    worker->thread_fiber.pinned_thread = worker->index;
+    worker->current_fiber = &worker->thread_fiber;
+    job_fiber* scheduler = _job_fiber_pop_free();
+    if (scheduler != NULL_PTR) {
+        _job_fiber_switch(scheduler, JOB_FIBER_ACTION_NONE, NULL_PTR);
+    } else {
+        _job_worker_loop();
+    }
+
+    // Switching back happens from a different fiber, so look the worker up again
+    worker = _job_current_worker();
+    worker->current_fiber = NULL_PTR;
+    platform_fiber_convert_to_thread(&worker->thread_fiber.handle);
+    return 0;
+}
+
+static void _job_worker_loop() {
+    while (fr_atomic_load_i32(&state->is_running, FR_MEMORY_ORDER_ACQUIRE)) {
+        job_worker* worker = _job_current_worker();
+        job next_job;
+        if (_job_get(worker, &next_job)) {
+            _job_execute(&next_job);
+            continue;
+        }
+        _job_worker_sleep();
+    }
+}
+
+static b8 _job_deque_push(job_deque* deque, const job* new_job) {
+    i64 bottom = fr_atomic_load_i64(&deque->bottom, FR_MEMORY_ORDER_RELAXED);
+    i64 top = fr_atomic_load_i64(&deque->top, FR_MEMORY_ORDER_ACQUIRE);
+    if (bottom - top >= JOB_QUEUE_SIZE) {
+        return FALSE;
+    }
+
+    deque->buffer[bottom & JOB_QUEUE_MASK] = *new_job;
+    // Make the job visible before the thieves can see the new bottom
+    fr_atomic_fence(FR_MEMORY_ORDER_RELEASE);
+    fr_atomic_store_i64(&deque->bottom, bottom + 1, FR_MEMORY_ORDER_RELAXED);
+    return TRUE;
+}
+
+static b8 _job_deque_pop(job_deque* deque, job* out_job) {
+    i64 bottom = fr_atomic_load_i64(&deque->bottom, FR_MEMORY_ORDER_RELAXED) - 1;
+    fr_atomic_store_i64(&deque->bottom, bottom, FR_MEMORY_ORDER_RELAXED);
+    // The new bottom has to be visible to the thieves before we read top
+    fr_atomic_fence(FR_MEMORY_ORDER_SEQ_CST);
+    i64 top = fr_atomic_load_i64(&deque->top, FR_MEMORY_ORDER_RELAXED);
+
+    if (top > bottom) {
+        // Empty
+        fr_atomic_store_i64(&deque->bottom, bottom + 1, FR_MEMORY_ORDER_RELAXED);
+        return FALSE;
+    }
+
+    *out_job = deque->buffer[bottom & JOB_QUEUE_MASK];
+    if (top == bottom) {
+        // Last job in the deque. Race the thieves for it.
+        b8 won = fr_atomic_compare_exchange_i64(&deque->top, &top, top + 1, FR_MEMORY_ORDER_SEQ_CST);
+        fr_atomic_store_i64(&deque->bottom, bottom + 1, FR_MEMORY_ORDER_RELAXED);
+        return won;
+    }
+    return TRUE;
+}
+
+static b8 _job_deque_steal(job_deque* deque, job* out_job) {
+    i64 top = fr_atomic_load_i64(&deque->top, FR_MEMORY_ORDER_ACQUIRE);
+    fr_atomic_fence(FR_MEMORY_ORDER_SEQ_CST);
+    i64 bottom = fr_atomic_load_i64(&deque->bottom, FR_MEMORY_ORDER_ACQUIRE);
+    if (top >= bottom) {
+        return FALSE;
+    }
+
+    *out_job = deque->buffer[top & JOB_QUEUE_MASK];
+    // Lost the race to the owner or another thief if this fails. The copy might be torn in that case but is discarded.
+    return fr_atomic_compare_exchange_i64(&deque->top, &top, top + 1, FR_MEMORY_ORDER_SEQ_CST);
+}
+
+// Never inlined: a fiber can suspend on one thread and resume on another, so the address of the thread local must not
+// be cached across a fiber switch.
+__attribute__((noinline)) static job_worker* _job_current_worker() {
+    if (state == NULL_PTR || thread_index >= state->thread_count) {
+        return NULL_PTR;
+    }
+    return &state->workers[thread_index];
+}
+
+static b8 _job_get(job_worker* worker, job* out_job) {
+    if (_job_deque_pop(&worker->deque, out_job)) {
+        return TRUE;
+    }
+    if (state->thread_count == 1) {
+        return FALSE;
+    }
+
+    // xorshift32 to pick the first victim so that thieves do not all hammer the same deque
+    u32 x = worker->random_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    worker->random_state = x;
+
+    u32 first_victim = x % state->thread_count;
+    for (u32 i = 0; i < state->thread_count; ++i) {
+        u32 victim = (first_victim + i) % state->thread_count;
+        if (victim == worker->index) {
+            continue;
+        }
+        if (_job_deque_steal(&state->workers[victim].deque, out_job)) {
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+static void _job_execute(const job* current_job) {
+    if (current_job->range_entry != NULL_PTR) {
+        current_job->range_entry(current_job->range_start, current_job->range_end, current_job->data);
+    } else {
+        current_job->entry(current_job->data);
+    }
+
+    if (current_job->counter != NULL_PTR) {
+        _job_counter_decrement(current_job->counter);
+    }
+}
+
+static void _job_counter_decrement(job_counter* counter) {
+    if (fr_atomic_fetch_add_i32(&counter->value, -1, FR_MEMORY_ORDER_SEQ_CST) == 1 && state != NULL_PTR &&
+        state->use_fibers) {
+        _job_fiber_resume_waiters(counter);
+    }
+}
+
+static void _job_wake_workers(u32 count) {
+    // Pairs with the fence in _job_worker_sleep. Either the sleeping worker sees the new jobs or we see the worker.
+    fr_atomic_fence(FR_MEMORY_ORDER_SEQ_CST);
+    i32 sleeping = fr_atomic_load_i32(&state->sleeping_count, FR_MEMORY_ORDER_RELAXED);
+    if (sleeping > 0) {
+        platform_semaphore_signal(&state->wake_semaphore, MIN(count, (u32)sleeping));
+    }
+}
+
+static void _job_worker_sleep() {
+    fr_atomic_fetch_add_i32(&state->sleeping_count, 1, FR_MEMORY_ORDER_SEQ_CST);
+    fr_atomic_fence(FR_MEMORY_ORDER_SEQ_CST);
+
+    b8 has_pending = fr_atomic_load_i32(&state->ready_count, FR_MEMORY_ORDER_RELAXED) > 0;
+    for (u32 i = 0; i < state->thread_count && !has_pending; ++i) {
+        job_deque* deque = &state->workers[i].deque;
+        has_pending = fr_atomic_load_i64(&deque->bottom, FR_MEMORY_ORDER_RELAXED) >
+                      fr_atomic_load_i64(&deque->top, FR_MEMORY_ORDER_RELAXED);
+    }
+
+    if (!has_pending && fr_atomic_load_i32(&state->is_running, FR_MEMORY_ORDER_ACQUIRE)) {
+        platform_semaphore_wait(&state->wake_semaphore, PLATFORM_WAIT_INFINITE);
+    }
+    fr_atomic_fetch_add_i32(&state->sleeping_count, -1, FR_MEMORY_ORDER_RELAXED);
+}
+
+static b8 _job_fibers_create(const job_system_config* config) {
+    u32 fiber_count = config->fiber_count != 0 ? config->fiber_count : JOB_DEFAULT_FIBER_COUNT;
+    u64 stack_size = config->fiber_stack_size != 0 ? config->fiber_stack_size : JOB_DEFAULT_FIBER_STACK_SIZE;
+    // Every worker needs a fiber for its scheduler and a few more to have something to switch to when jobs wait
+    if (fiber_count < state->thread_count * 4) {
+        fiber_count = state->thread_count * 4;
+    }
+
+    state->use_fibers = TRUE;
+    state->fibers = fr_memory_allocate(sizeof(job_fiber) * fiber_count, MEMORY_TYPE_JOB);
+    state->free_fibers = fr_memory_allocate(sizeof(job_fiber*) * fiber_count, MEMORY_TYPE_JOB);
+    state->waiting_fibers = fr_memory_allocate(sizeof(job_fiber*) * (fiber_count + 1), MEMORY_TYPE_JOB);
+    state->ready_fibers = fr_memory_allocate(sizeof(job_fiber*) * fiber_count, MEMORY_TYPE_JOB);
+    state->fiber_count = fiber_count;
+
+    for (u32 i = 0; i < fiber_count; ++i) {
+        job_fiber* fiber = &state->fibers[i];
+        fiber->pinned_thread = INVALID_THREAD_INDEX;
+        if (!platform_fiber_create(stack_size, _job_fiber_entry, fiber, &fiber->handle)) {
+            return FALSE;
+        }
+        state->free_fibers[state->free_count++] = fiber;
+    }
+
+    // The main thread runs the engine loop on its own fiber which only ever resumes on the main thread
+    job_worker* main_worker = &state->workers[0];
+    if (!platform_fiber_convert_thread(&main_worker->thread_fiber.handle)) {
+        return FALSE;
+    }
+    main_worker->thread_fiber.pinned_thread = 0;
+    main_worker->current_fiber = &main_worker->thread_fiber;
+    return TRUE;
+}
+
+static void _job_fibers_destroy() {
+    if (state->fibers == NULL_PTR) {
+        return;
+    }
+
+    job_worker* main_worker = &state->workers[0];
+    if (main_worker->thread_fiber.handle.internal_handle != NULL_PTR) {
+        platform_fiber_convert_to_thread(&main_worker->thread_fiber.handle);
+    }
+    main_worker->current_fiber = NULL_PTR;
+
+    for (u32 i = 0; i < state->fiber_count; ++i) {
+        platform_fiber_destroy(&state->fibers[i].handle);
+    }
+
+    u32 fiber_count = state->fiber_count;
+    fr_memory_free(state->fibers, sizeof(job_fiber) * fiber_count, MEMORY_TYPE_JOB);
+    fr_memory_free(state->free_fibers, sizeof(job_fiber*) * fiber_count, MEMORY_TYPE_JOB);
+    fr_memory_free(state->waiting_fibers, sizeof(job_fiber*) * (fiber_count + 1), MEMORY_TYPE_JOB);
+    fr_memory_free(state->ready_fibers, sizeof(job_fiber*) * fiber_count, MEMORY_TYPE_JOB);
+    state->fibers = NULL_PTR;
+    state->use_fibers = FALSE;
+}
+
+static void _job_fiber_entry(void* data) {
+    (void)data;
+    _job_fiber_post_switch();
+    _job_fiber_scheduler();
+}
+
+static void _job_fiber_scheduler() {
+    for (;;) {
+        job_worker* worker = _job_current_worker();
+        if (!fr_atomic_load_i32(&state->is_running, FR_MEMORY_ORDER_ACQUIRE) && worker->index != 0) {
+            _job_fiber_switch(&worker->thread_fiber, JOB_FIBER_ACTION_FREE, NULL_PTR);
+            continue;
+        }
+
+        // Resuming parked fibers first finishes work that has already started
+        job_fiber* ready = _job_fiber_pop_ready(worker);
+        if (ready != NULL_PTR) {
+            _job_fiber_switch(ready, JOB_FIBER_ACTION_FREE, NULL_PTR);
+            continue;
+        }
+
+        job next_job;
+        if (_job_get(worker, &next_job)) {
+            _job_execute(&next_job);
+            continue;
+        }
+
+        if (worker->index == 0) {
+            // The main thread cannot sleep on the shared semaphore since the wake up might go to another thread while
+            // the main thread fiber is the one that is ready.
+            platform_thread_yield();
+        } else {
+            _job_worker_sleep();
+        }
+    }
+}
+
+static void _job_fiber_switch(job_fiber* next, job_fiber_action action, job_counter* counter) {
+    job_worker* worker = _job_current_worker();
+    job_fiber* current = worker->current_fiber;
+    worker->pending_fiber = current;
+    worker->pending_action = action;
+    worker->pending_counter = counter;
+    worker->current_fiber = next;
+    platform_fiber_switch(&current->handle, &next->handle);
+
+    // We might be running on a different thread now
+    _job_fiber_post_switch();
+}
+
+static void _job_fiber_post_switch() {
+    job_worker* worker = _job_current_worker();
+    job_fiber* previous = worker->pending_fiber;
+    job_fiber_action action = worker->pending_action;
+    worker->pending_fiber = NULL_PTR;
+    worker->pending_action = JOB_FIBER_ACTION_NONE;
+
+    switch (action) {
+        case JOB_FIBER_ACTION_FREE: {
+            if (previous->pinned_thread != INVALID_THREAD_INDEX) {
+                // Thread fibers are not part of the pool
+                break;
+            }
+            _job_spin_lock(&state->free_lock);
+            state->free_fibers[state->free_count++] = previous;
+            _job_spin_unlock(&state->free_lock);
+        } break;
+        case JOB_FIBER_ACTION_WAIT: {
+            _job_fiber_add_waiter(previous, worker->pending_counter);
+        } break;
+        default:
+            break;
+    }
+    worker->pending_counter = NULL_PTR;
+}
+
+static job_fiber* _job_fiber_pop_free() {
+    job_fiber* fiber = NULL_PTR;
+    _job_spin_lock(&state->free_lock);
+    if (state->free_count > 0) {
+        fiber = state->free_fibers[--state->free_count];
+    }
+    _job_spin_unlock(&state->free_lock);
+    return fiber;
+}
+
+static job_fiber* _job_fiber_pop_ready(job_worker* worker) {
+    if (fr_atomic_load_ptr((void* const volatile*)&worker->pinned_resume, FR_MEMORY_ORDER_RELAXED) != NULL_PTR) {
+        return fr_atomic_exchange_ptr((void* volatile*)&worker->pinned_resume, NULL_PTR, FR_MEMORY_ORDER_ACQUIRE);
+    }
+
+    if (fr_atomic_load_i32(&state->ready_count, FR_MEMORY_ORDER_RELAXED) == 0) {
+        return NULL_PTR;
+    }
+
+    job_fiber* fiber = NULL_PTR;
+    _job_spin_lock(&state->ready_lock);
+    if (state->ready_count > 0) {
+        fiber = state->ready_fibers[state->ready_head];
+        state->ready_head = (state->ready_head + 1) % state->fiber_count;
+        fr_atomic_store_i32(&state->ready_count, state->ready_count - 1, FR_MEMORY_ORDER_RELAXED);
+    }
+    _job_spin_unlock(&state->ready_lock);
+    return fiber;
+}
+
+static void _job_fiber_make_ready(job_fiber* fiber) {
+    fiber->waiting_on = NULL_PTR;
+    if (fiber->pinned_thread != INVALID_THREAD_INDEX) {
+        job_worker* owner = &state->workers[fiber->pinned_thread];
+        fr_atomic_store_ptr((void* volatile*)&owner->pinned_resume, fiber, FR_MEMORY_ORDER_RELEASE);
+        return;
+    }
+
+    _job_spin_lock(&state->ready_lock);
+    u32 tail = (state->ready_head + (u32)state->ready_count) % state->fiber_count;
+    state->ready_fibers[tail] = fiber;
+    fr_atomic_store_i32(&state->ready_count, state->ready_count + 1, FR_MEMORY_ORDER_RELAXED);
+    _job_spin_unlock(&state->ready_lock);
+    _job_wake_workers(1);
+}
+
+static void _job_fiber_add_waiter(job_fiber* fiber, job_counter* counter) {
+    _job_spin_lock(&state->wait_lock);
+    // The counter can reach zero between the decision to wait and now. It is checked under the lock so that a
+    // concurrent _job_fiber_resume_waiters either sees this waiter or we see the zero.
+    if (fr_atomic_load_i32(&counter->value, FR_MEMORY_ORDER_SEQ_CST) <= 0) {
+        _job_spin_unlock(&state->wait_lock);
+        _job_fiber_make_ready(fiber);
+        return;
+    }
+
+    fiber->waiting_on = counter;
+    state->waiting_fibers[state->wait_count++] = fiber;
+    _job_spin_unlock(&state->wait_lock);
+}
+
+static void _job_fiber_resume_waiters(job_counter* counter) {
+    job_fiber* resumed[JOB_MAX_WORKER_THREADS + 1];
+    b8 has_more = TRUE;
+    while (has_more) {
+        u32 resumed_count = 0;
+        has_more = FALSE;
+
+        _job_spin_lock(&state->wait_lock);
+        for (u32 i = 0; i < state->wait_count;) {
+            if (state->waiting_fibers[i]->waiting_on != counter) {
+                ++i;
+                continue;
+            }
+            if (resumed_count == JOB_MAX_WORKER_THREADS + 1) {
+                has_more = TRUE;
+                break;
+            }
+            resumed[resumed_count++] = state->waiting_fibers[i];
+            state->waiting_fibers[i] = state->waiting_fibers[--state->wait_count];
+        }
+        _job_spin_unlock(&state->wait_lock);
+
+        for (u32 i = 0; i < resumed_count; ++i) {
+            _job_fiber_make_ready(resumed[i]);
+        }
+    }
+}
+
+static void _job_spin_lock(volatile i32* lock) {
+    for (;;) {
+        if (fr_atomic_exchange_i32(lock, 1, FR_MEMORY_ORDER_ACQUIRE) == 0) {
+            return;
+        }
+        while (fr_atomic_load_i32(lock, FR_MEMORY_ORDER_RELAXED) != 0) {
+            fr_atomic_pause();
+        }
+    }
+}
+
+static void _job_spin_unlock(volatile i32* lock) { fr_atomic_store_i32(lock, 0, FR_MEMORY_ORDER_RELEASE); }
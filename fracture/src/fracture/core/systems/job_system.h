@@ -0,0 +1,135 @@
+/**
+ * @file job_system.h
+ * @author Aditya Rajagopal
+ * @brief Job system backed by a pool of worker threads with work stealing.
+ * @details Every thread that runs jobs (the main thread and one worker per remaining core) owns a Chase-Lev work
+ * stealing deque. Jobs are pushed to and popped from the bottom of the deque of the thread that submits them and idle
+ * threads steal from the top of the deques of other threads. Fork/join is expressed with job counters: submitting jobs
+ * increments the counter, each finished job decrements it and fr_job_wait blocks until it reaches zero while running
+ * other jobs in the meantime.
+ *
+ * With fibers enabled every job runs on a fiber from a fixed pool. A job that waits on a counter that has not reached
+ * zero parks its fiber in a wait list and the thread switches to a ready fiber or a fresh one from the pool, so the
+ * worker keeps running other jobs instead of blocking. When the counter reaches zero the parked fibers are moved to a
+ * resume queue and picked up by the next idle thread. The main thread fiber is only ever resumed on the main thread.
+ *
+ * Jobs can only be submitted from the main thread or from inside a job. Each deque holds JOB_QUEUE_SIZE jobs, jobs
+ * submitted to a full deque run immediately on the submitting thread.
+ * @version 0.0.1
+ * @date 2024-04-04
+ *
+ * @copyright Fracture Game Engine is Copyright (c) Aditya Rajagopal 2024-2024
+ *
+ */
+#pragma once
+
+#include "fracture/core/defines.h"
+
+// Maximum number of worker threads the job system will create
+#define JOB_MAX_WORKER_THREADS 63
+
+// Number of jobs the deque of each thread can hold. Must be a power of 2.
+#define JOB_QUEUE_SIZE 4096
+
+// Number of fibers in the pool when the config does not specify one
+#define JOB_DEFAULT_FIBER_COUNT 128
+
+// Stack size of each fiber when the config does not specify one. Fiber stacks end in a guard page, so jobs that need
+// more stack than this crash on the guard page instead of overwriting memory.
+#define JOB_DEFAULT_FIBER_STACK_SIZE KiB(256)
+
+// Function pointer to the entry point of a job
+typedef void (*PFN_job_entry)(void* data);
+
+// Function pointer to the entry point of a parallel for batch. Processes the indices [start, end).
+typedef void (*PFN_job_range_entry)(u32 start, u32 end, void* data);
+
+/**
+ * @brief Description of a job to submit to the job system.
+ *
+ */
+typedef struct job_desc {
+    /** @brief The function that the job runs */
+    PFN_job_entry entry;
+
+    /** @brief User data passed to the function */
+    void* data;
+} job_desc;
+
+/**
+ * @brief Counter used to wait for a set of jobs. Must be zero initialized before it is first used and must stay alive
+ * until all the jobs that reference it have finished.
+ *
+ */
+typedef struct job_counter {
+    /** @brief Number of jobs that have not finished yet */
+    volatile i32 value;
+} job_counter;
+
+/**
+ * @brief Job system configuration
+ *
+ */
+typedef struct job_system_config {
+    /** @brief Number of worker threads. 0 creates one worker per logical processor besides the main thread */
+    u32 worker_count;
+
+    /** @brief Run jobs on fibers so that jobs waiting on counters yield their thread instead of blocking it */
+    b8 use_fibers;
+
+    /** @brief Number of fibers in the pool. 0 uses JOB_DEFAULT_FIBER_COUNT */
+    u32 fiber_count;
+
+    /** @brief Stack size of each fiber in bytes. 0 uses JOB_DEFAULT_FIBER_STACK_SIZE */
+    u32 fiber_stack_size;
+} job_system_config;
+
+/**
+ * @brief Initializes the job system and starts the worker threads. The calling thread becomes the main thread of the
+ * job system.
+ *
+ * @param config The job system configuration
+ * @return b8 TRUE if the job system was initialized successfully, FALSE otherwise
+ */
+b8 fr_job_system_initialize(const job_system_config* config);
+
+/**
+ * @brief Stops and joins the worker threads and frees the job system. All submitted jobs must have been waited on.
+ *
+ */
+void fr_job_system_shutdown();
+
+/**
+ * @brief Gets the number of worker threads excluding the main thread.
+ *
+ * @return u32 The number of worker threads
+ */
+FR_API u32 fr_job_system_worker_count();
+
+/**
+ * @brief Submits jobs to the job system. If the deque of the calling thread is full or the caller is not a job system
+ * thread the jobs are run immediately on the calling thread.
+ *
+ * @param jobs The jobs to submit
+ * @param count The number of jobs
+ * @param counter Counter that is incremented by count and decremented as each job finishes. Can be NULL_PTR.
+ */
+FR_API void fr_job_run(const job_desc* jobs, u32 count, job_counter* counter);
+
+/**
+ * @brief Waits until the counter reaches zero. When called from a fiber the fiber is suspended and the thread runs
+ * other jobs until the counter reaches zero, otherwise the calling thread runs pending jobs while it waits.
+ *
+ * @param counter The counter to wait on
+ */
+FR_API void fr_job_wait(job_counter* counter);
+
+/**
+ * @brief Splits the range [0, count) into batches, runs them on the job system and waits for all of them to finish.
+ *
+ * @param count The number of items to process
+ * @param batch_size The number of items processed by a single job. 0 picks a batch size based on the number of threads.
+ * @param entry The function that processes a batch
+ * @param data User data passed to the function
+ */
+FR_API void fr_job_parallel_for(u32 count, u32 batch_size, PFN_job_range_entry entry, void* data);
@@ -12,6 +12,11 @@ static const char* log_source_strings[] = {"CORE", "ENGINE", "GAME"};
 
 static logging_config* state = NULL_PTR;
 
+// Kept off the stack so that jobs running on small fiber stacks can log
+#define LOG_BUFFER_SIZE 32000
+static _Thread_local char log_buffer[LOG_BUFFER_SIZE];
+static _Thread_local char log_line[LOG_BUFFER_SIZE];
+
 b8 fr_logging_initialize(logging_config* config) {
     if (state != NULL_PTR) {
         return TRUE;
@@ -48,20 +53,19 @@ void fr_log_message(log_level level, log_source source, const char* message, ...
 
     b8 is_error = level <= LOG_LEVEL_ERROR;
 
-    char buffer[32000];
     __builtin_va_list vargs;
     va_start(vargs, message);
-    vsnprintf(buffer, 32000, message, vargs);
+    vsnprintf(log_buffer, LOG_BUFFER_SIZE, message, vargs);
     va_end(vargs);
 
-    char log_message[32000];
-    snprintf(log_message, 32000, "%s[%s] %s\n", log_source_strings[source], log_level_strings[level], buffer);
+    snprintf(
+        log_line, LOG_BUFFER_SIZE, "%s[%s] %s\n", log_source_strings[source], log_level_strings[level], log_buffer);
 
     if (state->enable_console) {
         if (is_error) {
-            platform_console_write_error(log_message, (u8)level);
+            platform_console_write_error(log_line, (u8)level);
         } else {
-            platform_console_write(log_message, (u8)level);
+            platform_console_write(log_line, (u8)level);
         }
     }
 
@@ -79,27 +83,25 @@ void fr_log_message_detailed(log_level level, log_source source, const char* fil
 
     b8 is_error = level <= LOG_LEVEL_ERROR;
 
-    char buffer[32000];
     __builtin_va_list vargs;
     va_start(vargs, format);
-    vsnprintf(buffer, 32000, format, vargs);
+    vsnprintf(log_buffer, LOG_BUFFER_SIZE, format, vargs);
     va_end(vargs);
 
-    char log_message[32000];
-    snprintf(log_message,
-             32000,
+    snprintf(log_line,
+             LOG_BUFFER_SIZE,
              "%s[%s] %s:%d %s\n",
              log_source_strings[source],
              log_level_strings[level],
              file,
              line,
-             buffer);
+             log_buffer);
 
     if (state->enable_console) {
         if (is_error) {
-            platform_console_write_error(log_message, (u8)level);
+            platform_console_write_error(log_line, (u8)level);
         } else {
-            platform_console_write(log_message, (u8)level);
+            platform_console_write(log_line, (u8)level);
         }
     }
 
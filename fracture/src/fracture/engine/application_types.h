@@ -11,8 +11,12 @@
 #pragma once
 
 #include "fracture/core/defines.h"
+#include "fracture/core/library/math/simd/dispatch.h"
+#include "fracture/core/systems/job_system.h"
 #include "fracture/core/systems/logging.h"
+#include "fracture/engine/frame_stats.h"
 #include "fracture/renderer/renderer_types.h"
+#include "fracture/resources/resource_system.h"
 
 /**
  * @brief Application configuration struct
@@ -43,6 +47,32 @@ typedef struct application_config {
     /** @brief Lock frame rate*/
     b8 lock_frame_rate;
 
+    /** @brief Run the update function at a fixed tick rate decoupled from the render rate */
+    b8 fixed_timestep;
+
+    /** @brief Number of fixed updates per second when fixed_timestep is enabled */
+    f64 fixed_tick_rate;
+
+    /** @brief Maximum number of fixed updates run in a single frame before the remaining time is dropped */
+    u32 max_catchup_steps;
+
+    /**
+     * @brief Run without a window and with the null renderer backend, e.g. for dedicated servers and benchmarks.
+     * @details Every frame runs exactly one update of 1 / fixed_tick_rate seconds. With lock_frame_rate the engine
+     * sleeps to keep the updates in step with real time, otherwise it runs them back to back as fast as possible. The
+     * engine also switches to it when the platform has no display to open a window on.
+     */
+    b8 headless;
+
+    /** @brief Widest instruction set of the math batch kernels, FR_SIMD_LEVEL_AUTO (0) for the widest supported */
+    simd_level simd_level;
+
+    /** @brief Job system configuration */
+    job_system_config job_config;
+
+    /** @brief Resource system configuration */
+    resource_system_config resource_config;
+
     /** @brief renderer settings*/
     renderer_settings settings;
 } application_config;
@@ -61,14 +91,22 @@ typedef struct application_handle {
     /** @brief Current frame rate of the engine*/
     f64 current_frame_rate;
 
+    /** @brief Frame time statistics of the last completed statistics window. Updated by the engine. */
+    frame_statistics frame_stats;
+
     /** @brief Function pointer to initialize the application */
     b8 (*initialize)(struct application_handle* app_config);
 
     /** @brief Function pointer to update the application */
     b8 (*update)(struct application_handle* app_config, f64 delta_time);
 
-    /** @brief Function pointer to applications render function */
-    b8 (*render)(struct application_handle* app_config, f64 delta_time);
+    /**
+     * @brief Function pointer to applications render function
+     * @details alpha is the fraction of a fixed tick that has accumulated since the last update, in the range [0, 1).
+     * It is used to interpolate between the previous and current simulation states. It is always 1.0 when the
+     * application does not use a fixed timestep.
+     */
+    b8 (*render)(struct application_handle* app_config, f64 delta_time, f64 alpha);
 
     /** @brief Application's on resize function */
     b8 (*on_resize)(struct application_handle* app_config, u32 width, u32 height);
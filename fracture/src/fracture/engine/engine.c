@@ -3,16 +3,23 @@
 #include <platform.h>
 
 #include "fracture/core/includes/system_event_codes.h"
+#include "fracture/core/library/math/simd/dispatch.h"
 #include "fracture/core/systems/clock.h"
 #include "fracture/core/systems/event.h"
+#include "fracture/core/systems/file_io.h"
 #include "fracture/core/systems/fracture_memory.h"
 #include "fracture/core/systems/input.h"
+#include "fracture/core/systems/job_system.h"
 #include "fracture/core/systems/logging.h"
 #include "fracture/engine/application_types.h"
 #include "fracture/engine/engine_events.h"
+#include "fracture/engine/frame_stats.h"
 #include "fracture/renderer/renderer_frontend.h"
+#include "fracture/resources/resource_system.h"
 
 #define FRAME_RATE_CALC_INTERVAL 2.0F
+#define DEFAULT_FIXED_TICK_RATE 60.0
+#define DEFAULT_MAX_CATCHUP_STEPS 5
 
 typedef struct engine_state {
     application_handle* app_handle;
@@ -25,6 +32,10 @@ typedef struct engine_state {
     clock app_clock;
     f64 last_frame_time;
     u64 frame_count;
+    f64 fixed_tick_seconds;
+    f64 fixed_accumulator;
+    u64 fixed_tick_count;
+    f64 next_tick_time;
     const char* name;
 } engine_state;
 
@@ -33,6 +44,8 @@ static engine_state state;
 
 b8 _engine_on_event(u16 event_code, void* sendeer, void* listener_instance, event_data data);
 b8 _engine_on_key_event(u16 event_code, void* sender, void* listener_instance, event_data data);
+b8 _engine_fixed_update(application_handle* app_handle, f64 delta_time, f64* out_alpha);
+b8 _engine_headless_update(application_handle* app_handle, f64* out_delta_time);
 
 b8 engine_initialize(application_handle* app_handle) {
     if (is_initialized) {
@@ -53,6 +66,8 @@ b8 engine_initialize(application_handle* app_handle) {
     state.app_handle = app_handle;
     state.current_width = app_handle->app_config.start_width;
     state.current_height = app_handle->app_config.start_height;
+    state.fixed_accumulator = 0.0;
+    state.fixed_tick_count = 0;
 
     // Initialize the platform
     state.plat_state.on_key_event = fr_input_process_keypress;
@@ -62,17 +77,41 @@ b8 engine_initialize(application_handle* app_handle) {
     state.plat_state.on_window_close = fr_engine_process_window_close;
     state.plat_state.on_window_resize = fr_engine_process_window_resize;
 
-    if (!platform_startup(&state.plat_state,
-                          app_handle->app_config.name,
-                          app_handle->app_config.start_width,
-                          app_handle->app_config.start_height,
-                          app_handle->app_config.start_x_pos,
-                          app_handle->app_config.start_y_pos)) {
+    if (app_handle->app_config.headless) {
+        // There is nothing to present to so the renderer is always the null backend
+        app_handle->app_config.settings.backend_type = FR_RENDERER_BACKEND_NULL;
+        if (!platform_startup_headless(&state.plat_state,
+                                       app_handle->app_config.start_width,
+                                       app_handle->app_config.start_height)) {
+            FR_CORE_FATAL("Failed to initialize headless platform");
+            return FALSE;
+        }
+    } else if (!platform_startup(&state.plat_state,
+                                 app_handle->app_config.name,
+                                 app_handle->app_config.start_width,
+                                 app_handle->app_config.start_height,
+                                 app_handle->app_config.start_x_pos,
+                                 app_handle->app_config.start_y_pos)) {
         FR_CORE_FATAL("Failed to initialize platform");
         return FALSE;
+    } else if (platform_is_headless(&state.plat_state)) {
+        // The platform found no display to open a window on, so there is nothing for a GPU backend to present to
+        FR_CORE_WARN("No display available, running headless");
+        app_handle->app_config.headless = TRUE;
+        app_handle->app_config.settings.backend_type = FR_RENDERER_BACKEND_NULL;
     }
     FR_CORE_INFO("Platform initialized: %s", app_handle->app_config.name);
 
+    if (app_handle->app_config.fixed_timestep || app_handle->app_config.headless) {
+        if (app_handle->app_config.fixed_tick_rate <= 0.0) {
+            app_handle->app_config.fixed_tick_rate = DEFAULT_FIXED_TICK_RATE;
+        }
+        if (app_handle->app_config.max_catchup_steps == 0) {
+            app_handle->app_config.max_catchup_steps = DEFAULT_MAX_CATCHUP_STEPS;
+        }
+        state.fixed_tick_seconds = 1.0 / app_handle->app_config.fixed_tick_rate;
+    }
+
     // Initialize the logger
     if (!fr_logging_initialize(&app_handle->app_config.logging_config)) {
         FR_CORE_FATAL("Failed to initialize logging");
@@ -80,6 +119,37 @@ b8 engine_initialize(application_handle* app_handle) {
     }
     FR_CORE_INFO("Logging initialized: %s", app_handle->app_config.name);
 
+    // Pick the math batch kernels before any system uses them
+    simd_level level = fr_simd_set_level(app_handle->app_config.simd_level);
+    FR_CORE_INFO("Math kernels: %s (widest supported: %s)",
+                 fr_simd_level_name(level),
+                 fr_simd_level_name(fr_simd_supported_level()));
+
+    // Initialize the frame statistics
+    if (!fr_frame_stats_initialize(FRAME_RATE_CALC_INTERVAL)) {
+        FR_CORE_FATAL("Failed to initialize frame statistics");
+        return FALSE;
+    }
+
+    // Initialize the job system
+    if (!fr_job_system_initialize(&app_handle->app_config.job_config)) {
+        FR_CORE_FATAL("Failed to initialize job system");
+        return FALSE;
+    }
+    FR_CORE_INFO("Job system initialized: %s", app_handle->app_config.name);
+
+    // Initialize the file I/O system
+    if (!fr_file_io_initialize()) {
+        FR_CORE_FATAL("Failed to initialize file I/O system");
+        return FALSE;
+    }
+
+    // Initialize the resource system
+    if (!fr_resource_system_initialize(&app_handle->app_config.resource_config)) {
+        FR_CORE_FATAL("Failed to initialize resource system");
+        return FALSE;
+    }
+
     // Initialize the event system
     if (!fr_event_initialize()) {
         FR_CORE_FATAL("Failed to initialize event system");
@@ -136,6 +206,13 @@ b8 engine_shutdown(application_handle* app_handle) {
     FR_CORE_INFO("Input system shutdown: %s", app_handle->app_config.name);
     fr_event_shutdown();
     FR_CORE_INFO("Event system shutdown: %s", app_handle->app_config.name);
+    fr_resource_system_shutdown();
+    FR_CORE_INFO("Resource system shutdown: %s", app_handle->app_config.name);
+    fr_file_io_shutdown();
+    FR_CORE_INFO("File I/O system shutdown: %s", app_handle->app_config.name);
+    fr_job_system_shutdown();
+    FR_CORE_INFO("Job system shutdown: %s", app_handle->app_config.name);
+    fr_frame_stats_shutdown();
     fr_logging_shutdown();
     FR_CORE_INFO("Logging shutdown: %s", app_handle->app_config.name);
 
@@ -161,13 +238,21 @@ b8 engine_run(application_handle* app_handle) {
 
     fr_memory_print_stats();
 
-    f64 frame_rate_time = 0.0F;
-    u64 last_frame_count = 0;
+    f64 frame_start_time = platform_get_absolute_time();
+    state.next_tick_time = frame_start_time;
 
     while (state.is_running) {
+        f64 stage_start_time = platform_get_absolute_time();
         if (!platform_pump_messages(&state.plat_state)) {
             state.is_running = FALSE;
         }
+        fr_frame_stats_record(FRAME_STAGE_PUMP, platform_get_absolute_time() - stage_start_time);
+
+        // Run the callbacks of the file requests that finished since the last frame
+        fr_file_io_update();
+
+        // Collect the finished resource loads and evict unreferenced resources over the memory budget
+        fr_resource_system_update();
 
         if (app_handle->renderer_settings_modified) {
             fr_renderer_update_renderer_config(&app_handle->app_config.settings);
@@ -178,27 +263,46 @@ b8 engine_run(application_handle* app_handle) {
             fr_clock_update(&state.app_clock);
             f64 delta_time = fr_clock_get_elapsed_time_s(&state.app_clock) - state.last_frame_time;
             // f64 frame_start_time = platform_get_absolute_time();
-
-            if (!app_handle->update(app_handle, delta_time)) {
+            f64 alpha = 1.0;
+
+            stage_start_time = platform_get_absolute_time();
+            if (app_handle->app_config.headless) {
+                if (!_engine_headless_update(app_handle, &delta_time)) {
+                    FR_CORE_FATAL("Failed to update client application");
+                    state.is_running = FALSE;
+                    return FALSE;
+                }
+            } else if (app_handle->app_config.fixed_timestep) {
+                if (!_engine_fixed_update(app_handle, delta_time, &alpha)) {
+                    FR_CORE_FATAL("Failed to update client application");
+                    state.is_running = FALSE;
+                    return FALSE;
+                }
+            } else if (!app_handle->update(app_handle, delta_time)) {
                 FR_CORE_FATAL("Failed to update client application");
                 state.is_running = FALSE;
                 return FALSE;
             }
+            fr_frame_stats_record(FRAME_STAGE_UPDATE, platform_get_absolute_time() - stage_start_time);
 
-            if (!app_handle->render(app_handle, delta_time)) {
+            stage_start_time = platform_get_absolute_time();
+            if (!app_handle->render(app_handle, delta_time, alpha)) {
                 FR_CORE_FATAL("Failed to render client application");
                 state.is_running = FALSE;
                 return FALSE;
             }
+            fr_frame_stats_record(FRAME_STAGE_RENDER, platform_get_absolute_time() - stage_start_time);
 
             // Trigger the renderer to draw the frame
             {
+                stage_start_time = platform_get_absolute_time();
                 // TODO: We dont want to create the packet here every frame.
                 renderer_packet packet = {0};
                 packet.delta_time = delta_time;
                 if (!fr_renderer_draw_frame(&packet)) {
                     FR_CORE_ERROR("Failed to draw frame");
                 }
+                fr_frame_stats_record(FRAME_STAGE_DRAW_FRAME, platform_get_absolute_time() - stage_start_time);
             }
 
             // f64 frame_end_time = platform_get_absolute_time();
@@ -216,16 +320,27 @@ b8 engine_run(application_handle* app_handle) {
             // frame_count++;
             state.last_frame_time = fr_clock_get_elapsed_time_s(&state.app_clock);
             state.frame_count++;
-            frame_rate_time += delta_time;
-            if (frame_rate_time > FRAME_RATE_CALC_INTERVAL) {
-                app_handle->current_frame_rate = (state.frame_count - last_frame_count) / frame_rate_time;
-                frame_rate_time = 0.0F;
-                last_frame_count = state.frame_count;
+
+            f64 frame_end_time = platform_get_absolute_time();
+            if (fr_frame_stats_end_frame(frame_end_time - frame_start_time)) {
+                fr_frame_stats_get(&app_handle->frame_stats);
+                app_handle->current_frame_rate = app_handle->frame_stats.frame_rate;
             }
+            frame_start_time = frame_end_time;
 
             if (fr_input_is_key_down(KEY_2)) {
-                FR_INFO("Frame rate: %f", app_handle->current_frame_rate);
+                const frame_stage_statistics* frame = &app_handle->frame_stats.stages[FRAME_STAGE_FRAME];
+                FR_INFO("Frame rate: %f | frame time (ms) avg: %.3f p50: %.3f p99: %.3f p99.9: %.3f max: %.3f",
+                        app_handle->current_frame_rate,
+                        frame->avg_ms,
+                        frame->p50_ms,
+                        frame->p99_ms,
+                        frame->p999_ms,
+                        frame->max_ms);
             }
+        } else {
+            // Do not count the time spent suspended towards the next frame
+            frame_start_time = platform_get_absolute_time();
         }
     }
 
@@ -238,6 +353,62 @@ void engine_get_framebuffer_size(u32* width, u32* height) {
     *height = state.current_height;
 }
 
+f64 engine_get_frame_time_percentile(frame_stage stage, f64 percentile) {
+    return fr_frame_stats_percentile(stage, percentile);
+}
+
+b8 _engine_fixed_update(application_handle* app_handle, f64 delta_time, f64* out_alpha) {
+    const f64 tick = state.fixed_tick_seconds;
+    const u32 max_steps = app_handle->app_config.max_catchup_steps;
+    state.fixed_accumulator += delta_time;
+
+    u32 steps = 0;
+    while (state.fixed_accumulator >= tick && steps < max_steps) {
+        if (!app_handle->update(app_handle, tick)) {
+            return FALSE;
+        }
+        state.fixed_accumulator -= tick;
+        state.fixed_tick_count++;
+        steps++;
+    }
+
+    // If we could not catch up within the allowed number of steps we drop the whole ticks that are left instead of
+    // carrying them over. Otherwise a single long frame makes every following frame run the maximum number of updates.
+    if (state.fixed_accumulator >= tick) {
+        u64 dropped_ticks = (u64)(state.fixed_accumulator / tick);
+        FR_CORE_TRACE("Fixed update fell behind, dropping %llu ticks", dropped_ticks);
+        state.fixed_accumulator -= (f64)dropped_ticks * tick;
+    }
+
+    *out_alpha = state.fixed_accumulator / tick;
+    return TRUE;
+}
+
+b8 _engine_headless_update(application_handle* app_handle, f64* out_delta_time) {
+    const f64 tick = state.fixed_tick_seconds;
+
+    if (app_handle->app_config.lock_frame_rate) {
+        // Hold the updates to real time. If we fell more than a tick behind we do not try to catch up, a server that
+        // cannot keep up should not also burst.
+        f64 now = platform_get_absolute_time();
+        if (state.next_tick_time > now) {
+            platform_sleep((u64)((state.next_tick_time - now) * 1000.0));
+        } else if (now - state.next_tick_time > tick) {
+            state.next_tick_time = now;
+        }
+        state.next_tick_time += tick;
+    }
+
+    if (!app_handle->update(app_handle, tick)) {
+        return FALSE;
+    }
+    state.fixed_tick_count++;
+
+    // The rest of the frame sees the simulated time step instead of the wall clock time
+    *out_delta_time = tick;
+    return TRUE;
+}
+
 b8 _engine_on_event(u16 event_code, void* sender, void* listener_instance, event_data data) {
     switch (event_code) {
         case EVENT_CODE_APPLICATION_QUIT:
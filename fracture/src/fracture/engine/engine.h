@@ -44,3 +44,13 @@ FR_API b8 engine_run(application_handle* app_handle);
  * @param height The height of the framebuffer
  */
 FR_API void engine_get_framebuffer_size(u32* width, u32* height);
+
+/**
+ * @brief Returns the frame time of the given stage at the given percentile over the last completed statistics window.
+ * The summary of the window is also available in application_handle::frame_stats.
+ *
+ * @param stage The stage of the frame to query
+ * @param percentile The percentile to query in the range [0, 100]
+ * @return f64 The frame time in milliseconds
+ */
+FR_API f64 engine_get_frame_time_percentile(frame_stage stage, f64 percentile);
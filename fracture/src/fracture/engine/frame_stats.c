@@ -0,0 +1,222 @@
+#include "frame_stats.h"
+
+#include "fracture/core/systems/fracture_memory.h"
+#include "fracture/core/systems/logging.h"
+
+// The histogram is log-linear. Values below HISTOGRAM_SUB_BUCKET_COUNT microseconds get a bucket each, above that
+// every power of two is split into HISTOGRAM_SUB_BUCKET_HALF buckets. This bounds the relative error of any bucket
+// to 1 / HISTOGRAM_SUB_BUCKET_HALF while still covering up to 2^(HISTOGRAM_MAX_EXPONENT + 7) microseconds (~35 min).
+#define HISTOGRAM_SUB_BUCKET_BITS 7
+#define HISTOGRAM_SUB_BUCKET_COUNT (1 << HISTOGRAM_SUB_BUCKET_BITS)
+#define HISTOGRAM_SUB_BUCKET_HALF (HISTOGRAM_SUB_BUCKET_COUNT >> 1)
+#define HISTOGRAM_MAX_EXPONENT 24
+#define HISTOGRAM_BUCKET_COUNT (HISTOGRAM_SUB_BUCKET_COUNT + HISTOGRAM_MAX_EXPONENT * HISTOGRAM_SUB_BUCKET_HALF)
+
+typedef struct frame_histogram {
+    u32 counts[HISTOGRAM_BUCKET_COUNT];
+    u64 sample_count;
+    f64 sum_seconds;
+    f64 min_seconds;
+    f64 max_seconds;
+} frame_histogram;
+
+typedef struct frame_stats_state {
+    f64 window_seconds;
+    f64 window_elapsed;
+    f64 stage_accumulators[FRAME_STAGE_COUNT];
+    b8 stage_recorded[FRAME_STAGE_COUNT];
+    frame_histogram active[FRAME_STAGE_COUNT];
+    frame_histogram published[FRAME_STAGE_COUNT];
+    frame_statistics snapshot;
+} frame_stats_state;
+
+static frame_stats_state* state = NULL_PTR;
+
+static void _histogram_reset(frame_histogram* histogram);
+static void _histogram_record(frame_histogram* histogram, f64 seconds);
+static f64 _histogram_percentile_ms(const frame_histogram* histogram, f64 percentile);
+static void _histogram_summarize(const frame_histogram* histogram, frame_stage_statistics* out_stats);
+
+b8 fr_frame_stats_initialize(f64 window_seconds) {
+    if (state != NULL_PTR) {
+        FR_CORE_WARN("Frame statistics already initialized");
+        return TRUE;
+    }
+
+    if (window_seconds <= 0.0) {
+        FR_CORE_ERROR("Frame statistics window must be positive: %f", window_seconds);
+        return FALSE;
+    }
+
+    state = fr_memory_allocate(sizeof(frame_stats_state), MEMORY_TYPE_SYSTEM);
+    state->window_seconds = window_seconds;
+    for (u32 i = 0; i < FRAME_STAGE_COUNT; ++i) {
+        _histogram_reset(&state->active[i]);
+        _histogram_reset(&state->published[i]);
+    }
+    return TRUE;
+}
+
+void fr_frame_stats_shutdown() {
+    if (state == NULL_PTR) {
+        return;
+    }
+
+    fr_memory_free(state, sizeof(frame_stats_state), MEMORY_TYPE_SYSTEM);
+    state = NULL_PTR;
+}
+
+void fr_frame_stats_record(frame_stage stage, f64 seconds) {
+    if (state == NULL_PTR || stage >= FRAME_STAGE_COUNT) {
+        return;
+    }
+
+    state->stage_accumulators[stage] += seconds;
+    state->stage_recorded[stage] = TRUE;
+}
+
+b8 fr_frame_stats_end_frame(f64 frame_seconds) {
+    if (state == NULL_PTR) {
+        return FALSE;
+    }
+
+    _histogram_record(&state->active[FRAME_STAGE_FRAME], frame_seconds);
+    for (u32 i = FRAME_STAGE_FRAME + 1; i < FRAME_STAGE_COUNT; ++i) {
+        if (state->stage_recorded[i]) {
+            _histogram_record(&state->active[i], state->stage_accumulators[i]);
+        }
+        state->stage_accumulators[i] = 0.0;
+        state->stage_recorded[i] = FALSE;
+    }
+
+    state->window_elapsed += frame_seconds;
+    if (state->window_elapsed < state->window_seconds) {
+        return FALSE;
+    }
+
+    // Publish the window
+    frame_statistics* snapshot = &state->snapshot;
+    snapshot->frame_count = state->active[FRAME_STAGE_FRAME].sample_count;
+    snapshot->window_seconds = state->window_elapsed;
+    snapshot->frame_rate = (f64)snapshot->frame_count / state->window_elapsed;
+    for (u32 i = 0; i < FRAME_STAGE_COUNT; ++i) {
+        _histogram_summarize(&state->active[i], &snapshot->stages[i]);
+    }
+
+    fr_memory_copy(state->published, state->active, sizeof(state->published));
+    for (u32 i = 0; i < FRAME_STAGE_COUNT; ++i) {
+        _histogram_reset(&state->active[i]);
+    }
+    state->window_elapsed = 0.0;
+    return TRUE;
+}
+
+void fr_frame_stats_get(frame_statistics* out_stats) {
+    if (state == NULL_PTR) {
+        fr_memory_zero(out_stats, sizeof(frame_statistics));
+        return;
+    }
+
+    *out_stats = state->snapshot;
+}
+
+f64 fr_frame_stats_percentile(frame_stage stage, f64 percentile) {
+    if (state == NULL_PTR || stage >= FRAME_STAGE_COUNT) {
+        return 0.0;
+    }
+
+    return _histogram_percentile_ms(&state->published[stage], percentile);
+}
+
+// -----------------------------------------------------------------------
+// PRIVATE FUNCTIONS
+// -----------------------------------------------------------------------
+
+static inline u32 _histogram_bucket_index(u64 value_us) {
+    if (value_us < HISTOGRAM_SUB_BUCKET_COUNT) {
+        return (u32)value_us;
+    }
+
+    // Shift the value so that its top HISTOGRAM_SUB_BUCKET_BITS - 1 bits select the sub bucket
+    u32 msb = 63 - __builtin_clzll(value_us);
+    u32 exponent = msb - (HISTOGRAM_SUB_BUCKET_BITS - 1);
+    if (exponent > HISTOGRAM_MAX_EXPONENT) {
+        return HISTOGRAM_BUCKET_COUNT - 1;
+    }
+    u32 sub_bucket = (u32)(value_us >> exponent) - HISTOGRAM_SUB_BUCKET_HALF;
+    return HISTOGRAM_SUB_BUCKET_COUNT + (exponent - 1) * HISTOGRAM_SUB_BUCKET_HALF + sub_bucket;
+}
+
+static inline f64 _histogram_bucket_value_us(u32 index) {
+    if (index < HISTOGRAM_SUB_BUCKET_COUNT) {
+        return (f64)index;
+    }
+
+    u32 exponent = (index - HISTOGRAM_SUB_BUCKET_COUNT) / HISTOGRAM_SUB_BUCKET_HALF + 1;
+    u64 sub_bucket = (index - HISTOGRAM_SUB_BUCKET_COUNT) % HISTOGRAM_SUB_BUCKET_HALF + HISTOGRAM_SUB_BUCKET_HALF;
+    u64 lower = sub_bucket << exponent;
+    // Report the middle of the bucket
+    return (f64)lower + (f64)((1ULL << exponent) >> 1);
+}
+
+static void _histogram_reset(frame_histogram* histogram) {
+    fr_memory_zero(histogram, sizeof(frame_histogram));
+    histogram->min_seconds = 1.0e30;
+}
+
+static void _histogram_record(frame_histogram* histogram, f64 seconds) {
+    if (seconds < 0.0) {
+        seconds = 0.0;
+    }
+
+    u64 value_us = (u64)(seconds * 1000000.0);
+    histogram->counts[_histogram_bucket_index(value_us)]++;
+    histogram->sample_count++;
+    histogram->sum_seconds += seconds;
+    if (seconds < histogram->min_seconds) {
+        histogram->min_seconds = seconds;
+    }
+    if (seconds > histogram->max_seconds) {
+        histogram->max_seconds = seconds;
+    }
+}
+
+static f64 _histogram_percentile_ms(const frame_histogram* histogram, f64 percentile) {
+    if (histogram->sample_count == 0) {
+        return 0.0;
+    }
+
+    percentile = CLAMP(percentile, 0.0, 100.0);
+    u64 target = (u64)((percentile / 100.0) * (f64)histogram->sample_count + 0.5);
+    if (target == 0) {
+        target = 1;
+    }
+
+    u64 cumulative = 0;
+    for (u32 i = 0; i < HISTOGRAM_BUCKET_COUNT; ++i) {
+        cumulative += histogram->counts[i];
+        if (cumulative >= target) {
+            // The bucket midpoint can be outside the observed range for the first and last buckets
+            f64 value_ms = _histogram_bucket_value_us(i) / 1000.0;
+            value_ms = CLAMP(value_ms, histogram->min_seconds * 1000.0, histogram->max_seconds * 1000.0);
+            return value_ms;
+        }
+    }
+
+    return histogram->max_seconds * 1000.0;
+}
+
+static void _histogram_summarize(const frame_histogram* histogram, frame_stage_statistics* out_stats) {
+    if (histogram->sample_count == 0) {
+        fr_memory_zero(out_stats, sizeof(frame_stage_statistics));
+        return;
+    }
+
+    out_stats->min_ms = histogram->min_seconds * 1000.0;
+    out_stats->max_ms = histogram->max_seconds * 1000.0;
+    out_stats->avg_ms = histogram->sum_seconds * 1000.0 / (f64)histogram->sample_count;
+    out_stats->p50_ms = _histogram_percentile_ms(histogram, 50.0);
+    out_stats->p95_ms = _histogram_percentile_ms(histogram, 95.0);
+    out_stats->p99_ms = _histogram_percentile_ms(histogram, 99.0);
+    out_stats->p999_ms = _histogram_percentile_ms(histogram, 99.9);
+}
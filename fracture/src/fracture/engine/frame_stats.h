@@ -0,0 +1,109 @@
+/**
+ * @file frame_stats.h
+ * @author Aditya Rajagopal
+ * @brief Rolling frame time statistics for the engine loop.
+ * @details Frame and stage times are recorded into HDR style log-linear histograms with microsecond resolution and a
+ * relative precision of better than 2%. Samples are collected over a window of time and when the window closes the
+ * min/avg/max and the p50/p95/p99/p99.9 values are published as a snapshot. The histograms of the last completed window
+ * are kept around so that arbitrary percentiles can be queried until the next window is published.
+ * @version 0.0.1
+ * @date 2024-04-02
+ *
+ * @copyright Fracture Game Engine is Copyright (c) Aditya Rajagopal 2024-2024
+ *
+ */
+#pragma once
+
+#include "fracture/core/defines.h"
+
+/**
+ * @brief The parts of a frame that are timed individually. FRAME_STAGE_FRAME is the time of the whole loop iteration.
+ *
+ */
+typedef enum frame_stage {
+    FRAME_STAGE_FRAME = 0,
+    FRAME_STAGE_PUMP,
+    FRAME_STAGE_UPDATE,
+    FRAME_STAGE_RENDER,
+    FRAME_STAGE_DRAW_FRAME,
+    FRAME_STAGE_COUNT
+} frame_stage;
+
+/**
+ * @brief Summary of the samples of a single stage over a window. All times are in milliseconds.
+ *
+ */
+typedef struct frame_stage_statistics {
+    f64 min_ms;
+    f64 avg_ms;
+    f64 max_ms;
+    f64 p50_ms;
+    f64 p95_ms;
+    f64 p99_ms;
+    f64 p999_ms;
+} frame_stage_statistics;
+
+/**
+ * @brief Snapshot of the frame statistics of the last completed window.
+ *
+ */
+typedef struct frame_statistics {
+    /** @brief Number of frames in the window */
+    u64 frame_count;
+
+    /** @brief Length of the window in seconds */
+    f64 window_seconds;
+
+    /** @brief Average frame rate over the window */
+    f64 frame_rate;
+
+    /** @brief Per stage statistics indexed by frame_stage */
+    frame_stage_statistics stages[FRAME_STAGE_COUNT];
+} frame_statistics;
+
+/**
+ * @brief Initializes the frame statistics system.
+ *
+ * @param window_seconds The length of the window over which samples are collected before publishing a snapshot.
+ * @return b8 TRUE if the system was initialized successfully, FALSE otherwise
+ */
+b8 fr_frame_stats_initialize(f64 window_seconds);
+
+/**
+ * @brief Shuts down the frame statistics system and frees the histograms.
+ *
+ */
+void fr_frame_stats_shutdown();
+
+/**
+ * @brief Records the time taken by a stage of the current frame. A stage can be recorded multiple times in a frame
+ * (e.g. when running several fixed updates) and the times are summed until fr_frame_stats_end_frame is called.
+ *
+ * @param stage The stage that was timed.
+ * @param seconds The time taken in seconds.
+ */
+void fr_frame_stats_record(frame_stage stage, f64 seconds);
+
+/**
+ * @brief Ends the current frame and records the time of the whole frame.
+ *
+ * @param frame_seconds The time of the whole frame in seconds.
+ * @return b8 TRUE if this frame closed the window and a new snapshot was published, FALSE otherwise
+ */
+b8 fr_frame_stats_end_frame(f64 frame_seconds);
+
+/**
+ * @brief Copies the snapshot of the last completed window.
+ *
+ * @param out_stats The statistics to write to.
+ */
+void fr_frame_stats_get(frame_statistics* out_stats);
+
+/**
+ * @brief Computes an arbitrary percentile of a stage over the last completed window.
+ *
+ * @param stage The stage to query.
+ * @param percentile The percentile in the range [0, 100].
+ * @return f64 The time at the given percentile in milliseconds or 0 if there are no samples.
+ */
+f64 fr_frame_stats_percentile(frame_stage stage, f64 percentile);
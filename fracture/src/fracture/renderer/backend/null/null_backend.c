@@ -0,0 +1,72 @@
+#include "null_backend.h"
+
+#include <platform.h>
+
+#include "fracture/core/systems/logging.h"
+
+typedef struct null_backend_state {
+    /** @brief Sum of the delta times passed to the backend, i.e. the time the application simulated */
+    f64 simulated_time;
+
+    /** @brief Wall clock time spent between begin_frame and end_frame */
+    f64 frame_time;
+
+    /** @brief Absolute time at which the current frame began */
+    f64 frame_start_time;
+
+    /** @brief Absolute time at which the backend was initialized */
+    f64 start_time;
+} null_backend_state;
+
+static null_backend_state state;
+
+b8 null_backend_initialize(renderer_backend* backend, const char* app_name, struct platform_state* plat_state) {
+    if (!backend) {
+        FR_CORE_ERROR("Renderer backend is NULL");
+        return FALSE;
+    }
+    if (backend->is_initialized) {
+        FR_CORE_WARN("Renderer backend already initialized");
+        return TRUE;
+    }
+
+    state.simulated_time = 0.0;
+    state.frame_time = 0.0;
+    state.frame_start_time = 0.0;
+    state.start_time = platform_get_absolute_time();
+
+    backend->frame_number = 0;
+    backend->is_initialized = TRUE;
+    FR_CORE_INFO("Null renderer backend initialized for %s", app_name);
+    return TRUE;
+}
+
+void null_backend_shutdown(renderer_backend* backend) {
+    if (!backend || !backend->is_initialized) {
+        return;
+    }
+
+    f64 run_time = platform_get_absolute_time() - state.start_time;
+    FR_CORE_INFO("Null renderer backend shutdown after %llu frames: %.3fs simulated, %.3fs wall clock, "
+                 "%.3fms in frames",
+                 backend->frame_number,
+                 state.simulated_time,
+                 run_time,
+                 state.frame_time * 1000.0);
+    backend->is_initialized = FALSE;
+}
+
+b8 null_backend_begin_frame(renderer_backend* backend, f64 delta_time) {
+    state.frame_start_time = platform_get_absolute_time();
+    state.simulated_time += delta_time;
+    return TRUE;
+}
+
+b8 null_backend_end_frame(renderer_backend* backend, f64 delta_time) {
+    state.frame_time += platform_get_absolute_time() - state.frame_start_time;
+    return TRUE;
+}
+
+void null_backend_on_window_resize(renderer_backend* backend, u32 width, u32 height) {}
+
+b8 null_backend_settings_callback(renderer_backend* backend) { return TRUE; }
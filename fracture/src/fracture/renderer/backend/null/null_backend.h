@@ -0,0 +1,67 @@
+/**
+ * @file null_backend.h
+ * @author Aditya Rajagopal
+ * @brief Renderer backend that does not draw anything.
+ * @details Used when the engine runs headless (dedicated servers, CPU benchmarks, machines without a GPU). Frames only
+ * account the time that passes between them so that the frame statistics of a headless run stay meaningful.
+ * @version 0.0.1
+ * @date 2024-04-08
+ *
+ * @copyright Fracture Game Engine is Copyright (c) Aditya Rajagopal 2024-2024
+ *
+ */
+#pragma once
+
+#include "fracture/renderer/renderer_types.h"
+
+/**
+ * @brief Initializes the null renderer backend
+ *
+ * @param backend The renderer backend to initialize
+ * @param app_name The name of the application
+ * @param plat_state The platform state. Not used.
+ * @return b8 TRUE if the backend was initialized successfully, FALSE otherwise
+ */
+b8 null_backend_initialize(renderer_backend* backend, const char* app_name, struct platform_state* plat_state);
+
+/**
+ * @brief Shuts down the null renderer backend and logs the number of frames and the time it accounted
+ *
+ * @param backend The renderer backend to shut down
+ */
+void null_backend_shutdown(renderer_backend* backend);
+
+/**
+ * @brief Begins a frame. Only records the time.
+ *
+ * @param backend The renderer backend
+ * @param delta_time The time since the last frame
+ * @return b8 Always TRUE
+ */
+b8 null_backend_begin_frame(renderer_backend* backend, f64 delta_time);
+
+/**
+ * @brief Ends a frame. Only records the time.
+ *
+ * @param backend The renderer backend
+ * @param delta_time The time since the last frame
+ * @return b8 Always TRUE
+ */
+b8 null_backend_end_frame(renderer_backend* backend, f64 delta_time);
+
+/**
+ * @brief Called when the window is resized. Does nothing.
+ *
+ * @param backend The renderer backend
+ * @param width The new width of the window
+ * @param height The new height of the window
+ */
+void null_backend_on_window_resize(renderer_backend* backend, u32 width, u32 height);
+
+/**
+ * @brief Callback for providing the renderer_settings to the backend. Every setting is accepted.
+ *
+ * @param backend The renderer backend
+ * @return b8 Always TRUE
+ */
+b8 null_backend_settings_callback(renderer_backend* backend);
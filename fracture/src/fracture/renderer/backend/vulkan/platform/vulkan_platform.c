@@ -39,4 +39,40 @@ b8 vulkan_platform_create_surface(struct vulkan_context* context) {
     return TRUE;
 }
 
+#elif defined(PLATFORM_LINUX)
+#include <xcb/xcb.h>
+#include <vulkan/vulkan_xcb.h>
+
+// Mirrors the start of the internal state of the linux platform layer
+typedef struct internal_state {
+    xcb_connection_t* connection;
+    xcb_window_t window;
+} internal_state;
+
+void vulkan_platform_get_required_instance_extensions(const char*** required_extensions) {
+    darray_push(*required_extensions, &"VK_KHR_xcb_surface");
+}
+
+b8 vulkan_platform_create_surface(struct vulkan_context* context) {
+    u64 platform_state_size = 0;
+    platform_get_handle_info(&platform_state_size, 0);
+    void* mem_block = fr_memory_allocate(platform_state_size, MEMORY_TYPE_RENDERER);
+    platform_get_handle_info(&platform_state_size, mem_block);
+
+    internal_state* handle = (internal_state*)mem_block;
+    if (!handle || handle->connection == NULL_PTR) {
+        // Headless platforms have no window to present to
+        fr_memory_free(mem_block, platform_state_size, MEMORY_TYPE_RENDERER);
+        return FALSE;
+    }
+
+    VkXcbSurfaceCreateInfoKHR create_info = {VK_STRUCTURE_TYPE_XCB_SURFACE_CREATE_INFO_KHR};
+    create_info.connection = handle->connection;
+    create_info.window = handle->window;
+
+    VK_CHECK_RESULT(vkCreateXcbSurfaceKHR(context->instance, &create_info, context->allocator, &context->surface));
+    fr_memory_free(mem_block, platform_state_size, MEMORY_TYPE_RENDERER);
+    return TRUE;
+}
+
 #endif
@@ -1,6 +1,7 @@
 #include "renderer_backend.h"
 
 #include "fracture/core/systems/logging.h"
+#include "fracture/renderer/backend/null/null_backend.h"
 #include "fracture/renderer/backend/vulkan/vulkan_backend.h"
 #include "fracture/renderer/renderer_types.h"
 
@@ -24,6 +25,16 @@ b8 fr_renderer_backend_create(const renderer_settings* settings,
             out_renderer_backend->PFN_renderer_settings_update_callback = vulkan_backend_settings_callback;
             return TRUE;
         } break;
+        case FR_RENDERER_BACKEND_NULL: {
+            out_renderer_backend->settings = *settings;
+            out_renderer_backend->PFN_initialize = null_backend_initialize;
+            out_renderer_backend->PFN_shutdown = null_backend_shutdown;
+            out_renderer_backend->PFN_begin_frame = null_backend_begin_frame;
+            out_renderer_backend->PFN_end_frame = null_backend_end_frame;
+            out_renderer_backend->PFN_on_window_resize = null_backend_on_window_resize;
+            out_renderer_backend->PFN_renderer_settings_update_callback = null_backend_settings_callback;
+            return TRUE;
+        } break;
         default: {
             FR_CORE_FATAL("Renderer backend type %d not supported", settings->backend_type);
             return FALSE;
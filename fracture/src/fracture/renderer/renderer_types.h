@@ -6,7 +6,9 @@ typedef enum renderer_backend_type {
     FR_RENDERER_BACKEND_OPENGL,
     FR_RENDERER_BACKEND_VULKAN,
     FR_RENDERER_BACKEND_DIRECTX,
-    FR_RENDERER_BACKEND_METAL
+    FR_RENDERER_BACKEND_METAL,
+    // Draws nothing. Used when the engine runs headless.
+    FR_RENDERER_BACKEND_NULL
 } renderer_backend_type;
 
 typedef enum renderer_backend_return_codes {
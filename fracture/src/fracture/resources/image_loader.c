@@ -0,0 +1,710 @@
+#include "image_loader.h"
+
+#include <string.h>
+
+#include "fracture/core/library/cpu_features.h"
+#include "fracture/core/library/fracture_compression.h"
+#include "fracture/core/systems/fracture_memory.h"
+#include "fracture/core/systems/job_system.h"
+
+#if FR_SIMD == 1
+#include <emmintrin.h>
+#if defined(_MSC_VER) || defined(_WIN32)
+#include <intrin.h>
+#else
+#include <immintrin.h>
+#endif
+#endif
+
+#define PNG_SIGNATURE_SIZE 8
+// Length, type and CRC around the data of every chunk
+#define PNG_CHUNK_OVERHEAD 12
+
+#define PNG_CHUNK_TYPE(a, b, c, d) (((u32)(a) << 24) | ((u32)(b) << 16) | ((u32)(c) << 8) | (u32)(d))
+#define PNG_CHUNK_IHDR PNG_CHUNK_TYPE('I', 'H', 'D', 'R')
+#define PNG_CHUNK_PLTE PNG_CHUNK_TYPE('P', 'L', 'T', 'E')
+#define PNG_CHUNK_TRNS PNG_CHUNK_TYPE('t', 'R', 'N', 'S')
+#define PNG_CHUNK_IDAT PNG_CHUNK_TYPE('I', 'D', 'A', 'T')
+#define PNG_CHUNK_IEND PNG_CHUNK_TYPE('I', 'E', 'N', 'D')
+
+// Alignment of the pixels of images created by the resource loader, one cache line after the image header
+#define IMAGE_PIXEL_ALIGNMENT 64
+
+STATIC_ASSERT(sizeof(image) <= IMAGE_PIXEL_ALIGNMENT, "image header must fit in front of the pixels");
+
+typedef enum png_color_type {
+    PNG_COLOR_GRAY = 0,
+    PNG_COLOR_RGB = 2,
+    PNG_COLOR_PALETTE = 3,
+    PNG_COLOR_GRAY_ALPHA = 4,
+    PNG_COLOR_RGBA = 6,
+} png_color_type;
+
+typedef enum png_filter {
+    PNG_FILTER_NONE = 0,
+    PNG_FILTER_SUB,
+    PNG_FILTER_UP,
+    PNG_FILTER_AVERAGE,
+    PNG_FILTER_PAETH,
+} png_filter;
+
+typedef struct png_image {
+    u32 width;
+    u32 height;
+    u32 bit_depth;
+    u32 color_type;
+    u32 channels;
+
+    // Bytes of a filtered row without the filter byte, and the distance to the corresponding byte of the pixel on the
+    // left used by the filters (at least 1)
+    u32 row_bytes;
+    u32 filter_stride;
+
+    // Palette expanded to RGBA, with the alpha of tRNS
+    u8 palette[256][4];
+    u32 palette_size;
+
+    // tRNS color key of gray and RGB images, in the bit depth of the image
+    b8 has_color_key;
+    u16 color_key[3];
+
+    // The zlib stream, either pointing into the file or gathered from several IDAT chunks
+    const u8* compressed;
+    u64 compressed_size;
+    u32 idat_count;
+} png_image;
+
+// Processor specific paths, picked once per image
+typedef struct png_simd {
+    b8 sse2;
+    b8 ssse3;
+    b8 avx2;
+} png_simd;
+
+static b8 _png_parse(const u8* data, u64 size, png_image* out_png);
+static b8 _png_gather_idat(const u8* data, u64 size, u8* out);
+static void _png_unfilter_row(
+    const png_simd* simd, u32 filter, const u8* in, const u8* prior, u8* out, u32 row_bytes, u32 stride);
+static void _png_convert_row(const png_simd* simd, const png_image* png, const u8* in, u8* out);
+static void _image_decode_range(u32 start, u32 end, void* data);
+
+b8 fr_image_png_info(const void* data, u64 size, image_info* out_info) {
+    png_image png;
+    if (!_png_parse((const u8*)data, size, &png)) {
+        return FALSE;
+    }
+    out_info->width = png.width;
+    out_info->height = png.height;
+    out_info->source_channels = png.channels;
+    out_info->bit_depth = png.bit_depth;
+    return TRUE;
+}
+
+u64 fr_image_pixels_size(const image_info* info, u32 row_pitch) {
+    u64 pitch = row_pitch != 0 ? row_pitch : (u64)info->width * IMAGE_CHANNELS;
+    if (info->height == 0) {
+        return 0;
+    }
+    // The last row does not need the padding of the pitch
+    return pitch * (info->height - 1) + (u64)info->width * IMAGE_CHANNELS;
+}
+
+b8 fr_image_png_decode(
+    const void* data, u64 size, void* pixels, u64 pixels_size, u32 row_pitch, image_info* out_info) {
+    png_image png;
+    if (!_png_parse((const u8*)data, size, &png)) {
+        return FALSE;
+    }
+
+    image_info info = {png.width, png.height, png.channels, png.bit_depth};
+    if (out_info != NULL_PTR) {
+        *out_info = info;
+    }
+    u64 pixel_row_bytes = (u64)png.width * IMAGE_CHANNELS;
+    u64 pitch = row_pitch != 0 ? row_pitch : pixel_row_bytes;
+    if (pitch < pixel_row_bytes || pixels_size < fr_image_pixels_size(&info, (u32)pitch)) {
+        return FALSE;
+    }
+
+    // Scratch: the inflated filtered rows, the gathered IDAT chunks if there are several, and two unfiltered rows
+    // (the current one and the one above it, which starts out as the zero row above the image)
+    u64 filtered_size = (u64)png.height * (png.row_bytes + 1);
+    u64 gathered_size = png.idat_count > 1 ? png.compressed_size : 0;
+    u64 scratch_size = filtered_size + gathered_size + 2 * (u64)png.row_bytes;
+    u8* scratch = fr_memory_allocate(scratch_size, MEMORY_TYPE_ARRAY);
+    u8* filtered = scratch;
+    u8* rows[2] = {scratch + filtered_size + gathered_size, scratch + filtered_size + gathered_size + png.row_bytes};
+
+    const u8* compressed = png.compressed;
+    if (png.idat_count > 1) {
+        _png_gather_idat((const u8*)data, size, scratch + filtered_size);
+        compressed = scratch + filtered_size;
+    }
+
+    u64 inflated_size = 0;
+    b8 result = fr_decompress_zlib(compressed, png.compressed_size, filtered, filtered_size, &inflated_size) &&
+                inflated_size == filtered_size;
+
+    png_simd simd = {0};
+#if FR_SIMD == 1
+    simd.sse2 = TRUE;
+    simd.ssse3 = fr_cpu_has_feature(FR_CPU_FEATURE_SSSE3);
+    simd.avx2 = fr_cpu_has_feature(FR_CPU_FEATURE_AVX2);
+#endif
+
+    // 8 bit RGBA rows are unfiltered straight into the destination, the row above being the previous destination row
+    b8 direct = png.color_type == PNG_COLOR_RGBA && png.bit_depth == 8;
+    u8* out_row = (u8*)pixels;
+    const u8* prior = rows[1];
+    for (u32 y = 0; result && y < png.height; ++y) {
+        const u8* in = filtered + (u64)y * (png.row_bytes + 1);
+        u32 filter = in[0];
+        if (filter > PNG_FILTER_PAETH) {
+            result = FALSE;
+            break;
+        }
+
+        u8* unfiltered = direct ? out_row : rows[y & 1];
+        _png_unfilter_row(&simd, filter, in + 1, prior, unfiltered, png.row_bytes, png.filter_stride);
+        if (!direct) {
+            _png_convert_row(&simd, &png, unfiltered, out_row);
+        }
+        prior = unfiltered;
+        out_row += pitch;
+    }
+
+    fr_memory_free(scratch, scratch_size, MEMORY_TYPE_ARRAY);
+    return result;
+}
+
+u32 fr_image_decode_batch(image_decode_request* requests, u32 count) {
+    fr_job_parallel_for(count, 1, _image_decode_range, requests);
+
+    u32 decoded = 0;
+    for (u32 i = 0; i < count; ++i) {
+        decoded += requests[i].succeeded ? 1 : 0;
+    }
+    return decoded;
+}
+
+b8 fr_image_resource_load(const char* name, const void* source, u64 source_size, resource_data* out_data) {
+    (void)name;
+    image_info info;
+    if (!fr_image_png_info(source, source_size, &info)) {
+        return FALSE;
+    }
+
+    u32 row_pitch = info.width * IMAGE_CHANNELS;
+    u64 size = IMAGE_PIXEL_ALIGNMENT + fr_image_pixels_size(&info, row_pitch);
+    image* result = fr_memory_allocate_aligned(size, IMAGE_PIXEL_ALIGNMENT, MEMORY_TYPE_TEXTURE);
+    result->width = info.width;
+    result->height = info.height;
+    result->row_pitch = row_pitch;
+    result->pixels = (u8*)result + IMAGE_PIXEL_ALIGNMENT;
+    if (!fr_image_png_decode(source, source_size, result->pixels, size - IMAGE_PIXEL_ALIGNMENT, row_pitch, NULL_PTR)) {
+        fr_memory_free_aligned(result, size, IMAGE_PIXEL_ALIGNMENT, MEMORY_TYPE_TEXTURE);
+        return FALSE;
+    }
+
+    out_data->data = result;
+    out_data->size = size;
+    return TRUE;
+}
+
+void fr_image_resource_unload(resource_data* data) {
+    fr_memory_free_aligned(data->data, data->size, IMAGE_PIXEL_ALIGNMENT, MEMORY_TYPE_TEXTURE);
+}
+
+// -----------------------------------------------------------------------
+// PRIVATE FUNCTIONS
+// -----------------------------------------------------------------------
+
+static inline u32 _png_read_u32(const u8* p) {
+    return ((u32)p[0] << 24) | ((u32)p[1] << 16) | ((u32)p[2] << 8) | (u32)p[3];
+}
+
+static b8 _png_parse(const u8* data, u64 size, png_image* out_png) {
+    static const u8 signature[PNG_SIGNATURE_SIZE] = {137, 80, 78, 71, 13, 10, 26, 10};
+    if (size < PNG_SIGNATURE_SIZE || memcmp(data, signature, PNG_SIGNATURE_SIZE) != 0) {
+        return FALSE;
+    }
+
+    png_image png;
+    memset(&png, 0, sizeof(png_image));
+    b8 has_header = FALSE;
+    b8 has_end = FALSE;
+    u64 offset = PNG_SIGNATURE_SIZE;
+    while (!has_end && size - offset >= PNG_CHUNK_OVERHEAD) {
+        u32 length = _png_read_u32(data + offset);
+        u32 type = _png_read_u32(data + offset + 4);
+        const u8* chunk = data + offset + 8;
+        if (length > size - offset - PNG_CHUNK_OVERHEAD) {
+            return FALSE;
+        }
+        offset += PNG_CHUNK_OVERHEAD + (u64)length;
+
+        if (!has_header && type != PNG_CHUNK_IHDR) {
+            return FALSE;
+        }
+
+        switch (type) {
+            case PNG_CHUNK_IHDR: {
+                if (has_header || length != 13) {
+                    return FALSE;
+                }
+                has_header = TRUE;
+                png.width = _png_read_u32(chunk);
+                png.height = _png_read_u32(chunk + 4);
+                png.bit_depth = chunk[8];
+                png.color_type = chunk[9];
+                // Compression and filter methods 0 are the only ones defined, interlacing is not supported
+                if (chunk[10] != 0 || chunk[11] != 0 || chunk[12] != 0) {
+                    return FALSE;
+                }
+                if (png.width == 0 || png.height == 0 || png.width > IMAGE_MAX_DIMENSION ||
+                    png.height > IMAGE_MAX_DIMENSION) {
+                    return FALSE;
+                }
+
+                u32 depth = png.bit_depth;
+                b8 valid_depth = FALSE;
+                switch (png.color_type) {
+                    case PNG_COLOR_GRAY:
+                        png.channels = 1;
+                        valid_depth = depth == 1 || depth == 2 || depth == 4 || depth == 8 || depth == 16;
+                        break;
+                    case PNG_COLOR_PALETTE:
+                        png.channels = 1;
+                        valid_depth = depth == 1 || depth == 2 || depth == 4 || depth == 8;
+                        break;
+                    case PNG_COLOR_RGB:
+                        png.channels = 3;
+                        valid_depth = depth == 8 || depth == 16;
+                        break;
+                    case PNG_COLOR_GRAY_ALPHA:
+                        png.channels = 2;
+                        valid_depth = depth == 8 || depth == 16;
+                        break;
+                    case PNG_COLOR_RGBA:
+                        png.channels = 4;
+                        valid_depth = depth == 8 || depth == 16;
+                        break;
+                    default:
+                        break;
+                }
+                if (!valid_depth) {
+                    return FALSE;
+                }
+
+                u64 row_bits = (u64)png.width * png.channels * depth;
+                png.row_bytes = (u32)((row_bits + 7) / 8);
+                png.filter_stride = MAX(1, png.channels * depth / 8);
+            } break;
+
+            case PNG_CHUNK_PLTE: {
+                if (length % 3 != 0 || length / 3 > 256 || length == 0) {
+                    return FALSE;
+                }
+                png.palette_size = length / 3;
+                for (u32 i = 0; i < png.palette_size; ++i) {
+                    png.palette[i][0] = chunk[i * 3 + 0];
+                    png.palette[i][1] = chunk[i * 3 + 1];
+                    png.palette[i][2] = chunk[i * 3 + 2];
+                    png.palette[i][3] = 255;
+                }
+            } break;
+
+            case PNG_CHUNK_TRNS: {
+                if (png.color_type == PNG_COLOR_PALETTE) {
+                    if (length > png.palette_size) {
+                        return FALSE;
+                    }
+                    for (u32 i = 0; i < length; ++i) {
+                        png.palette[i][3] = chunk[i];
+                    }
+                } else if (png.color_type == PNG_COLOR_GRAY || png.color_type == PNG_COLOR_RGB) {
+                    if (length != png.channels * 2) {
+                        return FALSE;
+                    }
+                    png.has_color_key = TRUE;
+                    for (u32 i = 0; i < png.channels; ++i) {
+                        png.color_key[i] = (u16)((chunk[i * 2] << 8) | chunk[i * 2 + 1]);
+                    }
+                } else {
+                    // Not allowed for images that have an alpha channel
+                    return FALSE;
+                }
+            } break;
+
+            case PNG_CHUNK_IDAT: {
+                if (png.idat_count == 0) {
+                    png.compressed = chunk;
+                }
+                png.compressed_size += length;
+                png.idat_count++;
+            } break;
+
+            case PNG_CHUNK_IEND:
+                has_end = TRUE;
+                break;
+
+            default:
+                // Critical chunks, the ones with an upper case first letter, must be understood to decode the image
+                if ((type & 0x20000000) == 0) {
+                    return FALSE;
+                }
+                break;
+        }
+    }
+
+    if (!has_header || png.idat_count == 0 || (png.color_type == PNG_COLOR_PALETTE && png.palette_size == 0)) {
+        return FALSE;
+    }
+    *out_png = png;
+    return TRUE;
+}
+
+static b8 _png_gather_idat(const u8* data, u64 size, u8* out) {
+    u64 offset = PNG_SIGNATURE_SIZE;
+    while (size - offset >= PNG_CHUNK_OVERHEAD) {
+        u32 length = _png_read_u32(data + offset);
+        u32 type = _png_read_u32(data + offset + 4);
+        if (type == PNG_CHUNK_IDAT) {
+            memcpy(out, data + offset + 8, length);
+            out += length;
+        } else if (type == PNG_CHUNK_IEND) {
+            break;
+        }
+        // Lengths were validated by _png_parse
+        offset += PNG_CHUNK_OVERHEAD + (u64)length;
+    }
+    return TRUE;
+}
+
+static inline u8 _png_paeth(u8 a, u8 b, u8 c) {
+    i32 pa = b - c;
+    i32 pb = a - c;
+    i32 pc = pa + pb;
+    pa = pa < 0 ? -pa : pa;
+    pb = pb < 0 ? -pb : pb;
+    pc = pc < 0 ? -pc : pc;
+    if (pa <= pb && pa <= pc) {
+        return a;
+    }
+    return pb <= pc ? b : c;
+}
+
+// Scalar filters for the bytes [start, row_bytes), used for bit depths without a SIMD path and for the tails
+static void _png_unfilter_scalar(
+    u32 filter, const u8* in, const u8* prior, u8* out, u32 start, u32 row_bytes, u32 stride) {
+    u32 i = start;
+    switch (filter) {
+        case PNG_FILTER_NONE:
+            memcpy(out + i, in + i, row_bytes - i);
+            break;
+        case PNG_FILTER_SUB:
+            for (; i < stride && i < row_bytes; ++i) {
+                out[i] = in[i];
+            }
+            for (; i < row_bytes; ++i) {
+                out[i] = (u8)(in[i] + out[i - stride]);
+            }
+            break;
+        case PNG_FILTER_UP:
+            for (; i < row_bytes; ++i) {
+                out[i] = (u8)(in[i] + prior[i]);
+            }
+            break;
+        case PNG_FILTER_AVERAGE:
+            for (; i < stride && i < row_bytes; ++i) {
+                out[i] = (u8)(in[i] + (prior[i] >> 1));
+            }
+            for (; i < row_bytes; ++i) {
+                out[i] = (u8)(in[i] + ((out[i - stride] + prior[i]) >> 1));
+            }
+            break;
+        case PNG_FILTER_PAETH:
+            for (; i < stride && i < row_bytes; ++i) {
+                out[i] = (u8)(in[i] + prior[i]);
+            }
+            for (; i < row_bytes; ++i) {
+                out[i] = (u8)(in[i] + _png_paeth(out[i - stride], prior[i], prior[i - stride]));
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+#if FR_SIMD == 1
+static inline __m128i _png_load_pixel(const u8* p, u32 stride) {
+    u32 value = 0;
+    memcpy(&value, p, stride);
+    return _mm_cvtsi32_si128((i32)value);
+}
+
+static inline void _png_store_pixel(u8* p, __m128i pixel, u32 stride) {
+    u32 value = (u32)_mm_cvtsi128_si32(pixel);
+    memcpy(p, &value, stride);
+}
+
+static u32 _png_unfilter_up_sse2(const u8* in, const u8* prior, u8* out, u32 start, u32 row_bytes) {
+    u32 i = start;
+    for (; i + 16 <= row_bytes; i += 16) {
+        __m128i x = _mm_loadu_si128((const __m128i*)(in + i));
+        __m128i b = _mm_loadu_si128((const __m128i*)(prior + i));
+        _mm_storeu_si128((__m128i*)(out + i), _mm_add_epi8(x, b));
+    }
+    return i;
+}
+
+FR_TARGET_AVX2 static u32 _png_unfilter_up_avx2(const u8* in, const u8* prior, u8* out, u32 row_bytes) {
+    u32 i = 0;
+    for (; i + 32 <= row_bytes; i += 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(in + i));
+        __m256i b = _mm256_loadu_si256((const __m256i*)(prior + i));
+        _mm256_storeu_si256((__m256i*)(out + i), _mm256_add_epi8(x, b));
+    }
+    return i;
+}
+
+// Sub is a running sum along the row. Within a block the sum is built with log2 shifted adds and the last pixel of
+// the previous block is added to every pixel.
+static u32 _png_unfilter_sub_sse2(const u8* in, u8* out, u32 row_bytes, u32 stride) {
+    u32 i = 0;
+    __m128i last = _mm_setzero_si128();
+    if (stride == 4) {
+        for (; i + 16 <= row_bytes; i += 16) {
+            __m128i x = _mm_loadu_si128((const __m128i*)(in + i));
+            x = _mm_add_epi8(x, _mm_slli_si128(x, 4));
+            x = _mm_add_epi8(x, _mm_slli_si128(x, 8));
+            x = _mm_add_epi8(x, last);
+            _mm_storeu_si128((__m128i*)(out + i), x);
+            last = _mm_shuffle_epi32(x, _MM_SHUFFLE(3, 3, 3, 3));
+        }
+    } else if (stride == 3) {
+        // 4 pixels in the low 12 bytes of each 16 byte block. The top 4 bytes are overwritten by the next block.
+        const __m128i pixel_mask = _mm_cvtsi32_si128(0x00FFFFFF);
+        for (; i + 16 <= row_bytes; i += 12) {
+            __m128i x = _mm_loadu_si128((const __m128i*)(in + i));
+            x = _mm_add_epi8(x, _mm_slli_si128(x, 3));
+            x = _mm_add_epi8(x, _mm_slli_si128(x, 6));
+            x = _mm_add_epi8(x, last);
+            _mm_storeu_si128((__m128i*)(out + i), x);
+            last = _mm_and_si128(_mm_srli_si128(x, 9), pixel_mask);
+            last = _mm_or_si128(last, _mm_slli_si128(last, 3));
+            last = _mm_or_si128(last, _mm_slli_si128(last, 6));
+        }
+    }
+    return i;
+}
+
+// Average and Paeth depend on the pixel on the left after it has been unfiltered, so they go one pixel at a time with
+// all the channels of the pixel in one register
+static u32 _png_unfilter_average_sse2(const u8* in, const u8* prior, u8* out, u32 row_bytes, u32 stride) {
+    __m128i a = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi8(1);
+    u32 i = 0;
+    for (; i + stride <= row_bytes; i += stride) {
+        __m128i b = _png_load_pixel(prior + i, stride);
+        __m128i x = _png_load_pixel(in + i, stride);
+        // _mm_avg_epu8 rounds up, the filter rounds down
+        __m128i average = _mm_sub_epi8(_mm_avg_epu8(a, b), _mm_and_si128(_mm_xor_si128(a, b), one));
+        a = _mm_add_epi8(x, average);
+        _png_store_pixel(out + i, a, stride);
+    }
+    return i;
+}
+
+static inline __m128i _png_abs_epi16(__m128i x) { return _mm_max_epi16(x, _mm_sub_epi16(_mm_setzero_si128(), x)); }
+
+static inline __m128i _png_select(__m128i mask, __m128i a, __m128i b) {
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+static u32 _png_unfilter_paeth_sse2(const u8* in, const u8* prior, u8* out, u32 row_bytes, u32 stride) {
+    const __m128i zero = _mm_setzero_si128();
+    // Left, above and above left pixels widened to 16 bits
+    __m128i a = zero;
+    __m128i c = zero;
+    u32 i = 0;
+    for (; i + stride <= row_bytes; i += stride) {
+        __m128i b = _mm_unpacklo_epi8(_png_load_pixel(prior + i, stride), zero);
+        __m128i x = _png_load_pixel(in + i, stride);
+
+        __m128i pa = _mm_sub_epi16(b, c);
+        __m128i pb = _mm_sub_epi16(a, c);
+        __m128i pc = _mm_add_epi16(pa, pb);
+        pa = _png_abs_epi16(pa);
+        pb = _png_abs_epi16(pb);
+        pc = _png_abs_epi16(pc);
+        __m128i smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+
+        // Ties prefer a, then b, as in the scalar predictor
+        __m128i predictor =
+            _png_select(_mm_cmpeq_epi16(pa, smallest), a, _png_select(_mm_cmpeq_epi16(pb, smallest), b, c));
+        x = _mm_add_epi8(x, _mm_packus_epi16(predictor, predictor));
+        _png_store_pixel(out + i, x, stride);
+
+        a = _mm_unpacklo_epi8(x, zero);
+        c = b;
+    }
+    return i;
+}
+
+FR_TARGET_SSSE3 static u32 _png_expand_rgb_ssse3(const u8* in, u8* out, u32 width) {
+    const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m128i alpha = _mm_set1_epi32((i32)0xFF000000);
+    u32 x = 0;
+    // Reads 16 bytes for 4 pixels, so stop while the read stays inside the row
+    for (; (x + 4) * 3 + 4 <= width * 3; x += 4) {
+        __m128i rgb = _mm_loadu_si128((const __m128i*)(in + x * 3));
+        _mm_storeu_si128((__m128i*)(out + x * 4), _mm_or_si128(_mm_shuffle_epi8(rgb, shuffle), alpha));
+    }
+    return x;
+}
+
+FR_TARGET_AVX2 static u32 _png_expand_rgb_avx2(const u8* in, u8* out, u32 width) {
+    // Moves bytes [0, 16) to the low lane and [12, 28) to the high lane so that each lane holds 4 pixels at its start
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 3, 4, 5, 6);
+    const __m256i shuffle = _mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+                                             0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m256i alpha = _mm256_set1_epi32((i32)0xFF000000);
+    u32 x = 0;
+    // Reads 32 bytes for 8 pixels
+    for (; (x + 8) * 3 + 8 <= width * 3; x += 8) {
+        __m256i rgb = _mm256_loadu_si256((const __m256i*)(in + x * 3));
+        rgb = _mm256_permutevar8x32_epi32(rgb, lanes);
+        _mm256_storeu_si256((__m256i*)(out + x * 4), _mm256_or_si256(_mm256_shuffle_epi8(rgb, shuffle), alpha));
+    }
+    return x;
+}
+#endif
+
+static void _png_unfilter_row(
+    const png_simd* simd, u32 filter, const u8* in, const u8* prior, u8* out, u32 row_bytes, u32 stride) {
+    u32 done = 0;
+#if FR_SIMD == 1
+    if (simd->sse2) {
+        switch (filter) {
+            case PNG_FILTER_UP:
+                if (simd->avx2) {
+                    done = _png_unfilter_up_avx2(in, prior, out, row_bytes);
+                }
+                done = _png_unfilter_up_sse2(in, prior, out, done, row_bytes);
+                break;
+            case PNG_FILTER_SUB:
+                done = _png_unfilter_sub_sse2(in, out, row_bytes, stride);
+                break;
+            case PNG_FILTER_AVERAGE:
+                if (stride == 3 || stride == 4) {
+                    done = _png_unfilter_average_sse2(in, prior, out, row_bytes, stride);
+                }
+                break;
+            case PNG_FILTER_PAETH:
+                if (stride == 3 || stride == 4) {
+                    done = _png_unfilter_paeth_sse2(in, prior, out, row_bytes, stride);
+                }
+                break;
+            default:
+                break;
+        }
+    }
+#else
+    (void)simd;
+#endif
+    if (done < row_bytes) {
+        _png_unfilter_scalar(filter, in, prior, out, done, row_bytes, stride);
+    }
+}
+
+static void _png_convert_row(const png_simd* simd, const png_image* png, const u8* in, u8* out) {
+    u32 width = png->width;
+    u32 depth = png->bit_depth;
+
+    if (png->color_type == PNG_COLOR_PALETTE || (png->color_type == PNG_COLOR_GRAY && depth < 8)) {
+        // Samples packed most significant bits first
+        u32 per_byte = 8 / depth;
+        u32 mask = (1u << depth) - 1;
+        u32 scale = 255 / mask;
+        for (u32 x = 0; x < width; ++x) {
+            u32 shift = 8 - depth * (x % per_byte + 1);
+            u32 sample = depth == 8 ? in[x] : (in[x / per_byte] >> shift) & mask;
+            u8* pixel = out + x * 4;
+            if (png->color_type == PNG_COLOR_PALETTE) {
+                if (sample < png->palette_size) {
+                    memcpy(pixel, png->palette[sample], 4);
+                } else {
+                    // Out of range indices are an error in the spec, decode them as opaque black
+                    pixel[0] = pixel[1] = pixel[2] = 0;
+                    pixel[3] = 255;
+                }
+            } else {
+                pixel[0] = pixel[1] = pixel[2] = (u8)(sample * scale);
+                pixel[3] = (png->has_color_key && sample == png->color_key[0]) ? 0 : 255;
+            }
+        }
+        return;
+    }
+
+    // 8 or 16 bits per sample. 16 bit samples are big endian and keep their high byte.
+    u32 sample_bytes = depth / 8;
+    u32 pixel_bytes = png->channels * sample_bytes;
+    u32 x = 0;
+#if FR_SIMD == 1
+    if (png->color_type == PNG_COLOR_RGB && depth == 8 && !png->has_color_key) {
+        if (simd->avx2) {
+            x = _png_expand_rgb_avx2(in, out, width);
+        } else if (simd->ssse3) {
+            x = _png_expand_rgb_ssse3(in, out, width);
+        }
+    }
+#else
+    (void)simd;
+#endif
+    for (; x < width; ++x) {
+        const u8* source = in + x * pixel_bytes;
+        u8* pixel = out + x * 4;
+        u16 samples[4] = {0};
+        for (u32 c = 0; c < png->channels; ++c) {
+            samples[c] = sample_bytes == 1 ? source[c] : (u16)((source[c * 2] << 8) | source[c * 2 + 1]);
+        }
+        u32 high = sample_bytes == 1 ? 0 : 8;
+
+        switch (png->color_type) {
+            case PNG_COLOR_GRAY:
+                pixel[0] = pixel[1] = pixel[2] = (u8)(samples[0] >> high);
+                pixel[3] = (png->has_color_key && samples[0] == png->color_key[0]) ? 0 : 255;
+                break;
+            case PNG_COLOR_GRAY_ALPHA:
+                pixel[0] = pixel[1] = pixel[2] = (u8)(samples[0] >> high);
+                pixel[3] = (u8)(samples[1] >> high);
+                break;
+            case PNG_COLOR_RGB: {
+                b8 keyed = png->has_color_key && samples[0] == png->color_key[0] &&
+                           samples[1] == png->color_key[1] && samples[2] == png->color_key[2];
+                pixel[0] = (u8)(samples[0] >> high);
+                pixel[1] = (u8)(samples[1] >> high);
+                pixel[2] = (u8)(samples[2] >> high);
+                pixel[3] = keyed ? 0 : 255;
+            } break;
+            case PNG_COLOR_RGBA:
+                pixel[0] = (u8)(samples[0] >> high);
+                pixel[1] = (u8)(samples[1] >> high);
+                pixel[2] = (u8)(samples[2] >> high);
+                pixel[3] = (u8)(samples[3] >> high);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+static void _image_decode_range(u32 start, u32 end, void* data) {
+    image_decode_request* requests = (image_decode_request*)data;
+    for (u32 i = start; i < end; ++i) {
+        image_decode_request* request = &requests[i];
+        request->succeeded = fr_image_png_decode(
+            request->data, request->size, request->pixels, request->pixels_size, request->row_pitch, &request->info);
+    }
+}
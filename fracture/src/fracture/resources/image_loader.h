@@ -0,0 +1,149 @@
+/**
+ * @file image_loader.h
+ * @author Aditya Rajagopal
+ * @brief PNG decoding into RGBA8 pixels, for single images and for batches decoded in parallel on the job system.
+ * @details Decoding writes straight into a buffer provided by the caller, typically a mapped staging buffer, with a
+ * row pitch of its choosing so that no intermediate copy of the pixels is needed before the upload. Every image is
+ * expanded to 8 bits per channel RGBA whatever its color type.
+ *
+ * The expensive parts of a PNG are inflating the compressed data and undoing the per row filters, and neither can be
+ * split across threads within an image. Batches therefore decode one image per job. The filters and the RGB to RGBA
+ * expansion of 8 bit images use SSE2, with SSSE3 and AVX2 paths picked at runtime when the processor supports them.
+ *
+ * Interlaced (Adam7) images are not supported. Chunk CRCs and the zlib checksum are not verified, the data comes from
+ * our own assets and corruption in the compressed stream is still detected by the decoder.
+ * @version 0.0.1
+ * @date 2024-04-24
+ *
+ * @copyright Fracture Game Engine is Copyright (c) Aditya Rajagopal 2024-2024
+ *
+ */
+#pragma once
+
+#include "fracture/core/defines.h"
+#include "fracture/resources/resource_system.h"
+
+// Decoded images always have 4 channels of 8 bits
+#define IMAGE_CHANNELS 4
+
+// Largest width or height of an image that is accepted
+#define IMAGE_MAX_DIMENSION (1u << 24)
+
+/**
+ * @brief Properties of an encoded image, read from its header.
+ *
+ */
+typedef struct image_info {
+    /** @brief Width in pixels */
+    u32 width;
+
+    /** @brief Height in pixels */
+    u32 height;
+
+    /** @brief Number of channels stored in the file, before expansion to RGBA. 1 for palette images. */
+    u32 source_channels;
+
+    /** @brief Bits per channel stored in the file */
+    u32 bit_depth;
+} image_info;
+
+/**
+ * @brief An image decoded by the resource system (RESOURCE_TYPE_IMAGE).
+ *
+ */
+typedef struct image {
+    /** @brief Width in pixels */
+    u32 width;
+
+    /** @brief Height in pixels */
+    u32 height;
+
+    /** @brief Distance between the start of two rows in bytes */
+    u32 row_pitch;
+
+    /** @brief RGBA8 pixels, top row first. Aligned to 64 bytes. */
+    u8* pixels;
+} image;
+
+/**
+ * @brief An image to decode as part of a batch.
+ *
+ */
+typedef struct image_decode_request {
+    /** @brief The encoded image */
+    const void* data;
+
+    /** @brief Size of the encoded image in bytes */
+    u64 size;
+
+    /** @brief Buffer to write the RGBA8 pixels to */
+    void* pixels;
+
+    /** @brief Size of the pixel buffer in bytes */
+    u64 pixels_size;
+
+    /** @brief Distance between the start of two rows in the pixel buffer. 0 for tightly packed rows. */
+    u32 row_pitch;
+
+    /** @brief Set to the properties of the image */
+    image_info info;
+
+    /** @brief Set to TRUE if the image was decoded */
+    b8 succeeded;
+} image_decode_request;
+
+/**
+ * @brief Reads the header of a PNG without decoding it, e.g. to size the pixel buffer.
+ *
+ * @param data The encoded image
+ * @param size The size of the encoded image in bytes
+ * @param out_info The properties of the image
+ * @return b8 TRUE if the data is a supported PNG, FALSE otherwise
+ */
+FR_API b8 fr_image_png_info(const void* data, u64 size, image_info* out_info);
+
+/**
+ * @brief Gets the size of the pixel buffer an image decodes into.
+ *
+ * @param info The properties of the image
+ * @param row_pitch Distance between the start of two rows in bytes. 0 for tightly packed rows.
+ * @return u64 The size of the buffer in bytes
+ */
+FR_API u64 fr_image_pixels_size(const image_info* info, u32 row_pitch);
+
+/**
+ * @brief Decodes a PNG on the calling thread.
+ *
+ * @param data The encoded image
+ * @param size The size of the encoded image in bytes
+ * @param pixels The buffer to write the RGBA8 pixels to
+ * @param pixels_size The size of the buffer. Must be at least fr_image_pixels_size bytes.
+ * @param row_pitch Distance between the start of two rows in the buffer. 0 for tightly packed rows.
+ * @param out_info The properties of the image. Can be NULL_PTR.
+ * @return b8 TRUE if the image was decoded, FALSE if it is malformed, unsupported or does not fit in the buffer
+ */
+FR_API b8 fr_image_png_decode(
+    const void* data, u64 size, void* pixels, u64 pixels_size, u32 row_pitch, image_info* out_info);
+
+/**
+ * @brief Decodes a batch of PNGs in parallel on the job system, one job per image, and waits for all of them. The
+ * calling thread decodes images as well while it waits. To load images without blocking at all acquire them through
+ * the resource system instead.
+ *
+ * @param requests The images to decode
+ * @param count The number of images
+ * @return u32 The number of images that were decoded
+ */
+FR_API u32 fr_image_decode_batch(image_decode_request* requests, u32 count);
+
+/**
+ * @brief Resource loader of RESOURCE_TYPE_IMAGE. Produces an image followed by its pixels in a single allocation.
+ *
+ */
+b8 fr_image_resource_load(const char* name, const void* source, u64 source_size, resource_data* out_data);
+
+/**
+ * @brief Frees an image created by fr_image_resource_load.
+ *
+ */
+void fr_image_resource_unload(resource_data* data);
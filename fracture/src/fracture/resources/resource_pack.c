@@ -0,0 +1,303 @@
+#include "resource_pack.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "fracture/core/containers/darrays.h"
+#include "fracture/core/library/fracture_compression.h"
+#include "fracture/core/library/fracture_hash.h"
+#include "fracture/core/systems/fracture_memory.h"
+#include "fracture/core/systems/logging.h"
+
+// A compressed payload is only kept if it saves at least 1/RESOURCE_PACK_MIN_SAVING of the size, otherwise the cost of
+// decompressing it is not worth it
+#define RESOURCE_PACK_MIN_SAVING 16
+
+STATIC_ASSERT(sizeof(resource_pack_header) == 64, "resource_pack_header must be 64 bytes");
+STATIC_ASSERT(sizeof(resource_pack_entry) == 40, "resource_pack_entry must be 40 bytes");
+
+static u64 _resource_pack_align(u64 offset);
+static u32 _resource_pack_bucket(u64 name_hash, u32 bucket_bits);
+static b8 _resource_pack_validate(const resource_pack* pack);
+static int _resource_pack_compare_entries(const void* a, const void* b);
+
+b8 fr_resource_pack_open(const char* path, resource_pack* out_pack) {
+    file_handle file;
+    if (!fr_file_open(path, FILE_MODE_READ, &file)) {
+        return FALSE;
+    }
+
+    resource_pack pack = {0};
+    b8 mapped = fr_file_map(&file, FILE_MAP_READ_ONLY, &pack.mapping);
+    fr_file_close(&file);
+    if (!mapped) {
+        FR_CORE_ERROR("Failed to map resource pack: %s", path);
+        return FALSE;
+    }
+
+    const u8* base = (const u8*)pack.mapping.data;
+    pack.header = (const resource_pack_header*)base;
+    if (pack.mapping.size < sizeof(resource_pack_header) || pack.header->magic != RESOURCE_PACK_MAGIC ||
+        pack.header->version != RESOURCE_PACK_VERSION) {
+        FR_CORE_ERROR("Not a resource pack or written by an incompatible packer: %s", path);
+        fr_file_unmap(&pack.mapping);
+        return FALSE;
+    }
+
+    pack.entries = (const resource_pack_entry*)(base + pack.header->toc_offset);
+    pack.buckets = (const u32*)(base + pack.header->bucket_offset);
+    pack.names = (const char*)(base + pack.header->names_offset);
+    if (!_resource_pack_validate(&pack)) {
+        FR_CORE_ERROR("Resource pack is corrupt: %s", path);
+        fr_file_unmap(&pack.mapping);
+        return FALSE;
+    }
+
+    // Lookups jump around the pack so read ahead would mostly bring in pages that are not needed
+    fr_file_advise(&pack.mapping, 0, pack.mapping.size, FILE_ACCESS_RANDOM);
+
+    *out_pack = pack;
+    return TRUE;
+}
+
+void fr_resource_pack_close(resource_pack* pack) {
+    if (pack == NULL_PTR || pack->mapping.data == NULL_PTR) {
+        return;
+    }
+
+    fr_file_unmap(&pack->mapping);
+    pack->header = NULL_PTR;
+    pack->entries = NULL_PTR;
+    pack->buckets = NULL_PTR;
+    pack->names = NULL_PTR;
+}
+
+const resource_pack_entry* fr_resource_pack_find(const resource_pack* pack, const char* name) {
+    u64 name_hash = fr_hash_string(name);
+    u32 bucket = _resource_pack_bucket(name_hash, pack->header->bucket_bits);
+    for (u32 i = pack->buckets[bucket]; i < pack->buckets[bucket + 1]; ++i) {
+        const resource_pack_entry* entry = &pack->entries[i];
+        // Names that are not in the pack can still collide with the hash of one that is
+        if (entry->name_hash == name_hash && strcmp(pack->names + entry->name_offset, name) == 0) {
+            return entry;
+        }
+    }
+    return NULL_PTR;
+}
+
+const resource_pack_entry* fr_resource_pack_find_hash(const resource_pack* pack, u64 name_hash) {
+    u32 bucket = _resource_pack_bucket(name_hash, pack->header->bucket_bits);
+    for (u32 i = pack->buckets[bucket]; i < pack->buckets[bucket + 1]; ++i) {
+        if (pack->entries[i].name_hash == name_hash) {
+            return &pack->entries[i];
+        }
+    }
+    return NULL_PTR;
+}
+
+const char* fr_resource_pack_entry_name(const resource_pack* pack, const resource_pack_entry* entry) {
+    return pack->names + entry->name_offset;
+}
+
+const void* fr_resource_pack_entry_data(const resource_pack* pack, const resource_pack_entry* entry) {
+    return (const u8*)pack->mapping.data + entry->offset;
+}
+
+void fr_resource_pack_prefetch(resource_pack* pack, const resource_pack_entry* entry) {
+    fr_file_advise(&pack->mapping, entry->offset, entry->stored_size, FILE_ACCESS_WILL_NEED);
+}
+
+b8 fr_resource_pack_read(const resource_pack* pack, const resource_pack_entry* entry, void* buffer) {
+    const void* data = fr_resource_pack_entry_data(pack, entry);
+    if (entry->compression == RESOURCE_PACK_COMPRESSION_LZ4) {
+        if (!fr_decompress_lz4(data, entry->stored_size, buffer, entry->size)) {
+            FR_CORE_ERROR("Failed to decompress resource: %s", fr_resource_pack_entry_name(pack, entry));
+            return FALSE;
+        }
+        return TRUE;
+    }
+
+    fr_memory_copy(buffer, data, entry->size);
+    return TRUE;
+}
+
+b8 fr_resource_pack_writer_begin(const char* path, resource_pack_writer* out_writer) {
+    if (!fr_file_open(path, FILE_MODE_WRITE, &out_writer->file)) {
+        return FALSE;
+    }
+
+    // The header is written last once the offsets of the tables are known
+    out_writer->offset = _resource_pack_align(sizeof(resource_pack_header));
+    out_writer->entries = darray_create(resource_pack_entry);
+    out_writer->names = darray_create(char);
+    return TRUE;
+}
+
+b8 fr_resource_pack_writer_add(
+    resource_pack_writer* writer, const char* name, const void* data, u64 size, b8 compress) {
+    resource_pack_entry entry = {0};
+    entry.name_hash = fr_hash_string(name);
+    entry.offset = writer->offset;
+    entry.size = size;
+    entry.stored_size = size;
+    entry.name_offset = (u32)darray_length(writer->names);
+    entry.compression = RESOURCE_PACK_COMPRESSION_NONE;
+
+    const void* payload = data;
+    u8* compressed = NULL_PTR;
+    u64 compressed_capacity = 0;
+    if (compress && size > 0 && size <= FR_LZ4_MAX_INPUT_SIZE) {
+        compressed_capacity = fr_compress_lz4_bound(size);
+        compressed = fr_memory_allocate(compressed_capacity, MEMORY_TYPE_ARRAY);
+        u64 compressed_size = fr_compress_lz4(data, size, compressed, compressed_capacity);
+        if (compressed_size > 0 && compressed_size <= size - size / RESOURCE_PACK_MIN_SAVING) {
+            payload = compressed;
+            entry.stored_size = compressed_size;
+            entry.compression = RESOURCE_PACK_COMPRESSION_LZ4;
+        }
+    }
+
+    b8 written = fr_file_write(&writer->file, entry.offset, entry.stored_size, payload, NULL_PTR);
+    if (compressed != NULL_PTR) {
+        fr_memory_free(compressed, compressed_capacity, MEMORY_TYPE_ARRAY);
+    }
+    if (!written) {
+        FR_CORE_ERROR("Failed to write resource to the pack: %s", name);
+        return FALSE;
+    }
+
+    for (const char* c = name; *c != 0; ++c) {
+        char character = *c;
+        darray_push(writer->names, character);
+    }
+    darray_push(writer->names, (char)0);
+    darray_push(writer->entries, entry);
+    writer->offset = _resource_pack_align(entry.offset + entry.stored_size);
+    return TRUE;
+}
+
+b8 fr_resource_pack_writer_end(resource_pack_writer* writer) {
+    u32 entry_count = (u32)darray_length(writer->entries);
+    qsort(writer->entries, entry_count, sizeof(resource_pack_entry), _resource_pack_compare_entries);
+    for (u32 i = 1; i < entry_count; ++i) {
+        if (writer->entries[i].name_hash == writer->entries[i - 1].name_hash) {
+            FR_CORE_ERROR("Resource names %s and %s have the same hash",
+                          writer->names + writer->entries[i - 1].name_offset,
+                          writer->names + writer->entries[i].name_offset);
+            fr_resource_pack_writer_abort(writer);
+            return FALSE;
+        }
+    }
+
+    // At least as many buckets as entries so that buckets hold about one entry each
+    u32 bucket_bits = 1;
+    while ((1ULL << bucket_bits) < entry_count) {
+        bucket_bits++;
+    }
+    u32 bucket_count = 1U << bucket_bits;
+    u64 bucket_table_size = sizeof(u32) * (bucket_count + 1);
+    u32* buckets = fr_memory_allocate(bucket_table_size, MEMORY_TYPE_ARRAY);
+    u32 entry_index = 0;
+    for (u32 bucket = 0; bucket <= bucket_count; ++bucket) {
+        while (entry_index < entry_count &&
+               _resource_pack_bucket(writer->entries[entry_index].name_hash, bucket_bits) < bucket) {
+            entry_index++;
+        }
+        buckets[bucket] = entry_index;
+    }
+
+    resource_pack_header header = {0};
+    header.magic = RESOURCE_PACK_MAGIC;
+    header.version = RESOURCE_PACK_VERSION;
+    header.entry_count = entry_count;
+    header.bucket_bits = bucket_bits;
+    header.toc_offset = writer->offset;
+    header.bucket_offset = header.toc_offset + sizeof(resource_pack_entry) * entry_count;
+    header.names_offset = header.bucket_offset + bucket_table_size;
+    header.names_size = darray_length(writer->names);
+    header.file_size = header.names_offset + header.names_size;
+
+    b8 written = fr_file_write(&writer->file,
+                               header.toc_offset,
+                               sizeof(resource_pack_entry) * entry_count,
+                               writer->entries,
+                               NULL_PTR) &&
+                 fr_file_write(&writer->file, header.bucket_offset, bucket_table_size, buckets, NULL_PTR) &&
+                 fr_file_write(&writer->file, header.names_offset, header.names_size, writer->names, NULL_PTR) &&
+                 fr_file_write(&writer->file, 0, sizeof(resource_pack_header), &header, NULL_PTR);
+    fr_memory_free(buckets, bucket_table_size, MEMORY_TYPE_ARRAY);
+    fr_resource_pack_writer_abort(writer);
+    if (!written) {
+        FR_CORE_ERROR("Failed to write the resource pack table of contents");
+        return FALSE;
+    }
+    return TRUE;
+}
+
+void fr_resource_pack_writer_abort(resource_pack_writer* writer) {
+    fr_file_close(&writer->file);
+    if (writer->entries != NULL_PTR) {
+        darray_destroy(writer->entries);
+        writer->entries = NULL_PTR;
+    }
+    if (writer->names != NULL_PTR) {
+        darray_destroy(writer->names);
+        writer->names = NULL_PTR;
+    }
+}
+
+// -----------------------------------------------------------------------
+// PRIVATE FUNCTIONS
+// -----------------------------------------------------------------------
+
+static u64 _resource_pack_align(u64 offset) {
+    return (offset + RESOURCE_PACK_ALIGNMENT - 1) & ~(u64)(RESOURCE_PACK_ALIGNMENT - 1);
+}
+
+static u32 _resource_pack_bucket(u64 name_hash, u32 bucket_bits) { return (u32)(name_hash >> (64 - bucket_bits)); }
+
+static b8 _resource_pack_validate(const resource_pack* pack) {
+    const resource_pack_header* header = pack->header;
+    u64 file_size = pack->mapping.size;
+    if (header->file_size != file_size || header->bucket_bits == 0 || header->bucket_bits > 31) {
+        return FALSE;
+    }
+
+    u64 bucket_count = 1ULL << header->bucket_bits;
+    u64 toc_size = sizeof(resource_pack_entry) * header->entry_count;
+    u64 bucket_table_size = sizeof(u32) * (bucket_count + 1);
+    if (header->toc_offset % sizeof(u64) != 0 || header->toc_offset > file_size ||
+        toc_size > file_size - header->toc_offset || header->bucket_offset % sizeof(u32) != 0 ||
+        header->bucket_offset > file_size || bucket_table_size > file_size - header->bucket_offset ||
+        header->names_offset > file_size || header->names_size > file_size - header->names_offset) {
+        return FALSE;
+    }
+
+    // Buckets have to be ordered for the lookups to stay inside the table of contents
+    if (pack->buckets[0] != 0 || pack->buckets[bucket_count] != header->entry_count) {
+        return FALSE;
+    }
+    for (u64 i = 0; i < bucket_count; ++i) {
+        if (pack->buckets[i] > pack->buckets[i + 1]) {
+            return FALSE;
+        }
+    }
+
+    for (u32 i = 0; i < header->entry_count; ++i) {
+        const resource_pack_entry* entry = &pack->entries[i];
+        if (entry->offset > file_size || entry->stored_size > file_size - entry->offset ||
+            entry->name_offset >= header->names_size || entry->compression > RESOURCE_PACK_COMPRESSION_LZ4 ||
+            (entry->compression == RESOURCE_PACK_COMPRESSION_NONE && entry->size != entry->stored_size)) {
+            return FALSE;
+        }
+    }
+
+    // Every name has to be terminated inside the pack
+    return header->names_size > 0 ? pack->names[header->names_size - 1] == 0 : header->entry_count == 0;
+}
+
+static int _resource_pack_compare_entries(const void* a, const void* b) {
+    u64 hash_a = ((const resource_pack_entry*)a)->name_hash;
+    u64 hash_b = ((const resource_pack_entry*)b)->name_hash;
+    return hash_a < hash_b ? -1 : hash_a > hash_b;
+}
@@ -0,0 +1,257 @@
+/**
+ * @file resource_pack.h
+ * @author Aditya Rajagopal
+ * @brief Binary resource packs: many resources stored in a single file that is memory mapped at runtime and looked up
+ * by the hash of their name.
+ * @details Layout of a pack, all values little endian:
+ *
+ *     resource_pack_header                           64 bytes at offset 0
+ *     payloads                                       each one starting on a RESOURCE_PACK_ALIGNMENT boundary
+ *     resource_pack_entry[entry_count]               the table of contents, sorted by name hash
+ *     u32 buckets[(1 << bucket_bits) + 1]            bucket b holds the entries [buckets[b], buckets[b + 1])
+ *     names                                          null terminated names of the entries
+ *
+ * The bucket of a name is the top bucket_bits bits of its FNV-1a hash. Since the table of contents is sorted by hash
+ * every bucket is a contiguous run of entries, and the packer picks at least as many buckets as entries so a lookup
+ * touches a single bucket with about one entry in it. Opening a pack only maps the file and validates the table of
+ * contents, nothing is parsed into separate structures.
+ *
+ * Payloads are stored either as is, in which case the data can be used straight from the mapping, or LZ4 compressed.
+ * The 64 byte alignment keeps payloads on their own cache lines and is enough for any SIMD load.
+ * @version 0.0.1
+ * @date 2024-04-22
+ *
+ * @copyright Fracture Game Engine is Copyright (c) Aditya Rajagopal 2024-2024
+ *
+ */
+#pragma once
+
+#include "fracture/core/defines.h"
+#include "fracture/core/systems/file_io.h"
+
+// "FRPK" in the first four bytes of the file
+#define RESOURCE_PACK_MAGIC 0x4B505246
+#define RESOURCE_PACK_VERSION 1
+
+// Alignment of every payload in the file
+#define RESOURCE_PACK_ALIGNMENT 64
+
+/**
+ * @brief How the payload of an entry is stored.
+ *
+ */
+typedef enum resource_pack_compression {
+    RESOURCE_PACK_COMPRESSION_NONE = 0,
+    RESOURCE_PACK_COMPRESSION_LZ4,
+} resource_pack_compression;
+
+/**
+ * @brief The header at the start of a pack.
+ *
+ */
+typedef struct resource_pack_header {
+    /** @brief RESOURCE_PACK_MAGIC */
+    u32 magic;
+
+    /** @brief RESOURCE_PACK_VERSION of the packer that wrote the pack */
+    u32 version;
+
+    /** @brief Number of entries in the table of contents */
+    u32 entry_count;
+
+    /** @brief Log2 of the number of buckets */
+    u32 bucket_bits;
+
+    /** @brief Offset of the table of contents */
+    u64 toc_offset;
+
+    /** @brief Offset of the bucket table */
+    u64 bucket_offset;
+
+    /** @brief Offset of the names */
+    u64 names_offset;
+
+    /** @brief Size of the names in bytes */
+    u64 names_size;
+
+    /** @brief Size of the whole pack, used to detect truncated files */
+    u64 file_size;
+
+    u8 reserved[8];
+} resource_pack_header;
+
+/**
+ * @brief An entry of the table of contents.
+ *
+ */
+typedef struct resource_pack_entry {
+    /** @brief FNV-1a hash of the name (fr_hash_string) */
+    u64 name_hash;
+
+    /** @brief Offset of the payload in the pack */
+    u64 offset;
+
+    /** @brief Size of the payload as stored in the pack */
+    u64 stored_size;
+
+    /** @brief Size of the resource once decompressed */
+    u64 size;
+
+    /** @brief Offset of the name from the start of the names */
+    u32 name_offset;
+
+    /** @brief One of resource_pack_compression */
+    u32 compression;
+} resource_pack_entry;
+
+/**
+ * @brief A pack opened for reading.
+ *
+ */
+typedef struct resource_pack {
+    /** @brief Mapping of the whole pack */
+    file_mapping mapping;
+
+    /** @brief The header, pointing into the mapping */
+    const resource_pack_header* header;
+
+    /** @brief The table of contents, pointing into the mapping */
+    const resource_pack_entry* entries;
+
+    /** @brief The bucket table, pointing into the mapping */
+    const u32* buckets;
+
+    /** @brief The names, pointing into the mapping */
+    const char* names;
+} resource_pack;
+
+/**
+ * @brief Builds a pack. Payloads are written to the file as they are added, the table of contents when the pack is
+ * finished.
+ *
+ */
+typedef struct resource_pack_writer {
+    /** @brief The pack being written */
+    file_handle file;
+
+    /** @brief Offset the next payload is written at */
+    u64 offset;
+
+    /** @brief darray of the entries added so far */
+    resource_pack_entry* entries;
+
+    /** @brief darray of the names added so far */
+    char* names;
+} resource_pack_writer;
+
+/**
+ * @brief Maps a pack and validates its header and table of contents.
+ *
+ * @param path The path of the pack
+ * @param out_pack The pack to write to
+ * @return b8 TRUE if the pack was opened, FALSE if it could not be mapped or is malformed
+ */
+FR_API b8 fr_resource_pack_open(const char* path, resource_pack* out_pack);
+
+/**
+ * @brief Unmaps a pack. Pointers into the pack become invalid.
+ *
+ * @param pack The pack to close
+ */
+FR_API void fr_resource_pack_close(resource_pack* pack);
+
+/**
+ * @brief Looks up an entry by name.
+ *
+ * @param pack The pack to search
+ * @param name The name the entry was added with
+ * @return const resource_pack_entry* The entry or NULL_PTR if the pack has no entry with that name
+ */
+FR_API const resource_pack_entry* fr_resource_pack_find(const resource_pack* pack, const char* name);
+
+/**
+ * @brief Looks up an entry by the hash of its name. Does not verify the name, so only use it with hashes that were
+ * computed from names known to be in the pack.
+ *
+ * @param pack The pack to search
+ * @param name_hash fr_hash_string of the name
+ * @return const resource_pack_entry* The entry or NULL_PTR if the pack has no entry with that hash
+ */
+FR_API const resource_pack_entry* fr_resource_pack_find_hash(const resource_pack* pack, u64 name_hash);
+
+/**
+ * @brief Gets the name of an entry.
+ *
+ * @param pack The pack the entry belongs to
+ * @param entry The entry
+ * @return const char* The name of the entry, pointing into the pack
+ */
+FR_API const char* fr_resource_pack_entry_name(const resource_pack* pack, const resource_pack_entry* entry);
+
+/**
+ * @brief Gets the payload of an entry as stored in the pack. For uncompressed entries this is the resource itself and
+ * can be used without copying it.
+ *
+ * @param pack The pack the entry belongs to
+ * @param entry The entry
+ * @return const void* The payload, pointing into the pack
+ */
+FR_API const void* fr_resource_pack_entry_data(const resource_pack* pack, const resource_pack_entry* entry);
+
+/**
+ * @brief Starts reading the payload of an entry from disk in the background so that it is resident by the time it is
+ * used.
+ *
+ * @param pack The pack the entry belongs to
+ * @param entry The entry
+ */
+FR_API void fr_resource_pack_prefetch(resource_pack* pack, const resource_pack_entry* entry);
+
+/**
+ * @brief Copies the resource of an entry into a buffer, decompressing it if needed.
+ *
+ * @param pack The pack the entry belongs to
+ * @param entry The entry
+ * @param buffer The buffer to write to. Must hold at least entry->size bytes.
+ * @return b8 TRUE if the resource was read, FALSE if the payload is corrupt
+ */
+FR_API b8 fr_resource_pack_read(const resource_pack* pack, const resource_pack_entry* entry, void* buffer);
+
+/**
+ * @brief Creates a pack file and starts writing it.
+ *
+ * @param path The path of the pack
+ * @param out_writer The writer to initialize
+ * @return b8 TRUE if the file was created, FALSE otherwise
+ */
+FR_API b8 fr_resource_pack_writer_begin(const char* path, resource_pack_writer* out_writer);
+
+/**
+ * @brief Adds a resource to the pack.
+ *
+ * @param writer The writer
+ * @param name The name the resource is looked up by
+ * @param data The contents of the resource
+ * @param size The size of the contents in bytes
+ * @param compress Compress the resource with LZ4. It is stored as is anyway if compression does not make it
+ * noticeably smaller.
+ * @return b8 TRUE if the resource was added, FALSE if it could not be written
+ */
+FR_API b8 fr_resource_pack_writer_add(
+    resource_pack_writer* writer, const char* name, const void* data, u64 size, b8 compress);
+
+/**
+ * @brief Writes the table of contents and closes the pack. Fails if two names have the same hash, in which case one
+ * of them has to be renamed.
+ *
+ * @param writer The writer
+ * @return b8 TRUE if the pack was written, FALSE otherwise
+ */
+FR_API b8 fr_resource_pack_writer_end(resource_pack_writer* writer);
+
+/**
+ * @brief Closes the pack without finishing it, leaving an invalid file behind.
+ *
+ * @param writer The writer
+ */
+FR_API void fr_resource_pack_writer_abort(resource_pack_writer* writer);
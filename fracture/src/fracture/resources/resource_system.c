@@ -0,0 +1,646 @@
+#include "resource_system.h"
+
+#include <platform.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "fracture/core/library/atomics.h"
+#include "fracture/core/library/fracture_compression.h"
+#include "fracture/core/library/fracture_hash.h"
+#include "fracture/core/library/fracture_string.h"
+#include "fracture/core/systems/file_io.h"
+#include "fracture/core/systems/fracture_memory.h"
+#include "fracture/core/systems/job_system.h"
+#include "fracture/core/systems/logging.h"
+#include "fracture/resources/image_loader.h"
+#include "fracture/resources/resource_pack.h"
+#include "fracture/resources/texture_file.h"
+
+// Marks empty buckets of the name table and the ends of the LRU list
+#define RESOURCE_INVALID_INDEX 0xFFFFFFFF
+
+typedef struct resource_entry {
+    // NULL_PTR while the slot is free
+    char* name;
+    u64 name_hash;
+    u32 type;
+    u32 generation;
+    u32 ref_count;
+
+    // Set from the acquire that queued the load until fr_resource_system_update collects it. Only touched by the main
+    // thread, unlike state which the load job writes.
+    b8 pending;
+    b8 in_lru;
+    volatile i32 state;
+
+    // Copied on acquire so that the resource is unloaded by the loader that created it
+    resource_loader loader;
+    resource_data data;
+    job_counter counter;
+
+    u32 lru_prev;
+    u32 lru_next;
+} resource_entry;
+
+typedef struct resource_system_state {
+    u32 max_resources;
+    u64 memory_budget;
+    char* root_path;
+
+    resource_loader loaders[RESOURCE_MAX_TYPES];
+
+    // Packs are only ever appended, so load jobs can read the first pack_count of them without a lock
+    resource_pack packs[RESOURCE_MAX_PACKS];
+    volatile i32 pack_count;
+
+    resource_entry* entries;
+    u32 free_count;
+    u32* free_indices;
+
+    // Open addressing with linear probing, holds entry indices. Twice as many buckets as entries.
+    u32* table;
+    u32 table_mask;
+
+    // Most recently released first
+    u32 lru_head;
+    u32 lru_tail;
+    u32 lru_count;
+
+    // Indices of the entries whose load job finished, pushed by the jobs and drained once per frame
+    platform_mutex completed_lock;
+    u32 completed_count;
+    u32* completed;
+    u32* completed_scratch;
+
+    u64 resident_bytes;
+    u32 resource_count;
+    u32 loading_count;
+    u64 eviction_count;
+} resource_system_state;
+
+static resource_system_state* state = NULL_PTR;
+
+static resource_entry* _resource_get_entry(resource_handle handle);
+static void _resource_collect();
+static void _resource_evict(u64 budget);
+static void _resource_free_entry(u32 index);
+static void _resource_load_job(void* data);
+static b8 _resource_read_source(resource_entry* entry, const void** out_source, u64* out_size, void** out_scratch);
+static u32 _resource_table_find(u64 name_hash, const char* name, u32 type);
+static void _resource_table_insert(u32 index);
+static void _resource_table_remove(u32 index);
+static void _resource_lru_push(u32 index);
+static void _resource_lru_remove(u32 index);
+static b8 _resource_binary_load(const char* name, const void* source, u64 source_size, resource_data* out_data);
+static void _resource_binary_unload(resource_data* data);
+static b8 _resource_text_load(const char* name, const void* source, u64 source_size, resource_data* out_data);
+
+b8 fr_resource_system_initialize(const resource_system_config* config) {
+    if (state != NULL_PTR) {
+        FR_CORE_WARN("Resource system already initialized");
+        return FALSE;
+    }
+
+    u32 max_resources = config->max_resources != 0 ? config->max_resources : RESOURCE_DEFAULT_MAX_RESOURCES;
+    if (max_resources >= RESOURCE_INVALID_INDEX / 4) {
+        FR_CORE_ERROR("Too many resources requested: %u", max_resources);
+        return FALSE;
+    }
+
+    u32 table_size = 1;
+    while (table_size < max_resources * 2) {
+        table_size <<= 1;
+    }
+
+    state = fr_memory_allocate(sizeof(resource_system_state), MEMORY_TYPE_SYSTEM);
+    if (!platform_mutex_create(&state->completed_lock)) {
+        FR_CORE_ERROR("Failed to create the resource system lock");
+        fr_memory_free(state, sizeof(resource_system_state), MEMORY_TYPE_SYSTEM);
+        state = NULL_PTR;
+        return FALSE;
+    }
+
+    state->max_resources = max_resources;
+    state->memory_budget = config->memory_budget != 0 ? config->memory_budget : RESOURCE_DEFAULT_MEMORY_BUDGET;
+    state->root_path = config->root_path != NULL_PTR ? fr_string_duplicate(config->root_path) : NULL_PTR;
+
+    state->entries = fr_memory_allocate(sizeof(resource_entry) * max_resources, MEMORY_TYPE_RESOURCE);
+    state->free_indices = fr_memory_allocate(sizeof(u32) * max_resources, MEMORY_TYPE_RESOURCE);
+    state->completed = fr_memory_allocate(sizeof(u32) * max_resources, MEMORY_TYPE_RESOURCE);
+    state->completed_scratch = fr_memory_allocate(sizeof(u32) * max_resources, MEMORY_TYPE_RESOURCE);
+    state->table = fr_memory_allocate(sizeof(u32) * table_size, MEMORY_TYPE_HASH_TABLE);
+    state->table_mask = table_size - 1;
+    memset(state->table, 0xFF, sizeof(u32) * table_size);
+
+    // Hand out low indices first
+    state->free_count = max_resources;
+    for (u32 i = 0; i < max_resources; ++i) {
+        state->entries[i].generation = 1;
+        state->free_indices[i] = max_resources - 1 - i;
+    }
+    state->lru_head = RESOURCE_INVALID_INDEX;
+    state->lru_tail = RESOURCE_INVALID_INDEX;
+
+    resource_loader binary_loader = {"binary", _resource_binary_load, _resource_binary_unload};
+    resource_loader text_loader = {"text", _resource_text_load, _resource_binary_unload};
+    fr_resource_register_loader(RESOURCE_TYPE_BINARY, &binary_loader);
+    fr_resource_register_loader(RESOURCE_TYPE_TEXT, &text_loader);
+    resource_loader image_loader = {"image", fr_image_resource_load, fr_image_resource_unload};
+    fr_resource_register_loader(RESOURCE_TYPE_IMAGE, &image_loader);
+    resource_loader texture_loader = {"texture", fr_texture_resource_load, fr_texture_resource_unload};
+    fr_resource_register_loader(RESOURCE_TYPE_TEXTURE, &texture_loader);
+
+    FR_CORE_INFO("Resource system initialized: %u resources, %llu byte budget", max_resources, state->memory_budget);
+    return TRUE;
+}
+
+void fr_resource_system_shutdown() {
+    if (state == NULL_PTR) {
+        return;
+    }
+
+    for (u32 i = 0; i < state->max_resources; ++i) {
+        if (state->entries[i].name != NULL_PTR && state->entries[i].pending) {
+            fr_job_wait(&state->entries[i].counter);
+        }
+    }
+    _resource_collect();
+
+    if (state->resource_count != state->lru_count) {
+        FR_CORE_WARN("%u resources are still referenced at shutdown", state->resource_count - state->lru_count);
+    }
+    for (u32 i = 0; i < state->max_resources; ++i) {
+        if (state->entries[i].name != NULL_PTR) {
+            _resource_free_entry(i);
+        }
+    }
+
+    for (i32 i = 0; i < state->pack_count; ++i) {
+        fr_resource_pack_close(&state->packs[i]);
+    }
+
+    u32 table_size = state->table_mask + 1;
+    fr_memory_free(state->table, sizeof(u32) * table_size, MEMORY_TYPE_HASH_TABLE);
+    fr_memory_free(state->completed_scratch, sizeof(u32) * state->max_resources, MEMORY_TYPE_RESOURCE);
+    fr_memory_free(state->completed, sizeof(u32) * state->max_resources, MEMORY_TYPE_RESOURCE);
+    fr_memory_free(state->free_indices, sizeof(u32) * state->max_resources, MEMORY_TYPE_RESOURCE);
+    fr_memory_free(state->entries, sizeof(resource_entry) * state->max_resources, MEMORY_TYPE_RESOURCE);
+    if (state->root_path != NULL_PTR) {
+        fr_memory_free(state->root_path, strlen(state->root_path) + 1, MEMORY_TYPE_STRING);
+    }
+    platform_mutex_destroy(&state->completed_lock);
+    fr_memory_free(state, sizeof(resource_system_state), MEMORY_TYPE_SYSTEM);
+    state = NULL_PTR;
+}
+
+void fr_resource_system_update() {
+    if (state == NULL_PTR) {
+        return;
+    }
+
+    _resource_collect();
+    _resource_evict(state->memory_budget);
+}
+
+b8 fr_resource_register_loader(u32 type, const resource_loader* loader) {
+    if (state == NULL_PTR) {
+        FR_CORE_ERROR("Resource system is not initialized");
+        return FALSE;
+    }
+    if (type >= RESOURCE_MAX_TYPES) {
+        FR_CORE_ERROR("Resource type %u is out of range, the maximum is %u", type, RESOURCE_MAX_TYPES - 1);
+        return FALSE;
+    }
+    if (loader->load == NULL_PTR || loader->unload == NULL_PTR) {
+        FR_CORE_ERROR("Resource loader %s is missing its load or unload function", loader->name);
+        return FALSE;
+    }
+
+    state->loaders[type] = *loader;
+    return TRUE;
+}
+
+b8 fr_resource_mount_pack(const char* path) {
+    if (state == NULL_PTR) {
+        FR_CORE_ERROR("Resource system is not initialized");
+        return FALSE;
+    }
+
+    i32 count = state->pack_count;
+    if (count == RESOURCE_MAX_PACKS) {
+        FR_CORE_ERROR("Cannot mount %s, %u packs are already mounted", path, RESOURCE_MAX_PACKS);
+        return FALSE;
+    }
+    if (!fr_resource_pack_open(path, &state->packs[count])) {
+        return FALSE;
+    }
+
+    // Publish the pack only once it is fully opened
+    fr_atomic_store_i32(&state->pack_count, count + 1, FR_MEMORY_ORDER_RELEASE);
+    FR_CORE_INFO("Mounted resource pack %s with %u resources", path, state->packs[count].header->entry_count);
+    return TRUE;
+}
+
+resource_handle fr_resource_acquire(const char* name, u32 type) {
+    resource_handle handle = {0};
+    if (state == NULL_PTR) {
+        FR_CORE_ERROR("Resource system is not initialized");
+        return handle;
+    }
+    if (type >= RESOURCE_MAX_TYPES || state->loaders[type].load == NULL_PTR) {
+        FR_CORE_ERROR("No loader registered for resource type %u: %s", type, name);
+        return handle;
+    }
+
+    u64 name_hash = fr_hash_string(name);
+    u32 index = _resource_table_find(name_hash, name, type);
+    if (index != RESOURCE_INVALID_INDEX) {
+        resource_entry* entry = &state->entries[index];
+        if (entry->in_lru) {
+            _resource_lru_remove(index);
+        }
+        entry->ref_count++;
+        handle.index = index;
+        handle.generation = entry->generation;
+        return handle;
+    }
+
+    if (state->free_count == 0 && state->lru_tail != RESOURCE_INVALID_INDEX) {
+        // Make room by evicting the coldest unreferenced resource even if the budget is not exceeded
+        u32 victim = state->lru_tail;
+        _resource_lru_remove(victim);
+        _resource_free_entry(victim);
+        state->eviction_count++;
+    }
+    if (state->free_count == 0) {
+        FR_CORE_ERROR("All %u resource slots are referenced, cannot load %s", state->max_resources, name);
+        return handle;
+    }
+
+    index = state->free_indices[--state->free_count];
+    resource_entry* entry = &state->entries[index];
+    entry->name = fr_string_duplicate(name);
+    entry->name_hash = name_hash;
+    entry->type = type;
+    entry->ref_count = 1;
+    entry->pending = TRUE;
+    entry->in_lru = FALSE;
+    entry->state = RESOURCE_STATE_LOADING;
+    entry->loader = state->loaders[type];
+    entry->data.data = NULL_PTR;
+    entry->data.size = 0;
+    entry->counter.value = 0;
+    _resource_table_insert(index);
+    state->resource_count++;
+    state->loading_count++;
+
+    if (fr_job_system_worker_count() == 0) {
+        // Without worker threads the job would only run once something waits on it, so load right away
+        _resource_load_job(entry);
+    } else {
+        job_desc job = {_resource_load_job, entry};
+        fr_job_run(&job, 1, &entry->counter);
+    }
+
+    handle.index = index;
+    handle.generation = entry->generation;
+    return handle;
+}
+
+b8 fr_resource_retain(resource_handle handle) {
+    resource_entry* entry = _resource_get_entry(handle);
+    if (entry == NULL_PTR) {
+        FR_CORE_ERROR("Cannot retain an invalid resource handle");
+        return FALSE;
+    }
+    if (entry->in_lru) {
+        _resource_lru_remove(handle.index);
+    }
+    entry->ref_count++;
+    return TRUE;
+}
+
+void fr_resource_release(resource_handle handle) {
+    resource_entry* entry = _resource_get_entry(handle);
+    if (entry == NULL_PTR) {
+        FR_CORE_WARN("Releasing an invalid resource handle");
+        return;
+    }
+    if (entry->ref_count == 0) {
+        FR_CORE_WARN("Resource %s released more often than it was acquired", entry->name);
+        return;
+    }
+
+    if (--entry->ref_count > 0 || entry->pending) {
+        // Pending entries are handled once their load has been collected
+        return;
+    }
+    if (entry->state == RESOURCE_STATE_LOADED) {
+        _resource_lru_push(handle.index);
+    } else {
+        // Keep no record of failures so that a later acquire tries again
+        _resource_free_entry(handle.index);
+    }
+}
+
+resource_states fr_resource_state(resource_handle handle) {
+    resource_entry* entry = _resource_get_entry(handle);
+    if (entry == NULL_PTR) {
+        return RESOURCE_STATE_INVALID;
+    }
+    return (resource_states)fr_atomic_load_i32(&entry->state, FR_MEMORY_ORDER_ACQUIRE);
+}
+
+const void* fr_resource_data(resource_handle handle, u64* out_size) {
+    resource_entry* entry = _resource_get_entry(handle);
+    if (entry == NULL_PTR || fr_atomic_load_i32(&entry->state, FR_MEMORY_ORDER_ACQUIRE) != RESOURCE_STATE_LOADED) {
+        return NULL_PTR;
+    }
+    if (out_size != NULL_PTR) {
+        *out_size = entry->data.size;
+    }
+    return entry->data.data;
+}
+
+resource_states fr_resource_wait(resource_handle handle) {
+    resource_entry* entry = _resource_get_entry(handle);
+    if (entry == NULL_PTR) {
+        return RESOURCE_STATE_INVALID;
+    }
+    if (entry->pending) {
+        fr_job_wait(&entry->counter);
+    }
+    return (resource_states)fr_atomic_load_i32(&entry->state, FR_MEMORY_ORDER_ACQUIRE);
+}
+
+void fr_resource_system_stats(resource_system_stats* out_stats) {
+    memset(out_stats, 0, sizeof(resource_system_stats));
+    if (state == NULL_PTR) {
+        return;
+    }
+    out_stats->resident_bytes = state->resident_bytes;
+    out_stats->memory_budget = state->memory_budget;
+    out_stats->resource_count = state->resource_count;
+    out_stats->loading_count = state->loading_count;
+    out_stats->unreferenced_count = state->lru_count;
+    out_stats->eviction_count = state->eviction_count;
+}
+
+// -----------------------------------------------------------------------
+// PRIVATE FUNCTIONS
+// -----------------------------------------------------------------------
+
+static resource_entry* _resource_get_entry(resource_handle handle) {
+    if (state == NULL_PTR || handle.generation == 0 || handle.index >= state->max_resources) {
+        return NULL_PTR;
+    }
+    resource_entry* entry = &state->entries[handle.index];
+    if (entry->name == NULL_PTR || entry->generation != handle.generation) {
+        return NULL_PTR;
+    }
+    return entry;
+}
+
+static void _resource_collect() {
+    platform_mutex_lock(&state->completed_lock);
+    u32 count = state->completed_count;
+    memcpy(state->completed_scratch, state->completed, sizeof(u32) * count);
+    state->completed_count = 0;
+    platform_mutex_unlock(&state->completed_lock);
+
+    for (u32 i = 0; i < count; ++i) {
+        u32 index = state->completed_scratch[i];
+        resource_entry* entry = &state->entries[index];
+        entry->pending = FALSE;
+        state->loading_count--;
+
+        b8 loaded = fr_atomic_load_i32(&entry->state, FR_MEMORY_ORDER_ACQUIRE) == RESOURCE_STATE_LOADED;
+        if (loaded) {
+            state->resident_bytes += entry->data.size;
+        } else {
+            FR_CORE_ERROR("Failed to load %s resource: %s", entry->loader.name, entry->name);
+        }
+
+        if (entry->ref_count == 0) {
+            if (loaded) {
+                _resource_lru_push(index);
+            } else {
+                _resource_free_entry(index);
+            }
+        }
+    }
+}
+
+static void _resource_evict(u64 budget) {
+    while (state->resident_bytes > budget && state->lru_tail != RESOURCE_INVALID_INDEX) {
+        u32 index = state->lru_tail;
+        _resource_lru_remove(index);
+        _resource_free_entry(index);
+        state->eviction_count++;
+    }
+}
+
+static void _resource_free_entry(u32 index) {
+    resource_entry* entry = &state->entries[index];
+    if (entry->state == RESOURCE_STATE_LOADED) {
+        entry->loader.unload(&entry->data);
+        state->resident_bytes -= entry->data.size;
+    }
+
+    _resource_table_remove(index);
+    fr_memory_free(entry->name, strlen(entry->name) + 1, MEMORY_TYPE_STRING);
+    entry->name = NULL_PTR;
+    entry->state = RESOURCE_STATE_INVALID;
+    entry->data.data = NULL_PTR;
+    entry->data.size = 0;
+    entry->ref_count = 0;
+
+    // Invalidate the outstanding handles. 0 is reserved for the zero initialized handle.
+    if (++entry->generation == 0) {
+        entry->generation = 1;
+    }
+    state->free_indices[state->free_count++] = index;
+    state->resource_count--;
+}
+
+static void _resource_load_job(void* data) {
+    resource_entry* entry = (resource_entry*)data;
+
+    const void* source = NULL_PTR;
+    u64 source_size = 0;
+    void* scratch = NULL_PTR;
+    b8 loaded = _resource_read_source(entry, &source, &source_size, &scratch) &&
+                entry->loader.load(entry->name, source, source_size, &entry->data);
+    if (scratch != NULL_PTR) {
+        fr_memory_free(scratch, source_size, MEMORY_TYPE_RESOURCE);
+    }
+
+    fr_atomic_store_i32(
+        &entry->state, loaded ? RESOURCE_STATE_LOADED : RESOURCE_STATE_FAILED, FR_MEMORY_ORDER_RELEASE);
+
+    platform_mutex_lock(&state->completed_lock);
+    state->completed[state->completed_count++] = (u32)(entry - state->entries);
+    platform_mutex_unlock(&state->completed_lock);
+}
+
+static b8 _resource_read_source(resource_entry* entry, const void** out_source, u64* out_size, void** out_scratch) {
+    // Packs mounted later override the earlier ones
+    i32 pack_count = fr_atomic_load_i32(&state->pack_count, FR_MEMORY_ORDER_ACQUIRE);
+    for (i32 i = pack_count - 1; i >= 0; --i) {
+        const resource_pack* pack = &state->packs[i];
+        const resource_pack_entry* pack_entry = fr_resource_pack_find(pack, entry->name);
+        if (pack_entry == NULL_PTR) {
+            continue;
+        }
+
+        *out_size = pack_entry->size;
+        if (pack_entry->compression == RESOURCE_PACK_COMPRESSION_NONE || pack_entry->size == 0) {
+            // Straight from the mapping, no copy
+            *out_source = fr_resource_pack_entry_data(pack, pack_entry);
+            return TRUE;
+        }
+
+        void* scratch = fr_memory_allocate(pack_entry->size, MEMORY_TYPE_RESOURCE);
+        const void* payload = fr_resource_pack_entry_data(pack, pack_entry);
+        if (!fr_decompress_lz4(payload, pack_entry->stored_size, scratch, pack_entry->size)) {
+            fr_memory_free(scratch, pack_entry->size, MEMORY_TYPE_RESOURCE);
+            return FALSE;
+        }
+        *out_source = scratch;
+        *out_scratch = scratch;
+        return TRUE;
+    }
+
+    char path[RESOURCE_MAX_PATH_LENGTH];
+    i32 length = state->root_path != NULL_PTR ? snprintf(path, sizeof(path), "%s/%s", state->root_path, entry->name)
+                                               : snprintf(path, sizeof(path), "%s", entry->name);
+    if (length < 0 || length >= (i32)sizeof(path)) {
+        return FALSE;
+    }
+
+    file_handle file = {0};
+    if (!fr_file_open(path, FILE_MODE_READ, &file)) {
+        return FALSE;
+    }
+
+    u64 size = 0;
+    b8 result = fr_file_size(&file, &size);
+    if (result && size > 0) {
+        void* scratch = fr_memory_allocate(size, MEMORY_TYPE_RESOURCE);
+        u64 bytes_read = 0;
+        result = fr_file_read(&file, 0, size, scratch, &bytes_read) && bytes_read == size;
+        if (result) {
+            *out_source = scratch;
+            *out_scratch = scratch;
+        } else {
+            fr_memory_free(scratch, size, MEMORY_TYPE_RESOURCE);
+        }
+    }
+    fr_file_close(&file);
+
+    *out_size = size;
+    return result;
+}
+
+static u32 _resource_table_find(u64 name_hash, const char* name, u32 type) {
+    u32 bucket = (u32)name_hash & state->table_mask;
+    while (state->table[bucket] != RESOURCE_INVALID_INDEX) {
+        const resource_entry* entry = &state->entries[state->table[bucket]];
+        if (entry->name_hash == name_hash && entry->type == type && strcmp(entry->name, name) == 0) {
+            return state->table[bucket];
+        }
+        bucket = (bucket + 1) & state->table_mask;
+    }
+    return RESOURCE_INVALID_INDEX;
+}
+
+static void _resource_table_insert(u32 index) {
+    u32 bucket = (u32)state->entries[index].name_hash & state->table_mask;
+    while (state->table[bucket] != RESOURCE_INVALID_INDEX) {
+        bucket = (bucket + 1) & state->table_mask;
+    }
+    state->table[bucket] = index;
+}
+
+static void _resource_table_remove(u32 index) {
+    u32 bucket = (u32)state->entries[index].name_hash & state->table_mask;
+    while (state->table[bucket] != index) {
+        bucket = (bucket + 1) & state->table_mask;
+    }
+
+    // Backward shift deletion: pull later entries of the cluster into the hole unless that moves them in front of
+    // their home bucket, so lookups never need tombstones
+    u32 hole = bucket;
+    u32 next = bucket;
+    for (;;) {
+        next = (next + 1) & state->table_mask;
+        if (state->table[next] == RESOURCE_INVALID_INDEX) {
+            break;
+        }
+        u32 home = (u32)state->entries[state->table[next]].name_hash & state->table_mask;
+        if (((next - home) & state->table_mask) >= ((next - hole) & state->table_mask)) {
+            state->table[hole] = state->table[next];
+            hole = next;
+        }
+    }
+    state->table[hole] = RESOURCE_INVALID_INDEX;
+}
+
+static void _resource_lru_push(u32 index) {
+    resource_entry* entry = &state->entries[index];
+    entry->in_lru = TRUE;
+    entry->lru_prev = RESOURCE_INVALID_INDEX;
+    entry->lru_next = state->lru_head;
+    if (state->lru_head != RESOURCE_INVALID_INDEX) {
+        state->entries[state->lru_head].lru_prev = index;
+    } else {
+        state->lru_tail = index;
+    }
+    state->lru_head = index;
+    state->lru_count++;
+}
+
+static void _resource_lru_remove(u32 index) {
+    resource_entry* entry = &state->entries[index];
+    if (entry->lru_prev != RESOURCE_INVALID_INDEX) {
+        state->entries[entry->lru_prev].lru_next = entry->lru_next;
+    } else {
+        state->lru_head = entry->lru_next;
+    }
+    if (entry->lru_next != RESOURCE_INVALID_INDEX) {
+        state->entries[entry->lru_next].lru_prev = entry->lru_prev;
+    } else {
+        state->lru_tail = entry->lru_prev;
+    }
+    entry->in_lru = FALSE;
+    state->lru_count--;
+}
+
+static b8 _resource_binary_load(const char* name, const void* source, u64 source_size, resource_data* out_data) {
+    (void)name;
+    out_data->data = NULL_PTR;
+    out_data->size = source_size;
+    if (source_size > 0) {
+        out_data->data = fr_memory_allocate(source_size, MEMORY_TYPE_RESOURCE);
+        memcpy(out_data->data, source, source_size);
+    }
+    return TRUE;
+}
+
+static void _resource_binary_unload(resource_data* data) {
+    if (data->data != NULL_PTR) {
+        fr_memory_free(data->data, data->size, MEMORY_TYPE_RESOURCE);
+    }
+}
+
+static b8 _resource_text_load(const char* name, const void* source, u64 source_size, resource_data* out_data) {
+    (void)name;
+    char* text = fr_memory_allocate(source_size + 1, MEMORY_TYPE_RESOURCE);
+    if (source_size > 0) {
+        memcpy(text, source, source_size);
+    }
+    text[source_size] = '\0';
+    out_data->data = text;
+    out_data->size = source_size + 1;
+    return TRUE;
+}
@@ -0,0 +1,267 @@
+/**
+ * @file resource_system.h
+ * @author Aditya Rajagopal
+ * @brief Resource manager: resources are requested by name, loaded in the background on the job system and shared
+ * through reference counted handles.
+ * @details Every resource is identified by its name and type and lives in a slot of a fixed size table. A handle is
+ * the index of the slot together with the generation of the slot when the handle was handed out, so handles to a
+ * resource that has since been evicted are detected instead of pointing at whatever reuses the slot. Names are looked
+ * up through an open addressing table keyed by the FNV-1a hash of the name.
+ *
+ * fr_resource_acquire never blocks. The first acquire of a resource queues a job that reads the source bytes, either
+ * from a mounted resource pack or from a file under the root path, and runs the loader registered for the type on
+ * them. Until the job finishes the handle reports RESOURCE_STATE_LOADING. Later acquires of the same resource only
+ * bump the reference count.
+ *
+ * A resource whose reference count drops to zero is not unloaded right away but moved to a least recently used list,
+ * so that a resource that is released and acquired again, e.g. between two levels sharing assets, does not have to be
+ * loaded again. Once per frame fr_resource_system_update unloads resources from the cold end of that list until the
+ * memory of the loaded resources fits in the budget. Referenced resources are never evicted, so the budget can be
+ * exceeded if the application holds on to more than fits.
+ *
+ * All the functions must be called from the main thread. Loaders run on the worker threads of the job system.
+ * @version 0.0.1
+ * @date 2024-04-23
+ *
+ * @copyright Fracture Game Engine is Copyright (c) Aditya Rajagopal 2024-2024
+ *
+ */
+#pragma once
+
+#include "fracture/core/defines.h"
+
+// Number of resource types loaders can be registered for
+#define RESOURCE_MAX_TYPES 16
+
+// Maximum number of resource packs that can be mounted at once
+#define RESOURCE_MAX_PACKS 8
+
+// Maximum length of the path of a resource loaded from a file, including the root path
+#define RESOURCE_MAX_PATH_LENGTH 512
+
+// Number of resources when the config does not specify one
+#define RESOURCE_DEFAULT_MAX_RESOURCES 4096
+
+// Memory budget when the config does not specify one
+#define RESOURCE_DEFAULT_MEMORY_BUDGET MiB(256)
+
+/**
+ * @brief Types of resources. Each type has its own loader.
+ *
+ */
+typedef enum resource_types {
+    /** @brief The contents of the source as is */
+    RESOURCE_TYPE_BINARY = 0,
+
+    /** @brief The contents of the source followed by a null terminator */
+    RESOURCE_TYPE_TEXT,
+
+    /** @brief A PNG decoded to RGBA8, see image_loader.h */
+    RESOURCE_TYPE_IMAGE,
+
+    /** @brief A texture file converted offline by texconv, see texture_file.h */
+    RESOURCE_TYPE_TEXTURE,
+
+    /** @brief First type available to loaders registered by the application */
+    RESOURCE_TYPE_CUSTOM,
+} resource_types;
+
+/**
+ * @brief State of the resource a handle refers to.
+ *
+ */
+typedef enum resource_states {
+    /** @brief The handle does not refer to a resource, or the resource has been evicted */
+    RESOURCE_STATE_INVALID = 0,
+
+    /** @brief The load job has not finished yet */
+    RESOURCE_STATE_LOADING,
+
+    /** @brief The resource is loaded and its data can be used */
+    RESOURCE_STATE_LOADED,
+
+    /** @brief The source could not be found or the loader failed */
+    RESOURCE_STATE_FAILED,
+} resource_states;
+
+/**
+ * @brief Handle to a resource. A zero initialized handle is invalid.
+ *
+ */
+typedef struct resource_handle {
+    /** @brief Index of the slot of the resource */
+    u32 index;
+
+    /** @brief Generation of the slot when the handle was created. Never 0 for a valid handle. */
+    u32 generation;
+} resource_handle;
+
+/**
+ * @brief The data a loader produced for a resource.
+ *
+ */
+typedef struct resource_data {
+    /** @brief The loaded resource */
+    void* data;
+
+    /** @brief Memory used by the resource in bytes. Counted against the memory budget. */
+    u64 size;
+} resource_data;
+
+// Function pointer to a loader. Runs on a worker thread and turns the source bytes into a resource. The source is
+// only valid for the duration of the call. Returning FALSE marks the resource as failed.
+typedef b8 (*PFN_resource_load)(const char* name, const void* source, u64 source_size, resource_data* out_data);
+
+// Function pointer to the function that frees a resource created by the loader. Runs on the main thread.
+typedef void (*PFN_resource_unload)(resource_data* data);
+
+/**
+ * @brief Loader for a resource type.
+ *
+ */
+typedef struct resource_loader {
+    /** @brief Name of the loader, used in log messages */
+    const char* name;
+
+    /** @brief Creates a resource from its source */
+    PFN_resource_load load;
+
+    /** @brief Frees a resource */
+    PFN_resource_unload unload;
+} resource_loader;
+
+/**
+ * @brief Resource system configuration
+ *
+ */
+typedef struct resource_system_config {
+    /** @brief Maximum number of resources alive at once, loaded or not. 0 uses RESOURCE_DEFAULT_MAX_RESOURCES */
+    u32 max_resources;
+
+    /** @brief Memory the loaded resources may use before unreferenced ones are evicted. 0 uses the default. */
+    u64 memory_budget;
+
+    /** @brief Directory resources that are not in a mounted pack are read from. NULL_PTR uses the working directory. */
+    const char* root_path;
+} resource_system_config;
+
+/**
+ * @brief Usage statistics of the resource system.
+ *
+ */
+typedef struct resource_system_stats {
+    /** @brief Memory used by the loaded resources in bytes */
+    u64 resident_bytes;
+
+    /** @brief The memory budget in bytes */
+    u64 memory_budget;
+
+    /** @brief Number of resources that are loading, loaded or failed */
+    u32 resource_count;
+
+    /** @brief Number of resources whose load job has not finished yet */
+    u32 loading_count;
+
+    /** @brief Number of loaded resources that are not referenced and can be evicted */
+    u32 unreferenced_count;
+
+    /** @brief Number of resources evicted since the system was initialized */
+    u64 eviction_count;
+} resource_system_stats;
+
+/**
+ * @brief Initializes the resource system and registers the binary, text, image and texture loaders.
+ *
+ * @param config The resource system configuration
+ * @return b8 TRUE if the resource system was initialized successfully, FALSE otherwise
+ */
+b8 fr_resource_system_initialize(const resource_system_config* config);
+
+/**
+ * @brief Waits for the loads in flight, unloads every resource and shuts the resource system down.
+ *
+ */
+void fr_resource_system_shutdown();
+
+/**
+ * @brief Collects the finished loads and evicts unreferenced resources until the memory budget is met. Called by the
+ * engine once per frame.
+ *
+ */
+void fr_resource_system_update();
+
+/**
+ * @brief Registers the loader for a resource type, replacing the previous one. Must not be called while resources of
+ * the type are loading.
+ *
+ * @param type The resource type, one of resource_types or a custom type below RESOURCE_MAX_TYPES
+ * @param loader The loader. load and unload must not be NULL_PTR.
+ * @return b8 TRUE if the loader was registered, FALSE otherwise
+ */
+FR_API b8 fr_resource_register_loader(u32 type, const resource_loader* loader);
+
+/**
+ * @brief Mounts a resource pack. Resources are looked up in the mounted packs, most recently mounted first, before
+ * falling back to files under the root path. Packs stay mounted until the system shuts down.
+ *
+ * @param path The path of the pack
+ * @return b8 TRUE if the pack was mounted, FALSE otherwise
+ */
+FR_API b8 fr_resource_mount_pack(const char* path);
+
+/**
+ * @brief Gets a resource and adds a reference to it, queueing its load if it is not loaded yet. Never blocks.
+ *
+ * @param name The name of the resource, i.e. its name in a pack or its path relative to the root path
+ * @param type The type of the resource
+ * @return resource_handle Handle to the resource, invalid if the type has no loader or every slot is referenced
+ */
+FR_API resource_handle fr_resource_acquire(const char* name, u32 type);
+
+/**
+ * @brief Adds a reference to a resource that is already referenced through a handle.
+ *
+ * @param handle The resource to reference
+ * @return b8 TRUE if the reference was added, FALSE if the handle is invalid
+ */
+FR_API b8 fr_resource_retain(resource_handle handle);
+
+/**
+ * @brief Drops a reference to a resource. A resource without references stays loaded until it is evicted.
+ *
+ * @param handle The resource to release
+ */
+FR_API void fr_resource_release(resource_handle handle);
+
+/**
+ * @brief Gets the state of a resource.
+ *
+ * @param handle The resource to query
+ * @return resource_states The state of the resource
+ */
+FR_API resource_states fr_resource_state(resource_handle handle);
+
+/**
+ * @brief Gets the data of a loaded resource.
+ *
+ * @param handle The resource
+ * @param out_size The size of the resource in bytes. Can be NULL_PTR.
+ * @return const void* The resource or NULL_PTR if it is not loaded
+ */
+FR_API const void* fr_resource_data(resource_handle handle, u64* out_size);
+
+/**
+ * @brief Blocks until a resource has finished loading, running jobs in the meantime. Meant for loading screens, never
+ * call it during gameplay.
+ *
+ * @param handle The resource to wait for
+ * @return resource_states The state of the resource after the load finished
+ */
+FR_API resource_states fr_resource_wait(resource_handle handle);
+
+/**
+ * @brief Gets the usage statistics of the resource system.
+ *
+ * @param out_stats The statistics to write to
+ */
+FR_API void fr_resource_system_stats(resource_system_stats* out_stats);
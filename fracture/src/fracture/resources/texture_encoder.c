@@ -0,0 +1,606 @@
+#include "texture_encoder.h"
+
+#include <math.h>
+
+#include "fracture/core/systems/fracture_memory.h"
+#include "fracture/core/systems/job_system.h"
+#include "fracture/core/systems/logging.h"
+
+// Power iterations used to find the principal axis of the colors of a block
+#define ENCODER_POWER_ITERATIONS 8
+
+// Least squares passes refining the endpoints after the initial fit
+#define ENCODER_REFINE_PASSES 2
+
+// Entries of the table converting linear values back to sRGB during mip generation
+#define ENCODER_LINEAR_TO_SRGB_SIZE 4096
+
+typedef struct encoder_level_context {
+    const u8* pixels;
+    u32 width;
+    u32 height;
+    texture_formats format;
+    const texture_file_mip* mip;
+    u8* dest;
+} encoder_level_context;
+
+static u64 _encoder_align(u64 offset);
+static void _encoder_encode_rows(u32 start, u32 end, void* data);
+static void _encoder_fetch_block(const u8* pixels, u32 width, u32 height, u32 block_x, u32 block_y, u8* out_block);
+
+b8 fr_texture_encode(const texture_encode_desc* desc, u8** out_file, u64* out_size) {
+    u32 block_size = fr_texture_format_block_size(desc->format);
+    if (block_size == 0 || desc->pixels == NULL_PTR || desc->width == 0 || desc->height == 0 ||
+        desc->width > TEXTURE_MAX_DIMENSION || desc->height > TEXTURE_MAX_DIMENSION) {
+        FR_CORE_ERROR("Invalid texture to encode: %ux%u in format %u", desc->width, desc->height, desc->format);
+        return FALSE;
+    }
+    u32 row_pitch = desc->row_pitch != 0 ? desc->row_pitch : desc->width * 4;
+    if (row_pitch < desc->width * 4) {
+        FR_CORE_ERROR("Texture row pitch %u is smaller than a row of pixels", row_pitch);
+        return FALSE;
+    }
+
+    texture_file_header header = {0};
+    header.magic = TEXTURE_FILE_MAGIC;
+    header.version = TEXTURE_FILE_VERSION;
+    header.format = desc->format;
+    header.flags = desc->srgb ? TEXTURE_FILE_FLAG_SRGB : 0;
+    header.width = desc->width;
+    header.height = desc->height;
+    header.mip_count = desc->generate_mips ? fr_texture_full_mip_count(desc->width, desc->height) : 1;
+
+    texture_file_mip mips[TEXTURE_MAX_MIPS];
+    u64 data_start = _encoder_align(sizeof(texture_file_header) + sizeof(texture_file_mip) * header.mip_count);
+    u64 offset = data_start;
+    for (u32 level = 0; level < header.mip_count; ++level) {
+        fr_texture_mip_layout(desc->format, desc->width, desc->height, level, &mips[level]);
+        mips[level].offset = offset;
+        offset = _encoder_align(offset + mips[level].size);
+    }
+    header.file_size = mips[header.mip_count - 1].offset + mips[header.mip_count - 1].size;
+    header.data_size = header.file_size - data_start;
+
+    u8* file = fr_memory_allocate(header.file_size, MEMORY_TYPE_TEXTURE);
+    fr_memory_copy(file, &header, sizeof(texture_file_header));
+    fr_memory_copy(file + sizeof(texture_file_header), mips, sizeof(texture_file_mip) * header.mip_count);
+
+    // Two scratch levels, the one being encoded and the next one being generated from it
+    u64 level_size = (u64)desc->width * desc->height * 4;
+    u64 scratch_size = level_size + MAX(1, desc->width / 2) * (u64)MAX(1, desc->height / 2) * 4;
+    u8* scratch = fr_memory_allocate(scratch_size, MEMORY_TYPE_ARRAY);
+    u8* level_pixels = scratch;
+    u8* next_pixels = scratch + level_size;
+    for (u32 y = 0; y < desc->height; ++y) {
+        fr_memory_copy(level_pixels + (u64)y * desc->width * 4, desc->pixels + (u64)y * row_pitch, desc->width * 4);
+    }
+
+    for (u32 level = 0; level < header.mip_count; ++level) {
+        encoder_level_context context;
+        context.pixels = level_pixels;
+        context.width = mips[level].width;
+        context.height = mips[level].height;
+        context.format = desc->format;
+        context.mip = &mips[level];
+        context.dest = file + mips[level].offset;
+        fr_job_parallel_for(mips[level].row_count, 1, _encoder_encode_rows, &context);
+
+        if (level + 1 < header.mip_count) {
+            fr_texture_downsample(level_pixels, mips[level].width, mips[level].height, desc->srgb, next_pixels);
+            // The next level is at most a quarter of this one, so it always fits where the level above was
+            u8* swap = level_pixels;
+            level_pixels = next_pixels;
+            next_pixels = swap;
+        }
+    }
+    fr_memory_free(scratch, scratch_size, MEMORY_TYPE_ARRAY);
+
+    *out_file = file;
+    *out_size = header.file_size;
+    return TRUE;
+}
+
+void fr_texture_encode_free(u8* file, u64 size) { fr_memory_free(file, size, MEMORY_TYPE_TEXTURE); }
+
+void fr_texture_downsample(const u8* source, u32 width, u32 height, b8 srgb, u8* dest) {
+    u32 dest_width = MAX(1, width / 2);
+    u32 dest_height = MAX(1, height / 2);
+
+    f32 srgb_to_linear[256];
+    u8 linear_to_srgb[ENCODER_LINEAR_TO_SRGB_SIZE];
+    if (srgb) {
+        for (u32 i = 0; i < 256; ++i) {
+            f32 c = i / 255.0f;
+            srgb_to_linear[i] = c <= 0.04045f ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+        }
+        for (u32 i = 0; i < ENCODER_LINEAR_TO_SRGB_SIZE; ++i) {
+            f32 l = i / (f32)(ENCODER_LINEAR_TO_SRGB_SIZE - 1);
+            f32 c = l <= 0.0031308f ? l * 12.92f : 1.055f * powf(l, 1.0f / 2.4f) - 0.055f;
+            linear_to_srgb[i] = (u8)(c * 255.0f + 0.5f);
+        }
+    }
+
+    for (u32 y = 0; y < dest_height; ++y) {
+        // A level of height 1 is only halved horizontally
+        u32 y0 = MIN(y * 2, height - 1);
+        u32 y1 = MIN(y * 2 + 1, height - 1);
+        for (u32 x = 0; x < dest_width; ++x) {
+            u32 x0 = MIN(x * 2, width - 1);
+            u32 x1 = MIN(x * 2 + 1, width - 1);
+            const u8* p[4] = {
+                source + ((u64)y0 * width + x0) * 4,
+                source + ((u64)y0 * width + x1) * 4,
+                source + ((u64)y1 * width + x0) * 4,
+                source + ((u64)y1 * width + x1) * 4,
+            };
+            u8* out = dest + ((u64)y * dest_width + x) * 4;
+            for (u32 c = 0; c < 4; ++c) {
+                if (srgb && c < 3) {
+                    f32 sum = srgb_to_linear[p[0][c]] + srgb_to_linear[p[1][c]] + srgb_to_linear[p[2][c]] +
+                              srgb_to_linear[p[3][c]];
+                    out[c] = linear_to_srgb[(u32)(sum * 0.25f * (ENCODER_LINEAR_TO_SRGB_SIZE - 1) + 0.5f)];
+                } else {
+                    out[c] = (u8)((p[0][c] + p[1][c] + p[2][c] + p[3][c] + 2) / 4);
+                }
+            }
+        }
+    }
+}
+
+// -----------------------------------------------------------------------
+// BLOCK COMPRESSION
+// -----------------------------------------------------------------------
+
+static inline f32 _encoder_clamp(f32 value, f32 low, f32 high) {
+    return value < low ? low : (value > high ? high : value);
+}
+
+// Finds the mean of the first channels of the 16 pixels and the direction along which they spread the most
+static void _encoder_principal_axis(const u8* pixels, u32 channels, f32* out_mean, f32* out_axis) {
+    f32 mean[4] = {0};
+    for (u32 i = 0; i < 16; ++i) {
+        for (u32 c = 0; c < channels; ++c) {
+            mean[c] += pixels[i * 4 + c];
+        }
+    }
+    for (u32 c = 0; c < channels; ++c) {
+        mean[c] /= 16.0f;
+    }
+
+    f32 covariance[4][4] = {0};
+    for (u32 i = 0; i < 16; ++i) {
+        f32 d[4];
+        for (u32 c = 0; c < channels; ++c) {
+            d[c] = pixels[i * 4 + c] - mean[c];
+        }
+        for (u32 r = 0; r < channels; ++r) {
+            for (u32 c = 0; c < channels; ++c) {
+                covariance[r][c] += d[r] * d[c];
+            }
+        }
+    }
+
+    // Start from the diagonal of the bounding box, which is close to the answer for most blocks
+    f32 axis[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+    for (u32 iteration = 0; iteration < ENCODER_POWER_ITERATIONS; ++iteration) {
+        f32 next[4] = {0};
+        f32 length = 0.0f;
+        for (u32 r = 0; r < channels; ++r) {
+            for (u32 c = 0; c < channels; ++c) {
+                next[r] += covariance[r][c] * axis[c];
+            }
+            length = MAX(length, fabsf(next[r]));
+        }
+        if (length < 1e-6f) {
+            break;
+        }
+        for (u32 c = 0; c < channels; ++c) {
+            axis[c] = next[c] / length;
+        }
+    }
+
+    f32 length = 0.0f;
+    for (u32 c = 0; c < channels; ++c) {
+        length += axis[c] * axis[c];
+    }
+    length = sqrtf(length);
+    for (u32 c = 0; c < channels; ++c) {
+        out_mean[c] = mean[c];
+        out_axis[c] = axis[c] / length;
+    }
+}
+
+// Endpoints at the extremes of the projections of the pixels on the principal axis
+static void _encoder_fit_endpoints(const u8* pixels, u32 channels, f32* out_start, f32* out_end) {
+    f32 mean[4];
+    f32 axis[4];
+    _encoder_principal_axis(pixels, channels, mean, axis);
+
+    f32 low = 0.0f;
+    f32 high = 0.0f;
+    for (u32 i = 0; i < 16; ++i) {
+        f32 t = 0.0f;
+        for (u32 c = 0; c < channels; ++c) {
+            t += (pixels[i * 4 + c] - mean[c]) * axis[c];
+        }
+        low = MIN(low, t);
+        high = MAX(high, t);
+    }
+    for (u32 c = 0; c < channels; ++c) {
+        out_start[c] = _encoder_clamp(mean[c] + axis[c] * low, 0.0f, 255.0f);
+        out_end[c] = _encoder_clamp(mean[c] + axis[c] * high, 0.0f, 255.0f);
+    }
+}
+
+// Least squares endpoints for the pixels given the interpolation weight in [0, 1] each of them was assigned. Returns
+// FALSE if every pixel has the same weight, in which case the endpoints are left alone.
+static b8 _encoder_refine_endpoints(const u8* pixels, u32 channels, const f32* weights, f32* out_start, f32* out_end) {
+    f32 aa = 0.0f;
+    f32 ab = 0.0f;
+    f32 bb = 0.0f;
+    f32 ax[4] = {0};
+    f32 bx[4] = {0};
+    for (u32 i = 0; i < 16; ++i) {
+        f32 b = weights[i];
+        f32 a = 1.0f - b;
+        aa += a * a;
+        ab += a * b;
+        bb += b * b;
+        for (u32 c = 0; c < channels; ++c) {
+            ax[c] += a * pixels[i * 4 + c];
+            bx[c] += b * pixels[i * 4 + c];
+        }
+    }
+
+    f32 determinant = aa * bb - ab * ab;
+    if (fabsf(determinant) < 1e-6f) {
+        return FALSE;
+    }
+    for (u32 c = 0; c < channels; ++c) {
+        out_start[c] = _encoder_clamp((ax[c] * bb - bx[c] * ab) / determinant, 0.0f, 255.0f);
+        out_end[c] = _encoder_clamp((bx[c] * aa - ax[c] * ab) / determinant, 0.0f, 255.0f);
+    }
+    return TRUE;
+}
+
+static inline u16 _encoder_pack_565(const f32* color) {
+    u32 r = (u32)(color[0] * 31.0f / 255.0f + 0.5f);
+    u32 g = (u32)(color[1] * 63.0f / 255.0f + 0.5f);
+    u32 b = (u32)(color[2] * 31.0f / 255.0f + 0.5f);
+    return (u16)((r << 11) | (g << 5) | b);
+}
+
+static inline void _encoder_unpack_565(u16 packed, i32* out_color) {
+    u32 r = (packed >> 11) & 31;
+    u32 g = (packed >> 5) & 63;
+    u32 b = packed & 31;
+    out_color[0] = (i32)((r << 3) | (r >> 2));
+    out_color[1] = (i32)((g << 2) | (g >> 4));
+    out_color[2] = (i32)((b << 3) | (b >> 2));
+}
+
+// Picks the closest of the 4 colors of a BC1 block for every pixel and returns the total squared error
+static u32 _encoder_bc1_indices(const u8* pixels, u16 start, u16 end, u8* out_indices) {
+    i32 palette[4][3];
+    _encoder_unpack_565(start, palette[0]);
+    _encoder_unpack_565(end, palette[1]);
+    for (u32 c = 0; c < 3; ++c) {
+        palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+        palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+    }
+
+    u32 total = 0;
+    for (u32 i = 0; i < 16; ++i) {
+        u32 best = 0xFFFFFFFF;
+        for (u32 p = 0; p < 4; ++p) {
+            u32 error = 0;
+            for (u32 c = 0; c < 3; ++c) {
+                i32 d = (i32)pixels[i * 4 + c] - palette[p][c];
+                error += (u32)(d * d);
+            }
+            if (error < best) {
+                best = error;
+                out_indices[i] = (u8)p;
+            }
+        }
+        total += best;
+    }
+    return total;
+}
+
+static void _encoder_bc1_color(const u8* pixels, u8* out_block) {
+    // Interpolation weight of each of the 4 indices
+    static const f32 index_weights[4] = {0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f};
+
+    f32 start[3];
+    f32 end[3];
+    _encoder_fit_endpoints(pixels, 3, start, end);
+
+    u16 best_start = _encoder_pack_565(start);
+    u16 best_end = _encoder_pack_565(end);
+    u8 best_indices[16];
+    u32 best_error = _encoder_bc1_indices(pixels, best_start, best_end, best_indices);
+
+    for (u32 pass = 0; pass < ENCODER_REFINE_PASSES && best_error > 0; ++pass) {
+        f32 weights[16];
+        for (u32 i = 0; i < 16; ++i) {
+            weights[i] = index_weights[best_indices[i]];
+        }
+        if (!_encoder_refine_endpoints(pixels, 3, weights, start, end)) {
+            break;
+        }
+
+        u16 refined_start = _encoder_pack_565(start);
+        u16 refined_end = _encoder_pack_565(end);
+        u8 indices[16];
+        u32 error = _encoder_bc1_indices(pixels, refined_start, refined_end, indices);
+        if (error >= best_error) {
+            break;
+        }
+        best_start = refined_start;
+        best_end = refined_end;
+        best_error = error;
+        fr_memory_copy(best_indices, indices, sizeof(indices));
+    }
+
+    // The 4 color mode needs the first endpoint to be the larger one. Swapping the endpoints swaps the indices of
+    // the endpoints and of the two interpolated colors.
+    if (best_start < best_end) {
+        u16 swap = best_start;
+        best_start = best_end;
+        best_end = swap;
+        for (u32 i = 0; i < 16; ++i) {
+            best_indices[i] ^= 1;
+        }
+    } else if (best_start == best_end) {
+        fr_memory_set(best_indices, 0, sizeof(best_indices));
+    }
+
+    u32 packed_indices = 0;
+    for (u32 i = 0; i < 16; ++i) {
+        packed_indices |= (u32)best_indices[i] << (i * 2);
+    }
+    out_block[0] = (u8)(best_start & 0xFF);
+    out_block[1] = (u8)(best_start >> 8);
+    out_block[2] = (u8)(best_end & 0xFF);
+    out_block[3] = (u8)(best_end >> 8);
+    for (u32 i = 0; i < 4; ++i) {
+        out_block[4 + i] = (u8)(packed_indices >> (i * 8));
+    }
+}
+
+// The 8 value mode of a BC4 block: the two endpoints and 6 values interpolated between them
+static void _encoder_alpha_block(const u8* pixels, u8* out_block) {
+    u32 high = 0;
+    u32 low = 255;
+    for (u32 i = 0; i < 16; ++i) {
+        high = MAX(high, pixels[i * 4 + 3]);
+        low = MIN(low, pixels[i * 4 + 3]);
+    }
+
+    u64 packed_indices = 0;
+    if (high > low) {
+        u32 palette[8];
+        palette[0] = high;
+        palette[1] = low;
+        for (u32 p = 2; p < 8; ++p) {
+            palette[p] = ((8 - p) * high + (p - 1) * low) / 7;
+        }
+        for (u32 i = 0; i < 16; ++i) {
+            u32 alpha = pixels[i * 4 + 3];
+            u32 best = 0xFFFFFFFF;
+            u64 best_index = 0;
+            for (u32 p = 0; p < 8; ++p) {
+                u32 error = alpha > palette[p] ? alpha - palette[p] : palette[p] - alpha;
+                if (error < best) {
+                    best = error;
+                    best_index = p;
+                }
+            }
+            packed_indices |= best_index << (i * 3);
+        }
+    }
+
+    out_block[0] = (u8)high;
+    out_block[1] = (u8)low;
+    for (u32 i = 0; i < 6; ++i) {
+        out_block[2 + i] = (u8)(packed_indices >> (i * 8));
+    }
+}
+
+void fr_texture_encode_bc1_block(const u8* pixels, u8* out_block) { _encoder_bc1_color(pixels, out_block); }
+
+void fr_texture_encode_bc3_block(const u8* pixels, u8* out_block) {
+    _encoder_alpha_block(pixels, out_block);
+    _encoder_bc1_color(pixels, out_block + 8);
+}
+
+// Interpolation weights of the 4 bit indices of BC7, in 64ths
+static const u32 bc7_weights[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+// Quantizes an endpoint to 7 bits per channel and the parity bit shared by its channels, picking the parity that
+// lands closest
+static void _encoder_bc7_quantize(const f32* endpoint, u32* out_channels, u32* out_parity) {
+    f32 best_error = 0.0f;
+    for (u32 parity = 0; parity < 2; ++parity) {
+        u32 channels[4];
+        f32 error = 0.0f;
+        for (u32 c = 0; c < 4; ++c) {
+            f32 value = _encoder_clamp((endpoint[c] - parity) / 2.0f + 0.5f, 0.0f, 127.0f);
+            channels[c] = (u32)value;
+            f32 d = (f32)((channels[c] << 1) | parity) - endpoint[c];
+            error += d * d;
+        }
+        if (parity == 0 || error < best_error) {
+            best_error = error;
+            *out_parity = parity;
+            for (u32 c = 0; c < 4; ++c) {
+                out_channels[c] = channels[c];
+            }
+        }
+    }
+}
+
+static u32 _encoder_bc7_indices(
+    const u8* pixels, const u32* start, u32 start_parity, const u32* end, u32 end_parity, u8* out_indices) {
+    i32 palette[16][4];
+    for (u32 c = 0; c < 4; ++c) {
+        u32 a = (start[c] << 1) | start_parity;
+        u32 b = (end[c] << 1) | end_parity;
+        for (u32 p = 0; p < 16; ++p) {
+            palette[p][c] = (i32)(((64 - bc7_weights[p]) * a + bc7_weights[p] * b + 32) >> 6);
+        }
+    }
+
+    u32 total = 0;
+    for (u32 i = 0; i < 16; ++i) {
+        u32 best = 0xFFFFFFFF;
+        for (u32 p = 0; p < 16; ++p) {
+            u32 error = 0;
+            for (u32 c = 0; c < 4; ++c) {
+                i32 d = (i32)pixels[i * 4 + c] - palette[p][c];
+                error += (u32)(d * d);
+            }
+            if (error < best) {
+                best = error;
+                out_indices[i] = (u8)p;
+            }
+        }
+        total += best;
+    }
+    return total;
+}
+
+static inline void _encoder_write_bits(u8* block, u32* bit_offset, u32 value, u32 count) {
+    for (u32 i = 0; i < count; ++i, ++*bit_offset) {
+        block[*bit_offset / 8] |= (u8)(((value >> i) & 1) << (*bit_offset % 8));
+    }
+}
+
+void fr_texture_encode_bc7_block(const u8* pixels, u8* out_block) {
+    f32 start[4];
+    f32 end[4];
+    _encoder_fit_endpoints(pixels, 4, start, end);
+
+    u32 best_start[4];
+    u32 best_end[4];
+    u32 best_start_parity = 0;
+    u32 best_end_parity = 0;
+    u8 best_indices[16];
+    _encoder_bc7_quantize(start, best_start, &best_start_parity);
+    _encoder_bc7_quantize(end, best_end, &best_end_parity);
+    u32 best_error =
+        _encoder_bc7_indices(pixels, best_start, best_start_parity, best_end, best_end_parity, best_indices);
+
+    for (u32 pass = 0; pass < ENCODER_REFINE_PASSES && best_error > 0; ++pass) {
+        f32 weights[16];
+        for (u32 i = 0; i < 16; ++i) {
+            weights[i] = bc7_weights[best_indices[i]] / 64.0f;
+        }
+        if (!_encoder_refine_endpoints(pixels, 4, weights, start, end)) {
+            break;
+        }
+
+        u32 refined_start[4];
+        u32 refined_end[4];
+        u32 start_parity;
+        u32 end_parity;
+        u8 indices[16];
+        _encoder_bc7_quantize(start, refined_start, &start_parity);
+        _encoder_bc7_quantize(end, refined_end, &end_parity);
+        u32 error = _encoder_bc7_indices(pixels, refined_start, start_parity, refined_end, end_parity, indices);
+        if (error >= best_error) {
+            break;
+        }
+        best_error = error;
+        best_start_parity = start_parity;
+        best_end_parity = end_parity;
+        for (u32 c = 0; c < 4; ++c) {
+            best_start[c] = refined_start[c];
+            best_end[c] = refined_end[c];
+        }
+        fr_memory_copy(best_indices, indices, sizeof(indices));
+    }
+
+    // The top bit of the index of the first pixel is implied to be 0, swapping the endpoints flips every index
+    if (best_indices[0] >= 8) {
+        for (u32 c = 0; c < 4; ++c) {
+            u32 swap = best_start[c];
+            best_start[c] = best_end[c];
+            best_end[c] = swap;
+        }
+        u32 swap = best_start_parity;
+        best_start_parity = best_end_parity;
+        best_end_parity = swap;
+        for (u32 i = 0; i < 16; ++i) {
+            best_indices[i] = (u8)(15 - best_indices[i]);
+        }
+    }
+
+    // Mode 6: the mode bit, the RGBA endpoints channel by channel, the parity bits and the indices
+    fr_memory_set(out_block, 0, 16);
+    u32 bit_offset = 0;
+    _encoder_write_bits(out_block, &bit_offset, 1 << 6, 7);
+    for (u32 c = 0; c < 4; ++c) {
+        _encoder_write_bits(out_block, &bit_offset, best_start[c], 7);
+        _encoder_write_bits(out_block, &bit_offset, best_end[c], 7);
+    }
+    _encoder_write_bits(out_block, &bit_offset, best_start_parity, 1);
+    _encoder_write_bits(out_block, &bit_offset, best_end_parity, 1);
+    _encoder_write_bits(out_block, &bit_offset, best_indices[0], 3);
+    for (u32 i = 1; i < 16; ++i) {
+        _encoder_write_bits(out_block, &bit_offset, best_indices[i], 4);
+    }
+}
+
+// -----------------------------------------------------------------------
+// PRIVATE FUNCTIONS
+// -----------------------------------------------------------------------
+
+static u64 _encoder_align(u64 offset) {
+    return (offset + TEXTURE_FILE_ALIGNMENT - 1) & ~(u64)(TEXTURE_FILE_ALIGNMENT - 1);
+}
+
+static void _encoder_encode_rows(u32 start, u32 end, void* data) {
+    encoder_level_context* context = (encoder_level_context*)data;
+    const texture_file_mip* mip = context->mip;
+    for (u32 row = start; row < end; ++row) {
+        u8* dest = context->dest + (u64)row * mip->row_pitch;
+        if (context->format == TEXTURE_FORMAT_RGBA8) {
+            fr_memory_copy(dest, context->pixels + (u64)row * context->width * 4, mip->row_pitch);
+            continue;
+        }
+
+        u32 block_size = fr_texture_format_block_size(context->format);
+        u32 block_count = mip->row_pitch / block_size;
+        for (u32 block = 0; block < block_count; ++block) {
+            u8 pixels[64];
+            _encoder_fetch_block(context->pixels, context->width, context->height, block, row, pixels);
+            u8* out_block = dest + (u64)block * block_size;
+            switch (context->format) {
+                case TEXTURE_FORMAT_BC1:
+                    fr_texture_encode_bc1_block(pixels, out_block);
+                    break;
+                case TEXTURE_FORMAT_BC3:
+                    fr_texture_encode_bc3_block(pixels, out_block);
+                    break;
+                case TEXTURE_FORMAT_BC7:
+                    fr_texture_encode_bc7_block(pixels, out_block);
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+}
+
+static void _encoder_fetch_block(const u8* pixels, u32 width, u32 height, u32 block_x, u32 block_y, u8* out_block) {
+    // Blocks hanging over the edge of the level repeat its last row and column
+    for (u32 y = 0; y < 4; ++y) {
+        u32 source_y = MIN(block_y * 4 + y, height - 1);
+        for (u32 x = 0; x < 4; ++x) {
+            u32 source_x = MIN(block_x * 4 + x, width - 1);
+            fr_memory_copy(out_block + (y * 4 + x) * 4, pixels + ((u64)source_y * width + source_x) * 4, 4);
+        }
+    }
+}
@@ -0,0 +1,108 @@
+/**
+ * @file texture_encoder.h
+ * @author Aditya Rajagopal
+ * @brief Offline conversion of RGBA8 images into texture files: mip chain generation and BC1, BC3 and BC7 block
+ * compression.
+ * @details The encoder is meant for tools and trades speed for simplicity. Mip levels are box filtered from the level
+ * above, averaging the color channels in linear space when the image is sRGB encoded. Blocks are fitted along the
+ * principal axis of their colors followed by a least squares refinement of the endpoints:
+ *
+ *     BC1   4 color mode, opaque
+ *     BC3   BC1 colors with an 8 value alpha block
+ *     BC7   mode 6 only, a single RGBA endpoint pair with per endpoint parity bits and 16 interpolation steps
+ *
+ * Mode 6 alone is well behaved on photos and gradients but blurs blocks with several distinct colors that the
+ * partitioned modes would keep apart.
+ *
+ * Block rows are compressed in parallel with fr_job_parallel_for when the encoder runs inside the engine. Without a
+ * job system, e.g. in the texconv tool, they are compressed on the calling thread.
+ * @version 0.0.1
+ * @date 2024-04-25
+ *
+ * @copyright Fracture Game Engine is Copyright (c) Aditya Rajagopal 2024-2024
+ *
+ */
+#pragma once
+
+#include "fracture/core/defines.h"
+#include "fracture/resources/texture_file.h"
+
+/**
+ * @brief What to convert an image into.
+ *
+ */
+typedef struct texture_encode_desc {
+    /** @brief RGBA8 pixels of the largest level, top row first */
+    const u8* pixels;
+
+    /** @brief Width in pixels */
+    u32 width;
+
+    /** @brief Height in pixels */
+    u32 height;
+
+    /** @brief Distance between the start of two rows of pixels. 0 for tightly packed rows. */
+    u32 row_pitch;
+
+    /** @brief Format of the texture, one of texture_formats */
+    texture_formats format;
+
+    /** @brief Generate the full mip chain down to 1x1, otherwise only the largest level is stored */
+    b8 generate_mips;
+
+    /** @brief The color channels are sRGB encoded. Sets TEXTURE_FILE_FLAG_SRGB and filters the mips in linear space. */
+    b8 srgb;
+} texture_encode_desc;
+
+/**
+ * @brief Converts an image into a texture file in memory.
+ *
+ * @param desc The image and the format to convert it into
+ * @param out_file The texture file, to free with fr_texture_encode_free
+ * @param out_size The size of the texture file in bytes
+ * @return b8 TRUE if the image was converted, FALSE if the description is invalid
+ */
+FR_API b8 fr_texture_encode(const texture_encode_desc* desc, u8** out_file, u64* out_size);
+
+/**
+ * @brief Frees a texture file created by fr_texture_encode.
+ *
+ * @param file The texture file
+ * @param size The size of the texture file in bytes
+ */
+FR_API void fr_texture_encode_free(u8* file, u64 size);
+
+/**
+ * @brief Generates the next mip level of an RGBA8 image with a 2x2 box filter.
+ *
+ * @param source The pixels of the level, tightly packed
+ * @param width Width of the level
+ * @param height Height of the level
+ * @param srgb Average the color channels in linear space
+ * @param dest The pixels of the next level, MAX(1, width / 2) by MAX(1, height / 2), tightly packed
+ */
+FR_API void fr_texture_downsample(const u8* source, u32 width, u32 height, b8 srgb, u8* dest);
+
+/**
+ * @brief Compresses a 4x4 block of RGBA8 pixels into BC1.
+ *
+ * @param pixels The 16 pixels of the block, row by row
+ * @param out_block The 8 byte block
+ */
+FR_API void fr_texture_encode_bc1_block(const u8* pixels, u8* out_block);
+
+/**
+ * @brief Compresses a 4x4 block of RGBA8 pixels into BC3.
+ *
+ * @param pixels The 16 pixels of the block, row by row
+ * @param out_block The 16 byte block
+ */
+FR_API void fr_texture_encode_bc3_block(const u8* pixels, u8* out_block);
+
+/**
+ * @brief Compresses a 4x4 block of RGBA8 pixels into BC7.
+ *
+ * @param pixels The 16 pixels of the block, row by row
+ * @param out_block The 16 byte block
+ */
+FR_API void fr_texture_encode_bc7_block(const u8* pixels, u8* out_block);
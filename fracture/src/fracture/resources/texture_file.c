@@ -0,0 +1,159 @@
+#include "texture_file.h"
+
+#include "fracture/core/systems/fracture_memory.h"
+#include "fracture/core/systems/logging.h"
+
+// The texture_view in front of the copy of the file made by the resource loader. Keeps the file data aligned.
+#define TEXTURE_RESOURCE_HEADER_SIZE TEXTURE_FILE_ALIGNMENT
+
+STATIC_ASSERT(sizeof(texture_file_header) == 64, "texture_file_header must be 64 bytes");
+STATIC_ASSERT(sizeof(texture_file_mip) == 32, "texture_file_mip must be 32 bytes");
+STATIC_ASSERT(sizeof(texture_view) <= TEXTURE_RESOURCE_HEADER_SIZE, "texture_view must fit in front of the file");
+
+u32 fr_texture_format_block_size(texture_formats format) {
+    switch (format) {
+        case TEXTURE_FORMAT_RGBA8:
+            return 4;
+        case TEXTURE_FORMAT_BC1:
+            return 8;
+        case TEXTURE_FORMAT_BC3:
+        case TEXTURE_FORMAT_BC7:
+            return 16;
+        default:
+            return 0;
+    }
+}
+
+b8 fr_texture_format_is_block_compressed(texture_formats format) {
+    return format == TEXTURE_FORMAT_BC1 || format == TEXTURE_FORMAT_BC3 || format == TEXTURE_FORMAT_BC7;
+}
+
+void fr_texture_mip_layout(texture_formats format, u32 width, u32 height, u32 level, texture_file_mip* out_mip) {
+    u32 mip_width = MAX(1, width >> level);
+    u32 mip_height = MAX(1, height >> level);
+    u32 block_size = fr_texture_format_block_size(format);
+
+    out_mip->offset = 0;
+    out_mip->width = mip_width;
+    out_mip->height = mip_height;
+    if (fr_texture_format_is_block_compressed(format)) {
+        // Levels smaller than a block still take a whole block
+        out_mip->row_pitch = ((mip_width + 3) / 4) * block_size;
+        out_mip->row_count = (mip_height + 3) / 4;
+    } else {
+        out_mip->row_pitch = mip_width * block_size;
+        out_mip->row_count = mip_height;
+    }
+    out_mip->size = (u64)out_mip->row_pitch * out_mip->row_count;
+}
+
+u32 fr_texture_full_mip_count(u32 width, u32 height) {
+    u32 largest = MAX(width, height);
+    u32 count = 1;
+    while (largest > 1) {
+        largest >>= 1;
+        count++;
+    }
+    return count;
+}
+
+b8 fr_texture_view_create(const void* data, u64 size, texture_view* out_view) {
+    const texture_file_header* header = (const texture_file_header*)data;
+    if (size < sizeof(texture_file_header) || header->magic != TEXTURE_FILE_MAGIC ||
+        header->version != TEXTURE_FILE_VERSION) {
+        return FALSE;
+    }
+
+    if (header->file_size != size || header->format == TEXTURE_FORMAT_UNKNOWN ||
+        header->format >= TEXTURE_FORMAT_MAX || header->width == 0 || header->height == 0 ||
+        header->width > TEXTURE_MAX_DIMENSION || header->height > TEXTURE_MAX_DIMENSION || header->mip_count == 0 ||
+        header->mip_count > fr_texture_full_mip_count(header->width, header->height) ||
+        sizeof(texture_file_header) + sizeof(texture_file_mip) * header->mip_count > size) {
+        return FALSE;
+    }
+
+    // Every level has to have the layout its format and dimensions imply and lie inside the file, so that the
+    // renderer can trust the table without checking it again
+    const texture_file_mip* mips = (const texture_file_mip*)(header + 1);
+    for (u32 level = 0; level < header->mip_count; ++level) {
+        texture_file_mip expected;
+        fr_texture_mip_layout(header->format, header->width, header->height, level, &expected);
+        const texture_file_mip* mip = &mips[level];
+        if (mip->width != expected.width || mip->height != expected.height || mip->row_pitch != expected.row_pitch ||
+            mip->row_count != expected.row_count || mip->size != expected.size ||
+            mip->offset % TEXTURE_FILE_ALIGNMENT != 0 || mip->offset > size || mip->size > size - mip->offset) {
+            return FALSE;
+        }
+    }
+
+    out_view->header = header;
+    out_view->mips = mips;
+    out_view->base = (const u8*)data;
+    return TRUE;
+}
+
+const void* fr_texture_mip_data(const texture_view* view, u32 level, u64* out_size) {
+    const texture_file_mip* mip = &view->mips[level];
+    if (out_size != NULL_PTR) {
+        *out_size = mip->size;
+    }
+    return view->base + mip->offset;
+}
+
+b8 fr_texture_file_open(const char* path, texture_file* out_file) {
+    file_handle file;
+    if (!fr_file_open(path, FILE_MODE_READ, &file)) {
+        return FALSE;
+    }
+
+    texture_file texture = {0};
+    b8 mapped = fr_file_map(&file, FILE_MAP_READ_ONLY, &texture.mapping);
+    fr_file_close(&file);
+    if (!mapped) {
+        FR_CORE_ERROR("Failed to map texture: %s", path);
+        return FALSE;
+    }
+
+    if (!fr_texture_view_create(texture.mapping.data, texture.mapping.size, &texture.view)) {
+        FR_CORE_ERROR("Not a texture file, written by an incompatible converter or corrupt: %s", path);
+        fr_file_unmap(&texture.mapping);
+        return FALSE;
+    }
+
+    // The levels are read front to back when they are uploaded
+    fr_file_advise(&texture.mapping, 0, texture.mapping.size, FILE_ACCESS_SEQUENTIAL);
+
+    *out_file = texture;
+    return TRUE;
+}
+
+void fr_texture_file_close(texture_file* file) {
+    if (file == NULL_PTR || file->mapping.data == NULL_PTR) {
+        return;
+    }
+
+    fr_file_unmap(&file->mapping);
+    file->view.header = NULL_PTR;
+    file->view.mips = NULL_PTR;
+    file->view.base = NULL_PTR;
+}
+
+b8 fr_texture_resource_load(const char* name, const void* source, u64 source_size, resource_data* out_data) {
+    (void)name;
+    u64 size = TEXTURE_RESOURCE_HEADER_SIZE + source_size;
+    u8* memory = fr_memory_allocate_aligned(size, TEXTURE_FILE_ALIGNMENT, MEMORY_TYPE_TEXTURE);
+    u8* file = memory + TEXTURE_RESOURCE_HEADER_SIZE;
+    fr_memory_copy(file, source, source_size);
+    if (!fr_texture_view_create(file, source_size, (texture_view*)memory)) {
+        fr_memory_free_aligned(memory, size, TEXTURE_FILE_ALIGNMENT, MEMORY_TYPE_TEXTURE);
+        return FALSE;
+    }
+
+    out_data->data = memory;
+    out_data->size = size;
+    return TRUE;
+}
+
+void fr_texture_resource_unload(resource_data* data) {
+    fr_memory_free_aligned(data->data, data->size, TEXTURE_FILE_ALIGNMENT, MEMORY_TYPE_TEXTURE);
+}
@@ -0,0 +1,245 @@
+/**
+ * @file texture_file.h
+ * @author Aditya Rajagopal
+ * @brief Engine texture files: pixels in their GPU format with the full mip chain, ready to be copied into an upload
+ * buffer as they are.
+ * @details Layout of a texture file, all values little endian:
+ *
+ *     texture_file_header                            64 bytes at offset 0
+ *     texture_file_mip[mip_count]                    one entry per mip level, largest first
+ *     mip data                                       each level starting on a TEXTURE_FILE_ALIGNMENT boundary
+ *
+ * Textures are converted offline by the texconv tool (see texture_encoder.h), which decodes the source image,
+ * generates the mip chain and optionally block compresses every level. At runtime nothing is decoded or parsed:
+ * opening a texture maps the file and validates the header and the mip table, after which every level can be handed
+ * to the renderer straight from the mapping. The rows of a level are tightly packed, rows of pixels for uncompressed
+ * formats and rows of 4x4 blocks for the block compressed ones.
+ * @version 0.0.1
+ * @date 2024-04-25
+ *
+ * @copyright Fracture Game Engine is Copyright (c) Aditya Rajagopal 2024-2024
+ *
+ */
+#pragma once
+
+#include "fracture/core/defines.h"
+#include "fracture/core/systems/file_io.h"
+#include "fracture/resources/resource_system.h"
+
+// "FRTX" in the first four bytes of the file
+#define TEXTURE_FILE_MAGIC 0x58545246
+#define TEXTURE_FILE_VERSION 1
+
+// Alignment of the data of every mip level in the file
+#define TEXTURE_FILE_ALIGNMENT 64
+
+// Enough levels for a 65536x65536 texture
+#define TEXTURE_MAX_MIPS 17
+
+// Largest width or height of a texture
+#define TEXTURE_MAX_DIMENSION 65536
+
+/**
+ * @brief Pixel formats of texture files.
+ *
+ */
+typedef enum texture_formats {
+    TEXTURE_FORMAT_UNKNOWN = 0,
+
+    /** @brief 8 bits per channel RGBA, 4 bytes per pixel */
+    TEXTURE_FORMAT_RGBA8,
+
+    /** @brief BC1 (DXT1), opaque RGB in 8 bytes per 4x4 block */
+    TEXTURE_FORMAT_BC1,
+
+    /** @brief BC3 (DXT5), RGB as in BC1 and a separate alpha block, 16 bytes per 4x4 block */
+    TEXTURE_FORMAT_BC3,
+
+    /** @brief BC7, high quality RGBA in 16 bytes per 4x4 block */
+    TEXTURE_FORMAT_BC7,
+
+    TEXTURE_FORMAT_MAX,
+} texture_formats;
+
+/**
+ * @brief Flags of a texture file.
+ *
+ */
+typedef enum texture_file_flags {
+    /** @brief The color channels are sRGB encoded and should be sampled through an sRGB view */
+    TEXTURE_FILE_FLAG_SRGB = BIT(0),
+} texture_file_flags;
+
+/**
+ * @brief The header at the start of a texture file.
+ *
+ */
+typedef struct texture_file_header {
+    /** @brief TEXTURE_FILE_MAGIC */
+    u32 magic;
+
+    /** @brief TEXTURE_FILE_VERSION of the converter that wrote the file */
+    u32 version;
+
+    /** @brief One of texture_formats */
+    u32 format;
+
+    /** @brief Combination of texture_file_flags */
+    u32 flags;
+
+    /** @brief Width of the largest level in pixels */
+    u32 width;
+
+    /** @brief Height of the largest level in pixels */
+    u32 height;
+
+    /** @brief Number of levels in the file */
+    u32 mip_count;
+
+    u32 reserved0;
+
+    /** @brief Size of the data of all the levels, from the start of the first one to the end of the last one */
+    u64 data_size;
+
+    /** @brief Size of the whole file, used to detect truncated files */
+    u64 file_size;
+
+    u8 reserved[16];
+} texture_file_header;
+
+/**
+ * @brief An entry of the mip table.
+ *
+ */
+typedef struct texture_file_mip {
+    /** @brief Offset of the level from the start of the file */
+    u64 offset;
+
+    /** @brief Size of the level in bytes */
+    u64 size;
+
+    /** @brief Width of the level in pixels */
+    u32 width;
+
+    /** @brief Height of the level in pixels */
+    u32 height;
+
+    /** @brief Bytes between two rows of pixels, or of blocks for block compressed formats */
+    u32 row_pitch;
+
+    /** @brief Number of rows of pixels, or of blocks for block compressed formats */
+    u32 row_count;
+} texture_file_mip;
+
+/**
+ * @brief A validated texture in memory, either a mapped file or a texture loaded by the resource system. Points into
+ * the texture data, nothing is copied.
+ *
+ */
+typedef struct texture_view {
+    /** @brief The header */
+    const texture_file_header* header;
+
+    /** @brief The mip table, header->mip_count entries */
+    const texture_file_mip* mips;
+
+    /** @brief The start of the file, level offsets are relative to it */
+    const u8* base;
+} texture_view;
+
+/**
+ * @brief A texture file mapped for reading.
+ *
+ */
+typedef struct texture_file {
+    /** @brief Mapping of the whole file */
+    file_mapping mapping;
+
+    /** @brief The texture, pointing into the mapping */
+    texture_view view;
+} texture_file;
+
+/**
+ * @brief Gets the size of a 4x4 block of a block compressed format, or of a pixel of an uncompressed one.
+ *
+ * @param format One of texture_formats
+ * @return u32 The size in bytes, 0 for unknown formats
+ */
+FR_API u32 fr_texture_format_block_size(texture_formats format);
+
+/**
+ * @brief Checks if a format stores 4x4 blocks instead of pixels.
+ *
+ * @param format One of texture_formats
+ * @return b8 TRUE for the BC formats, FALSE otherwise
+ */
+FR_API b8 fr_texture_format_is_block_compressed(texture_formats format);
+
+/**
+ * @brief Gets the layout of a level: its dimensions, pitch, row count and size.
+ *
+ * @param format One of texture_formats
+ * @param width Width of the largest level
+ * @param height Height of the largest level
+ * @param level The level, 0 being the largest
+ * @param out_mip The layout to write to. The offset is left at 0.
+ */
+FR_API void fr_texture_mip_layout(texture_formats format, u32 width, u32 height, u32 level, texture_file_mip* out_mip);
+
+/**
+ * @brief Gets the number of levels of a full mip chain, down to 1x1.
+ *
+ * @param width Width of the largest level
+ * @param height Height of the largest level
+ * @return u32 The number of levels
+ */
+FR_API u32 fr_texture_full_mip_count(u32 width, u32 height);
+
+/**
+ * @brief Validates a texture file in memory and creates a view of it. Only the header and the mip table are read.
+ *
+ * @param data The texture file. Must stay alive as long as the view is used.
+ * @param size The size of the data in bytes
+ * @param out_view The view to write to
+ * @return b8 TRUE if the data is a valid texture file, FALSE otherwise
+ */
+FR_API b8 fr_texture_view_create(const void* data, u64 size, texture_view* out_view);
+
+/**
+ * @brief Gets the data of a level.
+ *
+ * @param view The texture
+ * @param level The level, below header->mip_count
+ * @param out_size The size of the level in bytes. Can be NULL_PTR.
+ * @return const void* The level, pointing into the texture
+ */
+FR_API const void* fr_texture_mip_data(const texture_view* view, u32 level, u64* out_size);
+
+/**
+ * @brief Maps a texture file and validates it.
+ *
+ * @param path The path of the file
+ * @param out_file The file to write to
+ * @return b8 TRUE if the file was opened, FALSE if it could not be mapped or is malformed
+ */
+FR_API b8 fr_texture_file_open(const char* path, texture_file* out_file);
+
+/**
+ * @brief Unmaps a texture file. Pointers into the file become invalid.
+ *
+ * @param file The file to close
+ */
+FR_API void fr_texture_file_close(texture_file* file);
+
+/**
+ * @brief Resource loader of RESOURCE_TYPE_TEXTURE. Produces a texture_view followed by a copy of the file, the only
+ * work being the copy out of the source and the validation.
+ *
+ */
+b8 fr_texture_resource_load(const char* name, const void* source, u64 source_size, resource_data* out_data);
+
+/**
+ * @brief Frees a texture created by fr_texture_resource_load.
+ *
+ */
+void fr_texture_resource_unload(resource_data* data);
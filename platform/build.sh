@@ -0,0 +1,27 @@
+#!/bin/bash
+# Build script for the platform layer
+set -e
+
+# Get a list of all the .c files
+cFileNames=$(find . -type f -name "*.c")
+
+assembly="platform"
+compilerFlags="-g -O3 -fPIC"
+# -Wall -Werror
+includeFlags="-I../platform/src -I../fracture/src/"
+defines="-D_DEBUG -DPLATFORM_LINUX"
+
+mkdir -p ../bin ../obj
+
+echo "Building $assembly..."
+# Compile C files to object files
+objFiles=""
+for f in $cFileNames; do
+    obj="../obj/$(basename "${f%.*}").o"
+    clang -c $compilerFlags "$f" $defines $includeFlags -o "$obj"
+    objFiles="$objFiles $obj"
+done
+ar rcs ../bin/lib$assembly.a $objFiles
+
+echo "Writing the compile_flags.txt file"
+echo $includeFlags $defines $compilerFlags | tr " " "\n" > compile_flags.txt
@@ -60,6 +60,27 @@ b8 platform_startup(platform_state* platform_state,
                     u32 x_pos,
                     u32 y_pos);
 
+/**
+ * @brief Initializes the platform layer without creating a window. Used to run the engine on machines without a display
+ * such as dedicated servers and benchmark machines. Pumping messages does nothing and no input or window events are
+ * ever reported.
+ *
+ * @param platform_state The platform state to be initialized
+ * @param width Width reported as the framebuffer size
+ * @param height Height reported as the framebuffer size
+ * @return b8 returns TRUE if the platform was initialized successfully, FALSE otherwise
+ */
+b8 platform_startup_headless(platform_state* platform_state, u32 width, u32 height);
+
+/**
+ * @brief Checks whether the platform layer runs without a window, either because it was started with
+ * platform_startup_headless or because platform_startup found no display to create a window on.
+ *
+ * @param platform_state The platform state
+ * @return b8 TRUE if there is no window, FALSE otherwise
+ */
+b8 platform_is_headless(platform_state* platform_state);
+
 /**
  * @brief Shuts down the platform layer and frees any resources that were allocated during the platform_startup
  * function.
@@ -76,22 +97,25 @@ void platform_shutdown(platform_state* platform_state);
  */
 b8 platform_pump_messages(platform_state* platform_state);
 
+// Alignment of blocks returned by platform_allocate when no alignment is requested
+#define PLATFORM_DEFAULT_ALIGNMENT 16
+
 /**
  * @brief Allocates a block of memory of the given size and alignment.
  *
  * @param size The size of the block of memory to be allocated
- * @param aligned The alignment of the block of memory to be allocated
+ * @param alignment The alignment of the block in bytes. Must be a power of 2. 0 uses PLATFORM_DEFAULT_ALIGNMENT.
  * @return void* A pointer to the block of memory that was allocated
  */
-void* platform_allocate(u64 size, b8 aligned);
+void* platform_allocate(u64 size, u64 alignment);
 
 /**
  * @brief Frees a block of memory that was allocated by the platform_allocate function.
  *
  * @param block The block of memory to be freed
- * @param aligned The alignment of the block of memory to be freed
+ * @param alignment The alignment the block was allocated with
  */
-void platform_free(void* block, b8 aligned);
+void platform_free(void* block, u64 alignment);
 
 /**
  * @brief Zeros out a block of memory of the given size.
@@ -166,3 +190,644 @@ void platform_get_handle_info(u64* out_size, void* memory);
  * @param height The height of the framebuffer
  */
 void platform_get_framebuffer_size(u32* width, u32* height);
+
+/**
+ * @brief Gets the size of a virtual memory page. Reservations and commits are made in multiples of it.
+ *
+ * @return u64 The page size in bytes
+ */
+u64 platform_get_page_size();
+
+/**
+ * @brief Gets the size of a large (huge) page.
+ *
+ * @return u64 The large page size in bytes or 0 if the system does not support large pages
+ */
+u64 platform_get_large_page_size();
+
+/**
+ * @brief Reserves a range of virtual address space without backing it with memory. Accessing the range before it is
+ * committed faults. Reserving a large range up front lets a container grow in place instead of copying.
+ *
+ * @param size The size of the range in bytes. Rounded up to the page size.
+ * @param large_pages Hint to back the range with large pages once it is committed to reduce TLB misses. The range is
+ * then aligned to the large page size. Ignored where large pages cannot be committed incrementally (Windows).
+ * @return void* The start of the reserved range or NULL_PTR if the reservation failed
+ */
+void* platform_reserve(u64 size, b8 large_pages);
+
+/**
+ * @brief Commits memory to a part of a reserved range, making it readable and writable. Committed memory reads as zero
+ * until it is written to.
+ *
+ * @param address Start of the range to commit. Must be page aligned.
+ * @param size The size of the range in bytes
+ * @return b8 TRUE if the memory was committed, FALSE otherwise
+ */
+b8 platform_commit(void* address, u64 size);
+
+/**
+ * @brief Returns the memory of a committed range to the operating system. The range stays reserved and can be
+ * committed again.
+ *
+ * @param address Start of the range to decommit. Must be page aligned.
+ * @param size The size of the range in bytes
+ */
+void platform_decommit(void* address, u64 size);
+
+/**
+ * @brief Releases a whole range returned by platform_reserve, committed or not.
+ *
+ * @param address The address returned by platform_reserve
+ * @param size The size that was passed to platform_reserve
+ */
+void platform_release(void* address, u64 size);
+
+// Timeout value that makes platform wait functions wait forever
+#define PLATFORM_WAIT_INFINITE 0xFFFFFFFF
+
+// Function pointer for the entry point of a thread
+typedef u32 (*PFN_thread_start)(void* data);
+
+/**
+ * @brief Handle to a platform thread. The internal handle is owned by the platform layer.
+ *
+ */
+typedef struct platform_thread {
+    /** @brief Platform specific handle to the thread */
+    void* internal_handle;
+
+    /** @brief Platform specific id of the thread */
+    u64 thread_id;
+} platform_thread;
+
+/**
+ * @brief Handle to a counting semaphore. The internal handle is owned by the platform layer.
+ *
+ */
+typedef struct platform_semaphore {
+    /** @brief Platform specific handle to the semaphore */
+    void* internal_handle;
+} platform_semaphore;
+
+/**
+ * @brief Handle to a mutex. The mutex is not recursive. The internal handle is owned by the platform layer.
+ *
+ */
+typedef struct platform_mutex {
+    /** @brief Platform specific handle to the mutex */
+    void* internal_handle;
+} platform_mutex;
+
+/**
+ * @brief Handle to a condition variable. The internal handle is owned by the platform layer.
+ *
+ */
+typedef struct platform_condition {
+    /** @brief Platform specific handle to the condition variable */
+    void* internal_handle;
+} platform_condition;
+
+/**
+ * @brief Handle to an event that threads can wait on until it is set. The internal handle is owned by the platform
+ * layer.
+ *
+ */
+typedef struct platform_event {
+    /** @brief Platform specific handle to the event */
+    void* internal_handle;
+} platform_event;
+
+/**
+ * @brief Handle to a thread local storage slot. Every thread sees its own value in the slot.
+ *
+ */
+typedef struct platform_tls {
+    /** @brief Platform specific index of the slot */
+    u64 index;
+} platform_tls;
+
+/**
+ * @brief Creates a new thread that immediately starts running the given function.
+ *
+ * @param start The function the thread runs
+ * @param data User data passed to the start function
+ * @param out_thread The thread handle to write to
+ * @return b8 returns TRUE if the thread was created successfully, FALSE otherwise
+ */
+b8 platform_thread_create(PFN_thread_start start, void* data, platform_thread* out_thread);
+
+/**
+ * @brief Waits for the thread to finish and releases its handle.
+ *
+ * @param thread The thread to join
+ */
+void platform_thread_join(platform_thread* thread);
+
+/**
+ * @brief Yields the remainder of the time slice of the calling thread to another thread.
+ *
+ */
+void platform_thread_yield();
+
+/**
+ * @brief Gets the platform specific id of the calling thread.
+ *
+ * @return u64 The id of the calling thread
+ */
+u64 platform_thread_current_id();
+
+/**
+ * @brief Restricts the thread to run only on the logical processors in the mask.
+ *
+ * @param thread The thread to set the affinity of. NULL_PTR sets the affinity of the calling thread.
+ * @param affinity_mask Bit i allows the thread to run on logical processor i
+ * @return b8 returns TRUE if the affinity was set, FALSE otherwise
+ */
+b8 platform_thread_set_affinity(platform_thread* thread, u64 affinity_mask);
+
+/**
+ * @brief Sets the name of the thread as shown in debuggers and profilers. Some platforms truncate long names (linux
+ * keeps 15 characters).
+ *
+ * @param thread The thread to name. NULL_PTR names the calling thread.
+ * @param name The name of the thread
+ * @return b8 returns TRUE if the name was set, FALSE otherwise
+ */
+b8 platform_thread_set_name(platform_thread* thread, const char* name);
+
+/**
+ * @brief Gets the number of logical processors on the machine.
+ *
+ * @return u32 The number of logical processors
+ */
+u32 platform_get_processor_count();
+
+/**
+ * @brief Creates a counting semaphore.
+ *
+ * @param initial_count The initial count of the semaphore
+ * @param max_count The maximum count of the semaphore
+ * @param out_semaphore The semaphore handle to write to
+ * @return b8 returns TRUE if the semaphore was created successfully, FALSE otherwise
+ */
+b8 platform_semaphore_create(u32 initial_count, u32 max_count, platform_semaphore* out_semaphore);
+
+/**
+ * @brief Destroys a semaphore created with platform_semaphore_create.
+ *
+ * @param semaphore The semaphore to destroy
+ */
+void platform_semaphore_destroy(platform_semaphore* semaphore);
+
+/**
+ * @brief Increments the count of the semaphore waking up to count waiting threads.
+ *
+ * @param semaphore The semaphore to signal
+ * @param count The amount to increment the count by
+ */
+void platform_semaphore_signal(platform_semaphore* semaphore, u32 count);
+
+/**
+ * @brief Waits until the count of the semaphore is greater than zero and decrements it.
+ *
+ * @param semaphore The semaphore to wait on
+ * @param timeout_ms The maximum time to wait in milliseconds. PLATFORM_WAIT_INFINITE waits forever.
+ * @return b8 returns TRUE if the semaphore was acquired, FALSE if the wait timed out
+ */
+b8 platform_semaphore_wait(platform_semaphore* semaphore, u32 timeout_ms);
+
+/**
+ * @brief Creates a mutex.
+ *
+ * @param out_mutex The mutex handle to write to
+ * @return b8 returns TRUE if the mutex was created successfully, FALSE otherwise
+ */
+b8 platform_mutex_create(platform_mutex* out_mutex);
+
+/**
+ * @brief Destroys a mutex created with platform_mutex_create. The mutex must not be locked.
+ *
+ * @param mutex The mutex to destroy
+ */
+void platform_mutex_destroy(platform_mutex* mutex);
+
+/**
+ * @brief Locks the mutex, waiting until it is available.
+ *
+ * @param mutex The mutex to lock
+ */
+void platform_mutex_lock(platform_mutex* mutex);
+
+/**
+ * @brief Locks the mutex if it is available without waiting.
+ *
+ * @param mutex The mutex to lock
+ * @return b8 returns TRUE if the mutex was locked, FALSE if it is held by another thread
+ */
+b8 platform_mutex_try_lock(platform_mutex* mutex);
+
+/**
+ * @brief Unlocks a mutex locked by the calling thread.
+ *
+ * @param mutex The mutex to unlock
+ */
+void platform_mutex_unlock(platform_mutex* mutex);
+
+/**
+ * @brief Creates a condition variable.
+ *
+ * @param out_condition The condition variable handle to write to
+ * @return b8 returns TRUE if the condition variable was created successfully, FALSE otherwise
+ */
+b8 platform_condition_create(platform_condition* out_condition);
+
+/**
+ * @brief Destroys a condition variable created with platform_condition_create. No thread may be waiting on it.
+ *
+ * @param condition The condition variable to destroy
+ */
+void platform_condition_destroy(platform_condition* condition);
+
+/**
+ * @brief Atomically unlocks the mutex and waits until the condition variable is signaled, then locks the mutex again.
+ * Wake ups can be spurious so the caller has to check its condition in a loop.
+ *
+ * @param condition The condition variable to wait on
+ * @param mutex The mutex locked by the calling thread
+ * @param timeout_ms The maximum time to wait in milliseconds. PLATFORM_WAIT_INFINITE waits forever.
+ * @return b8 returns TRUE if the thread was woken up, FALSE if the wait timed out. The mutex is locked either way.
+ */
+b8 platform_condition_wait(platform_condition* condition, platform_mutex* mutex, u32 timeout_ms);
+
+/**
+ * @brief Wakes up one thread waiting on the condition variable.
+ *
+ * @param condition The condition variable to signal
+ */
+void platform_condition_signal(platform_condition* condition);
+
+/**
+ * @brief Wakes up all threads waiting on the condition variable.
+ *
+ * @param condition The condition variable to signal
+ */
+void platform_condition_broadcast(platform_condition* condition);
+
+/**
+ * @brief Creates an event.
+ *
+ * @param manual_reset If TRUE the event stays set until platform_event_reset is called and releases every waiting
+ * thread. If FALSE setting the event releases a single waiting thread and the event resets automatically.
+ * @param initially_set The initial state of the event
+ * @param out_event The event handle to write to
+ * @return b8 returns TRUE if the event was created successfully, FALSE otherwise
+ */
+b8 platform_event_create(b8 manual_reset, b8 initially_set, platform_event* out_event);
+
+/**
+ * @brief Destroys an event created with platform_event_create. No thread may be waiting on it.
+ *
+ * @param event The event to destroy
+ */
+void platform_event_destroy(platform_event* event);
+
+/**
+ * @brief Sets the event releasing the waiting threads.
+ *
+ * @param event The event to set
+ */
+void platform_event_set(platform_event* event);
+
+/**
+ * @brief Resets a manual reset event so that threads wait on it again.
+ *
+ * @param event The event to reset
+ */
+void platform_event_reset(platform_event* event);
+
+/**
+ * @brief Waits until the event is set.
+ *
+ * @param event The event to wait on
+ * @param timeout_ms The maximum time to wait in milliseconds. PLATFORM_WAIT_INFINITE waits forever.
+ * @return b8 returns TRUE if the event was set, FALSE if the wait timed out
+ */
+b8 platform_event_wait(platform_event* event, u32 timeout_ms);
+
+/**
+ * @brief Allocates a thread local storage slot. The value of the slot is NULL_PTR on every thread.
+ *
+ * @param out_tls The slot handle to write to
+ * @return b8 returns TRUE if a slot was allocated, FALSE otherwise
+ */
+b8 platform_tls_create(platform_tls* out_tls);
+
+/**
+ * @brief Frees a thread local storage slot.
+ *
+ * @param tls The slot to free
+ */
+void platform_tls_destroy(platform_tls* tls);
+
+/**
+ * @brief Sets the value of the slot for the calling thread.
+ *
+ * @param tls The slot to write
+ * @param value The value to store
+ */
+void platform_tls_set(platform_tls* tls, void* value);
+
+/**
+ * @brief Gets the value of the slot for the calling thread.
+ *
+ * @param tls The slot to read
+ * @return void* The value stored by the calling thread or NULL_PTR if it has not stored one
+ */
+void* platform_tls_get(platform_tls* tls);
+
+// Function pointer for the entry point of a fiber. The function must never return.
+typedef void (*PFN_fiber_start)(void* data);
+
+/**
+ * @brief Handle to a fiber (a user mode execution context with its own stack). The internal handle is owned by the
+ * platform layer.
+ *
+ */
+typedef struct platform_fiber {
+    /** @brief Platform specific handle to the fiber */
+    void* internal_handle;
+} platform_fiber;
+
+/**
+ * @brief Converts the calling thread into a fiber so that it can switch to other fibers. This has to be called before
+ * the thread switches to any other fiber.
+ *
+ * @param out_fiber The fiber handle of the calling thread to write to
+ * @return b8 returns TRUE if the thread was converted successfully, FALSE otherwise
+ */
+b8 platform_fiber_convert_thread(platform_fiber* out_fiber);
+
+/**
+ * @brief Converts the calling thread back to a regular thread. Must be called from the fiber that was returned by
+ * platform_fiber_convert_thread.
+ *
+ * @param fiber The fiber handle of the calling thread
+ */
+void platform_fiber_convert_to_thread(platform_fiber* fiber);
+
+/**
+ * @brief Creates a fiber that starts running the given function the first time it is switched to.
+ *
+ * @param stack_size The size of the stack of the fiber in bytes
+ * @param start The function the fiber runs. Must never return.
+ * @param data User data passed to the start function
+ * @param out_fiber The fiber handle to write to
+ * @return b8 returns TRUE if the fiber was created successfully, FALSE otherwise
+ */
+b8 platform_fiber_create(u64 stack_size, PFN_fiber_start start, void* data, platform_fiber* out_fiber);
+
+/**
+ * @brief Destroys a fiber created with platform_fiber_create. The fiber must not be running on any thread.
+ *
+ * @param fiber The fiber to destroy
+ */
+void platform_fiber_destroy(platform_fiber* fiber);
+
+/**
+ * @brief Saves the context of the currently running fiber into from and continues execution on the fiber to. Returns
+ * when some thread switches back to from.
+ *
+ * @param from The fiber that is currently running on the calling thread
+ * @param to The fiber to switch to
+ */
+void platform_fiber_switch(platform_fiber* from, platform_fiber* to);
+
+/**
+ * @brief Flags to open a file with. A file opened with only PLATFORM_FILE_MODE_WRITE is created if it does not exist
+ * and truncated if it does. Opening with both flags creates the file if it does not exist and keeps its contents.
+ *
+ */
+typedef enum platform_file_mode {
+    PLATFORM_FILE_MODE_READ = 0x1,
+    PLATFORM_FILE_MODE_WRITE = 0x2,
+} platform_file_mode;
+
+/**
+ * @brief Handle to an open file. The internal handle is owned by the platform layer.
+ *
+ */
+typedef struct platform_file {
+    /** @brief Platform specific handle to the file */
+    void* internal_handle;
+} platform_file;
+
+/**
+ * @brief How the pages of a file mapping can be accessed.
+ *
+ */
+typedef enum platform_file_map_mode {
+    /** @brief The pages are shared with the page cache and writing to them faults */
+    PLATFORM_FILE_MAP_READ_ONLY = 0,
+
+    /** @brief The pages can be written to. A page is copied the first time it is written so the changes stay private
+     * to the mapping and never reach the file. Useful to patch pointers in place after loading packed data. */
+    PLATFORM_FILE_MAP_COPY_ON_WRITE,
+} platform_file_map_mode;
+
+/**
+ * @brief Hints about how a range of a mapping is going to be accessed so that the operating system can schedule the
+ * reads from the file ahead of the page faults.
+ *
+ */
+typedef enum platform_file_access_hint {
+    /** @brief Default read ahead */
+    PLATFORM_FILE_ACCESS_NORMAL = 0,
+
+    /** @brief The range is read front to back. Reads further ahead and drops pages once they were read. */
+    PLATFORM_FILE_ACCESS_SEQUENTIAL,
+
+    /** @brief The range is read in no particular order. Disables read ahead. */
+    PLATFORM_FILE_ACCESS_RANDOM,
+
+    /** @brief The range is needed soon. Starts reading it in the background. */
+    PLATFORM_FILE_ACCESS_WILL_NEED,
+} platform_file_access_hint;
+
+/**
+ * @brief A view of the contents of a file mapped into the address space. Pages are read from the file the first time
+ * they are touched so mapping a large file is cheap and nothing is copied into a separate buffer.
+ *
+ */
+typedef struct platform_file_mapping {
+    /** @brief Start of the mapped contents. Only writable for PLATFORM_FILE_MAP_COPY_ON_WRITE mappings. */
+    void* data;
+
+    /** @brief Size of the mapped contents in bytes */
+    u64 size;
+
+    /** @brief The mode the mapping was created with */
+    platform_file_map_mode mode;
+
+    /** @brief Platform specific handle to the mapping */
+    void* internal_handle;
+} platform_file_mapping;
+
+/**
+ * @brief Opens a file.
+ *
+ * @param path The path of the file
+ * @param mode Combination of platform_file_mode flags
+ * @param out_file The file handle to write to
+ * @return b8 returns TRUE if the file was opened, FALSE otherwise
+ */
+b8 platform_file_open(const char* path, u32 mode, platform_file* out_file);
+
+/**
+ * @brief Closes a file opened with platform_file_open. The file must not have asynchronous requests in flight.
+ *
+ * @param file The file to close
+ */
+void platform_file_close(platform_file* file);
+
+/**
+ * @brief Gets the size of a file.
+ *
+ * @param file The file to query
+ * @param out_size The size of the file in bytes
+ * @return b8 returns TRUE if the size was queried, FALSE otherwise
+ */
+b8 platform_file_size(platform_file* file, u64* out_size);
+
+/**
+ * @brief Reads from a file at the given offset. Reads do not move a shared file position so several threads can read
+ * the same file at once.
+ *
+ * @param file The file to read from
+ * @param offset The offset in the file to read from
+ * @param size The number of bytes to read
+ * @param buffer The buffer to read into. Must hold at least size bytes.
+ * @param out_bytes_read The number of bytes that were read. Less than size if the end of the file was reached. Can be
+ * NULL_PTR.
+ * @return b8 returns TRUE if the read succeeded, FALSE otherwise
+ */
+b8 platform_file_read(platform_file* file, u64 offset, u64 size, void* buffer, u64* out_bytes_read);
+
+/**
+ * @brief Writes to a file at the given offset, growing the file if needed.
+ *
+ * @param file The file to write to
+ * @param offset The offset in the file to write to
+ * @param size The number of bytes to write
+ * @param buffer The data to write
+ * @param out_bytes_written The number of bytes that were written. Can be NULL_PTR.
+ * @return b8 returns TRUE if all the bytes were written, FALSE otherwise
+ */
+b8 platform_file_write(platform_file* file, u64 offset, u64 size, const void* buffer, u64* out_bytes_written);
+
+/**
+ * @brief Maps the whole file into the address space. The mapping stays valid after the file is closed. Empty files
+ * cannot be mapped.
+ *
+ * @param file The file to map. Must have been opened for reading.
+ * @param mode How the pages of the mapping can be accessed
+ * @param out_mapping The mapping to write to
+ * @return b8 returns TRUE if the file was mapped, FALSE otherwise
+ */
+b8 platform_file_map(platform_file* file, platform_file_map_mode mode, platform_file_mapping* out_mapping);
+
+/**
+ * @brief Unmaps a mapping created with platform_file_map. Changes made to a copy on write mapping are discarded.
+ *
+ * @param mapping The mapping to unmap
+ */
+void platform_file_unmap(platform_file_mapping* mapping);
+
+/**
+ * @brief Tells the operating system how a range of a mapping is going to be accessed. Only a hint, platforms that have
+ * no equivalent ignore it.
+ *
+ * @param mapping The mapping the range belongs to
+ * @param offset The offset of the range from the start of the mapping. Rounded down to the page size.
+ * @param size The size of the range in bytes. Clamped to the end of the mapping.
+ * @param hint How the range is going to be accessed
+ */
+void platform_file_mapping_advise(platform_file_mapping* mapping, u64 offset, u64 size, platform_file_access_hint hint);
+
+// Operation performed by an asynchronous file request
+typedef enum platform_io_operation {
+    PLATFORM_IO_OPERATION_READ = 0,
+    PLATFORM_IO_OPERATION_WRITE,
+} platform_io_operation;
+
+/**
+ * @brief An asynchronous read or write. The request is owned by the caller and together with its buffer has to stay
+ * alive until platform_io_poll returns it.
+ *
+ */
+typedef struct platform_io_request {
+    /** @brief The file to read from or write to */
+    platform_file file;
+
+    /** @brief Whether to read or write */
+    platform_io_operation operation;
+
+    /** @brief The offset in the file */
+    u64 offset;
+
+    /** @brief The number of bytes to transfer */
+    u64 size;
+
+    /** @brief The buffer to read into or write from */
+    void* buffer;
+
+    /** @brief Set on completion. Less than size for reads that reached the end of the file. */
+    u64 bytes_transferred;
+
+    /** @brief Set on completion. FALSE if the operating system reported an error. */
+    b8 succeeded;
+
+    /** @brief User data that the platform layer does not touch */
+    void* user_data;
+} platform_io_request;
+
+/**
+ * @brief Initializes the asynchronous file I/O queue. Linux submits requests to an io_uring and falls back to a pool
+ * of threads doing blocking I/O when io_uring is not available (old kernels or sandboxes that block it). Windows
+ * always uses the thread pool.
+ *
+ * @param queue_depth The maximum number of requests that can be in flight at once
+ * @return b8 returns TRUE if the queue was initialized, FALSE otherwise
+ */
+b8 platform_io_initialize(u32 queue_depth);
+
+/**
+ * @brief Shuts down the asynchronous file I/O queue. Waits for requests in flight to finish and drops their
+ * completions.
+ *
+ */
+void platform_io_shutdown();
+
+/**
+ * @brief Gets the name of the backend that platform_io_initialize picked.
+ *
+ * @return const char* The name of the backend
+ */
+const char* platform_io_backend_name();
+
+/**
+ * @brief Queues an asynchronous request. Can be called from any thread.
+ *
+ * @param request The request to queue
+ * @return b8 returns TRUE if the request was queued, FALSE if queue_depth requests are already in flight
+ */
+b8 platform_io_submit(platform_io_request* request);
+
+/**
+ * @brief Collects finished requests without waiting. Can be called from any thread.
+ *
+ * @param out_completed Array the finished requests are written to
+ * @param max_count The size of the array
+ * @return u32 The number of requests written to the array
+ */
+u32 platform_io_poll(platform_io_request** out_completed, u32 max_count);
@@ -0,0 +1,154 @@
+#include "platform_io_pool.h"
+
+#include <stdlib.h>
+
+/**
+ * @brief Ring buffers of requests waiting for a thread and requests waiting to be polled. A request counts as in flight
+ * from the moment it is submitted until it is polled, and at most capacity requests are in flight, so neither ring can
+ * overflow.
+ *
+ */
+typedef struct io_pool_state {
+    platform_thread threads[PLATFORM_IO_POOL_THREAD_COUNT];
+    u32 thread_count;
+    b8 is_running;
+
+    platform_mutex lock;
+    platform_semaphore work_semaphore;
+
+    u32 capacity;
+    u32 in_flight;
+
+    platform_io_request** pending;
+    u32 pending_head;
+    u32 pending_count;
+
+    platform_io_request** completed;
+    u32 completed_head;
+    u32 completed_count;
+} io_pool_state;
+
+static io_pool_state* pool = NULL_PTR;
+
+static u32 _io_pool_thread(void* data);
+static void _io_pool_execute(platform_io_request* request);
+
+b8 platform_io_pool_initialize(u32 queue_depth) {
+    if (pool != NULL_PTR || queue_depth == 0) {
+        return FALSE;
+    }
+
+    pool = calloc(1, sizeof(io_pool_state));
+    if (pool == NULL_PTR) {
+        return FALSE;
+    }
+    pool->capacity = queue_depth;
+    pool->pending = malloc(sizeof(platform_io_request*) * queue_depth);
+    pool->completed = malloc(sizeof(platform_io_request*) * queue_depth);
+    if (pool->pending == NULL_PTR || pool->completed == NULL_PTR || !platform_mutex_create(&pool->lock) ||
+        !platform_semaphore_create(0, 0x7FFFFFFF, &pool->work_semaphore)) {
+        platform_io_pool_shutdown();
+        return FALSE;
+    }
+
+    pool->is_running = TRUE;
+    for (u32 i = 0; i < PLATFORM_IO_POOL_THREAD_COUNT; ++i) {
+        if (!platform_thread_create(_io_pool_thread, 0, &pool->threads[i])) {
+            platform_io_pool_shutdown();
+            return FALSE;
+        }
+        platform_thread_set_name(&pool->threads[i], "fr_io");
+        pool->thread_count++;
+    }
+    return TRUE;
+}
+
+void platform_io_pool_shutdown() {
+    if (pool == NULL_PTR) {
+        return;
+    }
+
+    if (pool->thread_count > 0) {
+        platform_mutex_lock(&pool->lock);
+        pool->is_running = FALSE;
+        platform_mutex_unlock(&pool->lock);
+        platform_semaphore_signal(&pool->work_semaphore, pool->thread_count);
+        for (u32 i = 0; i < pool->thread_count; ++i) {
+            platform_thread_join(&pool->threads[i]);
+        }
+    }
+
+    platform_semaphore_destroy(&pool->work_semaphore);
+    platform_mutex_destroy(&pool->lock);
+    free(pool->pending);
+    free(pool->completed);
+    free(pool);
+    pool = NULL_PTR;
+}
+
+b8 platform_io_pool_submit(platform_io_request* request) {
+    platform_mutex_lock(&pool->lock);
+    if (pool->in_flight == pool->capacity) {
+        platform_mutex_unlock(&pool->lock);
+        return FALSE;
+    }
+    pool->in_flight++;
+    pool->pending[(pool->pending_head + pool->pending_count) % pool->capacity] = request;
+    pool->pending_count++;
+    platform_mutex_unlock(&pool->lock);
+
+    platform_semaphore_signal(&pool->work_semaphore, 1);
+    return TRUE;
+}
+
+u32 platform_io_pool_poll(platform_io_request** out_completed, u32 max_count) {
+    platform_mutex_lock(&pool->lock);
+    u32 count = pool->completed_count < max_count ? pool->completed_count : max_count;
+    for (u32 i = 0; i < count; ++i) {
+        out_completed[i] = pool->completed[pool->completed_head];
+        pool->completed_head = (pool->completed_head + 1) % pool->capacity;
+    }
+    pool->completed_count -= count;
+    pool->in_flight -= count;
+    platform_mutex_unlock(&pool->lock);
+    return count;
+}
+
+static u32 _io_pool_thread(void* data) {
+    (void)data;
+    while (TRUE) {
+        platform_semaphore_wait(&pool->work_semaphore, PLATFORM_WAIT_INFINITE);
+
+        platform_mutex_lock(&pool->lock);
+        if (pool->pending_count == 0) {
+            b8 is_running = pool->is_running;
+            platform_mutex_unlock(&pool->lock);
+            if (!is_running) {
+                return 0;
+            }
+            continue;
+        }
+        platform_io_request* request = pool->pending[pool->pending_head];
+        pool->pending_head = (pool->pending_head + 1) % pool->capacity;
+        pool->pending_count--;
+        platform_mutex_unlock(&pool->lock);
+
+        _io_pool_execute(request);
+
+        platform_mutex_lock(&pool->lock);
+        pool->completed[(pool->completed_head + pool->completed_count) % pool->capacity] = request;
+        pool->completed_count++;
+        platform_mutex_unlock(&pool->lock);
+    }
+}
+
+static void _io_pool_execute(platform_io_request* request) {
+    request->bytes_transferred = 0;
+    if (request->operation == PLATFORM_IO_OPERATION_READ) {
+        request->succeeded = platform_file_read(
+            &request->file, request->offset, request->size, request->buffer, &request->bytes_transferred);
+    } else {
+        request->succeeded = platform_file_write(
+            &request->file, request->offset, request->size, request->buffer, &request->bytes_transferred);
+    }
+}
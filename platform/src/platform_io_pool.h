@@ -0,0 +1,51 @@
+/**
+ * @file platform_io_pool.h
+ * @author Aditya Rajagopal
+ * @brief Portable backend of the asynchronous file I/O queue. A small pool of threads takes requests off a queue and
+ * runs them with the blocking platform_file_read and platform_file_write calls.
+ * @details Used by platforms without a native asynchronous file API and as the fallback when the native one is not
+ * available. Only the platform layer calls these, the rest of the engine goes through the platform_io functions.
+ * @version 0.0.1
+ * @date 2024-04-20
+ *
+ * @copyright Fracture Game Engine is Copyright (c) Aditya Rajagopal 2024-2024
+ *
+ */
+#pragma once
+
+#include "platform.h"
+
+// Number of threads in the pool. I/O threads spend most of their time blocked in the kernel so a few are enough to
+// keep the device busy.
+#define PLATFORM_IO_POOL_THREAD_COUNT 4
+
+/**
+ * @brief Creates the queues and starts the threads of the pool.
+ *
+ * @param queue_depth The maximum number of requests that can be in flight at once
+ * @return b8 returns TRUE if the pool was started, FALSE otherwise
+ */
+b8 platform_io_pool_initialize(u32 queue_depth);
+
+/**
+ * @brief Lets the threads finish the queued requests, joins them and frees the pool.
+ *
+ */
+void platform_io_pool_shutdown();
+
+/**
+ * @brief Queues a request for the threads of the pool.
+ *
+ * @param request The request to queue
+ * @return b8 returns TRUE if the request was queued, FALSE if the pool is full
+ */
+b8 platform_io_pool_submit(platform_io_request* request);
+
+/**
+ * @brief Collects requests that the threads of the pool have finished.
+ *
+ * @param out_completed Array the finished requests are written to
+ * @param max_count The size of the array
+ * @return u32 The number of requests written to the array
+ */
+u32 platform_io_pool_poll(platform_io_request** out_completed, u32 max_count);
@@ -0,0 +1,1635 @@
+// Needed for pthread_setaffinity_np, pthread_setname_np and MAP_STACK
+#define _GNU_SOURCE
+#include "platform.h"
+#include "platform_io_pool.h"
+
+#if PLATFORM_LINUX
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <linux/io_uring.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <X11/XKBlib.h>
+#include <X11/Xlib-xcb.h>
+#include <X11/Xlib.h>
+#include <X11/keysym.h>
+#include <xcb/xcb.h>
+
+//*********************************************************************************************************************
+//*****************************************************WINDOW**********************************************************
+//*********************************************************************************************************************
+
+// Allocations at least this large (including the header) get their own mapping, smaller ones come from the C heap
+#define LINUX_MMAP_THRESHOLD KiB(64)
+
+/**
+ * @brief Internal state for the linux platform layer
+ *
+ */
+typedef struct internal_state {
+    /** @brief Connection to the X server. Must be the first member, the vulkan backend reads it through
+     * platform_get_handle_info. NULL_PTR when running headless. */
+    xcb_connection_t* connection;
+
+    /** @brief The window. Must be the second member for the same reason as the connection. */
+    xcb_window_t window;
+
+    /** @brief Xlib display that owns the connection. Only used to translate key codes. */
+    Display* display;
+
+    /** @brief Atom of the WM_DELETE_WINDOW protocol sent when the user closes the window */
+    xcb_atom_t wm_delete_window;
+
+    /** @brief TRUE when there is no display to create a window on */
+    b8 headless;
+
+    /** @brief Size of the client area of the window */
+    u32 width;
+    u32 height;
+} internal_state;
+
+/**
+ * @brief Header right in front of every block returned by platform_allocate. Records where the underlying allocation
+ * starts since aligning the block can move it forward.
+ *
+ */
+typedef struct linux_allocation_header {
+    /** @brief Start of the malloc block or mapping the block lives in */
+    void* base;
+
+    /** @brief Size of the mapping the block lives in or 0 if the block was allocated with malloc */
+    u64 mapped_size;
+} linux_allocation_header;
+
+static platform_state* plat_state;
+static internal_state* state_ptr;
+
+static keys _linux_translate_keycode(KeySym key_symbol);
+static void _linux_console_write(FILE* stream, const char* message, u8 color);
+
+b8 platform_startup(
+    platform_state* platform_state, const char* window_title, u32 width, u32 height, u32 x_pos, u32 y_pos) {
+    if (platform_state->on_key_event == NULL_PTR || platform_state->on_mouse_move == NULL_PTR ||
+        platform_state->on_mouse_button_event == NULL_PTR || platform_state->on_mouse_scroll == NULL_PTR ||
+        platform_state->on_window_resize == NULL_PTR) {
+        return FALSE;
+    }
+
+    // Servers do not have a display. Run without a window instead of failing so that the engine can still simulate.
+    const char* display_name = getenv("DISPLAY");
+    Display* display = NULL_PTR;
+    if (display_name == NULL_PTR || display_name[0] == 0 || (display = XOpenDisplay(display_name)) == NULL_PTR) {
+        _linux_console_write(stderr, "No X display available, running headless\n", 2);
+        return platform_startup_headless(platform_state, width, height);
+    }
+
+    platform_state->internal_state = calloc(1, sizeof(internal_state));
+    plat_state = platform_state;
+    internal_state* state = (internal_state*)platform_state->internal_state;
+    state_ptr = state;
+    state->display = display;
+    state->width = width;
+    state->height = height;
+
+    // Without detectable auto repeat a held key sends a release before every repeated press
+    XkbSetDetectableAutoRepeat(state->display, True, 0);
+
+    state->connection = XGetXCBConnection(state->display);
+    if (xcb_connection_has_error(state->connection)) {
+        _linux_console_write(stderr, "Failed to connect to the X server via XCB\n", 1);
+        XCloseDisplay(state->display);
+        state->display = NULL_PTR;
+        state->connection = NULL_PTR;
+        return FALSE;
+    }
+    // We read all the events through XCB
+    XSetEventQueueOwner(state->display, XCBOwnsEventQueue);
+
+    const xcb_setup_t* setup = xcb_get_setup(state->connection);
+    xcb_screen_t* screen = xcb_setup_roots_iterator(setup).data;
+
+    state->window = xcb_generate_id(state->connection);
+
+    u32 event_mask = XCB_CW_BACK_PIXEL | XCB_CW_EVENT_MASK;
+    u32 event_values = XCB_EVENT_MASK_BUTTON_PRESS | XCB_EVENT_MASK_BUTTON_RELEASE | XCB_EVENT_MASK_KEY_PRESS |
+                       XCB_EVENT_MASK_KEY_RELEASE | XCB_EVENT_MASK_EXPOSURE | XCB_EVENT_MASK_POINTER_MOTION |
+                       XCB_EVENT_MASK_STRUCTURE_NOTIFY;
+    u32 value_list[] = {screen->black_pixel, event_values};
+
+    xcb_create_window(state->connection,
+                      XCB_COPY_FROM_PARENT,
+                      state->window,
+                      screen->root,
+                      (i16)x_pos,
+                      (i16)y_pos,
+                      (u16)width,
+                      (u16)height,
+                      0,
+                      XCB_WINDOW_CLASS_INPUT_OUTPUT,
+                      screen->root_visual,
+                      event_mask,
+                      value_list);
+
+    xcb_change_property(state->connection,
+                        XCB_PROP_MODE_REPLACE,
+                        state->window,
+                        XCB_ATOM_WM_NAME,
+                        XCB_ATOM_STRING,
+                        8,
+                        strlen(window_title),
+                        window_title);
+
+    // Ask the window manager to send us a message instead of killing the connection when the window is closed
+    xcb_intern_atom_cookie_t delete_cookie = xcb_intern_atom(state->connection, 0, 16, "WM_DELETE_WINDOW");
+    xcb_intern_atom_cookie_t protocols_cookie = xcb_intern_atom(state->connection, 0, 12, "WM_PROTOCOLS");
+    xcb_intern_atom_reply_t* delete_reply = xcb_intern_atom_reply(state->connection, delete_cookie, 0);
+    xcb_intern_atom_reply_t* protocols_reply = xcb_intern_atom_reply(state->connection, protocols_cookie, 0);
+    if (delete_reply != NULL_PTR && protocols_reply != NULL_PTR) {
+        state->wm_delete_window = delete_reply->atom;
+        xcb_change_property(state->connection,
+                            XCB_PROP_MODE_REPLACE,
+                            state->window,
+                            protocols_reply->atom,
+                            XCB_ATOM_ATOM,
+                            32,
+                            1,
+                            &delete_reply->atom);
+    }
+    free(delete_reply);
+    free(protocols_reply);
+
+    xcb_map_window(state->connection, state->window);
+
+    if (xcb_flush(state->connection) <= 0) {
+        _linux_console_write(stderr, "Failed to flush the XCB connection\n", 1);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+b8 platform_startup_headless(platform_state* platform_state, u32 width, u32 height) {
+    platform_state->internal_state = calloc(1, sizeof(internal_state));
+    plat_state = platform_state;
+    internal_state* state = (internal_state*)platform_state->internal_state;
+    state_ptr = state;
+    state->headless = TRUE;
+    state->width = width;
+    state->height = height;
+    return TRUE;
+}
+
+b8 platform_is_headless(platform_state* platform_state) {
+    return ((internal_state*)platform_state->internal_state)->headless;
+}
+
+void platform_shutdown(platform_state* platform_state) {
+    internal_state* state = (internal_state*)platform_state->internal_state;
+
+    if (state->connection) {
+        xcb_destroy_window(state->connection, state->window);
+        xcb_flush(state->connection);
+        state->window = 0;
+        state->connection = NULL_PTR;
+    }
+
+    if (state->display) {
+        // Closing the display also closes the XCB connection it owns
+        XCloseDisplay(state->display);
+        state->display = NULL_PTR;
+    }
+
+    free(state);
+    platform_state->internal_state = NULL_PTR;
+    state_ptr = NULL_PTR;
+    plat_state = NULL_PTR;
+}
+
+b8 platform_pump_messages(platform_state* platform_state) {
+    internal_state* state = (internal_state*)platform_state->internal_state;
+    if (state->headless) {
+        return TRUE;
+    }
+
+    xcb_generic_event_t* event;
+    while ((event = xcb_poll_for_event(state->connection)) != NULL_PTR) {
+        // The high bit of the response type is set for events generated by SendEvent
+        switch (event->response_type & ~0x80) {
+            case XCB_KEY_PRESS:
+            case XCB_KEY_RELEASE: {
+                xcb_key_press_event_t* key_event = (xcb_key_press_event_t*)event;
+                b8 pressed = (event->response_type & ~0x80) == XCB_KEY_PRESS;
+                KeySym key_symbol = XkbKeycodeToKeysym(state->display, (KeyCode)key_event->detail, 0, 0);
+                keys key = _linux_translate_keycode(key_symbol);
+                if (key != 0) {
+                    plat_state->on_key_event(key, pressed);
+                }
+            } break;
+            case XCB_BUTTON_PRESS:
+            case XCB_BUTTON_RELEASE: {
+                xcb_button_press_event_t* button_event = (xcb_button_press_event_t*)event;
+                b8 pressed = (event->response_type & ~0x80) == XCB_BUTTON_PRESS;
+                switch (button_event->detail) {
+                    case XCB_BUTTON_INDEX_1:
+                        plat_state->on_mouse_button_event(MOUSE_BUTTON_LEFT, pressed);
+                        break;
+                    case XCB_BUTTON_INDEX_2:
+                        plat_state->on_mouse_button_event(MOUSE_BUTTON_MIDDLE, pressed);
+                        break;
+                    case XCB_BUTTON_INDEX_3:
+                        plat_state->on_mouse_button_event(MOUSE_BUTTON_RIGHT, pressed);
+                        break;
+                    case XCB_BUTTON_INDEX_4:
+                        // X reports the scroll wheel as buttons 4 (up) and 5 (down)
+                        if (pressed) {
+                            plat_state->on_mouse_scroll(1);
+                        }
+                        break;
+                    case XCB_BUTTON_INDEX_5:
+                        if (pressed) {
+                            plat_state->on_mouse_scroll(-1);
+                        }
+                        break;
+                }
+            } break;
+            case XCB_MOTION_NOTIFY: {
+                xcb_motion_notify_event_t* move_event = (xcb_motion_notify_event_t*)event;
+                plat_state->on_mouse_move(move_event->event_x, move_event->event_y);
+            } break;
+            case XCB_CONFIGURE_NOTIFY: {
+                // Also sent when the window moves so only report actual size changes
+                xcb_configure_notify_event_t* configure_event = (xcb_configure_notify_event_t*)event;
+                if (configure_event->width != state->width || configure_event->height != state->height) {
+                    state->width = configure_event->width;
+                    state->height = configure_event->height;
+                    plat_state->on_window_resize(state->width, state->height);
+                }
+            } break;
+            case XCB_CLIENT_MESSAGE: {
+                xcb_client_message_event_t* client_message = (xcb_client_message_event_t*)event;
+                if (client_message->data.data32[0] == state->wm_delete_window) {
+                    plat_state->on_window_close();
+                }
+            } break;
+            default:
+                break;
+        }
+        free(event);
+    }
+
+    return TRUE;
+}
+
+void* platform_allocate(u64 size, u64 alignment) {
+    if (alignment < PLATFORM_DEFAULT_ALIGNMENT) {
+        alignment = PLATFORM_DEFAULT_ALIGNMENT;
+    }
+
+    // Both malloc and mmap return at least 16 byte aligned memory so this is always enough room to align the block and
+    // fit the header in front of it
+    u64 total_size = size + sizeof(linux_allocation_header) + alignment - PLATFORM_DEFAULT_ALIGNMENT;
+    u8* base;
+    u64 mapped_size = 0;
+    // Large blocks are mapped directly so that freeing them returns the pages to the OS right away
+    if (total_size >= LINUX_MMAP_THRESHOLD) {
+        u64 page_size = (u64)sysconf(_SC_PAGESIZE);
+        mapped_size = (total_size + page_size - 1) & ~(page_size - 1);
+        base = mmap(0, mapped_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (base == MAP_FAILED) {
+            return NULL_PTR;
+        }
+    } else {
+        base = malloc(total_size);
+        if (base == NULL_PTR) {
+            return NULL_PTR;
+        }
+    }
+
+    u8* block = (u8*)(((u64)base + sizeof(linux_allocation_header) + alignment - 1) & ~(alignment - 1));
+    linux_allocation_header* header = (linux_allocation_header*)block - 1;
+    header->base = base;
+    header->mapped_size = mapped_size;
+    return block;
+}
+
+void platform_free(void* block, u64 alignment) {
+    if (block == NULL_PTR) {
+        return;
+    }
+
+    linux_allocation_header* header = (linux_allocation_header*)block - 1;
+    if (header->mapped_size != 0) {
+        munmap(header->base, header->mapped_size);
+    } else {
+        free(header->base);
+    }
+}
+
+void* platform_zero_memory(void* block, u64 size) { return memset(block, 0, size); }
+
+void* platform_set_memory(void* block, i32 value, u64 size) { return memset(block, value, size); }
+
+void* platform_copy_memory(void* dest, const void* source, u64 size) { return memcpy(dest, source, size); }
+
+void platform_console_write(const char* message, u8 color) { _linux_console_write(stdout, message, color); }
+
+void platform_console_write_error(const char* message, u8 color) { _linux_console_write(stderr, message, color); }
+
+f64 platform_get_absolute_time() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (f64)now.tv_sec + (f64)now.tv_nsec * 0.000000001;
+}
+
+void platform_sleep(u64 milliseconds) {
+    struct timespec remaining = {(time_t)(milliseconds / 1000), (long)((milliseconds % 1000) * 1000000)};
+    // nanosleep returns early when a signal arrives, keep sleeping for whatever time is left
+    while (nanosleep(&remaining, &remaining) == -1 && errno == EINTR) {
+    }
+}
+
+void platform_get_handle_info(u64* out_size, void* memory) {
+    *out_size = sizeof(internal_state);
+    if (!memory) {
+        return;
+    }
+
+    memcpy(memory, state_ptr, *out_size);
+}
+
+void platform_get_framebuffer_size(u32* width, u32* height) {
+    // Kept up to date from the configure notify events in platform_pump_messages
+    *width = state_ptr->width;
+    *height = state_ptr->height;
+}
+
+static void _linux_console_write(FILE* stream, const char* message, u8 color) {
+    // Only emit color codes when writing to a terminal so that redirected logs stay readable
+    if (!isatty(fileno(stream))) {
+        fputs(message, stream);
+        return;
+    }
+
+    // FATAL, ERROR, WARN, INFO, TRACE, ASSERTION
+    static const char* colors[] = {
+        "1;37;41",  // FATAL - White text on red background
+        "1;31",     // ERROR - Red
+        "1;33",     // WARN - Yellow
+        "1;32",     // INFO - Green
+        "0;37",     // TRACE - Grey
+        "1;31;47",  // ASSERTION - Red text on white background
+    };
+    fprintf(stream, "\033[%sm%s\033[0m", colors[color], message);
+}
+
+static keys _linux_translate_keycode(KeySym key_symbol) {
+    // Letters and digits map straight onto the key codes once upper cased
+    if (key_symbol >= XK_a && key_symbol <= XK_z) {
+        return (keys)(KEY_A + (key_symbol - XK_a));
+    }
+    if (key_symbol >= XK_A && key_symbol <= XK_Z) {
+        return (keys)(KEY_A + (key_symbol - XK_A));
+    }
+    if (key_symbol >= XK_0 && key_symbol <= XK_9) {
+        return (keys)(KEY_0 + (key_symbol - XK_0));
+    }
+    if (key_symbol >= XK_F1 && key_symbol <= XK_F24) {
+        return (keys)(KEY_F1 + (key_symbol - XK_F1));
+    }
+    if (key_symbol >= XK_KP_0 && key_symbol <= XK_KP_9) {
+        return (keys)(KEY_NUMPAD0 + (key_symbol - XK_KP_0));
+    }
+
+    switch (key_symbol) {
+        case XK_BackSpace:
+            return KEY_BACKSPACE;
+        case XK_Return:
+            return KEY_ENTER;
+        case XK_Tab:
+            return KEY_TAB;
+        case XK_Pause:
+            return KEY_PAUSE;
+        case XK_Caps_Lock:
+            return KEY_CAPITAL;
+        case XK_Escape:
+            return KEY_ESCAPE;
+        case XK_Mode_switch:
+            return KEY_MODECHANGE;
+        case XK_space:
+            return KEY_SPACE;
+        case XK_Prior:
+            return KEY_PAGEUP;
+        case XK_Next:
+            return KEY_PAGEDOWN;
+        case XK_End:
+            return KEY_END;
+        case XK_Home:
+            return KEY_HOME;
+        case XK_Left:
+            return KEY_LEFT;
+        case XK_Up:
+            return KEY_UP;
+        case XK_Right:
+            return KEY_RIGHT;
+        case XK_Down:
+            return KEY_DOWN;
+        case XK_Select:
+            return KEY_SELECT;
+        case XK_Print:
+            return KEY_PRINTSCREEN;
+        case XK_Execute:
+            return KEY_EXECUTE;
+        case XK_Insert:
+            return KEY_INSERT;
+        case XK_Delete:
+            return KEY_DELETE;
+        case XK_Help:
+            return KEY_HELP;
+        case XK_Super_L:
+            return KEY_LSUPER;
+        case XK_Super_R:
+            return KEY_RSUPER;
+        case XK_Menu:
+            return KEY_APPS;
+        case XK_KP_Multiply:
+            return KEY_MULTIPLY;
+        case XK_KP_Add:
+            return KEY_ADD;
+        case XK_KP_Separator:
+            return KEY_SEPARATOR;
+        case XK_KP_Subtract:
+            return KEY_SUBTRACT;
+        case XK_KP_Decimal:
+            return KEY_DECIMAL;
+        case XK_KP_Divide:
+            return KEY_DIVIDE;
+        case XK_KP_Equal:
+            return KEY_NUMPAD_EQUAL;
+        case XK_Num_Lock:
+            return KEY_NUMLOCK;
+        case XK_Scroll_Lock:
+            return KEY_SCROLL;
+        case XK_Shift_L:
+            return KEY_LSHIFT;
+        case XK_Shift_R:
+            return KEY_RSHIFT;
+        case XK_Control_L:
+            return KEY_LCONTROL;
+        case XK_Control_R:
+            return KEY_RCONTROL;
+        case XK_Alt_L:
+            return KEY_LALT;
+        case XK_Alt_R:
+            return KEY_RALT;
+        case XK_semicolon:
+            return KEY_SEMICOLON;
+        case XK_apostrophe:
+            return KEY_APOSTROPHE;
+        case XK_equal:
+            return KEY_EQUAL;
+        case XK_comma:
+            return KEY_COMMA;
+        case XK_minus:
+            return KEY_MINUS;
+        case XK_period:
+            return KEY_PERIOD;
+        case XK_slash:
+            return KEY_SLASH;
+        case XK_grave:
+            return KEY_GRAVE;
+        case XK_bracketleft:
+            return KEY_LBRACKET;
+        case XK_backslash:
+            return KEY_BACKSLASH;
+        case XK_bracketright:
+            return KEY_RBRACKET;
+        default:
+            return 0;
+    }
+}
+
+//*********************************************************************************************************************
+//*************************************************VIRTUAL MEMORY******************************************************
+//*********************************************************************************************************************
+
+// Path of the size of a transparent huge page
+#define LINUX_HUGE_PAGE_SIZE_PATH "/sys/kernel/mm/transparent_hugepage/hpage_pmd_size"
+
+u64 platform_get_page_size() { return (u64)sysconf(_SC_PAGESIZE); }
+
+u64 platform_get_large_page_size() {
+    static u64 large_page_size = (u64)-1;
+    if (large_page_size != (u64)-1) {
+        return large_page_size;
+    }
+
+    // Transparent huge pages can be requested per range with madvise, unlike hugetlbfs pages which have to be set
+    // aside by the administrator
+    large_page_size = 0;
+    FILE* file = fopen(LINUX_HUGE_PAGE_SIZE_PATH, "r");
+    if (file != NULL_PTR) {
+        unsigned long long size = 0;
+        if (fscanf(file, "%llu", &size) == 1) {
+            large_page_size = (u64)size;
+        }
+        fclose(file);
+    }
+    return large_page_size;
+}
+
+void* platform_reserve(u64 size, b8 large_pages) {
+    u64 page_size = platform_get_page_size();
+    size = (size + page_size - 1) & ~(page_size - 1);
+
+    u64 large_page_size = large_pages ? platform_get_large_page_size() : 0;
+    if (large_page_size == 0 || size < large_page_size) {
+        void* address = mmap(0, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        return address == MAP_FAILED ? NULL_PTR : address;
+    }
+
+    // Huge pages are only used for the parts of a range that are aligned to the huge page size. Over reserve so that
+    // the range can start on a huge page boundary and unmap the slack on either side.
+    u64 padded_size = size + large_page_size;
+    u8* padded = mmap(0, padded_size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (padded == MAP_FAILED) {
+        return NULL_PTR;
+    }
+
+    u8* address = (u8*)(((u64)padded + large_page_size - 1) & ~(large_page_size - 1));
+    u64 head = (u64)(address - padded);
+    u64 tail = padded_size - head - size;
+    if (head) {
+        munmap(padded, head);
+    }
+    if (tail) {
+        munmap(address + size, tail);
+    }
+
+    // The advice sticks to the range so every later commit in it can be backed by huge pages
+    madvise(address, size, MADV_HUGEPAGE);
+    return address;
+}
+
+b8 platform_commit(void* address, u64 size) {
+    // Anonymous pages are only backed on first touch so making the range accessible is all that is needed
+    return mprotect(address, size, PROT_READ | PROT_WRITE) == 0;
+}
+
+void platform_decommit(void* address, u64 size) {
+    // MADV_DONTNEED drops the pages immediately and makes them read as zero if they are committed again
+    madvise(address, size, MADV_DONTNEED);
+    mprotect(address, size, PROT_NONE);
+}
+
+void platform_release(void* address, u64 size) { munmap(address, size); }
+
+//*********************************************************************************************************************
+//****************************************************THREADING********************************************************
+//*********************************************************************************************************************
+
+// Number of times a contended mutex is polled before the thread goes to sleep in the kernel
+#define MUTEX_SPIN_COUNT 64
+
+/**
+ * @brief Arguments of _linux_thread_trampoline. Owned by the new thread.
+ *
+ */
+typedef struct linux_thread_start {
+    PFN_thread_start start;
+    void* data;
+} linux_thread_start;
+
+/**
+ * @brief Futex based counting semaphore. waiters is only used to skip the wake system call when nobody is sleeping.
+ *
+ */
+typedef struct linux_semaphore {
+    volatile i32 count;
+    volatile i32 waiters;
+    i32 max_count;
+} linux_semaphore;
+
+/**
+ * @brief Futex based mutex. state is 0 when unlocked, 1 when locked and 2 when locked and threads might be sleeping on
+ * it. See "Futexes Are Tricky" by Ulrich Drepper.
+ *
+ */
+typedef struct linux_mutex {
+    volatile i32 state;
+} linux_mutex;
+
+/**
+ * @brief Futex based condition variable. Waiters sleep until the sequence changes.
+ *
+ */
+typedef struct linux_condition {
+    volatile i32 sequence;
+} linux_condition;
+
+/**
+ * @brief Futex based event. state is 1 while the event is set.
+ *
+ */
+typedef struct linux_event {
+    volatile i32 state;
+    b8 manual_reset;
+} linux_event;
+
+static void* _linux_thread_trampoline(void* data);
+static u64 _linux_time_ns();
+static u64 _linux_deadline(u32 timeout_ms);
+static b8 _linux_futex_wait(volatile i32* address, i32 expected, u64 deadline_ns);
+static void _linux_futex_wake(volatile i32* address, i32 count);
+static void _linux_mutex_lock_contended(linux_mutex* mutex);
+
+b8 platform_thread_create(PFN_thread_start start, void* data, platform_thread* out_thread) {
+    if (start == NULL_PTR || out_thread == NULL_PTR) {
+        return FALSE;
+    }
+
+    pthread_t* handle = malloc(sizeof(pthread_t));
+    linux_thread_start* start_args = malloc(sizeof(linux_thread_start));
+    if (handle == NULL_PTR || start_args == NULL_PTR) {
+        free(handle);
+        free(start_args);
+        return FALSE;
+    }
+    start_args->start = start;
+    start_args->data = data;
+
+    if (pthread_create(handle, 0, _linux_thread_trampoline, start_args) != 0) {
+        free(handle);
+        free(start_args);
+        return FALSE;
+    }
+
+    out_thread->internal_handle = handle;
+    out_thread->thread_id = (u64)*handle;
+    return TRUE;
+}
+
+void platform_thread_join(platform_thread* thread) {
+    if (thread == NULL_PTR || thread->internal_handle == NULL_PTR) {
+        return;
+    }
+
+    pthread_join(*(pthread_t*)thread->internal_handle, 0);
+    free(thread->internal_handle);
+    thread->internal_handle = NULL_PTR;
+    thread->thread_id = 0;
+}
+
+void platform_thread_yield() { sched_yield(); }
+
+// The pthread id rather than the kernel thread id so that it matches the thread_id of the threads we create, which is
+// known as soon as pthread_create returns
+u64 platform_thread_current_id() { return (u64)pthread_self(); }
+
+b8 platform_thread_set_affinity(platform_thread* thread, u64 affinity_mask) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (u32 i = 0; i < 64; ++i) {
+        if (affinity_mask & (1ULL << i)) {
+            CPU_SET(i, &set);
+        }
+    }
+
+    pthread_t handle = thread != NULL_PTR ? *(pthread_t*)thread->internal_handle : pthread_self();
+    return pthread_setaffinity_np(handle, sizeof(cpu_set_t), &set) == 0;
+}
+
+b8 platform_thread_set_name(platform_thread* thread, const char* name) {
+    // The kernel keeps at most 15 characters and fails for anything longer
+    char truncated[16];
+    strncpy(truncated, name, sizeof(truncated) - 1);
+    truncated[sizeof(truncated) - 1] = 0;
+
+    pthread_t handle = thread != NULL_PTR ? *(pthread_t*)thread->internal_handle : pthread_self();
+    return pthread_setname_np(handle, truncated) == 0;
+}
+
+u32 platform_get_processor_count() {
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (u32)count : 1;
+}
+
+b8 platform_semaphore_create(u32 initial_count, u32 max_count, platform_semaphore* out_semaphore) {
+    if (out_semaphore == NULL_PTR) {
+        return FALSE;
+    }
+
+    linux_semaphore* semaphore = calloc(1, sizeof(linux_semaphore));
+    if (semaphore == NULL_PTR) {
+        return FALSE;
+    }
+    semaphore->count = (i32)initial_count;
+    semaphore->max_count = max_count > INT_MAX ? INT_MAX : (i32)max_count;
+    out_semaphore->internal_handle = semaphore;
+    return TRUE;
+}
+
+void platform_semaphore_destroy(platform_semaphore* semaphore) {
+    if (semaphore == NULL_PTR || semaphore->internal_handle == NULL_PTR) {
+        return;
+    }
+
+    free(semaphore->internal_handle);
+    semaphore->internal_handle = NULL_PTR;
+}
+
+void platform_semaphore_signal(platform_semaphore* semaphore, u32 count) {
+    linux_semaphore* internal = (linux_semaphore*)semaphore->internal_handle;
+    i32 current = __atomic_load_n(&internal->count, __ATOMIC_RELAXED);
+    i32 desired;
+    do {
+        i64 sum = (i64)current + count;
+        desired = sum > internal->max_count ? internal->max_count : (i32)sum;
+    } while (!__atomic_compare_exchange_n(
+        &internal->count, &current, desired, FALSE, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED));
+
+    if (__atomic_load_n(&internal->waiters, __ATOMIC_SEQ_CST) > 0) {
+        _linux_futex_wake(&internal->count, count > INT_MAX ? INT_MAX : (i32)count);
+    }
+}
+
+b8 platform_semaphore_wait(platform_semaphore* semaphore, u32 timeout_ms) {
+    linux_semaphore* internal = (linux_semaphore*)semaphore->internal_handle;
+    u64 deadline = _linux_deadline(timeout_ms);
+    for (;;) {
+        i32 count = __atomic_load_n(&internal->count, __ATOMIC_ACQUIRE);
+        while (count > 0) {
+            if (__atomic_compare_exchange_n(
+                    &internal->count, &count, count - 1, FALSE, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+                return TRUE;
+            }
+        }
+
+        __atomic_fetch_add(&internal->waiters, 1, __ATOMIC_SEQ_CST);
+        b8 in_time = _linux_futex_wait(&internal->count, 0, deadline);
+        __atomic_fetch_sub(&internal->waiters, 1, __ATOMIC_RELAXED);
+        if (!in_time) {
+            return FALSE;
+        }
+    }
+}
+
+b8 platform_mutex_create(platform_mutex* out_mutex) {
+    if (out_mutex == NULL_PTR) {
+        return FALSE;
+    }
+
+    linux_mutex* mutex = calloc(1, sizeof(linux_mutex));
+    if (mutex == NULL_PTR) {
+        return FALSE;
+    }
+    out_mutex->internal_handle = mutex;
+    return TRUE;
+}
+
+void platform_mutex_destroy(platform_mutex* mutex) {
+    if (mutex == NULL_PTR || mutex->internal_handle == NULL_PTR) {
+        return;
+    }
+
+    free(mutex->internal_handle);
+    mutex->internal_handle = NULL_PTR;
+}
+
+void platform_mutex_lock(platform_mutex* mutex) {
+    linux_mutex* internal = (linux_mutex*)mutex->internal_handle;
+    i32 expected = 0;
+    if (__atomic_compare_exchange_n(&internal->state, &expected, 1, FALSE, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        return;
+    }
+
+    // Most critical sections are short so poll for a bit before paying for the system call
+    for (u32 i = 0; i < MUTEX_SPIN_COUNT; ++i) {
+        __builtin_ia32_pause();
+        expected = 0;
+        if (__atomic_load_n(&internal->state, __ATOMIC_RELAXED) == 0 &&
+            __atomic_compare_exchange_n(&internal->state, &expected, 1, FALSE, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            return;
+        }
+    }
+
+    _linux_mutex_lock_contended(internal);
+}
+
+b8 platform_mutex_try_lock(platform_mutex* mutex) {
+    linux_mutex* internal = (linux_mutex*)mutex->internal_handle;
+    i32 expected = 0;
+    return __atomic_compare_exchange_n(&internal->state, &expected, 1, FALSE, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+}
+
+void platform_mutex_unlock(platform_mutex* mutex) {
+    linux_mutex* internal = (linux_mutex*)mutex->internal_handle;
+    if (__atomic_exchange_n(&internal->state, 0, __ATOMIC_RELEASE) == 2) {
+        _linux_futex_wake(&internal->state, 1);
+    }
+}
+
+b8 platform_condition_create(platform_condition* out_condition) {
+    if (out_condition == NULL_PTR) {
+        return FALSE;
+    }
+
+    linux_condition* condition = calloc(1, sizeof(linux_condition));
+    if (condition == NULL_PTR) {
+        return FALSE;
+    }
+    out_condition->internal_handle = condition;
+    return TRUE;
+}
+
+void platform_condition_destroy(platform_condition* condition) {
+    if (condition == NULL_PTR || condition->internal_handle == NULL_PTR) {
+        return;
+    }
+
+    free(condition->internal_handle);
+    condition->internal_handle = NULL_PTR;
+}
+
+b8 platform_condition_wait(platform_condition* condition, platform_mutex* mutex, u32 timeout_ms) {
+    linux_condition* internal = (linux_condition*)condition->internal_handle;
+    // Read the sequence before unlocking so that a signal sent after the unlock makes the futex wait return
+    i32 sequence = __atomic_load_n(&internal->sequence, __ATOMIC_RELAXED);
+    platform_mutex_unlock(mutex);
+
+    b8 in_time = _linux_futex_wait(&internal->sequence, sequence, _linux_deadline(timeout_ms));
+
+    // Other waiters may have been woken with us so the mutex has to be taken in the contended state
+    _linux_mutex_lock_contended((linux_mutex*)mutex->internal_handle);
+    return in_time;
+}
+
+void platform_condition_signal(platform_condition* condition) {
+    linux_condition* internal = (linux_condition*)condition->internal_handle;
+    __atomic_fetch_add(&internal->sequence, 1, __ATOMIC_RELEASE);
+    _linux_futex_wake(&internal->sequence, 1);
+}
+
+void platform_condition_broadcast(platform_condition* condition) {
+    linux_condition* internal = (linux_condition*)condition->internal_handle;
+    __atomic_fetch_add(&internal->sequence, 1, __ATOMIC_RELEASE);
+    _linux_futex_wake(&internal->sequence, INT_MAX);
+}
+
+b8 platform_event_create(b8 manual_reset, b8 initially_set, platform_event* out_event) {
+    if (out_event == NULL_PTR) {
+        return FALSE;
+    }
+
+    linux_event* event = calloc(1, sizeof(linux_event));
+    if (event == NULL_PTR) {
+        return FALSE;
+    }
+    event->state = initially_set ? 1 : 0;
+    event->manual_reset = manual_reset;
+    out_event->internal_handle = event;
+    return TRUE;
+}
+
+void platform_event_destroy(platform_event* event) {
+    if (event == NULL_PTR || event->internal_handle == NULL_PTR) {
+        return;
+    }
+
+    free(event->internal_handle);
+    event->internal_handle = NULL_PTR;
+}
+
+void platform_event_set(platform_event* event) {
+    linux_event* internal = (linux_event*)event->internal_handle;
+    __atomic_store_n(&internal->state, 1, __ATOMIC_RELEASE);
+    _linux_futex_wake(&internal->state, internal->manual_reset ? INT_MAX : 1);
+}
+
+void platform_event_reset(platform_event* event) {
+    linux_event* internal = (linux_event*)event->internal_handle;
+    __atomic_store_n(&internal->state, 0, __ATOMIC_RELEASE);
+}
+
+b8 platform_event_wait(platform_event* event, u32 timeout_ms) {
+    linux_event* internal = (linux_event*)event->internal_handle;
+    u64 deadline = _linux_deadline(timeout_ms);
+    for (;;) {
+        if (internal->manual_reset) {
+            if (__atomic_load_n(&internal->state, __ATOMIC_ACQUIRE) == 1) {
+                return TRUE;
+            }
+        } else {
+            // Only one waiter gets to consume the set state of an auto reset event
+            i32 expected = 1;
+            if (__atomic_compare_exchange_n(
+                    &internal->state, &expected, 0, FALSE, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+                return TRUE;
+            }
+        }
+
+        if (!_linux_futex_wait(&internal->state, 0, deadline)) {
+            return FALSE;
+        }
+    }
+}
+
+b8 platform_tls_create(platform_tls* out_tls) {
+    if (out_tls == NULL_PTR) {
+        return FALSE;
+    }
+
+    pthread_key_t key;
+    if (pthread_key_create(&key, 0) != 0) {
+        return FALSE;
+    }
+    out_tls->index = (u64)key;
+    return TRUE;
+}
+
+void platform_tls_destroy(platform_tls* tls) { pthread_key_delete((pthread_key_t)tls->index); }
+
+void platform_tls_set(platform_tls* tls, void* value) { pthread_setspecific((pthread_key_t)tls->index, value); }
+
+void* platform_tls_get(platform_tls* tls) { return pthread_getspecific((pthread_key_t)tls->index); }
+
+static void* _linux_thread_trampoline(void* data) {
+    linux_thread_start start_args = *(linux_thread_start*)data;
+    free(data);
+    start_args.start(start_args.data);
+    return 0;
+}
+
+static u64 _linux_time_ns() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (u64)now.tv_sec * 1000000000ULL + (u64)now.tv_nsec;
+}
+
+// Converts a relative timeout into an absolute deadline on the monotonic clock. 0 means wait forever.
+static u64 _linux_deadline(u32 timeout_ms) {
+    if (timeout_ms == PLATFORM_WAIT_INFINITE) {
+        return 0;
+    }
+    return _linux_time_ns() + (u64)timeout_ms * 1000000ULL;
+}
+
+// Sleeps while *address == expected. Returns FALSE if the deadline passed, TRUE when woken up (possibly spuriously).
+static b8 _linux_futex_wait(volatile i32* address, i32 expected, u64 deadline_ns) {
+    if (deadline_ns == 0) {
+        syscall(SYS_futex, address, FUTEX_WAIT_PRIVATE, expected, 0, 0, 0);
+        return TRUE;
+    }
+
+    u64 now = _linux_time_ns();
+    if (now >= deadline_ns) {
+        return FALSE;
+    }
+    u64 remaining = deadline_ns - now;
+    struct timespec timeout = {(time_t)(remaining / 1000000000ULL), (long)(remaining % 1000000000ULL)};
+    if (syscall(SYS_futex, address, FUTEX_WAIT_PRIVATE, expected, &timeout, 0, 0) == -1 && errno == ETIMEDOUT) {
+        return FALSE;
+    }
+    return TRUE;
+}
+
+static void _linux_futex_wake(volatile i32* address, i32 count) {
+    syscall(SYS_futex, address, FUTEX_WAKE_PRIVATE, count, 0, 0, 0);
+}
+
+static void _linux_mutex_lock_contended(linux_mutex* mutex) {
+    // Mark the mutex as contended so that the owner wakes us up when it unlocks
+    while (__atomic_exchange_n(&mutex->state, 2, __ATOMIC_ACQUIRE) != 0) {
+        _linux_futex_wait(&mutex->state, 2, 0);
+    }
+}
+
+//*********************************************************************************************************************
+//*****************************************************FIBERS**********************************************************
+//*********************************************************************************************************************
+
+/**
+ * @brief Internal state of a fiber on linux. The context of a suspended fiber is saved on its own stack and
+ * stack_pointer points to it.
+ *
+ */
+typedef struct linux_fiber {
+    /** @brief Saved stack pointer of the fiber while it is not running */
+    void* stack_pointer;
+
+    /** @brief Base of the mapping of the stack including the guard page. NULL for fibers converted from threads */
+    void* stack_base;
+
+    /** @brief Size of the mapping of the stack including the guard page */
+    u64 stack_size;
+} linux_fiber;
+
+// Default values of the MXCSR register and the x87 control word as defined by the System V ABI
+#define FIBER_DEFAULT_MXCSR 0x1F80
+#define FIBER_DEFAULT_FPU_CONTROL_WORD 0x037F
+
+// Number of 8 byte slots of a saved context: mxcsr and x87 control word, r15, r14, r13, r12, rbx, rbp, return address
+#define FIBER_CONTEXT_SLOTS 8
+
+/*
+ * Saves the callee saved state of the System V ABI (rbp, rbx, r12-r15, the MXCSR control bits and the x87 control
+ * word) on the current stack, stores the stack pointer in *from_stack_pointer and restores the same state from
+ * to_stack_pointer. Everything else is caller saved so the compiler has already spilled it around the call.
+ *
+ * void _platform_fiber_swap(void** from_stack_pointer, void* to_stack_pointer);
+ */
+__asm__(
+    ".text\n"
+    ".p2align 4\n"
+    ".type _platform_fiber_swap, @function\n"
+    "_platform_fiber_swap:\n"
+    "    pushq %rbp\n"
+    "    pushq %rbx\n"
+    "    pushq %r12\n"
+    "    pushq %r13\n"
+    "    pushq %r14\n"
+    "    pushq %r15\n"
+    "    subq $8, %rsp\n"
+    "    stmxcsr (%rsp)\n"
+    "    fnstcw 4(%rsp)\n"
+    "    movq %rsp, (%rdi)\n"
+    "    movq %rsi, %rsp\n"
+    "    ldmxcsr (%rsp)\n"
+    "    fldcw 4(%rsp)\n"
+    "    addq $8, %rsp\n"
+    "    popq %r15\n"
+    "    popq %r14\n"
+    "    popq %r13\n"
+    "    popq %r12\n"
+    "    popq %rbx\n"
+    "    popq %rbp\n"
+    "    ret\n"
+    ".size _platform_fiber_swap, .-_platform_fiber_swap\n");
+
+/*
+ * First code that runs on a new fiber. _platform_fiber_swap returns into it with the start function in r13 and the
+ * user data in r12. The stack is 16 byte aligned at this point as required before a call. The start function must
+ * never return.
+ */
+__asm__(
+    ".text\n"
+    ".p2align 4\n"
+    ".type _platform_fiber_trampoline, @function\n"
+    "_platform_fiber_trampoline:\n"
+    "    movq %r12, %rdi\n"
+    "    callq *%r13\n"
+    "    ud2\n"
+    ".size _platform_fiber_trampoline, .-_platform_fiber_trampoline\n");
+
+void _platform_fiber_swap(void** from_stack_pointer, void* to_stack_pointer);
+void _platform_fiber_trampoline();
+
+b8 platform_fiber_convert_thread(platform_fiber* out_fiber) {
+    if (out_fiber == NULL_PTR) {
+        return FALSE;
+    }
+
+    // The thread already has a stack. Its context is saved into stack_pointer the first time it switches away.
+    linux_fiber* fiber = calloc(1, sizeof(linux_fiber));
+    if (fiber == NULL_PTR) {
+        return FALSE;
+    }
+
+    out_fiber->internal_handle = fiber;
+    return TRUE;
+}
+
+void platform_fiber_convert_to_thread(platform_fiber* fiber) {
+    free(fiber->internal_handle);
+    fiber->internal_handle = NULL_PTR;
+}
+
+b8 platform_fiber_create(u64 stack_size, PFN_fiber_start start, void* data, platform_fiber* out_fiber) {
+    if (start == NULL_PTR || out_fiber == NULL_PTR) {
+        return FALSE;
+    }
+
+    u64 page_size = (u64)sysconf(_SC_PAGESIZE);
+    stack_size = (stack_size + page_size - 1) & ~(page_size - 1);
+    // One extra page at the bottom of the stack is left inaccessible so that an overflow faults instead of silently
+    // corrupting the memory below it.
+    u64 mapping_size = stack_size + page_size;
+    void* mapping = mmap(0, mapping_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+    if (mapping == MAP_FAILED) {
+        return FALSE;
+    }
+    mprotect(mapping, page_size, PROT_NONE);
+
+    linux_fiber* fiber = calloc(1, sizeof(linux_fiber));
+    if (fiber == NULL_PTR) {
+        munmap(mapping, mapping_size);
+        return FALSE;
+    }
+    fiber->stack_base = mapping;
+    fiber->stack_size = mapping_size;
+
+    // Build the context that _platform_fiber_swap expects so that the first switch returns into the trampoline. The
+    // stack pointer has to be 16 byte aligned after the return address is popped.
+    u8* stack_top = (u8*)mapping + mapping_size;
+    u64* context = (u64*)(stack_top - 16 - FIBER_CONTEXT_SLOTS * sizeof(u64));
+    context[0] = FIBER_DEFAULT_MXCSR | ((u64)FIBER_DEFAULT_FPU_CONTROL_WORD << 32);
+    context[1] = 0;              // r15
+    context[2] = 0;              // r14
+    context[3] = (u64)start;     // r13
+    context[4] = (u64)data;      // r12
+    context[5] = 0;              // rbx
+    context[6] = 0;              // rbp
+    context[7] = (u64)_platform_fiber_trampoline;
+    fiber->stack_pointer = context;
+
+    out_fiber->internal_handle = fiber;
+    return TRUE;
+}
+
+void platform_fiber_destroy(platform_fiber* fiber) {
+    if (fiber == NULL_PTR || fiber->internal_handle == NULL_PTR) {
+        return;
+    }
+
+    linux_fiber* internal = (linux_fiber*)fiber->internal_handle;
+    if (internal->stack_base != NULL_PTR) {
+        munmap(internal->stack_base, internal->stack_size);
+    }
+    free(internal);
+    fiber->internal_handle = NULL_PTR;
+}
+
+void platform_fiber_switch(platform_fiber* from, platform_fiber* to) {
+    linux_fiber* from_fiber = (linux_fiber*)from->internal_handle;
+    linux_fiber* to_fiber = (linux_fiber*)to->internal_handle;
+    _platform_fiber_swap(&from_fiber->stack_pointer, to_fiber->stack_pointer);
+}
+
+
+//*********************************************************************************************************************
+//****************************************************FILE I/O*********************************************************
+//*********************************************************************************************************************
+
+// Largest transfer made by a single system call. read and write never move more than 2GiB - 4KiB at once anyway.
+#define LINUX_IO_MAX_TRANSFER GiB(1)
+
+/**
+ * @brief An io_uring set up with raw system calls. The submission and completion rings are shared with the kernel:
+ * we produce submission entries and consume completion entries, the kernel does the opposite.
+ * @details user_data of every submission entry is the platform_io_request it belongs to. Transfers that come back
+ * short (or larger than LINUX_IO_MAX_TRANSFER) are resubmitted for the remainder when they are polled so that callers
+ * only ever see whole requests.
+ *
+ */
+typedef struct linux_io_uring {
+    i32 ring_fd;
+    platform_mutex lock;
+
+    // At most sq_entries requests are in flight so that there is always room for a resubmission
+    u32 capacity;
+    u32 in_flight;
+    // Entries written to the submission ring that the kernel has not consumed yet
+    u32 unsubmitted;
+
+    void* sq_ring;
+    u64 sq_ring_size;
+    void* cq_ring;
+    u64 cq_ring_size;
+    struct io_uring_sqe* sqes;
+    u64 sqes_size;
+
+    volatile u32* sq_head;
+    volatile u32* sq_tail;
+    u32 sq_mask;
+    u32* sq_array;
+
+    volatile u32* cq_head;
+    volatile u32* cq_tail;
+    u32 cq_mask;
+    struct io_uring_cqe* cqes;
+} linux_io_uring;
+
+static linux_io_uring* io_ring = NULL_PTR;
+static b8 io_use_pool = FALSE;
+
+static i32 _linux_file_descriptor(const platform_file* file);
+static b8 _linux_io_uring_create(u32 queue_depth);
+static void _linux_io_uring_destroy();
+static void _linux_io_uring_queue(platform_io_request* request);
+static void _linux_io_uring_enter(u32 min_complete);
+
+b8 platform_file_open(const char* path, u32 mode, platform_file* out_file) {
+    if (path == NULL_PTR || out_file == NULL_PTR) {
+        return FALSE;
+    }
+
+    i32 flags = O_CLOEXEC;
+    if ((mode & PLATFORM_FILE_MODE_READ) && (mode & PLATFORM_FILE_MODE_WRITE)) {
+        flags |= O_RDWR | O_CREAT;
+    } else if (mode & PLATFORM_FILE_MODE_WRITE) {
+        flags |= O_WRONLY | O_CREAT | O_TRUNC;
+    } else if (mode & PLATFORM_FILE_MODE_READ) {
+        flags |= O_RDONLY;
+    } else {
+        return FALSE;
+    }
+
+    i32 fd = open(path, flags, 0644);
+    if (fd == -1) {
+        return FALSE;
+    }
+    // Offset by one so that a zeroed handle is never a valid file
+    out_file->internal_handle = (void*)(i64)(fd + 1);
+    return TRUE;
+}
+
+void platform_file_close(platform_file* file) {
+    if (file == NULL_PTR || file->internal_handle == NULL_PTR) {
+        return;
+    }
+
+    close(_linux_file_descriptor(file));
+    file->internal_handle = NULL_PTR;
+}
+
+b8 platform_file_size(platform_file* file, u64* out_size) {
+    struct stat file_stat;
+    if (fstat(_linux_file_descriptor(file), &file_stat) == -1) {
+        return FALSE;
+    }
+    *out_size = (u64)file_stat.st_size;
+    return TRUE;
+}
+
+b8 platform_file_read(platform_file* file, u64 offset, u64 size, void* buffer, u64* out_bytes_read) {
+    i32 fd = _linux_file_descriptor(file);
+    u64 total = 0;
+    b8 succeeded = TRUE;
+    while (total < size) {
+        u64 chunk = size - total < LINUX_IO_MAX_TRANSFER ? size - total : LINUX_IO_MAX_TRANSFER;
+        ssize_t result = pread(fd, (u8*)buffer + total, chunk, (off_t)(offset + total));
+        if (result == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            succeeded = FALSE;
+            break;
+        }
+        if (result == 0) {
+            break;
+        }
+        total += (u64)result;
+    }
+
+    if (out_bytes_read != NULL_PTR) {
+        *out_bytes_read = total;
+    }
+    return succeeded;
+}
+
+b8 platform_file_write(platform_file* file, u64 offset, u64 size, const void* buffer, u64* out_bytes_written) {
+    i32 fd = _linux_file_descriptor(file);
+    u64 total = 0;
+    while (total < size) {
+        u64 chunk = size - total < LINUX_IO_MAX_TRANSFER ? size - total : LINUX_IO_MAX_TRANSFER;
+        ssize_t result = pwrite(fd, (const u8*)buffer + total, chunk, (off_t)(offset + total));
+        if (result == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        total += (u64)result;
+    }
+
+    if (out_bytes_written != NULL_PTR) {
+        *out_bytes_written = total;
+    }
+    return total == size;
+}
+
+b8 platform_file_map(platform_file* file, platform_file_map_mode mode, platform_file_mapping* out_mapping) {
+    if (out_mapping == NULL_PTR) {
+        return FALSE;
+    }
+
+    u64 size = 0;
+    if (!platform_file_size(file, &size) || size == 0) {
+        return FALSE;
+    }
+
+    // A private writable mapping of a read only descriptor is allowed since the writes never reach the file
+    i32 protection = mode == PLATFORM_FILE_MAP_COPY_ON_WRITE ? PROT_READ | PROT_WRITE : PROT_READ;
+    void* data = mmap(0, size, protection, MAP_PRIVATE, _linux_file_descriptor(file), 0);
+    if (data == MAP_FAILED) {
+        return FALSE;
+    }
+    out_mapping->data = data;
+    out_mapping->size = size;
+    out_mapping->mode = mode;
+    out_mapping->internal_handle = NULL_PTR;
+    return TRUE;
+}
+
+void platform_file_unmap(platform_file_mapping* mapping) {
+    if (mapping == NULL_PTR || mapping->data == NULL_PTR) {
+        return;
+    }
+
+    munmap(mapping->data, mapping->size);
+    mapping->data = NULL_PTR;
+    mapping->size = 0;
+}
+
+void platform_file_mapping_advise(platform_file_mapping* mapping,
+                                  u64 offset,
+                                  u64 size,
+                                  platform_file_access_hint hint) {
+    if (mapping == NULL_PTR || mapping->data == NULL_PTR || offset >= mapping->size) {
+        return;
+    }
+
+    // madvise wants a page aligned start
+    u64 page_size = platform_get_page_size();
+    u64 start = offset & ~(page_size - 1);
+    u64 end = size > mapping->size - offset ? mapping->size : offset + size;
+
+    i32 advice = MADV_NORMAL;
+    switch (hint) {
+        case PLATFORM_FILE_ACCESS_SEQUENTIAL:
+            advice = MADV_SEQUENTIAL;
+            break;
+        case PLATFORM_FILE_ACCESS_RANDOM:
+            advice = MADV_RANDOM;
+            break;
+        case PLATFORM_FILE_ACCESS_WILL_NEED:
+            advice = MADV_WILLNEED;
+            break;
+        default:
+            break;
+    }
+    madvise((u8*)mapping->data + start, end - start, advice);
+}
+
+b8 platform_io_initialize(u32 queue_depth) {
+    if (io_ring != NULL_PTR || io_use_pool || queue_depth == 0) {
+        return FALSE;
+    }
+
+    if (_linux_io_uring_create(queue_depth)) {
+        return TRUE;
+    }
+
+    // io_uring is missing on kernels older than 5.6 and is commonly disabled by seccomp filters in containers
+    if (!platform_io_pool_initialize(queue_depth)) {
+        return FALSE;
+    }
+    io_use_pool = TRUE;
+    return TRUE;
+}
+
+void platform_io_shutdown() {
+    if (io_use_pool) {
+        platform_io_pool_shutdown();
+        io_use_pool = FALSE;
+        return;
+    }
+    _linux_io_uring_destroy();
+}
+
+const char* platform_io_backend_name() {
+    if (io_use_pool) {
+        return "thread pool";
+    }
+    return io_ring != NULL_PTR ? "io_uring" : "none";
+}
+
+b8 platform_io_submit(platform_io_request* request) {
+    if (io_use_pool) {
+        return platform_io_pool_submit(request);
+    }
+
+    platform_mutex_lock(&io_ring->lock);
+    if (io_ring->in_flight == io_ring->capacity) {
+        platform_mutex_unlock(&io_ring->lock);
+        return FALSE;
+    }
+    io_ring->in_flight++;
+    request->bytes_transferred = 0;
+    request->succeeded = FALSE;
+    _linux_io_uring_queue(request);
+    _linux_io_uring_enter(0);
+    platform_mutex_unlock(&io_ring->lock);
+    return TRUE;
+}
+
+u32 platform_io_poll(platform_io_request** out_completed, u32 max_count) {
+    if (io_use_pool) {
+        return platform_io_pool_poll(out_completed, max_count);
+    }
+
+    platform_mutex_lock(&io_ring->lock);
+    if (io_ring->in_flight == 0) {
+        platform_mutex_unlock(&io_ring->lock);
+        return 0;
+    }
+
+    u32 head = *io_ring->cq_head;
+    u32 tail = __atomic_load_n(io_ring->cq_tail, __ATOMIC_ACQUIRE);
+    if (head == tail) {
+        // Some completions are only posted once the task enters the kernel, so give it the chance to run them
+        _linux_io_uring_enter(0);
+        tail = __atomic_load_n(io_ring->cq_tail, __ATOMIC_ACQUIRE);
+    }
+
+    u32 count = 0;
+    while (head != tail && count < max_count) {
+        struct io_uring_cqe* cqe = &io_ring->cqes[head & io_ring->cq_mask];
+        platform_io_request* request = (platform_io_request*)cqe->user_data;
+        i32 result = cqe->res;
+        head++;
+
+        if (result == -EINTR || result == -EAGAIN) {
+            _linux_io_uring_queue(request);
+            continue;
+        }
+
+        if (result > 0) {
+            request->bytes_transferred += (u64)result;
+            if (request->bytes_transferred < request->size) {
+                _linux_io_uring_queue(request);
+                continue;
+            }
+        }
+
+        // A read that returns 0 reached the end of the file, a write that returns 0 can not make progress
+        request->succeeded = result > 0 || (result == 0 && request->operation == PLATFORM_IO_OPERATION_READ);
+        out_completed[count++] = request;
+    }
+    __atomic_store_n(io_ring->cq_head, head, __ATOMIC_RELEASE);
+
+    io_ring->in_flight -= count;
+    if (io_ring->unsubmitted > 0) {
+        _linux_io_uring_enter(0);
+    }
+    platform_mutex_unlock(&io_ring->lock);
+    return count;
+}
+
+static i32 _linux_file_descriptor(const platform_file* file) { return (i32)(i64)file->internal_handle - 1; }
+
+static b8 _linux_io_uring_create(u32 queue_depth) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    i32 ring_fd = (i32)syscall(__NR_io_uring_setup, queue_depth, &params);
+    if (ring_fd < 0) {
+        return FALSE;
+    }
+
+    // IORING_OP_READ and IORING_OP_WRITE arrived in the same kernel (5.6) as this feature flag
+    if (!(params.features & IORING_FEAT_RW_CUR_POS)) {
+        close(ring_fd);
+        return FALSE;
+    }
+
+    linux_io_uring* ring = calloc(1, sizeof(linux_io_uring));
+    if (ring == NULL_PTR) {
+        close(ring_fd);
+        return FALSE;
+    }
+    ring->ring_fd = ring_fd;
+    ring->capacity = params.sq_entries;
+    io_ring = ring;
+
+    ring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(u32);
+    ring->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    // Since 5.4 both rings live in a single mapping
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        if (ring->cq_ring_size > ring->sq_ring_size) {
+            ring->sq_ring_size = ring->cq_ring_size;
+        }
+        ring->cq_ring_size = ring->sq_ring_size;
+    }
+
+    ring->sq_ring = mmap(
+        0, ring->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+    if (ring->sq_ring == MAP_FAILED) {
+        ring->sq_ring = NULL_PTR;
+        _linux_io_uring_destroy();
+        return FALSE;
+    }
+
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        ring->cq_ring = ring->sq_ring;
+    } else {
+        ring->cq_ring = mmap(
+            0, ring->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+        if (ring->cq_ring == MAP_FAILED) {
+            ring->cq_ring = NULL_PTR;
+            _linux_io_uring_destroy();
+            return FALSE;
+        }
+    }
+
+    ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes =
+        mmap(0, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED) {
+        ring->sqes = NULL_PTR;
+        _linux_io_uring_destroy();
+        return FALSE;
+    }
+
+    u8* sq = (u8*)ring->sq_ring;
+    ring->sq_head = (volatile u32*)(sq + params.sq_off.head);
+    ring->sq_tail = (volatile u32*)(sq + params.sq_off.tail);
+    ring->sq_mask = *(u32*)(sq + params.sq_off.ring_mask);
+    ring->sq_array = (u32*)(sq + params.sq_off.array);
+
+    u8* cq = (u8*)ring->cq_ring;
+    ring->cq_head = (volatile u32*)(cq + params.cq_off.head);
+    ring->cq_tail = (volatile u32*)(cq + params.cq_off.tail);
+    ring->cq_mask = *(u32*)(cq + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe*)(cq + params.cq_off.cqes);
+
+    if (!platform_mutex_create(&ring->lock)) {
+        _linux_io_uring_destroy();
+        return FALSE;
+    }
+    return TRUE;
+}
+
+static void _linux_io_uring_destroy() {
+    linux_io_uring* ring = io_ring;
+    if (ring == NULL_PTR) {
+        return;
+    }
+
+    // Wait for the requests in flight so that the kernel stops writing into buffers the caller is about to free
+    if (ring->lock.internal_handle != NULL_PTR) {
+        platform_io_request* completed[64];
+        while (ring->in_flight > 0) {
+            if (platform_io_poll(completed, 64) == 0) {
+                _linux_io_uring_enter(1);
+            }
+        }
+        platform_mutex_destroy(&ring->lock);
+    }
+
+    if (ring->sqes != NULL_PTR) {
+        munmap(ring->sqes, ring->sqes_size);
+    }
+    if (ring->cq_ring != NULL_PTR && ring->cq_ring != ring->sq_ring) {
+        munmap(ring->cq_ring, ring->cq_ring_size);
+    }
+    if (ring->sq_ring != NULL_PTR) {
+        munmap(ring->sq_ring, ring->sq_ring_size);
+    }
+    close(ring->ring_fd);
+    free(ring);
+    io_ring = NULL_PTR;
+}
+
+// Writes a submission entry for the part of the request that has not been transferred yet. Requires the lock.
+static void _linux_io_uring_queue(platform_io_request* request) {
+    u32 tail = *io_ring->sq_tail;
+    u32 index = tail & io_ring->sq_mask;
+    struct io_uring_sqe* sqe = &io_ring->sqes[index];
+
+    u64 remaining = request->size - request->bytes_transferred;
+    memset(sqe, 0, sizeof(struct io_uring_sqe));
+    sqe->opcode = request->operation == PLATFORM_IO_OPERATION_READ ? IORING_OP_READ : IORING_OP_WRITE;
+    sqe->fd = _linux_file_descriptor(&request->file);
+    sqe->addr = (u64)((u8*)request->buffer + request->bytes_transferred);
+    sqe->len = (u32)(remaining < LINUX_IO_MAX_TRANSFER ? remaining : LINUX_IO_MAX_TRANSFER);
+    sqe->off = request->offset + request->bytes_transferred;
+    sqe->user_data = (u64)request;
+
+    io_ring->sq_array[index] = index;
+    // The kernel may read the entry as soon as it sees the new tail
+    __atomic_store_n(io_ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    io_ring->unsubmitted++;
+}
+
+// Hands the unsubmitted entries to the kernel and waits for min_complete completions. Requires the lock.
+static void _linux_io_uring_enter(u32 min_complete) {
+    i32 result = (i32)syscall(
+        __NR_io_uring_enter, io_ring->ring_fd, io_ring->unsubmitted, min_complete, IORING_ENTER_GETEVENTS, 0, 0);
+    if (result > 0) {
+        // Entries that were not consumed (the kernel was out of memory) are handed over again on the next call
+        io_ring->unsubmitted -= (u32)result;
+    }
+}
+
+#endif
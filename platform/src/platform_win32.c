@@ -1,11 +1,13 @@
-#include <excpt.h>
 #include <string.h>
 
 #include "platform.h"
+#include "platform_io_pool.h"
 
 #if PLATFORM_WINDOWS
 
 #define WIN32_LEAN_AND_MEAN
+#include <excpt.h>
+#include <malloc.h>
 #include <stdlib.h>
 #include <windows.h>
 #include <windowsx.h>  // For GET_X_LPARAM and GET_Y_LPARAM
@@ -20,6 +22,13 @@ typedef struct internal_state {
 
     /** @brief handle to the window */
     HWND hWnd;
+
+    /** @brief TRUE when the platform was started without a window */
+    b8 headless;
+
+    /** @brief Framebuffer size reported when running headless */
+    u32 headless_width;
+    u32 headless_height;
 } internal_state;
 
 static f64 clock_frequency;
@@ -36,6 +45,7 @@ b8 platform_startup(
     plat_state = platform_state;
     internal_state* state = (internal_state*)platform_state->internal_state;
     state_ptr = state;
+    memset(state, 0, sizeof(internal_state));
 
     if (platform_state->on_key_event == NULL_PTR || platform_state->on_mouse_move == NULL_PTR ||
         platform_state->on_mouse_button_event == NULL_PTR || platform_state->on_mouse_scroll == NULL_PTR ||
@@ -133,6 +143,30 @@ b8 platform_startup(
     return TRUE;
 }
 
+b8 platform_startup_headless(platform_state* platform_state, u32 width, u32 height) {
+    platform_state->internal_state = malloc(sizeof(internal_state));
+    plat_state = platform_state;
+    internal_state* state = (internal_state*)platform_state->internal_state;
+    state_ptr = state;
+    memset(state, 0, sizeof(internal_state));
+
+    state->hInstance = GetModuleHandleA(0);
+    state->headless = TRUE;
+    state->headless_width = width;
+    state->headless_height = height;
+
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    clock_frequency = 1.0 / (f64)frequency.QuadPart;
+    QueryPerformanceCounter(&start_time);
+
+    return TRUE;
+}
+
+b8 platform_is_headless(platform_state* platform_state) {
+    return ((internal_state*)platform_state->internal_state)->headless;
+}
+
 void platform_shutdown(platform_state* platform_state) {
     internal_state* state = (internal_state*)platform_state->internal_state;
 
@@ -145,6 +179,11 @@ void platform_shutdown(platform_state* platform_state) {
 }
 
 b8 platform_pump_messages(platform_state* platform_state) {
+    internal_state* state = (internal_state*)platform_state->internal_state;
+    if (state->headless) {
+        return TRUE;
+    }
+
     MSG message;
 
     // We will be calling this function once every application loop. Windows has a stack of messages we need to handle.
@@ -157,11 +196,22 @@ b8 platform_pump_messages(platform_state* platform_state) {
     return TRUE;
 }
 
-void* platform_allocate(u64 size, b8 aligned) {
-    return malloc(size);  // TODO: Temporary
+void* platform_allocate(u64 size, u64 alignment) {
+    // malloc already returns 16 byte aligned blocks on x64
+    if (alignment <= PLATFORM_DEFAULT_ALIGNMENT) {
+        return malloc(size);
+    }
+    return _aligned_malloc(size, alignment);
 }
 
-void platform_free(void* block, b8 aligned) { free(block); }
+void platform_free(void* block, u64 alignment) {
+    // Blocks from _aligned_malloc have to be freed with _aligned_free
+    if (alignment <= PLATFORM_DEFAULT_ALIGNMENT) {
+        free(block);
+    } else {
+        _aligned_free(block);
+    }
+}
 
 void* platform_zero_memory(void* block, u64 size) { return memset(block, 0, size); }
 
@@ -234,12 +284,492 @@ void platform_get_handle_info(u64* out_size, void* memory) {
 }
 
 void platform_get_framebuffer_size(u32* width, u32* height) {
+    if (state_ptr->headless) {
+        *width = state_ptr->headless_width;
+        *height = state_ptr->headless_height;
+        return;
+    }
+
     RECT rect;
     GetClientRect(state_ptr->hWnd, &rect);
     *width = rect.right - rect.left;
     *height = rect.bottom - rect.top;
 }
 
+u64 platform_get_page_size() {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (u64)info.dwPageSize;
+}
+
+u64 platform_get_large_page_size() { return (u64)GetLargePageMinimum(); }
+
+void* platform_reserve(u64 size, b8 large_pages) {
+    // MEM_LARGE_PAGES has to be reserved and committed in one go and needs the lock pages privilege, so reservations
+    // that commit incrementally always use regular pages on windows
+    (void)large_pages;
+    return VirtualAlloc(0, (SIZE_T)size, MEM_RESERVE, PAGE_NOACCESS);
+}
+
+b8 platform_commit(void* address, u64 size) {
+    return VirtualAlloc(address, (SIZE_T)size, MEM_COMMIT, PAGE_READWRITE) != NULL;
+}
+
+void platform_decommit(void* address, u64 size) { VirtualFree(address, (SIZE_T)size, MEM_DECOMMIT); }
+
+void platform_release(void* address, u64 size) {
+    // The size has to be 0 when releasing, windows remembers the size of the reservation
+    (void)size;
+    VirtualFree(address, 0, MEM_RELEASE);
+}
+
+b8 platform_thread_create(PFN_thread_start start, void* data, platform_thread* out_thread) {
+    if (start == NULL_PTR || out_thread == NULL_PTR) {
+        return FALSE;
+    }
+
+    DWORD thread_id = 0;
+    // PFN_thread_start has the same signature and calling convention as LPTHREAD_START_ROUTINE on x64
+    HANDLE handle = CreateThread(0, 0, (LPTHREAD_START_ROUTINE)start, data, 0, &thread_id);
+    if (handle == NULL) {
+        return FALSE;
+    }
+
+    out_thread->internal_handle = handle;
+    out_thread->thread_id = thread_id;
+    return TRUE;
+}
+
+void platform_thread_join(platform_thread* thread) {
+    if (thread == NULL_PTR || thread->internal_handle == NULL_PTR) {
+        return;
+    }
+
+    WaitForSingleObject((HANDLE)thread->internal_handle, INFINITE);
+    CloseHandle((HANDLE)thread->internal_handle);
+    thread->internal_handle = NULL_PTR;
+    thread->thread_id = 0;
+}
+
+void platform_thread_yield() { SwitchToThread(); }
+
+u64 platform_thread_current_id() { return (u64)GetCurrentThreadId(); }
+
+b8 platform_thread_set_affinity(platform_thread* thread, u64 affinity_mask) {
+    HANDLE handle = thread != NULL_PTR ? (HANDLE)thread->internal_handle : GetCurrentThread();
+    return SetThreadAffinityMask(handle, (DWORD_PTR)affinity_mask) != 0;
+}
+
+b8 platform_thread_set_name(platform_thread* thread, const char* name) {
+    // SetThreadDescription only exists on Windows 10 1607 and newer so it is looked up at runtime
+    typedef HRESULT(WINAPI * PFN_set_thread_description)(HANDLE, PCWSTR);
+    static PFN_set_thread_description set_thread_description = NULL_PTR;
+    if (set_thread_description == NULL_PTR) {
+        set_thread_description =
+            (PFN_set_thread_description)GetProcAddress(GetModuleHandleA("kernel32.dll"), "SetThreadDescription");
+        if (set_thread_description == NULL_PTR) {
+            return FALSE;
+        }
+    }
+
+    WCHAR wide_name[64];
+    if (MultiByteToWideChar(CP_UTF8, 0, name, -1, wide_name, 64) == 0) {
+        return FALSE;
+    }
+    HANDLE handle = thread != NULL_PTR ? (HANDLE)thread->internal_handle : GetCurrentThread();
+    return SUCCEEDED(set_thread_description(handle, wide_name));
+}
+
+u32 platform_get_processor_count() {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (u32)info.dwNumberOfProcessors;
+}
+
+b8 platform_semaphore_create(u32 initial_count, u32 max_count, platform_semaphore* out_semaphore) {
+    if (out_semaphore == NULL_PTR) {
+        return FALSE;
+    }
+
+    HANDLE handle = CreateSemaphoreA(0, (LONG)initial_count, (LONG)max_count, 0);
+    if (handle == NULL) {
+        return FALSE;
+    }
+
+    out_semaphore->internal_handle = handle;
+    return TRUE;
+}
+
+void platform_semaphore_destroy(platform_semaphore* semaphore) {
+    if (semaphore == NULL_PTR || semaphore->internal_handle == NULL_PTR) {
+        return;
+    }
+
+    CloseHandle((HANDLE)semaphore->internal_handle);
+    semaphore->internal_handle = NULL_PTR;
+}
+
+void platform_semaphore_signal(platform_semaphore* semaphore, u32 count) {
+    ReleaseSemaphore((HANDLE)semaphore->internal_handle, (LONG)count, 0);
+}
+
+b8 platform_semaphore_wait(platform_semaphore* semaphore, u32 timeout_ms) {
+    DWORD timeout = timeout_ms == PLATFORM_WAIT_INFINITE ? INFINITE : (DWORD)timeout_ms;
+    return WaitForSingleObject((HANDLE)semaphore->internal_handle, timeout) == WAIT_OBJECT_0;
+}
+
+b8 platform_mutex_create(platform_mutex* out_mutex) {
+    if (out_mutex == NULL_PTR) {
+        return FALSE;
+    }
+
+    // Slim reader/writer locks are a single pointer sized word that only enters the kernel when contended
+    SRWLOCK* lock = malloc(sizeof(SRWLOCK));
+    if (lock == NULL) {
+        return FALSE;
+    }
+    InitializeSRWLock(lock);
+    out_mutex->internal_handle = lock;
+    return TRUE;
+}
+
+void platform_mutex_destroy(platform_mutex* mutex) {
+    if (mutex == NULL_PTR || mutex->internal_handle == NULL_PTR) {
+        return;
+    }
+
+    free(mutex->internal_handle);
+    mutex->internal_handle = NULL_PTR;
+}
+
+void platform_mutex_lock(platform_mutex* mutex) { AcquireSRWLockExclusive((SRWLOCK*)mutex->internal_handle); }
+
+b8 platform_mutex_try_lock(platform_mutex* mutex) {
+    return TryAcquireSRWLockExclusive((SRWLOCK*)mutex->internal_handle) != 0;
+}
+
+void platform_mutex_unlock(platform_mutex* mutex) { ReleaseSRWLockExclusive((SRWLOCK*)mutex->internal_handle); }
+
+b8 platform_condition_create(platform_condition* out_condition) {
+    if (out_condition == NULL_PTR) {
+        return FALSE;
+    }
+
+    CONDITION_VARIABLE* condition = malloc(sizeof(CONDITION_VARIABLE));
+    if (condition == NULL) {
+        return FALSE;
+    }
+    InitializeConditionVariable(condition);
+    out_condition->internal_handle = condition;
+    return TRUE;
+}
+
+void platform_condition_destroy(platform_condition* condition) {
+    if (condition == NULL_PTR || condition->internal_handle == NULL_PTR) {
+        return;
+    }
+
+    free(condition->internal_handle);
+    condition->internal_handle = NULL_PTR;
+}
+
+b8 platform_condition_wait(platform_condition* condition, platform_mutex* mutex, u32 timeout_ms) {
+    DWORD timeout = timeout_ms == PLATFORM_WAIT_INFINITE ? INFINITE : (DWORD)timeout_ms;
+    return SleepConditionVariableSRW(
+               (CONDITION_VARIABLE*)condition->internal_handle, (SRWLOCK*)mutex->internal_handle, timeout, 0) != 0;
+}
+
+void platform_condition_signal(platform_condition* condition) {
+    WakeConditionVariable((CONDITION_VARIABLE*)condition->internal_handle);
+}
+
+void platform_condition_broadcast(platform_condition* condition) {
+    WakeAllConditionVariable((CONDITION_VARIABLE*)condition->internal_handle);
+}
+
+b8 platform_event_create(b8 manual_reset, b8 initially_set, platform_event* out_event) {
+    if (out_event == NULL_PTR) {
+        return FALSE;
+    }
+
+    HANDLE handle = CreateEventA(0, manual_reset ? TRUE : FALSE, initially_set ? TRUE : FALSE, 0);
+    if (handle == NULL) {
+        return FALSE;
+    }
+    out_event->internal_handle = handle;
+    return TRUE;
+}
+
+void platform_event_destroy(platform_event* event) {
+    if (event == NULL_PTR || event->internal_handle == NULL_PTR) {
+        return;
+    }
+
+    CloseHandle((HANDLE)event->internal_handle);
+    event->internal_handle = NULL_PTR;
+}
+
+void platform_event_set(platform_event* event) { SetEvent((HANDLE)event->internal_handle); }
+
+void platform_event_reset(platform_event* event) { ResetEvent((HANDLE)event->internal_handle); }
+
+b8 platform_event_wait(platform_event* event, u32 timeout_ms) {
+    DWORD timeout = timeout_ms == PLATFORM_WAIT_INFINITE ? INFINITE : (DWORD)timeout_ms;
+    return WaitForSingleObject((HANDLE)event->internal_handle, timeout) == WAIT_OBJECT_0;
+}
+
+b8 platform_tls_create(platform_tls* out_tls) {
+    if (out_tls == NULL_PTR) {
+        return FALSE;
+    }
+
+    DWORD index = TlsAlloc();
+    if (index == TLS_OUT_OF_INDEXES) {
+        return FALSE;
+    }
+    out_tls->index = index;
+    return TRUE;
+}
+
+void platform_tls_destroy(platform_tls* tls) { TlsFree((DWORD)tls->index); }
+
+void platform_tls_set(platform_tls* tls, void* value) { TlsSetValue((DWORD)tls->index, value); }
+
+void* platform_tls_get(platform_tls* tls) { return TlsGetValue((DWORD)tls->index); }
+
+b8 platform_fiber_convert_thread(platform_fiber* out_fiber) {
+    if (out_fiber == NULL_PTR) {
+        return FALSE;
+    }
+
+    LPVOID fiber = ConvertThreadToFiber(0);
+    if (fiber == NULL) {
+        return FALSE;
+    }
+
+    out_fiber->internal_handle = fiber;
+    return TRUE;
+}
+
+void platform_fiber_convert_to_thread(platform_fiber* fiber) {
+    ConvertFiberToThread();
+    fiber->internal_handle = NULL_PTR;
+}
+
+b8 platform_fiber_create(u64 stack_size, PFN_fiber_start start, void* data, platform_fiber* out_fiber) {
+    if (start == NULL_PTR || out_fiber == NULL_PTR) {
+        return FALSE;
+    }
+
+    // PFN_fiber_start has the same signature and calling convention as LPFIBER_START_ROUTINE on x64
+    LPVOID fiber = CreateFiber((SIZE_T)stack_size, (LPFIBER_START_ROUTINE)start, data);
+    if (fiber == NULL) {
+        return FALSE;
+    }
+
+    out_fiber->internal_handle = fiber;
+    return TRUE;
+}
+
+void platform_fiber_destroy(platform_fiber* fiber) {
+    if (fiber == NULL_PTR || fiber->internal_handle == NULL_PTR) {
+        return;
+    }
+
+    DeleteFiber(fiber->internal_handle);
+    fiber->internal_handle = NULL_PTR;
+}
+
+void platform_fiber_switch(platform_fiber* from, platform_fiber* to) {
+    // Windows keeps track of the current fiber itself
+    (void)from;
+    SwitchToFiber(to->internal_handle);
+}
+
+// Largest transfer made by a single ReadFile or WriteFile call, which take a 32 bit size
+#define WIN32_IO_MAX_TRANSFER GiB(1)
+
+static b8 win32_io_initialized = FALSE;
+
+b8 platform_file_open(const char* path, u32 mode, platform_file* out_file) {
+    if (path == NULL_PTR || out_file == NULL_PTR) {
+        return FALSE;
+    }
+
+    DWORD access = 0;
+    DWORD creation = OPEN_EXISTING;
+    if ((mode & PLATFORM_FILE_MODE_READ) && (mode & PLATFORM_FILE_MODE_WRITE)) {
+        access = GENERIC_READ | GENERIC_WRITE;
+        creation = OPEN_ALWAYS;
+    } else if (mode & PLATFORM_FILE_MODE_WRITE) {
+        access = GENERIC_WRITE;
+        creation = CREATE_ALWAYS;
+    } else if (mode & PLATFORM_FILE_MODE_READ) {
+        access = GENERIC_READ;
+    } else {
+        return FALSE;
+    }
+
+    HANDLE handle = CreateFileA(path, access, FILE_SHARE_READ, 0, creation, FILE_ATTRIBUTE_NORMAL, 0);
+    if (handle == INVALID_HANDLE_VALUE) {
+        return FALSE;
+    }
+    out_file->internal_handle = handle;
+    return TRUE;
+}
+
+void platform_file_close(platform_file* file) {
+    if (file == NULL_PTR || file->internal_handle == NULL_PTR) {
+        return;
+    }
+
+    CloseHandle((HANDLE)file->internal_handle);
+    file->internal_handle = NULL_PTR;
+}
+
+b8 platform_file_size(platform_file* file, u64* out_size) {
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx((HANDLE)file->internal_handle, &size)) {
+        return FALSE;
+    }
+    *out_size = (u64)size.QuadPart;
+    return TRUE;
+}
+
+b8 platform_file_read(platform_file* file, u64 offset, u64 size, void* buffer, u64* out_bytes_read) {
+    u64 total = 0;
+    b8 succeeded = TRUE;
+    while (total < size) {
+        // The offset in the OVERLAPPED structure makes the read positional on a synchronous handle
+        OVERLAPPED overlapped = {0};
+        overlapped.Offset = (DWORD)(offset + total);
+        overlapped.OffsetHigh = (DWORD)((offset + total) >> 32);
+        DWORD chunk = (DWORD)(size - total < WIN32_IO_MAX_TRANSFER ? size - total : WIN32_IO_MAX_TRANSFER);
+        DWORD bytes_read = 0;
+        if (!ReadFile((HANDLE)file->internal_handle, (u8*)buffer + total, chunk, &bytes_read, &overlapped)) {
+            succeeded = GetLastError() == ERROR_HANDLE_EOF;
+            break;
+        }
+        if (bytes_read == 0) {
+            break;
+        }
+        total += bytes_read;
+    }
+
+    if (out_bytes_read != NULL_PTR) {
+        *out_bytes_read = total;
+    }
+    return succeeded;
+}
+
+b8 platform_file_write(platform_file* file, u64 offset, u64 size, const void* buffer, u64* out_bytes_written) {
+    u64 total = 0;
+    while (total < size) {
+        OVERLAPPED overlapped = {0};
+        overlapped.Offset = (DWORD)(offset + total);
+        overlapped.OffsetHigh = (DWORD)((offset + total) >> 32);
+        DWORD chunk = (DWORD)(size - total < WIN32_IO_MAX_TRANSFER ? size - total : WIN32_IO_MAX_TRANSFER);
+        DWORD bytes_written = 0;
+        if (!WriteFile(
+                (HANDLE)file->internal_handle, (const u8*)buffer + total, chunk, &bytes_written, &overlapped) ||
+            bytes_written == 0) {
+            break;
+        }
+        total += bytes_written;
+    }
+
+    if (out_bytes_written != NULL_PTR) {
+        *out_bytes_written = total;
+    }
+    return total == size;
+}
+
+b8 platform_file_map(platform_file* file, platform_file_map_mode mode, platform_file_mapping* out_mapping) {
+    if (out_mapping == NULL_PTR) {
+        return FALSE;
+    }
+
+    u64 size = 0;
+    if (!platform_file_size(file, &size) || size == 0) {
+        return FALSE;
+    }
+
+    b8 copy_on_write = mode == PLATFORM_FILE_MAP_COPY_ON_WRITE;
+    HANDLE mapping = CreateFileMappingA(
+        (HANDLE)file->internal_handle, 0, copy_on_write ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, 0);
+    if (mapping == NULL) {
+        return FALSE;
+    }
+    void* data = MapViewOfFile(mapping, copy_on_write ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0);
+    if (data == NULL) {
+        CloseHandle(mapping);
+        return FALSE;
+    }
+    out_mapping->data = data;
+    out_mapping->size = size;
+    out_mapping->mode = mode;
+    out_mapping->internal_handle = mapping;
+    return TRUE;
+}
+
+void platform_file_unmap(platform_file_mapping* mapping) {
+    if (mapping == NULL_PTR || mapping->data == NULL_PTR) {
+        return;
+    }
+
+    UnmapViewOfFile(mapping->data);
+    CloseHandle((HANDLE)mapping->internal_handle);
+    mapping->data = NULL_PTR;
+    mapping->size = 0;
+    mapping->internal_handle = NULL_PTR;
+}
+
+void platform_file_mapping_advise(platform_file_mapping* mapping,
+                                  u64 offset,
+                                  u64 size,
+                                  platform_file_access_hint hint) {
+    if (mapping == NULL_PTR || mapping->data == NULL_PTR || offset >= mapping->size) {
+        return;
+    }
+
+    // Windows only takes access patterns when the file is opened, the one thing it can do for a mapping is to start
+    // reading a range ahead of time
+    if (hint != PLATFORM_FILE_ACCESS_WILL_NEED) {
+        return;
+    }
+
+    u64 end = size > mapping->size - offset ? mapping->size : offset + size;
+    WIN32_MEMORY_RANGE_ENTRY range;
+    range.VirtualAddress = (u8*)mapping->data + offset;
+    range.NumberOfBytes = (SIZE_T)(end - offset);
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+}
+
+b8 platform_io_initialize(u32 queue_depth) {
+    // TODO: Overlapped I/O on a completion port would avoid the extra threads
+    if (win32_io_initialized || !platform_io_pool_initialize(queue_depth)) {
+        return FALSE;
+    }
+    win32_io_initialized = TRUE;
+    return TRUE;
+}
+
+void platform_io_shutdown() {
+    if (!win32_io_initialized) {
+        return;
+    }
+    platform_io_pool_shutdown();
+    win32_io_initialized = FALSE;
+}
+
+const char* platform_io_backend_name() { return win32_io_initialized ? "thread pool" : "none"; }
+
+b8 platform_io_submit(platform_io_request* request) { return platform_io_pool_submit(request); }
+
+u32 platform_io_poll(platform_io_request** out_completed, u32 max_count) {
+    return platform_io_pool_poll(out_completed, max_count);
+}
+
 //*********************************************************************************************************************
 //***********************************************PRIVATE FUNCTIONS*****************************************************
 //*********************************************************************************************************************
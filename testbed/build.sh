@@ -0,0 +1,20 @@
+#!/bin/bash
+# Build script for the testbed
+set -e
+
+# Get a list of all the .c files
+cFileNames=$(find . -type f -name "*.c")
+
+assembly="testbed"
+compilerFlags="-g -O3 -fno-math-errno -fno-trapping-math"
+# -Wall -Werror
+includeFlags="-Isrc -I../fracture/src -I../fracture/includes"
+# The rpath lets the executable find libfracture.so next to it in bin
+linkerFlags="-L../bin/ -lfracture -Wl,-rpath,\$ORIGIN"
+defines="-D_DEBUG -DFR_IMPORT -D_ENABLE_ASSERTS -D_SIMD -DFR_MATH_FORCE_INLINE -D_RNG_XORWOW -D_VEC3_SIMD"
+
+echo "Building $assembly..."
+clang $cFileNames $compilerFlags -o ../bin/$assembly $defines $includeFlags $linkerFlags
+
+echo "Writing the compile_flags.txt file"
+echo $includeFlags $defines $compilerFlags | tr " " "\n" > compile_flags.txt
@@ -12,6 +12,17 @@ b8 create_client_application(application_handle* app_handle) {
     app_handle->app_config.start_y_pos = 100;
     app_handle->app_config.target_frame_rate = 60;
     app_handle->app_config.lock_frame_rate = FALSE;
+    app_handle->app_config.fixed_timestep = FALSE;
+    app_handle->app_config.fixed_tick_rate = 60.0;
+    app_handle->app_config.max_catchup_steps = 5;
+    app_handle->app_config.headless = FALSE;
+    app_handle->app_config.job_config.worker_count = 0;
+    app_handle->app_config.job_config.use_fibers = TRUE;
+    app_handle->app_config.job_config.fiber_count = 0;
+    app_handle->app_config.job_config.fiber_stack_size = 0;
+    app_handle->app_config.resource_config.max_resources = 0;
+    app_handle->app_config.resource_config.memory_budget = 0;
+    app_handle->app_config.resource_config.root_path = NULL_PTR;
 
     logging_config config = {0};
     config.enable_console = TRUE;
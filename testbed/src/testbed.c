@@ -1,18 +1,22 @@
 #include "testbed.h"
 
+#include <math.h>
+
 #include "fracture/core/containers/llist.h"
+#include "fracture/core/library/math/transcendental.h"
 #include "fracture/core/library/random/fr_random.h"
 #include "fracture/core/systems/clock.h"
 #include "fracture/core/systems/event.h"
 #include "fracture/core/systems/fracture_memory.h"
 #include "fracture/core/systems/input.h"
+#include "fracture/core/systems/job_system.h"
 #include "fracture/engine/application_types.h"
 #include "fracture/renderer/renderer_types.h"
-
-#define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
+#include "fracture/resources/image_loader.h"
+#include "fracture/resources/resource_system.h"
 
 #define TEST_LEN 10000000
+#define TEST_LOG_JOBS 16
 
 typedef struct test_node {
     struct llist_node* node;
@@ -24,12 +28,15 @@ typedef struct testbed_internal_state {
     struct llist_head* test_llist_head;
     struct llist_head* test_llist_head_2;
     fr_rng_config rng_state;
+    resource_handle test_image;
 } testbed_internal_state;
 
 static testbed_internal_state* state = NULL_PTR;
 static u32* transform_array = NULL_PTR;
 
 static inline b8 testbed_add_test_node(struct llist_head* head, u32 data);
+static void testbed_log_job(void* data);
+static b8 testbed_check_sincos_special_values();
 
 b8 testbed_on_key_pressed(u16 event_code, void* sender, void* listener_instance, event_data data);
 
@@ -86,18 +93,36 @@ b8 testbed_initialize(application_handle* app_handle) {
         FR_INFO("LLIST 2 AFTER MERGE: %d", ((test_node*)pos)->data);
     }
 
+    // Fiber logging test: with use_fibers the jobs run on fiber stacks and have to be able to log from them
+    job_desc log_jobs[TEST_LOG_JOBS];
+    for (u32 i = 0; i < TEST_LOG_JOBS; ++i) {
+        log_jobs[i].entry = testbed_log_job;
+        log_jobs[i].data = (void*)(u64)i;
+    }
+    job_counter log_counter = {0};
+    fr_job_run(log_jobs, TEST_LOG_JOBS, &log_counter);
+    fr_job_wait(&log_counter);
+    FR_INFO("Logged from %u jobs", TEST_LOG_JOBS);
+
+    // Transcendental special value test
+    if (!testbed_check_sincos_special_values()) {
+        FR_ERROR("sin or cos of a special value does not match the C library");
+    }
+
     clock clock;
     fr_clock_start(&clock);
 
-
-    int width, height, channels;
-    u8* output = stbi_load("test2.png", &width, &height, &channels, 4);
+    // The image is decoded on a worker thread, waiting here only to time the load
+    state->test_image = fr_resource_acquire("test2.png", RESOURCE_TYPE_IMAGE);
+    resource_states image_state = fr_resource_wait(state->test_image);
     fr_clock_update(&clock);
     const f64 time_seconds = fr_clock_get_elapsed_time_ms(&clock);
-    if (output == NULL) {
+    if (image_state != RESOURCE_STATE_LOADED) {
         FR_FATAL("Failed to load image");
+    } else {
+        const image* test_image = fr_resource_data(state->test_image, NULL_PTR);
+        FR_INFO("Time to load image: %f (%ux%u)", time_seconds, test_image->width, test_image->height);
     }
-    FR_INFO("Time to load image: %f", time_seconds);
 
     return TRUE;
 }
@@ -105,6 +130,7 @@ b8 testbed_initialize(application_handle* app_handle) {
 b8 testbed_shutdown(application_handle* app_handle) {
     testbed_state* app_state = (testbed_state*)app_handle->application_data;
     app_state->is_running = FALSE;
+    fr_resource_release(state->test_image);
     fr_memory_free(state, sizeof(testbed_internal_state), MEMORY_TYPE_APPLICATION);
     fr_event_deregister_handler(EVENT_CODE_KEY_PRESS, app_handle, testbed_on_key_pressed);
     fr_event_deregister_handler(EVENT_CODE_KEY_RELEASE, app_handle, testbed_on_key_pressed);
@@ -129,7 +155,7 @@ b8 testbed_update(application_handle* app_handle, f64 delta_time) {
     return TRUE;
 }
 
-b8 testbed_render(application_handle* app_handle, f64 delta_time) { return TRUE; }
+b8 testbed_render(application_handle* app_handle, f64 delta_time, f64 alpha) { return TRUE; }
 
 b8 testbed_on_resize(application_handle* app_handle, u32 width, u32 height) { return TRUE; }
 
@@ -208,3 +234,32 @@ static inline b8 testbed_add_test_node(struct llist_head* llist, u32 data) {
     fr_core_llist_push((struct llist_node*)node, llist);
     return TRUE;
 }
+
+static void testbed_log_job(void* data) {
+    u64 index = (u64)data;
+    FR_INFO("Logging from job %llu", index);
+    FR_INFO_DETAILED("Detailed logging from job %llu", index);
+}
+
+static b8 testbed_check_sincos_special_values() {
+    // Two of each so that both the full vectors and the tails see them
+    f32 values[] = {0.0f, -0.0f, INFINITY, -INFINITY, NAN, 0.0f, -0.0f, INFINITY, -INFINITY, NAN};
+    const u32 count = sizeof(values) / sizeof(values[0]);
+    f32 sines[sizeof(values) / sizeof(values[0])];
+    f32 cosines[sizeof(values) / sizeof(values[0])];
+    b8 result = TRUE;
+    for (u32 accuracy = FR_MATH_ACCURACY_PRECISE; accuracy <= FR_MATH_ACCURACY_FAST; ++accuracy) {
+        fr_sincos_array(values, sines, cosines, count, (math_accuracy)accuracy);
+        for (u32 i = 0; i < count; ++i) {
+            // sin(+-0) is +-0 and cos(+-0) is 1, both are NaN for infinity and NaN
+            b8 ok = isfinite(values[i])
+                        ? sines[i] == 0.0f && signbit(sines[i]) == signbit(values[i]) && cosines[i] == 1.0f
+                        : isnan(sines[i]) && isnan(cosines[i]);
+            if (!ok) {
+                FR_ERROR("sincos(%f) = (%f, %f) with accuracy %u", values[i], sines[i], cosines[i], accuracy);
+                result = FALSE;
+            }
+        }
+    }
+    return result;
+}
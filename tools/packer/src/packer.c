@@ -0,0 +1,137 @@
+/**
+ * @file packer.c
+ * @author Aditya Rajagopal
+ * @brief Command line tool that bundles loose resource files into a resource pack.
+ * @details Usage: packer [-c] [-r root] <output pack> <files...>
+ *
+ *     -c        LZ4 compress the resources that get noticeably smaller
+ *     -r root   strip root from the start of the paths to form the resource names
+ *
+ * Resources are named by their path with forward slashes, so "assets\textures\wall.png" packed with -r assets is
+ * looked up as "textures/wall.png" on every platform.
+ * @version 0.0.1
+ * @date 2024-04-22
+ *
+ * @copyright Fracture Game Engine is Copyright (c) Aditya Rajagopal 2024-2024
+ *
+ */
+#include <fracture.h>
+
+// Longest resource name the packer accepts
+#define PACKER_MAX_NAME_LENGTH 1024
+
+static void _packer_usage() { FR_INFO("Usage: packer [-c] [-r root] <output pack> <files...>"); }
+
+static b8 _packer_make_name(const char* path, const char* root, char* out_name) {
+    u64 root_length = root != NULL_PTR ? fr_string_length(root) : 0;
+    const char* name = path;
+    if (root_length > 0) {
+        b8 inside = TRUE;
+        for (u64 i = 0; inside && i < root_length; ++i) {
+            inside = path[i] == root[i];
+        }
+        // The root has to end at a path separator, -r assets must not turn assets2/x into 2/x
+        char last = root[root_length - 1];
+        char next = inside ? path[root_length] : 0;
+        if (!inside || (last != '/' && last != '\\' && next != 0 && next != '/' && next != '\\')) {
+            FR_ERROR("%s is not inside %s", path, root);
+            return FALSE;
+        }
+        name = path + root_length;
+    }
+
+    while (*name == '/' || *name == '\\') {
+        name++;
+    }
+
+    u64 length = 0;
+    for (; name[length] != 0; ++length) {
+        if (length + 1 == PACKER_MAX_NAME_LENGTH) {
+            FR_ERROR("Resource name is too long: %s", path);
+            return FALSE;
+        }
+        out_name[length] = name[length] == '\\' ? '/' : name[length];
+    }
+    out_name[length] = 0;
+    return length > 0;
+}
+
+static b8 _packer_add_file(resource_pack_writer* writer, const char* path, const char* root, b8 compress) {
+    char name[PACKER_MAX_NAME_LENGTH];
+    if (!_packer_make_name(path, root, name)) {
+        return FALSE;
+    }
+
+    file_handle file;
+    u64 size = 0;
+    if (!fr_file_open(path, FILE_MODE_READ, &file)) {
+        return FALSE;
+    }
+    if (!fr_file_size(&file, &size)) {
+        FR_ERROR("Failed to get the size of %s", path);
+        fr_file_close(&file);
+        return FALSE;
+    }
+
+    // Allocate at least one byte so that empty files can be packed too
+    u8* data = fr_memory_allocate(size > 0 ? size : 1, MEMORY_TYPE_APPLICATION);
+    u64 bytes_read = 0;
+    b8 added = fr_file_read(&file, 0, size, data, &bytes_read) && bytes_read == size;
+    fr_file_close(&file);
+    if (!added) {
+        FR_ERROR("Failed to read %s", path);
+    } else {
+        added = fr_resource_pack_writer_add(writer, name, data, size, compress);
+    }
+    fr_memory_free(data, size > 0 ? size : 1, MEMORY_TYPE_APPLICATION);
+    return added;
+}
+
+int main(int argc, char** argv) {
+    fr_memory_initialize();
+    logging_config log_config = {0};
+    log_config.enable_console = TRUE;
+    log_config.logging_flags = FR_LOG_LEVEL_DEFAULT;
+    fr_logging_initialize(&log_config);
+
+    b8 compress = FALSE;
+    const char* root = NULL_PTR;
+    int arg = 1;
+    for (; arg < argc && argv[arg][0] == '-'; ++arg) {
+        if (argv[arg][1] == 'c' && argv[arg][2] == 0) {
+            compress = TRUE;
+        } else if (argv[arg][1] == 'r' && argv[arg][2] == 0 && arg + 1 < argc) {
+            root = argv[++arg];
+        } else {
+            _packer_usage();
+            return 1;
+        }
+    }
+    if (argc - arg < 2) {
+        _packer_usage();
+        return 1;
+    }
+
+    const char* output = argv[arg++];
+    resource_pack_writer writer;
+    if (!fr_resource_pack_writer_begin(output, &writer)) {
+        return 1;
+    }
+
+    for (; arg < argc; ++arg) {
+        if (!_packer_add_file(&writer, argv[arg], root, compress)) {
+            fr_resource_pack_writer_abort(&writer);
+            return 1;
+        }
+    }
+
+    u32 entry_count = (u32)darray_length(writer.entries);
+    if (!fr_resource_pack_writer_end(&writer)) {
+        return 1;
+    }
+    FR_INFO("Packed %u resources into %s", entry_count, output);
+
+    fr_logging_shutdown();
+    fr_memory_shutdown();
+    return 0;
+}
@@ -0,0 +1,23 @@
+REM Build script for the texture converter
+@ECHO OFF
+SetLocal EnableDelayedExpansion
+
+REM Get a list of all the .c files
+SET cFileNames=
+FOR /R %%f in (*.c) do (
+    SET cFileNames=!cFileNames! %%f
+)
+
+SET assembly=texconv
+SET compilerFlags=-g -O3
+REM -Wall -Werror
+SET includeFlags=-Isrc -I..\..\fracture\src -I..\..\fracture\includes
+SET linkerFlags=-L../../bin/ -lfracture.lib
+SET defines=-D_DEBUG -DFR_IMPORT -D_ENABLE_ASSERTS -D_SIMD -DFR_MATH_FORCE_INLINE -D_RNG_XORWOW -D_VEC3_SIMD
+
+ECHO "Building %assembly%...."
+clang %cFileNames% %compilerFlags% -o ../../bin/%assembly%.exe %defines% %includeFlags% %linkerFlags%
+
+REM "Writing the compile_flags.txt file"
+ECHO "Writing the compile_flags.txt file"
+echo %includeFlags% %defines% %compilerFlags% | sed -e "s/-I/-I\\/g" -e "s/ /\n/g" -e "s/-I\\C/-IC:/g" -e "s/-I\\..\\/-I..\\/g" > compile_flags.txt
@@ -0,0 +1,132 @@
+/**
+ * @file texconv.c
+ * @author Aditya Rajagopal
+ * @brief Command line tool that converts PNG, JPG, TGA and BMP images into engine texture files.
+ * @details Usage: texconv [-f format] [-n] [-l] <input image> <output texture>
+ *
+ *     -f format   rgba8, bc1, bc3 or bc7 (the default)
+ *     -n          store only the largest level instead of the full mip chain
+ *     -l          the image holds linear data such as normals or masks rather than sRGB colors
+ *
+ * The output can be loaded with fr_texture_file_open, packed with the packer tool, or acquired through the resource
+ * system as RESOURCE_TYPE_TEXTURE.
+ * @version 0.0.1
+ * @date 2024-04-25
+ *
+ * @copyright Fracture Game Engine is Copyright (c) Aditya Rajagopal 2024-2024
+ *
+ */
+#include <fracture.h>
+#include <string.h>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+static void _texconv_usage() {
+    FR_INFO("Usage: texconv [-f rgba8|bc1|bc3|bc7] [-n] [-l] <input image> <output texture>");
+}
+
+static b8 _texconv_parse_format(const char* name, texture_formats* out_format) {
+    static const struct {
+        const char* name;
+        texture_formats format;
+    } formats[] = {
+        {"rgba8", TEXTURE_FORMAT_RGBA8},
+        {"bc1", TEXTURE_FORMAT_BC1},
+        {"bc3", TEXTURE_FORMAT_BC3},
+        {"bc7", TEXTURE_FORMAT_BC7},
+    };
+    for (u32 i = 0; i < sizeof(formats) / sizeof(formats[0]); ++i) {
+        if (strcmp(name, formats[i].name) == 0) {
+            *out_format = formats[i].format;
+            return TRUE;
+        }
+    }
+    FR_ERROR("Unknown texture format: %s", name);
+    return FALSE;
+}
+
+static b8 _texconv_write(const char* path, const u8* data, u64 size) {
+    file_handle file;
+    if (!fr_file_open(path, FILE_MODE_WRITE, &file)) {
+        return FALSE;
+    }
+    b8 written = fr_file_write(&file, 0, size, data, NULL_PTR);
+    fr_file_close(&file);
+    if (!written) {
+        FR_ERROR("Failed to write %s", path);
+    }
+    return written;
+}
+
+int main(int argc, char** argv) {
+    fr_memory_initialize();
+    logging_config log_config = {0};
+    log_config.enable_console = TRUE;
+    log_config.logging_flags = FR_LOG_LEVEL_DEFAULT;
+    fr_logging_initialize(&log_config);
+
+    texture_encode_desc desc = {0};
+    desc.format = TEXTURE_FORMAT_BC7;
+    desc.generate_mips = TRUE;
+    desc.srgb = TRUE;
+    int arg = 1;
+    for (; arg < argc && argv[arg][0] == '-'; ++arg) {
+        if (argv[arg][1] == 'f' && argv[arg][2] == 0 && arg + 1 < argc) {
+            if (!_texconv_parse_format(argv[++arg], &desc.format)) {
+                return 1;
+            }
+        } else if (argv[arg][1] == 'n' && argv[arg][2] == 0) {
+            desc.generate_mips = FALSE;
+        } else if (argv[arg][1] == 'l' && argv[arg][2] == 0) {
+            desc.srgb = FALSE;
+        } else {
+            _texconv_usage();
+            return 1;
+        }
+    }
+    if (argc - arg != 2) {
+        _texconv_usage();
+        return 1;
+    }
+
+    const char* input = argv[arg];
+    const char* output = argv[arg + 1];
+    int width, height, channels;
+    u8* pixels = stbi_load(input, &width, &height, &channels, 4);
+    if (pixels == NULL_PTR) {
+        FR_ERROR("Failed to load %s: %s", input, stbi_failure_reason());
+        return 1;
+    }
+    if (desc.format == TEXTURE_FORMAT_BC1 && (channels == 2 || channels == 4)) {
+        FR_WARN("%s has an alpha channel that BC1 does not store, use bc3 or bc7 to keep it", input);
+    }
+
+    desc.pixels = pixels;
+    desc.width = (u32)width;
+    desc.height = (u32)height;
+    u8* file = NULL_PTR;
+    u64 file_size = 0;
+    b8 converted = fr_texture_encode(&desc, &file, &file_size);
+    stbi_image_free(pixels);
+    if (!converted) {
+        return 1;
+    }
+
+    b8 written = _texconv_write(output, file, file_size);
+    if (written) {
+        u64 source_size = (u64)width * height * 4;
+        FR_INFO("Converted %s (%dx%d) into %s: %llu bytes for the largest level instead of %llu",
+                input,
+                width,
+                height,
+                output,
+                ((const texture_file_mip*)(file + sizeof(texture_file_header)))->size,
+                source_size);
+    }
+    fr_texture_encode_free(file, file_size);
+
+    fr_logging_shutdown();
+    fr_memory_shutdown();
+    return written ? 0 : 1;
+}